@@ -9,13 +9,32 @@ out vec4 fColor;
 out vec2 fUV1;
 
 // Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
 uniform mat4 gViewMatrix;
 uniform mat4 gProjMatrix;
 uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
 uniform mat4 gObjectToWorldMatrix;
 
 // User-defined uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform MaterialBlock
+{
+    vec4 uColor;
+    vec4 uReplaceColor;
+};
+#else
 uniform vec4 uColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+#endif
 
 void main()
 {
@@ -0,0 +1,50 @@
+#version 150
+
+in vec3 vPos;
+in vec3 vNormal;
+in vec2 vUV1;
+
+// Per-instance object to world matrix (instead of the gObjectToWorldMatrix uniform).
+in mat4 vInstanceTransform;
+
+out vec4 fColor;
+out vec2 fUV1;
+
+// Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
+uniform mat4 gViewMatrix;
+uniform mat4 gProjMatrix;
+uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
+
+// User-defined uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform MaterialBlock
+{
+    vec4 uColor;
+    vec4 uReplaceColor;
+};
+#else
+uniform vec4 uColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+#endif
+
+void main()
+{
+    // Pass through color attribute.
+	fColor = uColor;
+    
+    // Pass through the UV attribute.
+    fUV1 = vUV1;
+    
+    // Transform position obj->world->view->proj
+    gl_Position = gWorldToProjMatrix * vInstanceTransform * vec4(vPos, 1.0f);
+}
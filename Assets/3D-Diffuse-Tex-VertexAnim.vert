@@ -0,0 +1,69 @@
+#version 150
+
+in vec3 vPos;
+in vec3 vNormal;
+in vec2 vUV1;
+
+out vec4 fColor;
+out vec2 fUV1;
+
+// Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
+uniform mat4 gViewMatrix;
+uniform mat4 gProjMatrix;
+uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
+uniform mat4 gObjectToWorldMatrix;
+
+// User-defined uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform MaterialBlock
+{
+    vec4 uColor;
+    vec4 uReplaceColor;
+};
+#else
+uniform vec4 uColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+#endif
+
+// Vertex animation uniforms
+// Keyframe positions are stored as normalized 16-bit values (X, Y, Z per vertex, one keyframe after another).
+// "From" and "To" are the texel offsets of the two keyframes to interpolate between, and "T" is how far between them we are.
+uniform samplerBuffer uVertexAnimKeyframes;
+uniform int uVertexAnimFrom;
+uniform int uVertexAnimTo;
+uniform float uVertexAnimT;
+uniform float uVertexAnimOffset;
+uniform float uVertexAnimScale;
+
+void main()
+{
+    // Pass through color attribute.
+	fColor = uColor;
+    
+    // Pass through the UV attribute.
+    fUV1 = vUV1;
+    
+    // Look up this vertex's position in both keyframes and interpolate between them.
+    // This replaces the position attribute entirely - vPos is not used.
+    int vertexOffset = gl_VertexID * 3;
+    vec3 fromPos = vec3(texelFetch(uVertexAnimKeyframes, uVertexAnimFrom + vertexOffset).r,
+                        texelFetch(uVertexAnimKeyframes, uVertexAnimFrom + vertexOffset + 1).r,
+                        texelFetch(uVertexAnimKeyframes, uVertexAnimFrom + vertexOffset + 2).r);
+    vec3 toPos = vec3(texelFetch(uVertexAnimKeyframes, uVertexAnimTo + vertexOffset).r,
+                      texelFetch(uVertexAnimKeyframes, uVertexAnimTo + vertexOffset + 1).r,
+                      texelFetch(uVertexAnimKeyframes, uVertexAnimTo + vertexOffset + 2).r);
+    vec3 pos = vec3(uVertexAnimOffset) + mix(fromPos, toPos, uVertexAnimT) * uVertexAnimScale;
+    
+    // Transform position obj->world->view->proj
+    gl_Position = gWorldToProjMatrix * gObjectToWorldMatrix * vec4(pos, 1.0f);
+}
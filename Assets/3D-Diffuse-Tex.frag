@@ -6,7 +6,20 @@ in vec2 fUV1;
 out vec4 oColor;
 
 // Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
+uniform mat4 gViewMatrix;
+uniform mat4 gProjMatrix;
+uniform mat4 gWorldToProjMatrix;
 uniform float gAlphaTest;
+#endif
 
 // User-defined uniforms
 uniform sampler2D uDiffuse;
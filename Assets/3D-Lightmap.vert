@@ -7,9 +7,20 @@ out vec2 fUV1;
 out vec2 fUV2;
 
 // Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
 uniform mat4 gViewMatrix;
 uniform mat4 gProjMatrix;
 uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
 uniform mat4 gObjectToWorldMatrix;
 
 // User-defined uniforms
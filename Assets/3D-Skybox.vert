@@ -5,7 +5,20 @@ in vec3 vPos;
 out vec3 fTexCoords;
 
 // Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
+uniform mat4 gViewMatrix;
+uniform mat4 gProjMatrix;
 uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
 
 void main()
 {
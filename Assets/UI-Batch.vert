@@ -0,0 +1,48 @@
+#version 150
+
+in vec3 vPos;
+in vec4 vColor;
+in vec2 vUV1;
+
+out vec4 fColor;
+out vec2 fUV1;
+
+// Built-in uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform FrameBlock
+{
+    mat4 gViewMatrix;
+    mat4 gProjMatrix;
+    mat4 gWorldToProjMatrix;
+    float gAlphaTest;
+};
+#else
+uniform mat4 gViewMatrix;
+uniform mat4 gProjMatrix;
+uniform mat4 gWorldToProjMatrix;
+uniform float gAlphaTest;
+#endif
+uniform mat4 gObjectToWorldMatrix;
+
+// User-defined uniforms
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform MaterialBlock
+{
+    vec4 uColor;
+    vec4 uReplaceColor;
+};
+#else
+uniform vec4 uColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+#endif
+
+void main()
+{
+    // UI is batched, so each quad's color comes from its vertices rather than a uniform.
+    fColor = vColor * uColor;
+    
+    // Pass through the UV attribute.
+    fUV1 = vUV1;
+    
+    // Batched positions are already in world space, so the object to world matrix is usually identity.
+    gl_Position = gWorldToProjMatrix * gObjectToWorldMatrix * vec4(vPos, 1.0f);
+}
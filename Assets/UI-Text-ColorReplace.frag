@@ -7,7 +7,15 @@ out vec4 oColor;
 
 // User-defined uniforms
 uniform sampler2D uDiffuse;
+#ifdef USE_UNIFORM_BUFFERS
+layout(std140) uniform MaterialBlock
+{
+    vec4 uColor;
+    vec4 uReplaceColor;
+};
+#else
 uniform vec4 uReplaceColor;
+#endif
 
 void main()
 {
@@ -0,0 +1,179 @@
+//
+// ActionIndex.cpp
+//
+// Clark Kromenaker
+//
+#include "ActionIndex.h"
+
+#include <algorithm>
+
+#include "NVC.h"
+
+namespace
+{
+	const Atom kAnyObject("any_object");
+	const Atom kAnyInvItem("any_inv_item");
+}
+
+void ActionIndex::Add(const Action* action, int actionSetIndex, int verbTypes)
+{
+	// Within a noun, an action set's actions are in file order, so each noun/verb list stays in priority order.
+	mNounVerbToActions[Atom::MakeKey(action->nounAtom, action->verbAtom)].push_back({ action, actionSetIndex });
+
+	std::vector<IndexedVerb>& verbs = mNounToVerbs[action->nounAtom];
+	auto it = std::find_if(verbs.begin(), verbs.end(), [action](const IndexedVerb& verb) { return verb.verb == action->verbAtom; });
+	if(it == verbs.end())
+	{
+		// The "ANY_INV_ITEM" wildcard isn't any type of verb on its own - it only matches when a specific verb is given.
+		IndexedVerb verb;
+		verb.verb = action->verbAtom;
+		verb.verbTypes = action->verbAtom != kAnyInvItem ? verbTypes : 0;
+		verbs.push_back(verb);
+	}
+}
+
+void ActionIndex::Clear()
+{
+	mNounVerbToActions.clear();
+	mNounToVerbs.clear();
+}
+
+const Action* ActionIndex::GetExecuteAction(Atom noun, Atom verb, const CaseCheck& isCaseMet) const
+{
+	// Only the first action for this noun/verb combo in each action set is a candidate.
+	// Action sets are loaded such that the LAST valid candidate is the one we should use, so check from last to first.
+	const std::vector<IndexedAction>* actions = GetIndexedActions(noun, verb);
+	if(actions != nullptr)
+	{
+		for(int i = (int)actions->size() - 1; i >= 0; --i)
+		{
+			const IndexedAction& indexedAction = (*actions)[i];
+			if(i > 0 && (*actions)[i - 1].actionSetIndex == indexedAction.actionSetIndex) { continue; }
+
+			if(isCaseMet(indexedAction.action, VerbType::Normal))
+			{
+				return indexedAction.action;
+			}
+		}
+	}
+	return nullptr;
+}
+
+const Action* ActionIndex::GetAction(Atom noun, Atom verb, bool verbIsInventoryItem, const CaseCheck& isCaseMet) const
+{
+	// For any noun/verb pair, there is only ONE possible action that can be performed at any given time.
+	// The most specific valid action is used, so check from most specific to most general:
+	// noun/verb, noun/ANY_INV_ITEM, ANY_OBJECT/verb, and then ANY_OBJECT/ANY_INV_ITEM.
+	const std::vector<IndexedAction>* candidates[4] = {
+		GetIndexedActions(noun, verb),
+		verbIsInventoryItem ? GetIndexedActions(noun, kAnyInvItem) : nullptr,
+		GetIndexedActions(kAnyObject, verb),
+		verbIsInventoryItem ? GetIndexedActions(kAnyObject, kAnyInvItem) : nullptr
+	};
+	for(auto& actions : candidates)
+	{
+		if(actions == nullptr) { continue; }
+
+		// Within each, the last valid action (by action set, and then by order in the action set) is used.
+		for(auto it = actions->rbegin(); it != actions->rend(); ++it)
+		{
+			if(isCaseMet(it->action, VerbType::Normal))
+			{
+				return it->action;
+			}
+		}
+	}
+	return nullptr;
+}
+
+bool ActionIndex::GetActionBarActions(Atom noun, VerbType verbType, const CaseCheck& isCaseMet, std::vector<const Action*>* outActions) const
+{
+	// "ANY_OBJECT" is a wildcard. Any action with a noun of "ANY_OBJECT" can be valid for any noun passed in.
+	// Each verb only appears on the action bar once, so ANY_OBJECT actions are considered along with the noun's actions for the same verb.
+	auto anyObjectIt = mNounToVerbs.find(kAnyObject);
+	bool found = false;
+
+	// Verbs with actions for this noun.
+	auto nounIt = mNounToVerbs.find(noun);
+	if(nounIt != mNounToVerbs.end() && noun != kAnyObject)
+	{
+		for(const IndexedVerb& verb : nounIt->second)
+		{
+			if(!verb.IsType(verbType)) { continue; }
+
+			const Action* action = GetActionBarAction(GetIndexedActions(noun, verb.verb), GetIndexedActions(kAnyObject, verb.verb), verbType, isCaseMet);
+			if(action != nullptr)
+			{
+				if(outActions == nullptr) { return true; }
+				outActions->push_back(action);
+				found = true;
+			}
+		}
+	}
+
+	// Verbs with only ANY_OBJECT actions.
+	if(anyObjectIt != mNounToVerbs.end())
+	{
+		for(const IndexedVerb& verb : anyObjectIt->second)
+		{
+			if(!verb.IsType(verbType)) { continue; }
+
+			const std::vector<IndexedAction>* nounActions = GetIndexedActions(noun, verb.verb);
+			if(nounActions != nullptr && noun != kAnyObject) { continue; }
+
+			const Action* action = GetActionBarAction(nullptr, GetIndexedActions(kAnyObject, verb.verb), verbType, isCaseMet);
+			if(action != nullptr)
+			{
+				if(outActions == nullptr) { return true; }
+				outActions->push_back(action);
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+const std::vector<ActionIndex::IndexedAction>* ActionIndex::GetIndexedActions(Atom noun, Atom verb) const
+{
+	auto it = mNounVerbToActions.find(Atom::MakeKey(noun, verb));
+	return it != mNounVerbToActions.end() ? &it->second : nullptr;
+}
+
+const Action* ActionIndex::GetActionBarAction(const std::vector<IndexedAction>* nounActions, const std::vector<IndexedAction>* anyObjectActions,
+											  VerbType verbType, const CaseCheck& isCaseMet) const
+{
+	// Both lists are in action set order, so work backwards through them one action set at a time.
+	int nounEnd = nounActions != nullptr ? (int)nounActions->size() : 0;
+	int anyObjectEnd = anyObjectActions != nullptr ? (int)anyObjectActions->size() : 0;
+	while(nounEnd > 0 || anyObjectEnd > 0)
+	{
+		int actionSetIndex = std::max(nounEnd > 0 ? (*nounActions)[nounEnd - 1].actionSetIndex : -1,
+									  anyObjectEnd > 0 ? (*anyObjectActions)[anyObjectEnd - 1].actionSetIndex : -1);
+
+		// Within the action set, the first action with its case met is used - and one for the noun beats one for ANY_OBJECT.
+		// Ex: if ANY_OBJECT, LOOK, CASE1 matches, but then CANDY, LOOK, CASE2 matches exactly - use the second one.
+		int nounStart = nounEnd;
+		while(nounStart > 0 && (*nounActions)[nounStart - 1].actionSetIndex == actionSetIndex) { --nounStart; }
+		for(int i = nounStart; i < nounEnd; ++i)
+		{
+			if(isCaseMet((*nounActions)[i].action, verbType))
+			{
+				return (*nounActions)[i].action;
+			}
+		}
+
+		int anyObjectStart = anyObjectEnd;
+		while(anyObjectStart > 0 && (*anyObjectActions)[anyObjectStart - 1].actionSetIndex == actionSetIndex) { --anyObjectStart; }
+		for(int i = anyObjectStart; i < anyObjectEnd; ++i)
+		{
+			if(isCaseMet((*anyObjectActions)[i].action, verbType))
+			{
+				return (*anyObjectActions)[i].action;
+			}
+		}
+
+		nounEnd = nounStart;
+		anyObjectEnd = anyObjectStart;
+	}
+	return nullptr;
+}
@@ -0,0 +1,86 @@
+//
+// ActionIndex.h
+//
+// Clark Kromenaker
+//
+// Actions from the active action sets (NVC files), indexed by noun and verb.
+// Queries only look at actions that could match, rather than every action in every action set.
+//
+// Whether an action's case is met is up to the caller (see ActionManager::IsCaseMet).
+//
+#pragma once
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "Atom.h"
+
+struct Action;
+
+enum class VerbType
+{
+	Normal,
+	Inventory,
+	Topic
+};
+
+class ActionIndex
+{
+public:
+	// Returns true if the case for an action is met.
+	typedef std::function<bool(const Action*, VerbType)> CaseCheck;
+
+	// Bit flag for a verb type, for the verb types passed to Add.
+	static int GetVerbTypeFlag(VerbType verbType) { return 1 << static_cast<int>(verbType); }
+
+	// Adds an action from an action set. Action sets must be added in order, since later action sets take priority.
+	// Verb types are the verb's types (see GetVerbTypeFlag). Only the verb types for the first action for a noun/verb are used.
+	void Add(const Action* action, int actionSetIndex, int verbTypes);
+	void Clear();
+
+	// Gets the action to execute for a noun/verb: from the last action set with a valid action, the first action for that noun/verb.
+	// No wildcards are used.
+	const Action* GetExecuteAction(Atom noun, Atom verb, const CaseCheck& isCaseMet) const;
+
+	// Gets the one action that can be performed for a noun/verb, including ANY_OBJECT and ANY_INV_ITEM wildcards.
+	// The ANY_INV_ITEM wildcard only applies if the verb is an inventory item.
+	const Action* GetAction(Atom noun, Atom verb, bool verbIsInventoryItem, const CaseCheck& isCaseMet) const;
+
+	// Finds the action bar actions (one per verb) of a verb type for a noun, and adds them to the given vector.
+	// If the vector is null, stops at the first action found. Returns true if any action was found.
+	bool GetActionBarActions(Atom noun, VerbType verbType, const CaseCheck& isCaseMet, std::vector<const Action*>* outActions) const;
+
+private:
+	struct IndexedAction
+	{
+		const Action* action = nullptr;
+
+		// Index of the action set this action came from. Actions from later action sets take priority.
+		int actionSetIndex = 0;
+	};
+
+	// Actions for each noun/verb pair (see Atom::MakeKey), in the order they were added.
+	// Wildcards (ANY_OBJECT, ANY_INV_ITEM) are indexed like any other noun or verb.
+	std::unordered_map<U64, std::vector<IndexedAction>> mNounVerbToActions;
+
+	struct IndexedVerb
+	{
+		Atom verb;
+
+		// Which verb types this verb is, as bit flags (see GetVerbTypeFlag).
+		int verbTypes = 0;
+
+		bool IsType(VerbType verbType) const { return (verbTypes & GetVerbTypeFlag(verbType)) != 0; }
+	};
+
+	// Verbs that have actions for each noun, in the order they were first added.
+	std::unordered_map<Atom, std::vector<IndexedVerb>> mNounToVerbs;
+
+	// Gets indexed actions for a noun/verb pair, or null if there aren't any.
+	const std::vector<IndexedAction>* GetIndexedActions(Atom noun, Atom verb) const;
+
+	// Gets the action to use for a verb on the action bar: the first action with its case met, in priority order.
+	// Later action sets take priority. Within an action set, actions for the noun come before ANY_OBJECT actions.
+	const Action* GetActionBarAction(const std::vector<IndexedAction>* nounActions, const std::vector<IndexedAction>* anyObjectActions,
+									 VerbType verbType, const CaseCheck& isCaseMet) const;
+};
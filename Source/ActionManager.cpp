@@ -8,6 +8,7 @@
 #include <cassert>
 
 #include "ActionBar.h"
+#include "ConditionCache.h"
 #include "VerbManager.h"
 #include "GameProgress.h"
 #include "GKActor.h"
@@ -25,6 +26,9 @@ void ActionManager::Init()
 	mSheepCommandAction.noun = "SHEEP_COMMAND";
 	mSheepCommandAction.verb = "NONE";
 	mSheepCommandAction.caseLabel = "NONE";
+	mSheepCommandAction.nounAtom = Atom(mSheepCommandAction.noun);
+	mSheepCommandAction.verbAtom = Atom(mSheepCommandAction.verb);
+	mSheepCommandAction.caseAtom = Atom(mSheepCommandAction.caseLabel);
 	
 	// Create action bar, which will be used to choose nouns/verbs by the player.
 	mActionBar = new ActionBar();
@@ -63,6 +67,18 @@ void ActionManager::AddActionSet(const std::string& assetName)
 				mVerbs.push_back(action->verb);
 			}
 		}
+		
+		// Add the actions to the index too.
+		int actionSetIndex = (int)mActionSets.size() - 1;
+		VerbManager* verbManager = Services::Get<VerbManager>();
+		for(auto& action : actions)
+		{
+			int verbTypes = 0;
+			verbTypes |= verbManager->IsVerb(action->verb) ? ActionIndex::GetVerbTypeFlag(VerbType::Normal) : 0;
+			verbTypes |= verbManager->IsInventoryItem(action->verb) ? ActionIndex::GetVerbTypeFlag(VerbType::Inventory) : 0;
+			verbTypes |= verbManager->IsTopic(action->verb) ? ActionIndex::GetVerbTypeFlag(VerbType::Topic) : 0;
+			mActionIndex.Add(action, actionSetIndex, verbTypes);
+		}
 	}
 }
 
@@ -98,27 +114,19 @@ void ActionManager::ClearActionSets()
 	mNouns.clear();
 	mVerbToEnum.clear();
 	mVerbs.clear();
+	mActionIndex.Clear();
+	
+	// The cleared actions' case logic won't be evaluated again until their scene is loaded again, so don't keep results for it.
+	ConditionCache::Clear();
 }
 
 bool ActionManager::ExecuteAction(const std::string& noun, const std::string& verb)
 {
-	// Iterate action sets and find a valid candidate for this noun/verb combo.
-	// Action sets are loaded such that the LAST valid candidate we find is the one we should use.
-	const Action* candidate = nullptr;
-	for(auto& actionSet : mActionSets)
-	{
-		const Action* action = actionSet->GetAction(noun, verb);
-		if(action != nullptr && IsCaseMet(action))
-		{
-			candidate = action;
-			continue;
-		}
-	}
-	
 	// Execute action if we found a valid one.
-	if(candidate != nullptr)
+	const Action* action = mActionIndex.GetExecuteAction(Atom::Find(noun), Atom::Find(verb), GetCaseCheck());
+	if(action != nullptr)
 	{
-		ExecuteAction(candidate);
+		ExecuteAction(action);
 		return true;
 	}
 	return false;
@@ -149,7 +157,7 @@ void ActionManager::ExecuteAction(const Action* action)
 	// If this is a topic, automatically increment topic counts.
 	if(Services::Get<VerbManager>()->IsTopic(action->verb))
 	{
-		Services::Get<GameProgress>()->IncTopicCount(action->noun, action->verb);
+		Services::Get<GameProgress>()->IncTopicCount(action->nounAtom, action->verbAtom);
 	}
 	
 	// If no script is associated with the action, that might be an error...
@@ -168,179 +176,20 @@ void ActionManager::ExecuteAction(const Action* action)
 
 const Action* ActionManager::GetAction(const std::string& noun, const std::string& verb) const
 {
-	// For any noun/verb pair, there is only ONE possible action that can be performed at any given time.
-	// Keep track of the candidate as we iterate from most general/broad to most specific.
-	// The most specific valid action will be our candidate.
-	const Action* candidate = nullptr;
-	
-	// If the verb is an inventory item, handle ANY_OBJECT/ANY_INV_ITEM wildcards for noun/verb.
 	bool verbIsInventoryItem = Services::Get<VerbManager>()->IsInventoryItem(verb);
-	if(verbIsInventoryItem)
-	{
-		for(auto& nvc : mActionSets)
-		{
-			std::vector<const Action*> actionsForAnyObject = nvc->GetActions("ANY_OBJECT", "ANY_INV_ITEM");
-			for(auto& action : actionsForAnyObject)
-			{
-				if(IsCaseMet(action))
-				{
-					std::cout << "Candidate action for " << noun << "/" << verb << " matches ANY_OBJECT/ANY_INV_ITEM" << std::endl;
-					candidate = action;
-				}
-			}
-		}
-	}
-	
-	// Find any matches for "ANY_OBJECT" and this verb next.
-	for(auto& nvc : mActionSets)
-	{
-		std::vector<const Action*> actionsForAnyObject = nvc->GetActions("ANY_OBJECT", verb);
-		for(auto& action : actionsForAnyObject)
-		{
-			if(IsCaseMet(action))
-			{
-				std::cout << "Candidate action for " << noun << "/" << verb << " matches ANY_OBJECT/" << verb << std::endl;
-				candidate = action;
-			}
-		}
-	}
-	
-	// If the verb is an inventory item, handle noun/ANY_INV_ITEM combo.
-	// Find any matches for "ANY_OBJECT" and this verb next.
-	if(verbIsInventoryItem)
-	{
-		for(auto& nvc : mActionSets)
-		{
-			std::vector<const Action*> actionsForAnyObject = nvc->GetActions(noun, "ANY_INV_ITEM");
-			for(auto& action : actionsForAnyObject)
-			{
-				if(IsCaseMet(action))
-				{
-					std::cout << "Candidate action for " << noun << "/" << verb << " matches " << noun << "/ANY_INV_ITEM" << std::endl;
-					candidate = action;
-				}
-			}
-		}
-	}
-	
-	// Finally, check for any exact noun/verb matches.
-	for(auto& nvc : mActionSets)
-	{
-		std::vector<const Action*> actionsForAnyObject = nvc->GetActions(noun, verb);
-		for(auto& action : actionsForAnyObject)
-		{
-			if(IsCaseMet(action))
-			{
-				std::cout << "Candidate action for " << noun << "/" << verb << " matches " << noun << "/" << verb << std::endl;
-				candidate = action;
-			}
-		}
-	}
-	return candidate;
+	return mActionIndex.GetAction(Atom::Find(noun), Atom::Find(verb), verbIsInventoryItem, GetCaseCheck());
 }
 
 std::vector<const Action*> ActionManager::GetActions(const std::string& noun, VerbType verbType) const
 {
-	// As we find actions for this noun, we don't want repeated "verbs".
-	// For example, if two actions exist for the verb "LOOK", we don't want two look actions on the action bar!
-	// So, keep track of the verb-to-action mappings; only the first verb with a true case will be used.
-	std::unordered_map<std::string, const Action*> verbToAction;
-	
-	// Iterate all loaded action sets to find valid actions for this noun.
-	for(auto& actionSet : mActionSets)
-	{
-		// Within a single action set, we only want to use the first matching verb.
-		// Ex: if NOUN, VERB, CASE1 matches and is then followed by NOUN, VERB, CASE2 (which also matches), ignore the second one.
-		std::unordered_set<std::string> usedVerbs;
-		
-		// "ANY_OBJECT" is a wildcard. Any action with a noun of "ANY_OBJECT" can be valid for any noun passed in.
-		// These are lowest-priority, so we do them first (they might be overwritten later).
-		const std::vector<Action>& anyObjectActions = actionSet->GetActions("ANY_OBJECT");
-		for(auto& action : anyObjectActions)
-		{
-			// The "ANY_INV_ITEM" wildcard only matches if a specific verb was provided.
-			// This function doesn't let you specify a verb, so this never matches.
-			bool isWildcardInvItem = StringUtil::EqualsIgnoreCase(action.verb, "ANY_INV_ITEM");
-			if(isWildcardInvItem) { continue; }
-			
-			// Ignore this action if the verb has already been used in this action set.
-			if(usedVerbs.find(action.verb) != usedVerbs.end()) { continue; }
-			
-			// The action's verb must be of the correct type for us to use it.
-			bool validType = false;
-			switch(verbType)
-			{
-			case VerbType::Normal:
-				validType = Services::Get<VerbManager>()->IsVerb(action.verb);
-				break;
-			case VerbType::Inventory:
-				validType = Services::Get<VerbManager>()->IsInventoryItem(action.verb);
-				break;
-			case VerbType::Topic:
-				validType = Services::Get<VerbManager>()->IsTopic(action.verb);
-				break;
-			}
-			
-			// If type is valid and the action meets any case specified, we can use this action!
-			if(validType && IsCaseMet(&action, verbType))
-			{
-				verbToAction[action.verb] = &action;
-				usedVerbs.insert(action.verb);
-			}
-		}
-		
-		// Clear used verbs here - we allow an exact match to overwrite a wildcard match.
-		// Ex: ANY_OBJECT, LOOK, CASE1 matches, but then CANDY, LOOK, CASE2 matches exactly - use the second one.
-		usedVerbs.clear();
-		
-		// Check actions that map directly to this noun.
-		const std::vector<Action>& nounActions = actionSet->GetActions(noun);
-		for(auto& action : nounActions)
-		{
-			// The "ANY_INV_ITEM" wildcard only matches if a specific verb was provided.
-			// This function doesn't let you specify a verb, so this never matches.
-			bool isWildcardInvItem = StringUtil::EqualsIgnoreCase(action.verb, "ANY_INV_ITEM");
-			if(isWildcardInvItem) { continue; }
-			
-			// Ignore this action if the verb has already been used in this action set.
-			if(usedVerbs.find(action.verb) != usedVerbs.end()) { continue; }
-						
-			// The action's verb must be of the correct type for us to use it.
-			bool validType = false;
-			switch(verbType)
-			{
-			case VerbType::Normal:
-				validType = Services::Get<VerbManager>()->IsVerb(action.verb);
-				break;
-			case VerbType::Inventory:
-				validType = Services::Get<VerbManager>()->IsInventoryItem(action.verb);
-				break;
-			case VerbType::Topic:
-				validType = Services::Get<VerbManager>()->IsTopic(action.verb);
-				break;
-			}
-			
-			// If type is valid and the action meets any case specified, we can use this action!
-			if(validType && IsCaseMet(&action, verbType))
-			{
-				verbToAction[action.verb] = &action;
-				usedVerbs.insert(action.verb);
-			}
-		}
-	}
-	
-	// Finally, convert our map to a vector to return.
-	std::vector<const Action*> viableActions;
-	for(auto entry : verbToAction)
-	{
-		viableActions.push_back(entry.second);
-	}
-	return viableActions;
+	std::vector<const Action*> actions;
+	mActionIndex.GetActionBarActions(Atom::Find(noun), verbType, GetCaseCheck(), &actions);
+	return actions;
 }
 
-bool ActionManager::HasTopicsLeft(const std::string &noun) const
+bool ActionManager::HasTopicsLeft(const std::string& noun) const
 {
-	return GetActions(noun, VerbType::Topic).size() > 0;
+	return mActionIndex.GetActionBarActions(Atom::Find(noun), VerbType::Topic, GetCaseCheck(), nullptr);
 }
 
 std::string& ActionManager::GetNoun(int nounEnum)
@@ -353,19 +202,9 @@ std::string& ActionManager::GetVerb(int verbEnum)
 	return mVerbs[Math::Clamp(verbEnum, 0, (int)mVerbs.size() - 1)];
 }
 
-// Temp, for debugging.
-void OutputActions(const std::vector<const Action*>& actions)
-{
-	for(auto& action : actions)
-	{
-		std::cout << "Action " << action->ToString() << std::endl;
-	}
-}
-
 void ActionManager::ShowActionBar(const std::string& noun, std::function<void(const Action*)> selectCallback)
 {
 	auto actions = GetActions(noun, VerbType::Normal);
-	OutputActions(actions);
 	mActionBar->Show(noun, VerbType::Normal, actions, selectCallback, std::bind(&ActionManager::OnActionBarCanceled, this));
 }
 
@@ -382,7 +221,6 @@ void ActionManager::ShowTopicBar(const std::string& noun)
 	if(actions.size() == 0) { return; }
 	
 	// Show topics.
-	OutputActions(actions);
 	mActionBar->Show(noun, VerbType::Topic, actions, nullptr, std::bind(&ActionManager::OnActionBarCanceled, this));
 }
 
@@ -465,6 +303,11 @@ bool ActionManager::IsActionSetForTimeblock(const std::string& assetName, const
 	return false;
 }
 
+ActionIndex::CaseCheck ActionManager::GetCaseCheck() const
+{
+	return [this](const Action* action, VerbType verbType) { return IsCaseMet(action, verbType); };
+}
+
 bool ActionManager::IsCaseMet(const Action* action, VerbType verbType) const
 {
 	// Empty condition is automatically met.
@@ -487,84 +330,96 @@ bool ActionManager::IsCaseMet(const Action* action, VerbType verbType) const
 	}
 	
 	// Check global case conditions.
-	if(StringUtil::EqualsIgnoreCase(action->caseLabel, "all"))
+	// Labels are compared as atoms, since this is called a lot when showing the action bar.
+	static const Atom kAllCase("all");
+	static const Atom kGabeAllCase("gabe_all");
+	static const Atom kGraceAllCase("grace_all");
+	static const Atom kFirstTimeCase("1st_time");
+	static const Atom kSecondTimeCase("2cd_time");
+	static const Atom kThirdTimeCase("3rd_time");
+	static const Atom kOtherTimeCase("otr_time");
+	static const Atom kDialogueTopicsLeftCase("dialogue_topics_left");
+	static const Atom kNotDialogueTopicsLeftCase("not_dialogue_topics_left");
+	static const Atom kTimeBlockOverrideCase("time_block_override");
+	static const Atom kTimeBlockCase("time_block");
+	if(action->caseAtom == kAllCase)
 	{
 		// all: same as "no condition" - condition is always met!
 		return true;
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "gabe_all"))
+	else if(action->caseAtom == kGabeAllCase)
 	{
 		// gabe_all: condition is met if Ego is Gabriel.
 		Scene* scene = GEngine::Instance()->GetScene();
 		GKActor* ego = scene != nullptr ? scene->GetEgo() : nullptr;
 		return ego != nullptr && StringUtil::EqualsIgnoreCase(ego->GetNoun(), "gabriel");
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "grace_all"))
+	else if(action->caseAtom == kGraceAllCase)
 	{
 		// grace_all: condition is met if Ego is Grace.
 		Scene* scene = GEngine::Instance()->GetScene();
 		GKActor* ego = scene != nullptr ? scene->GetEgo() : nullptr;
 		return ego != nullptr && StringUtil::EqualsIgnoreCase(ego->GetNoun(), "grace");
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "1st_time"))
+	else if(action->caseAtom == kFirstTimeCase)
 	{
 		// 1st_time: condition is met if this is the first time we've executed this action (noun/verb combo).
 		if(verbType == VerbType::Topic)
 		{
-			return Services::Get<GameProgress>()->GetTopicCount(action->noun, action->verb) == 0;
+			return Services::Get<GameProgress>()->GetTopicCount(action->nounAtom, action->verbAtom) == 0;
 		}
 		else
 		{
-			return Services::Get<GameProgress>()->GetNounVerbCount(action->noun, action->verb) == 0;
+			return Services::Get<GameProgress>()->GetNounVerbCount(action->nounAtom, action->verbAtom) == 0;
 		}
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "2cd_time"))
+	else if(action->caseAtom == kSecondTimeCase)
 	{
 		// 2cd_time: a surprising way to abbreviate "2nd time"...condition is met if this is the 2nd time we did the action.
 		if(verbType == VerbType::Topic)
 		{
-			return Services::Get<GameProgress>()->GetTopicCount(action->noun, action->verb) == 1;
+			return Services::Get<GameProgress>()->GetTopicCount(action->nounAtom, action->verbAtom) == 1;
 		}
 		else
 		{
-			return Services::Get<GameProgress>()->GetNounVerbCount(action->noun, action->verb) == 1;
+			return Services::Get<GameProgress>()->GetNounVerbCount(action->nounAtom, action->verbAtom) == 1;
 		}
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "3rd_time"))
+	else if(action->caseAtom == kThirdTimeCase)
 	{
 		// 3rd_time: and again for good measure.
 		if(verbType == VerbType::Topic)
 		{
-			return Services::Get<GameProgress>()->GetTopicCount(action->noun, action->verb) == 2;
+			return Services::Get<GameProgress>()->GetTopicCount(action->nounAtom, action->verbAtom) == 2;
 		}
 		else
 		{
-			return Services::Get<GameProgress>()->GetNounVerbCount(action->noun, action->verb) == 2;
+			return Services::Get<GameProgress>()->GetNounVerbCount(action->nounAtom, action->verbAtom) == 2;
 		}
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "otr_time"))
+	else if(action->caseAtom == kOtherTimeCase)
 	{
 		// otr_time: condition is met if this IS NOT the first time we've executed this action (noun/verb combo).
 		if(verbType == VerbType::Topic)
 		{
-			return Services::Get<GameProgress>()->GetTopicCount(action->noun, action->verb) > 0;
+			return Services::Get<GameProgress>()->GetTopicCount(action->nounAtom, action->verbAtom) > 0;
 		}
 		else
 		{
-			return Services::Get<GameProgress>()->GetNounVerbCount(action->noun, action->verb) > 0;
+			return Services::Get<GameProgress>()->GetNounVerbCount(action->nounAtom, action->verbAtom) > 0;
 		}
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "dialogue_topics_left"))
+	else if(action->caseAtom == kDialogueTopicsLeftCase)
 	{
 		// dialogue_topics_left: condition is met if there are any "topic" type actions available for this noun.
 		return HasTopicsLeft(action->noun);
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "not_dialogue_topics_left"))
+	else if(action->caseAtom == kNotDialogueTopicsLeftCase)
 	{
 		// not_dialogue_topics_left: condition is met if there are no more "topic" type actions available for this noun.
 		return !HasTopicsLeft(action->noun);
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "time_block_override"))
+	else if(action->caseAtom == kTimeBlockOverrideCase)
 	{
 		// time_block_override: not 100% sure...only appears in timeblock-specific NVC files.
 		// Possibilities:
@@ -576,10 +431,9 @@ bool ActionManager::IsCaseMet(const Action* action, VerbType verbType) const
 		// RC1_ALL.NVC has (TELE_SIGN, LOOK, GABE_ALL), which executes some VO.
 		// RC1110A.NVC has (TELE_SIGN, LOOK, TIME_BLOCK_OVERRIDE), which executes different VO.
 		// So...seems the idea would be to play the timeblock-specific VO during that timeblock, but fall back on general one otherwise?
-		std::cout << "Using TIME_BLOCK_OVERRIDE global condition!" << std::endl;
 		return true;
 	}
-	else if(StringUtil::EqualsIgnoreCase(action->caseLabel, "time_block"))
+	else if(action->caseAtom == kTimeBlockCase)
 	{
 		//TODO
 	}
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "ActionIndex.h"
 #include "NVC.h"
 #include "Type.h"
 
@@ -19,13 +20,6 @@ class GKActor;
 class SheepScript;
 class Timeblock;
 
-enum class VerbType
-{
-	Normal,
-	Inventory,
-	Topic
-};
-
 class ActionManager
 {
 	TYPE_DECL_BASE();
@@ -104,6 +98,10 @@ private:
 	// Cases must be stored here (rather than in Action Sets) because cases can be shared (especially global/inventory ones).
     std::unordered_map<std::string, SheepScript*> mCaseLogic;
 	
+	// Actions in the active action sets, indexed so that queries only look at actions that could match.
+	// Added to as action sets are added, and cleared along with them.
+	ActionIndex mActionIndex;
+	
 	// Nouns and verbs that are currently active. Pulled out of action sets as they are loaded.
 	// We do this to support the Sheep-eval feature of specifying n$ and v$ variables as wildcards for current noun/verb.
 	// To use these, we must map each active noun/verb to an integer and back again.
@@ -134,6 +132,9 @@ private:
 	// Checks asset name against current timeblock to see if the asset should be used.
 	bool IsActionSetForTimeblock(const std::string& assetName, const Timeblock& timeblock);
 	
+	// Wraps IsCaseMet for action index queries.
+	ActionIndex::CaseCheck GetCaseCheck() const;
+	
 	// Returns true if the case for an action is met.
 	// A case can be a global condition, or some user-defined script to evaluate.
 	bool IsCaseMet(const Action* item, VerbType verbType = VerbType::Normal) const;
@@ -140,10 +140,35 @@ void AssetManager::WriteBarnAssetToFile(const std::string& assetName)
 void AssetManager::WriteBarnAssetToFile(const std::string& assetName, const std::string& outputDir)
 {
 	BarnFile* barn = GetBarnContainingAsset(assetName);
-	if(barn != nullptr)
+	if(barn == nullptr) { return; }
+	
+	// Textures can't be written directly to file and open correctly, so convert them to a proper BMP first.
+	// This is done here (rather than in BarnFile) so barn reading doesn't depend on rendering code.
+	if(assetName.find(".BMP") != std::string::npos)
 	{
-		barn->WriteToFile(assetName, outputDir);
+		BarnAsset* asset = barn->GetAsset(assetName);
+		unsigned int bufferSize = asset->uncompressedSize;
+		char* buffer = new char[bufferSize];
+		if(barn->Extract(assetName, buffer, bufferSize))
+		{
+			std::string outputPath = assetName;
+			if(!outputDir.empty())
+			{
+				Directory::CreateAll(outputDir);
+				if(Directory::Exists(outputDir))
+				{
+					outputPath = Path::Combine({ outputDir, assetName });
+				}
+			}
+			
+			Texture texture(assetName, buffer, bufferSize);
+			texture.WriteToFile(outputPath);
+			std::cout << "Wrote out " << assetName << std::endl;
+		}
+		delete[] buffer;
+		return;
 	}
+	barn->WriteToFile(assetName, outputDir);
 }
 
 void AssetManager::WriteAllBarnAssetsToFile(const std::string& search)
@@ -153,11 +178,22 @@ void AssetManager::WriteAllBarnAssetsToFile(const std::string& search)
 
 void AssetManager::WriteAllBarnAssetsToFile(const std::string& search, const std::string& outputDir)
 {
-	// Pass the buck to all loaded barn files.
+	// Write out each matching asset, so assets that need converting are handled the same as when written individually.
+	for(auto& assetName : GetBarnAssetNames(search))
+	{
+		WriteBarnAssetToFile(assetName, outputDir);
+	}
+}
+
+std::vector<std::string> AssetManager::GetBarnAssetNames(const std::string& search) const
+{
+	std::vector<std::string> assetNames;
 	for(auto& entry : mLoadedBarns)
 	{
-		entry.second->WriteAllToFile(search, outputDir);
+		std::vector<std::string> barnAssetNames = entry.second->GetAssetNames(search);
+		assetNames.insert(assetNames.end(), barnAssetNames.begin(), barnAssetNames.end());
 	}
+	return assetNames;
 }
 
 Audio* AssetManager::LoadAudio(const std::string& name)
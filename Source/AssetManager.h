@@ -53,6 +53,9 @@ public:
 	void WriteAllBarnAssetsToFile(const std::string& search);
 	void WriteAllBarnAssetsToFile(const std::string& search, const std::string& outputDir);
 	
+	// Gets the names of all assets in loaded bundles that match a search string.
+	std::vector<std::string> GetBarnAssetNames(const std::string& search) const;
+	
     Audio* LoadAudio(const std::string& name);
     Soundtrack* LoadSoundtrack(const std::string& name);
 	Animation* LoadYak(const std::string& name);
@@ -0,0 +1,94 @@
+//
+// Atom.cpp
+//
+// Clark Kromenaker
+//
+#include "Atom.h"
+
+#include <cctype>
+#include <deque>
+#include <unordered_map>
+
+#include "StringUtil.h"
+
+namespace
+{
+	// Hashes a string without regard to case, so the lookup table doesn't need lowercase copies of strings.
+	// This is FNV-1a, applied to the lowercase version of each character.
+	struct CaseInsensitiveHash
+	{
+		size_t operator()(const std::string& str) const
+		{
+			U32 hash = 2166136261u;
+			for(char c : str)
+			{
+				hash ^= static_cast<U32>(std::tolower(static_cast<unsigned char>(c)));
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+	};
+
+	struct CaseInsensitiveEqual
+	{
+		bool operator()(const std::string& str1, const std::string& str2) const
+		{
+			return StringUtil::EqualsIgnoreCase(str1, str2);
+		}
+	};
+
+	// Each interned string, indexed by atom ID.
+	// A deque is used so references returned by ToString stay valid as more atoms are created.
+	std::deque<std::string>& GetStrings()
+	{
+		// Empty string is always atom zero.
+		static std::deque<std::string> strings { "" };
+		return strings;
+	}
+
+	// Maps strings (case-insensitive) to atom ID.
+	std::unordered_map<std::string, U32, CaseInsensitiveHash, CaseInsensitiveEqual>& GetIds()
+	{
+		static std::unordered_map<std::string, U32, CaseInsensitiveHash, CaseInsensitiveEqual> ids { { "", 0 } };
+		return ids;
+	}
+}
+
+Atom::Atom(const std::string& str)
+{
+	auto& ids = GetIds();
+	auto it = ids.find(str);
+	if(it != ids.end())
+	{
+		mId = it->second;
+		return;
+	}
+
+	// First time seeing this string, so create a new atom for it.
+	auto& strings = GetStrings();
+	mId = static_cast<U32>(strings.size());
+	strings.push_back(str);
+	ids[str] = mId;
+}
+
+Atom::Atom(const char* str) : Atom(std::string(str != nullptr ? str : ""))
+{
+
+}
+
+/*static*/ Atom Atom::Find(const std::string& str)
+{
+	Atom atom;
+	auto& ids = GetIds();
+	auto it = ids.find(str);
+	if(it != ids.end())
+	{
+		atom.mId = it->second;
+	}
+	return atom;
+}
+
+const std::string& Atom::ToString() const
+{
+	return GetStrings()[mId];
+}
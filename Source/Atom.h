@@ -0,0 +1,57 @@
+//
+// Atom.h
+//
+// Clark Kromenaker
+//
+// An "interned" string, represented by a 32-bit integer.
+//
+// Almost all names in the game (nouns, verbs, actors, flags, scenes, etc) are case-insensitive.
+// Converting such a name to an atom once lets you compare or hash it as an integer from then on,
+// rather than lowercasing, concatenating, and comparing strings every time.
+//
+// Strings that differ only by case get the same atom. The atom remembers the first spelling it was created with.
+// Atoms should only be created on the main thread.
+//
+#pragma once
+#include <functional>
+#include <string>
+
+#include "Atomics.h"
+
+class Atom
+{
+public:
+	Atom() = default;
+	explicit Atom(const std::string& str);
+	explicit Atom(const char* str);
+
+	// Gets the atom for a string, but only if one already exists - a new one isn't created.
+	// Useful for lookups with arbitrary strings, since a string that was never interned can't match anything.
+	static Atom Find(const std::string& str);
+
+	// The atom's integer value. Zero is always the empty string.
+	U32 GetId() const { return mId; }
+	bool IsEmpty() const { return mId == 0; }
+
+	// The string this atom was first created with.
+	const std::string& ToString() const;
+
+	// Combines two atoms into one 64-bit key (e.g. for noun/verb pairs).
+	static U64 MakeKey(Atom first, Atom second) { return (static_cast<U64>(first.mId) << 32) | second.mId; }
+
+	bool operator==(const Atom& other) const { return mId == other.mId; }
+	bool operator!=(const Atom& other) const { return mId != other.mId; }
+	bool operator<(const Atom& other) const { return mId < other.mId; }
+
+private:
+	U32 mId = 0;
+};
+
+// Allows atoms to be used as keys in unordered containers.
+namespace std
+{
+	template<> struct hash<Atom>
+	{
+		size_t operator()(const Atom& atom) const { return std::hash<U32>()(atom.GetId()); }
+	};
+}
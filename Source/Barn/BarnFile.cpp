@@ -14,7 +14,6 @@
 #include "zlib.h"
 
 #include "FileSystem.h"
-#include "Texture.h"
 
 BarnFile::BarnFile(const std::string& filePath) :
     mName(filePath),
@@ -434,30 +433,19 @@ bool BarnFile::WriteToFile(const std::string& assetName, const std::string outpu
 		outputPath = asset->name;
 	}
 	
-	// Extract the asset and write it to file.
+	// Extract the asset and write it to file, as-is.
+	// Assets that need converting to open correctly (e.g. textures) are handled by AssetManager::WriteBarnAssetToFile.
 	bool result = false;
 	char* assetData = new char[asset->uncompressedSize];
 	if(Extract(assetName, assetData, asset->uncompressedSize))
 	{
-		// Textures can't be written directly to file and open correctly.
-		// Handle those separately (TODO: More modular/extenable way to do this?)
-		if(assetName.find(".BMP") != std::string::npos)
+		std::ofstream fileStream(outputPath);
+		if(fileStream.good())
 		{
-			Texture tex(assetName, assetData, asset->uncompressedSize);
-			tex.WriteToFile(outputPath);
+			fileStream.write(assetData, asset->uncompressedSize);
+			fileStream.close();
 			result = true;
 		}
-		else
-		{
-			// Most other assets can just be written out directly.
-			std::ofstream fileStream(outputPath);
-			if(fileStream.good())
-			{
-				fileStream.write(assetData, asset->uncompressedSize);
-				fileStream.close();
-				result = true;
-			}
-		}
 	}
 	
 	// Output the result of the write.
@@ -498,6 +486,22 @@ void BarnFile::WriteAllToFile(const std::string& search, const std::string outpu
 	}
 }
 
+std::vector<std::string> BarnFile::GetAssetNames(const std::string& search) const
+{
+	std::vector<std::string> assetNames;
+	for(auto& entry : mAssetMap)
+	{
+		// Asset pointers are listed by the barn that actually contains the asset.
+		if(entry.second.IsPointer()) { continue; }
+		
+		if(entry.first.find(search) != std::string::npos)
+		{
+			assetNames.push_back(entry.first);
+		}
+	}
+	return assetNames;
+}
+
 void BarnFile::OutputAssetList() const
 {
 	for(auto it = mAssetMap.begin(); it != mAssetMap.end(); it++)
@@ -7,6 +7,7 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "BarnAsset.h"
 #include "BinaryReader.h"
@@ -33,6 +34,9 @@ public:
 	void WriteAllToFile(const std::string& search);
 	void WriteAllToFile(const std::string& search, const std::string outputDir);
 	
+	// Gets the names of all assets (not asset pointers) whose names contain a search string.
+	std::vector<std::string> GetAssetNames(const std::string& search) const;
+	
 	// For debugging, output asset list to cout.
 	void OutputAssetList() const;
     
@@ -22,12 +22,19 @@ BinaryReader::BinaryReader(const char* filePath)
     if(!mStream->good())
     {
         std::cout << "BinaryReader can't read from file " << filePath << "!" << std::endl;
+        return;
     }
+    
+    // Find the file's length by seeking to the end.
+    mStream->seekg(0, std::ios::end);
+    mLength = (int)mStream->tellg();
+    mStream->seekg(0, std::ios::beg);
 }
 
 BinaryReader::BinaryReader(const char* memory, unsigned int memoryLength)
 {
     mStream = new imstream(memory, memoryLength);
+    mLength = (int)memoryLength;
 }
 
 BinaryReader::~BinaryReader()
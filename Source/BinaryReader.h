@@ -29,6 +29,9 @@ public:
     void Skip(int size);
     
 	int GetPosition() const { return (int)mStream->tellg(); }
+	
+	// Number of bytes left to read. Useful to check lengths and counts read from data before trusting them.
+	int GetRemaining() const { return OK() ? mLength - GetPosition() : 0; }
     
     int Read(char* buffer, int size);
     int Read(unsigned char* buffer, int size);
@@ -55,4 +58,7 @@ private:
 	// Stream we are reading from.
 	// Needs to be pointer because type of stream (memory, file, etc) changes sometimes.
     std::istream* mStream = nullptr;
+	
+	// Total length of the data, in bytes.
+	int mLength = 0;
 };
@@ -16,6 +16,12 @@ BinaryWriter::BinaryWriter(const char* filePath)
     }
 }
 
+BinaryWriter::BinaryWriter()
+{
+	mMemoryStream = new std::ostringstream(std::ios::out | std::ios::binary);
+	mStream = mMemoryStream;
+}
+
 BinaryWriter::~BinaryWriter()
 {
     delete mStream;
@@ -8,11 +8,15 @@
 //
 #pragma once
 #include <fstream>
+#include <sstream>
 
 class BinaryWriter
 {
 public:
     BinaryWriter(const char* filePath);
+	
+	// Writes to memory, rather than a file. Get the written bytes with GetMemory.
+	BinaryWriter();
     ~BinaryWriter();
 	
 	// Should only write if OK is true.
@@ -43,7 +47,13 @@ public:
     
     void WriteFloat(float val);
     void WriteDouble(double val);
+	
+	// Bytes written so far, if writing to memory.
+	std::string GetMemory() const { return mMemoryStream != nullptr ? mMemoryStream->str() : std::string(); }
     
 private:
     std::ostream* mStream = nullptr;
+	
+	// If writing to memory, same as stream.
+	std::ostringstream* mMemoryStream = nullptr;
 };
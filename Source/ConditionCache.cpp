@@ -0,0 +1,124 @@
+//
+// ConditionCache.cpp
+//
+// Clark Kromenaker
+//
+#include "ConditionCache.h"
+
+#include <algorithm>
+
+/*static*/ U32 ConditionCache::sVersion = 0;
+/*static*/ U32 ConditionCache::sAllVersions[static_cast<int>(ConditionInput::Count)] = { };
+/*static*/ std::unordered_map<ConditionCache::InputKey, U32, ConditionCache::InputKeyHash> ConditionCache::sValueVersions;
+/*static*/ std::unordered_map<ConditionCache::ConditionKey, ConditionCache::Entry, ConditionCache::ConditionKeyHash> ConditionCache::sEntries;
+/*static*/ ConditionCache::Entry* ConditionCache::sRecording = nullptr;
+/*static*/ bool ConditionCache::sCallRead = false;
+/*static*/ const size_t ConditionCache::kMaxEntries;
+
+/*static*/ void ConditionCache::Changed(ConditionInput input, U64 key)
+{
+	sValueVersions[{ input, key }] = ++sVersion;
+}
+
+/*static*/ void ConditionCache::ChangedAll(ConditionInput input)
+{
+	sAllVersions[static_cast<int>(input)] = ++sVersion;
+}
+
+/*static*/ void ConditionCache::Read(ConditionInput input, U64 key)
+{
+	if(sRecording == nullptr) { return; }
+	sCallRead = true;
+
+	// Conditions usually read just a few things, so a linear search to avoid duplicates is fine.
+	InputKey inputKey { input, key };
+	if(std::find(sRecording->reads.begin(), sRecording->reads.end(), inputKey) == sRecording->reads.end())
+	{
+		sRecording->reads.push_back(inputKey);
+	}
+}
+
+/*static*/ bool ConditionCache::TryGet(const void* condition, int n, int v, bool& outResult)
+{
+	auto it = sEntries.find({ condition, n, v });
+	if(it == sEntries.end()) { return false; }
+
+	// If anything this condition read has changed since it was evaluated, the result is stale.
+	const Entry& entry = it->second;
+	for(const InputKey& inputKey : entry.reads)
+	{
+		if(GetVersion(inputKey) > entry.version)
+		{
+			return false;
+		}
+	}
+	outResult = entry.result;
+	return true;
+}
+
+/*static*/ bool ConditionCache::BeginRecord()
+{
+	// Don't support nested recording - if an evaluation happens during an evaluation, neither is cached.
+	if(sRecording != nullptr)
+	{
+		sRecording->cacheable = false;
+		return false;
+	}
+
+	static Entry entry;
+	entry.reads.clear();
+	entry.cacheable = true;
+	entry.version = sVersion;
+	sRecording = &entry;
+	return true;
+}
+
+/*static*/ void ConditionCache::EndRecord(const void* condition, int n, int v, bool result)
+{
+	if(sRecording == nullptr) { return; }
+	Entry* entry = sRecording;
+	sRecording = nullptr;
+
+	// The entry is stamped with the version from the start of evaluation.
+	// If evaluation itself changed something it read, the next lookup will see that and re-evaluate.
+	if(entry->cacheable)
+	{
+		// Keep the cache from growing forever. Everything is thrown away, rather than picking entries to remove.
+		// Conditions are cheap to re-evaluate, so it doesn't cost much. And the cache fills slowly, so it rarely happens.
+		ConditionKey key { condition, n, v };
+		if(sEntries.size() >= kMaxEntries && sEntries.find(key) == sEntries.end())
+		{
+			sEntries.clear();
+		}
+		entry->result = result;
+		sEntries[key] = *entry;
+	}
+	else
+	{
+		sEntries.erase({ condition, n, v });
+	}
+}
+
+/*static*/ void ConditionCache::MarkUncacheable()
+{
+	if(sRecording != nullptr)
+	{
+		sRecording->cacheable = false;
+	}
+}
+
+/*static*/ void ConditionCache::Clear()
+{
+	sEntries.clear();
+}
+
+/*static*/ U32 ConditionCache::GetVersion(const InputKey& inputKey)
+{
+	U32 version = sAllVersions[static_cast<int>(inputKey.input)];
+	auto it = sValueVersions.find(inputKey);
+	if(it != sValueVersions.end())
+	{
+		version = std::max(version, it->second);
+	}
+	return version;
+}
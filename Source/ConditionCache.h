@@ -0,0 +1,129 @@
+//
+// ConditionCache.h
+//
+// Clark Kromenaker
+//
+// Remembers the results of condition logic (NVC cases, SIF conditions, etc), along with which game state each condition read.
+// A result is reused until one of the inputs it read changes.
+//
+// Owners of game state (GameProgress, LocationManager, Scene) report changes. Each change gets a version stamp.
+// Sheep system functions report what they read while a condition is being recorded.
+//
+// A condition is only cached if every system function it called reported its reads.
+// Calling any other function (e.g. Random, or one that reads untracked state) makes that result uncacheable.
+//
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "Atom.h"
+
+enum class ConditionInput : U8
+{
+	Flag,
+	GameVariable,
+	ChatCount,
+	TopicCount,
+	NounVerbCount,
+	Timeblock,
+	Location,
+	Ego,
+	Count
+};
+
+class ConditionCache
+{
+public:
+	// Called when some state a condition might read has changed.
+	// Single-value inputs (timeblock, location, ego) don't need a key.
+	static void Changed(ConditionInput input, U64 key = 0);
+	static void Changed(ConditionInput input, Atom key) { Changed(input, key.GetId()); }
+
+	// Called when all values of an input change at once (e.g. chat counts reset on timeblock change).
+	static void ChangedAll(ConditionInput input);
+
+	// Called by system functions when they read state. Does nothing unless a condition is being recorded.
+	static void Read(ConditionInput input, U64 key = 0);
+	static void Read(ConditionInput input, Atom key) { Read(input, key.GetId()); }
+
+	// Gets a cached result for a condition and its arguments, if one exists and none of its inputs changed since.
+	static bool TryGet(const void* condition, int n, int v, bool& outResult);
+
+	// Records the reads made while evaluating a condition. Recording can't be nested.
+	static bool BeginRecord();
+	static void EndRecord(const void* condition, int n, int v, bool result);
+	static bool IsRecording() { return sRecording != nullptr; }
+
+	// Brackets each system function call while recording.
+	// A function call that didn't report any reads makes the condition uncacheable.
+	static void BeginCall() { sCallRead = false; }
+	static void EndCall() { if(!sCallRead) { MarkUncacheable(); } }
+	static void MarkUncacheable();
+
+	// Throws away all cached results.
+	// Conditions are identified by address, so this is called whenever a condition is deleted (see ~SheepScript).
+	// It's also called when a scene's actions are cleared, since that scene's conditions won't be evaluated again for a while.
+	static void Clear();
+	
+	// Number of cached results. At most "kMaxEntries" are kept; when full, all are thrown away.
+	static const size_t kMaxEntries = 4096;
+	static size_t GetEntryCount() { return sEntries.size(); }
+
+private:
+	// An input and a key for which value of that input (e.g. ConditionInput::Flag and a flag's atom).
+	struct InputKey
+	{
+		ConditionInput input;
+		U64 key;
+		bool operator==(const InputKey& other) const { return input == other.input && key == other.key; }
+	};
+	struct InputKeyHash
+	{
+		size_t operator()(const InputKey& inputKey) const { return std::hash<U64>()(inputKey.key) * 31 + static_cast<size_t>(inputKey.input); }
+	};
+
+	// Identifies a cached result: the condition and the n/v arguments it was evaluated with.
+	struct ConditionKey
+	{
+		const void* condition;
+		int n;
+		int v;
+		bool operator==(const ConditionKey& other) const { return condition == other.condition && n == other.n && v == other.v; }
+	};
+	struct ConditionKeyHash
+	{
+		size_t operator()(const ConditionKey& key) const
+		{
+			return (std::hash<const void*>()(key.condition) * 31 + std::hash<int>()(key.n)) * 31 + std::hash<int>()(key.v);
+		}
+	};
+
+	// What a condition evaluated to, and what it read to get there.
+	struct Entry
+	{
+		bool result = false;
+		U32 version = 0;
+		std::vector<InputKey> reads;
+		bool cacheable = true;
+	};
+
+	// Increases every time anything changes. Changes and cached results are stamped with it.
+	static U32 sVersion;
+
+	// Version at which every value of an input last changed at once (see ChangedAll).
+	static U32 sAllVersions[static_cast<int>(ConditionInput::Count)];
+
+	// Version at which each individual value last changed. A missing value has never changed.
+	static std::unordered_map<InputKey, U32, InputKeyHash> sValueVersions;
+
+	// Cached results.
+	static std::unordered_map<ConditionKey, Entry, ConditionKeyHash> sEntries;
+
+	// Entry being recorded, if any.
+	static Entry* sRecording;
+
+	// Whether the current system function call reported any reads.
+	static bool sCallRead;
+
+	static U32 GetVersion(const InputKey& inputKey);
+};
@@ -8,18 +8,32 @@
 #include "Services.h"
 #include "StringUtil.h"
 
-void Console::AddToScrollback(std::string str)
+void Console::AddToScrollback(const std::string& str)
 {
-	std::vector<std::string> lines = StringUtil::Split(str, '\n');
-	for(auto& line : lines)
+	// Add each line of the string. Like splitting on '\n', a trailing line break doesn't add an empty line.
+	size_t lineStart = 0;
+	while(lineStart < str.size())
 	{
-		mScrollback.push_back(line);
-	}
-	
-	if(mScrollback.size() > kMaxScrollbackLength)
-	{
-		int extraCount = kMaxScrollbackLength - (int)mScrollback.size();
-		mScrollback.erase(mScrollback.begin(), mScrollback.begin() + extraCount);
+		size_t lineEnd = str.find('\n', lineStart);
+		if(lineEnd == std::string::npos)
+		{
+			lineEnd = str.size();
+		}
+		
+		// Until the buffer is full, just add to the end.
+		// After that, overwrite the oldest line; the next oldest line becomes the start of the buffer.
+		if(mScrollback.size() < kMaxScrollbackLength)
+		{
+			mScrollback.emplace_back(str, lineStart, lineEnd - lineStart);
+		}
+		else
+		{
+			mScrollback[mScrollbackStart].assign(str, lineStart, lineEnd - lineStart);
+			mScrollbackStart = (mScrollbackStart + 1) % kMaxScrollbackLength;
+		}
+		++mScrollbackAddCount;
+		
+		lineStart = lineEnd + 1;
 	}
 }
 
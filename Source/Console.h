@@ -10,13 +10,22 @@
 #include <string>
 #include <vector>
 
+#include "Atomics.h"
+
 class ReportStream;
 
 class Console
 {
 public:
-	void AddToScrollback(std::string str);
-	const std::vector<std::string>& GetScrollback() const { return mScrollback; }
+	void AddToScrollback(const std::string& str);
+	
+	// Scrollback lines, from oldest (index 0) to newest. Once the scrollback is full, adding a line removes the oldest one.
+	int GetScrollbackLength() const { return static_cast<int>(mScrollback.size()); }
+	const std::string& GetScrollbackLine(int index) const { return mScrollback[(mScrollbackStart + index) % mScrollback.size()]; }
+	
+	// Total number of lines ever added to the scrollback. Unlike the length, this changes even when the scrollback is full.
+	// The line at index "i" was the "GetScrollbackAddCount() - GetScrollbackLength() + i"th line added, which uniquely identifies it.
+	U64 GetScrollbackAddCount() const { return mScrollbackAddCount; }
 	
 	void ExecuteCommand(std::string command);
 	
@@ -27,10 +36,14 @@ public:
 	
 private:
 	// Max scrollback lines we will store.
-	const unsigned int kMaxScrollbackLength = 1000;
+	const unsigned int kMaxScrollbackLength = 100000;
 	
 	// The scrollback buffer. Split into individual lines.
+	// This is a ring buffer: once full, new lines overwrite the oldest, and the start index moves forward.
+	// Overwriting reuses the old line's string memory, so adding lines usually doesn't allocate.
 	std::vector<std::string> mScrollback;
+	unsigned int mScrollbackStart = 0;
+	U64 mScrollbackAddCount = 0;
 	
 	// Max number of commands we will store in history.
 	const unsigned int kMaxCommandHistoryLength = 40;
@@ -5,6 +5,9 @@
 //
 #include "ConsoleUI.h"
 
+#include <algorithm>
+
+#include "GMath.h"
 #include "Mover.h"
 #include "UICanvas.h"
 #include "UIImage.h"
@@ -264,25 +267,22 @@ void ConsoleUI::OnUpdate(float deltaTime)
 			// Ctrl+Up moves scrollback up one line.
 			else if(Services::GetInput()->IsKeyDown(SDL_SCANCODE_UP))
 			{
-				//TODO
+				ScrollTo(mScrollbackOffset + 1);
 			}
 			// Ctrl+PgDown moves scrollback down 10 lines.
 			else if(Services::GetInput()->IsKeyDown(SDL_SCANCODE_PAGEDOWN))
 			{
-				//TODO
-				Refresh();
+				ScrollTo(mScrollbackOffset - 10);
 			}
 			// Ctrl+PgUp moves scrollback up 10 lines.
 			else if(Services::GetInput()->IsKeyDown(SDL_SCANCODE_PAGEUP))
 			{
-				//TODO
-				Refresh();
+				ScrollTo(mScrollbackOffset + 10);
 			}
 			// Ctrl+Home moves scrollback to earliest line.
 			else if(Services::GetInput()->IsKeyDown(SDL_SCANCODE_HOME))
 			{
-				//TODO
-				Refresh();
+				ScrollTo(Services::GetConsole()->GetScrollbackLength());
 			}
 			// Ctrl+End moves scrollback to the latest line.
 			else if(Services::GetInput()->IsKeyDown(SDL_SCANCODE_END))
@@ -372,20 +372,18 @@ void ConsoleUI::Refresh()
 	mScrollbackTransform->SetSizeDeltaY(scrollbackHeight);
 	mBackgroundTransform->SetSizeDeltaY(height);
 	
-	// FOR TESTING
-	std::string bufferText;
-	for(int i = 0; i < lineCount; ++i)
+}
+
+void ConsoleUI::ScrollTo(int scrollbackOffset)
+{
+	// Offset is lines from the newest line; can't scroll past the oldest line.
+	int maxOffset = std::max(Services::GetConsole()->GetScrollbackLength() - 1, 0);
+	scrollbackOffset = Math::Clamp(scrollbackOffset, 0, maxOffset);
+	if(scrollbackOffset != mScrollbackOffset)
 	{
-		if(i == 2)
-		{
-			bufferText += "This is a really really really long line of text. It goes on and on and on. This is some really verbose console output text. Perhaps someone should consider editing this copy to make it shorter.\n";
-		}
-		else
-		{
-			bufferText += "Line" + std::to_string(i) + "\n";
-		}
+		mScrollbackOffset = scrollbackOffset;
+		Refresh();
 	}
-	mScrollbackBuffer->SetText(bufferText);
 }
 
 float ConsoleUI::CalcInputFieldHeight() const
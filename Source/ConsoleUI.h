@@ -61,6 +61,7 @@ private:
 	UITextInput* mTextInput = nullptr;
 	
 	void Refresh();
+	void ScrollTo(int scrollbackOffset);
 	
 	float CalcInputFieldHeight() const;
 };
@@ -12,6 +12,10 @@
 #include <CoreFoundation/CoreFoundation.h>
 #include <dirent.h>
 #include <sys/stat.h>
+#elif defined(PLATFORM_LINUX)
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
 #elif defined(PLATFORM_WINDOWS)
 #include <Windows.h>
 #endif
@@ -158,7 +162,7 @@ bool Path::HasExtension(const std::string& path)
 
 bool Directory::Exists(const std::string& path)
 {
-#if defined(PLATFORM_MAC)
+#if defined(PLATFORM_MAC) || defined(PLATFORM_LINUX)
 	DIR* directoryStream = opendir(path.c_str());
 	if (directoryStream == nullptr)
 	{
@@ -184,7 +188,7 @@ bool Directory::Exists(const std::string& path)
 
 bool Directory::Create(const std::string& path)
 {
-#if defined(PLATFORM_MAC)
+#if defined(PLATFORM_MAC) || defined(PLATFORM_LINUX)
 	// Makes the directory with Read/Write/Execute permissions for User and Group, Read/Execute for Other.
 	const int result = mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
 
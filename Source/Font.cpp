@@ -7,9 +7,9 @@
 
 #include "Color32.h"
 #include "IniParser.h"
-#include "Material.h"
 #include "Services.h"
 #include "StringUtil.h"
+#include "UIBatcher.h"
 
 Font::Font(std::string name, char* data, int dataLength) :
 	Asset(name)
@@ -72,7 +72,9 @@ Font::Font(std::string name, char* data, int dataLength) :
 		glyph.bottomRightUvCoord = Vector2(rightUvX, botUvY);
 		
 		// Save the glyph, mapped to its character.
-		mFontGlyphs[glyph.character] = glyph;
+		unsigned char index = static_cast<unsigned char>(glyph.character);
+		mGlyphs[index] = glyph;
+		mHasGlyph[index] = true;
 		
 		// If we reached the end of the font texture, go to the next line, if possible.
 		if(currentX >= mFontTexture->GetWidth() - 1 && currentLine < mLineCount)
@@ -96,34 +98,30 @@ Font::Font(std::string name, char* data, int dataLength) :
 	/*
 	// Outputs glyphs for verification.
 	std::cout << "Glyphs for font " << GetName() << std::endl;
-	for(auto& glyph : mFontGlyphs)
+	for(auto& glyph : mGlyphs)
 	{
-		std::cout << glyph.second.character << ": " << glyph.second.width <<
-		", " << glyph.second.height << std::endl;
+		std::cout << glyph.character << ": " << glyph.width <<
+		", " << glyph.height << std::endl;
 	}
 	*/
 }
 
-Glyph& Font::GetGlyph(char character)
+Shader* Font::GetShader()
 {
-	auto it = mFontGlyphs.find(character);
-	if(it != mFontGlyphs.end())
+	// Cached, since every label using this font needs it every frame.
+	if(mShader == nullptr)
 	{
-		return it->second;
-	}
-	else
-	{
-		return mFontGlyphs[mDefaultChar];
-	}
-}
-
-Shader* Font::GetShader() const
-{
-	if(mColorMode == ColorMode::ColorReplace)
-	{
-		return Services::GetAssets()->LoadShader("3D-Diffuse-Tex", "UI-Text-ColorReplace");
+		// Text is drawn by the UI batcher, so these use the batched UI vertex shader.
+		if(mColorMode == ColorMode::ColorReplace)
+		{
+			mShader = Services::GetAssets()->LoadShader("UI-Batch", "UI-Text-ColorReplace");
+		}
+		else
+		{
+			mShader = UIBatcher::GetDefaultShader();
+		}
 	}
-	return Material::sDefaultShader;
+	return mShader;
 }
 
 void Font::ParseFromData(char* data, int dataLength)
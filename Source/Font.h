@@ -8,8 +8,6 @@
 #pragma once
 #include "Asset.h"
 
-#include <unordered_map>
-
 #include "Color32.h"
 #include "Vector2.h"
 
@@ -22,8 +20,8 @@ struct Glyph
 	char character = 'a';
 	
 	// Width and height of glyph, in pixels.
-	int width;
-	int height;
+	int width = 0;
+	int height = 0;
 	
 	// The UVs to use on a quad to render this glyph.
 	Vector2 bottomLeftUvCoord;
@@ -39,12 +37,16 @@ public:
 	Font(std::string name, char* data, int dataLength);
 	
 	Texture* GetTexture() const { return mFontTexture; }
-	Glyph& GetGlyph(char character);
+	const Glyph& GetGlyph(char character) const
+	{
+		unsigned char index = static_cast<unsigned char>(character);
+		return mHasGlyph[index] ? mGlyphs[index] : mGlyphs[mDefaultChar];
+	}
 	
 	Color32 GetColor() const { return mColor; }
     Color32 GetReplaceColor() const { return mReplaceColor; }
 	
-	Shader* GetShader() const;
+	Shader* GetShader();
 	
 	int GetGlyphHeight() const { return mGlyphHeight; }
 	
@@ -94,8 +96,13 @@ private:
 	// We can use this to make some assumptions about line height.
 	int mGlyphHeight = 0;
 	
-	// A mapping from character to glyph.
-	std::unordered_map<char, Glyph> mFontGlyphs;
+	// Glyphs, indexed by character. Text layout looks up a glyph for every character, so this is a flat array rather than a map.
+	// If a character has no glyph, the default char's glyph is used instead.
+	Glyph mGlyphs[256];
+	bool mHasGlyph[256] = { };
+	
+	// Shader used to render this font; depends on color mode.
+	Shader* mShader = nullptr;
 	
 	void ParseFromData(char* data, int dataLength);
 };
@@ -22,6 +22,7 @@
 #include "Scene.h"
 #include "Services.h"
 #include "TextInput.h"
+#include "VertexAnimator.h"
 
 GEngine* GEngine::sInstance = nullptr;
 
@@ -92,6 +93,9 @@ bool GEngine::Initialize()
     
     // Initialize sheep manager.
     Services::SetSheep(&mSheepManager);
+	
+	// Load previously compiled sheep, so assets don't need to compile it again.
+	mSheepManager.LoadScriptCache(SheepManager::GetDefaultScriptCachePath());
     
     //SDL_Log(SDL_GetBasePath());
     //SDL_Log(SDL_GetPrefPath("Test", "GK3"));
@@ -187,6 +191,15 @@ void GEngine::Shutdown()
 	}
 	mActors.clear();
 	
+	// Save any newly compiled sheep for next time.
+	mSheepManager.SaveScriptCache(SheepManager::GetDefaultScriptCachePath());
+	
+	// If sheep were being profiled, save the results.
+	if(mSheepManager.GetProfiler().IsEnabled())
+	{
+		mSheepManager.GetProfiler().Dump("SheepProfile");
+	}
+	
     mRenderer.Shutdown();
     mAudioManager.Shutdown();
     
@@ -373,6 +386,9 @@ void GEngine::Update()
 	
 	// Delete any destroyed actors.
 	DeleteDestroyedActors();
+	
+	// Take vertex animation samples requested during actor updates, in parallel.
+	VertexAnimator::TakePendingSamples(mJobSystem);
     
     // Also update audio system (before or after actors?)
     mAudioManager.Update(deltaTime);
@@ -0,0 +1,242 @@
+//
+// GLState.cpp
+//
+// Clark Kromenaker
+//
+#include "GLState.h"
+
+namespace
+{
+	// Index of a texture target in the remembered texture bindings, or -1 if it isn't remembered.
+	int GetTextureTargetIndex(GLenum target)
+	{
+		switch(target)
+		{
+		case GL_TEXTURE_2D:
+			return 0;
+		case GL_TEXTURE_CUBE_MAP:
+			return 1;
+		case GL_TEXTURE_BUFFER:
+			return 2;
+		default:
+			return -1;
+		}
+	}
+}
+
+/*static*/ GLState* GLState::sInstance = nullptr;
+
+GLState::GLState()
+{
+	sInstance = this;
+	Invalidate();
+}
+
+GLState::~GLState()
+{
+	if(sInstance == this)
+	{
+		sInstance = nullptr;
+	}
+}
+
+void GLState::Invalidate()
+{
+	mProgram = kUnknown;
+	mVertexArray = kUnknown;
+	mArrayBuffer = kUnknown;
+	
+	mActiveTextureUnit = -1;
+	for(int i = 0; i < kMaxTextureUnits; ++i)
+	{
+		for(int j = 0; j < kTextureTargetCount; ++j)
+		{
+			mTextures[i][j] = kUnknown;
+		}
+	}
+	
+	mBlend = -1;
+	mDepthTest = -1;
+	mDepthWrite = -1;
+	mCullFace = -1;
+}
+
+void GLState::UseProgram(GLuint program)
+{
+	if(mProgram == program)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	glUseProgram(program);
+	mProgram = program;
+	++mBindsIssued;
+}
+
+void GLState::BindVertexArray(GLuint vertexArray)
+{
+	if(mVertexArray == vertexArray)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	glBindVertexArray(vertexArray);
+	mVertexArray = vertexArray;
+	++mBindsIssued;
+}
+
+void GLState::BindArrayBuffer(GLuint buffer)
+{
+	if(mArrayBuffer == buffer)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	mArrayBuffer = buffer;
+	++mBindsIssued;
+}
+
+void GLState::BindTexture(int textureUnit, GLenum target, GLuint texture)
+{
+	// If this texture is already bound to the unit, there's no need to even change the active unit.
+	int targetIndex = GetTextureTargetIndex(target);
+	if(textureUnit >= 0 && textureUnit < kMaxTextureUnits && targetIndex >= 0 && mTextures[textureUnit][targetIndex] == texture)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	SetActiveTextureUnit(textureUnit);
+	BindTexture(target, texture);
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture)
+{
+	int targetIndex = GetTextureTargetIndex(target);
+	bool remembered = mActiveTextureUnit >= 0 && mActiveTextureUnit < kMaxTextureUnits && targetIndex >= 0;
+	if(remembered && mTextures[mActiveTextureUnit][targetIndex] == texture)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	
+	glBindTexture(target, texture);
+	if(remembered)
+	{
+		mTextures[mActiveTextureUnit][targetIndex] = texture;
+	}
+	++mBindsIssued;
+}
+
+void GLState::SetBlendEnabled(bool enabled)
+{
+	SetCapabilityEnabled(mBlend, GL_BLEND, enabled);
+}
+
+void GLState::SetDepthTestEnabled(bool enabled)
+{
+	SetCapabilityEnabled(mDepthTest, GL_DEPTH_TEST, enabled);
+}
+
+void GLState::SetDepthWriteEnabled(bool enabled)
+{
+	if(SetEnabled(mDepthWrite, enabled))
+	{
+		glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+	}
+}
+
+void GLState::SetCullFaceEnabled(bool enabled)
+{
+	SetCapabilityEnabled(mCullFace, GL_CULL_FACE, enabled);
+}
+
+void GLState::OnProgramDeleted(GLuint program)
+{
+	// A program that's in use isn't actually deleted until it's no longer in use. But its handle can't be used anymore.
+	if(mProgram == program)
+	{
+		mProgram = kUnknown;
+	}
+}
+
+void GLState::OnVertexArrayDeleted(GLuint vertexArray)
+{
+	// Deleting the bound vertex array reverts the binding to zero.
+	if(mVertexArray == vertexArray)
+	{
+		mVertexArray = GL_NONE;
+	}
+}
+
+void GLState::OnBufferDeleted(GLuint buffer)
+{
+	// Deleting the bound array buffer reverts the binding to zero.
+	if(mArrayBuffer == buffer)
+	{
+		mArrayBuffer = GL_NONE;
+	}
+}
+
+void GLState::OnTextureDeleted(GLuint texture)
+{
+	// Deleting a texture reverts any units it was bound to back to zero.
+	for(int i = 0; i < kMaxTextureUnits; ++i)
+	{
+		for(int j = 0; j < kTextureTargetCount; ++j)
+		{
+			if(mTextures[i][j] == texture)
+			{
+				mTextures[i][j] = GL_NONE;
+			}
+		}
+	}
+}
+
+void GLState::EndFrame()
+{
+	mLastFrameBindsIssued = mBindsIssued;
+	mLastFrameBindsSkipped = mBindsSkipped;
+	mBindsIssued = 0;
+	mBindsSkipped = 0;
+}
+
+void GLState::SetActiveTextureUnit(int textureUnit)
+{
+	if(mActiveTextureUnit == textureUnit)
+	{
+		++mBindsSkipped;
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	mActiveTextureUnit = textureUnit;
+	++mBindsIssued;
+}
+
+bool GLState::SetEnabled(signed char& current, bool enabled)
+{
+	signed char value = enabled ? 1 : 0;
+	if(current == value)
+	{
+		++mBindsSkipped;
+		return false;
+	}
+	current = value;
+	++mBindsIssued;
+	return true;
+}
+
+void GLState::SetCapabilityEnabled(signed char& current, GLenum capability, bool enabled)
+{
+	if(SetEnabled(current, enabled))
+	{
+		if(enabled)
+		{
+			glEnable(capability);
+		}
+		else
+		{
+			glDisable(capability);
+		}
+	}
+}
@@ -0,0 +1,91 @@
+//
+// GLState.h
+//
+// Clark Kromenaker
+//
+// Remembers what OpenGL state is currently set (bound program, vertex array, array buffer, textures, blend/depth/cull),
+// so that setting something that's already set doesn't result in a GL call.
+//
+// All code that changes this state should do it through here, or the remembered state will be wrong.
+// The Renderer owns the one instance; use "GLState::Instance()" to get it.
+//
+#pragma once
+#include <GL/glew.h>
+
+class GLState
+{
+public:
+	static GLState* Instance() { return sInstance; }
+	
+	GLState();
+	~GLState();
+	
+	// Forgets all remembered state, so the next change of each state always goes to GL.
+	// Call after creating a GL context, or after code outside of this class has changed GL state.
+	void Invalidate();
+	
+	void UseProgram(GLuint program);
+	GLuint GetProgram() const { return mProgram; }
+	
+	void BindVertexArray(GLuint vertexArray);
+	
+	// Binds a buffer to GL_ARRAY_BUFFER. Unlike the index buffer binding, this isn't part of the vertex array's state.
+	void BindArrayBuffer(GLuint buffer);
+	
+	// Binds a texture to a texture unit (making that unit the active one).
+	void BindTexture(int textureUnit, GLenum target, GLuint texture);
+	
+	// Binds a texture to the active texture unit - for when a texture needs to be bound to change it, rather than draw with it.
+	void BindTexture(GLenum target, GLuint texture);
+	
+	void SetBlendEnabled(bool enabled);
+	void SetDepthTestEnabled(bool enabled);
+	void SetDepthWriteEnabled(bool enabled);
+	void SetCullFaceEnabled(bool enabled);
+	
+	// When GL objects are deleted, GL unbinds them. And a new object may get the same handle later.
+	// So, the remembered state must forget deleted objects too.
+	void OnProgramDeleted(GLuint program);
+	void OnVertexArrayDeleted(GLuint vertexArray);
+	void OnBufferDeleted(GLuint buffer);
+	void OnTextureDeleted(GLuint texture);
+	
+	// Number of state changes sent to GL and skipped (because the state was already set) during the last frame.
+	// "EndFrame" should be called once at the end of each frame to update these.
+	void EndFrame();
+	int GetBindsIssued() const { return mLastFrameBindsIssued; }
+	int GetBindsSkipped() const { return mLastFrameBindsSkipped; }
+	
+private:
+	static GLState* sInstance;
+	
+	// Means "not known" for remembered handles - any handle set after this is sent to GL.
+	static const GLuint kUnknown = 0xFFFFFFFF;
+	
+	// Texture units and targets that are remembered. Binds to other units/targets always go to GL.
+	static const int kMaxTextureUnits = 16;
+	static const int kTextureTargetCount = 3;
+	
+	GLuint mProgram = kUnknown;
+	GLuint mVertexArray = kUnknown;
+	GLuint mArrayBuffer = kUnknown;
+	
+	int mActiveTextureUnit = -1;
+	GLuint mTextures[kMaxTextureUnits][kTextureTargetCount];
+	
+	// Enabled states: 1 is enabled, 0 is disabled, -1 is not known.
+	signed char mBlend = -1;
+	signed char mDepthTest = -1;
+	signed char mDepthWrite = -1;
+	signed char mCullFace = -1;
+	
+	// Counts for the frame in progress, and for the last completed frame.
+	int mBindsIssued = 0;
+	int mBindsSkipped = 0;
+	int mLastFrameBindsIssued = 0;
+	int mLastFrameBindsSkipped = 0;
+	
+	void SetActiveTextureUnit(int textureUnit);
+	bool SetEnabled(signed char& current, bool enabled);
+	void SetCapabilityEnabled(signed char& current, GLenum capability, bool enabled);
+};
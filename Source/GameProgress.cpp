@@ -5,10 +5,12 @@
 //
 #include "GameProgress.h"
 
+#include <algorithm>
+
+#include "ConditionCache.h"
 #include "GMath.h"
 #include "Localizer.h"
 #include "Services.h"
-#include "StringUtil.h"
 
 TYPE_DEF_BASE(GameProgress);
 
@@ -28,7 +30,11 @@ void GameProgress::SetTimeblock(const Timeblock& timeblock)
 	mTimeblock = timeblock;
 	
 	// Chat counts are reset on time block change.
-	mChatCounts.clear();
+	std::fill(mChatCounts.begin(), mChatCounts.end(), 0);
+	
+	// Let cached conditions know about the changes.
+	ConditionCache::Changed(ConditionInput::Timeblock);
+	ConditionCache::ChangedAll(ConditionInput::ChatCount);
 }
 
 std::string GameProgress::GetTimeblockDisplayName() const
@@ -37,134 +43,170 @@ std::string GameProgress::GetTimeblockDisplayName() const
     return Services::Get<Localizer>()->GetText("Day" + mTimeblock.ToString());
 }
 
-bool GameProgress::GetFlag(const std::string& flagName) const
+bool GameProgress::GetFlag(Atom flagName) const
 {
-	// If the flag exists, it implies a "true" value.
-	// Absence of flag implies "false" value.
-	auto it = mGameFlags.find(flagName);
-	return it != mGameFlags.end();
+	// A flag past the end of the bits has never been set, and is false.
+	U32 id = flagName.GetId();
+	return id / 32 < mFlags.size() && (mFlags[id / 32] & (1u << (id % 32))) != 0;
 }
 
-void GameProgress::SetFlag(const std::string& flagName)
+void GameProgress::SetFlag(Atom flagName)
 {
-	// Doesn't matter whether we are setting an already set flag.
-	mGameFlags.insert(flagName);
+	U32 id = flagName.GetId();
+	if(id / 32 >= mFlags.size())
+	{
+		mFlags.resize(id / 32 + 1, 0);
+	}
+	mFlags[id / 32] |= (1u << (id % 32));
+	ConditionCache::Changed(ConditionInput::Flag, flagName);
 }
 
-void GameProgress::ClearFlag(const std::string& flagName)
+void GameProgress::ClearFlag(Atom flagName)
 {
-	// Erase the flag from the container to "clear" it.
-	auto it = mGameFlags.find(flagName);
-	if(it != mGameFlags.end())
+	U32 id = flagName.GetId();
+	if(id / 32 < mFlags.size())
 	{
-		mGameFlags.erase(it);
+		mFlags[id / 32] &= ~(1u << (id % 32));
 	}
+	ConditionCache::Changed(ConditionInput::Flag, flagName);
 }
 
-int GameProgress::GetGameVariable(const std::string& varName) const
+int GameProgress::GetGameVariable(Atom varName) const
 {
-	auto it = mGameVariables.find(StringUtil::ToLowerCopy(varName));
-	if(it != mGameVariables.end())
-	{
-		return it->second;
-	}
-	return 0;
+	return GetValue(mGameVariables, varName);
 }
 
-void GameProgress::SetGameVariable(const std::string& varName, int value)
+void GameProgress::SetGameVariable(Atom varName, int value)
 {
-	mGameVariables[StringUtil::ToLowerCopy(varName)] = value;
+	GetOrAddValue(mGameVariables, varName) = value;
+	ConditionCache::Changed(ConditionInput::GameVariable, varName);
 }
 
-void GameProgress::IncGameVariable(const std::string& varName)
+void GameProgress::IncGameVariable(Atom varName)
 {
-	++mGameVariables[StringUtil::ToLowerCopy(varName)];
+	++GetOrAddValue(mGameVariables, varName);
+	ConditionCache::Changed(ConditionInput::GameVariable, varName);
 }
 
-int GameProgress::GetChatCount(const std::string& noun) const
+int GameProgress::GetChatCount(Atom noun) const
 {
-	auto it = mChatCounts.find(StringUtil::ToLowerCopy(noun));
-	if(it != mChatCounts.end())
-	{
-		return it->second;
-	}
-	return 0;
+	return GetValue(mChatCounts, noun);
 }
 
-void GameProgress::SetChatCount(const std::string& noun, int count)
+void GameProgress::SetChatCount(Atom noun, int count)
 {
-	mChatCounts[StringUtil::ToLowerCopy(noun)] = count;
+	GetOrAddValue(mChatCounts, noun) = count;
+	ConditionCache::Changed(ConditionInput::ChatCount, noun);
 }
 
-void GameProgress::IncChatCount(const std::string& noun)
+void GameProgress::IncChatCount(Atom noun)
 {
-	++mChatCounts[StringUtil::ToLowerCopy(noun)];
+	++GetOrAddValue(mChatCounts, noun);
+	ConditionCache::Changed(ConditionInput::ChatCount, noun);
 }
 
-int GameProgress::GetTopicCount(const std::string& noun, const std::string& topic) const
+int GameProgress::GetTopicCount(Atom noun, Atom topic) const
 {
-	// Key is noun+topic.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + topic;
-	StringUtil::ToLower(key);
-	
-	// Find and return, or return default.
-	auto it = mTopicCounts.find(key);
-	if(it != mTopicCounts.end())
-	{
-		return it->second;
-	}
-	return 0;
+	return GetValue(mTopicCountIds, mTopicCounts, Atom::MakeKey(noun, topic));
+}
+
+void GameProgress::SetTopicCount(Atom noun, Atom topic, int count)
+{
+	U64 key = Atom::MakeKey(noun, topic);
+	GetOrAddValue(mTopicCountIds, mTopicCounts, key) = count;
+	ConditionCache::Changed(ConditionInput::TopicCount, key);
+}
+
+void GameProgress::IncTopicCount(Atom noun, Atom topic)
+{
+	U64 key = Atom::MakeKey(noun, topic);
+	++GetOrAddValue(mTopicCountIds, mTopicCounts, key);
+	ConditionCache::Changed(ConditionInput::TopicCount, key);
+}
+
+int GameProgress::GetNounVerbCount(Atom noun, Atom verb) const
+{
+	return GetValue(mNounVerbCountIds, mNounVerbCounts, Atom::MakeKey(noun, verb));
 }
 
-void GameProgress::SetTopicCount(const std::string& noun, const std::string& topic, int count)
+void GameProgress::SetNounVerbCount(Atom noun, Atom verb, int count)
 {
-	// Key is noun+topic.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + topic;
-	StringUtil::ToLower(key);
-	mTopicCounts[key] = count;
+	U64 key = Atom::MakeKey(noun, verb);
+	GetOrAddValue(mNounVerbCountIds, mNounVerbCounts, key) = count;
+	ConditionCache::Changed(ConditionInput::NounVerbCount, key);
 }
 
-void GameProgress::IncTopicCount(const std::string& noun, const std::string& topic)
+void GameProgress::IncNounVerbCount(Atom noun, Atom verb)
 {
-	// Key is noun+topic.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + topic;
-	StringUtil::ToLower(key);
-	++mTopicCounts[key];
+	U64 key = Atom::MakeKey(noun, verb);
+	++GetOrAddValue(mNounVerbCountIds, mNounVerbCounts, key);
+	ConditionCache::Changed(ConditionInput::NounVerbCount, key);
 }
 
-int GameProgress::GetNounVerbCount(const std::string& noun, const std::string& verb) const
+void GameProgress::SaveSnapshot(Snapshot& snapshot) const
 {
-	// Key is noun+verb.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + verb;
-	StringUtil::ToLower(key);
+	// Values are plain ints, so these assignments are just memcpys.
+	snapshot.score = mScore;
+	snapshot.timeblock = mTimeblock;
+	snapshot.lastTimeblock = mLastTimeblock;
+	snapshot.flags = mFlags;
+	snapshot.chatCounts = mChatCounts;
+	snapshot.topicCounts = mTopicCounts;
+	snapshot.nounVerbCounts = mNounVerbCounts;
+	snapshot.gameVariables = mGameVariables;
+}
+
+void GameProgress::RestoreSnapshot(const Snapshot& snapshot)
+{
+	mScore = snapshot.score;
+	mTimeblock = snapshot.timeblock;
+	mLastTimeblock = snapshot.lastTimeblock;
+	
+	// Anything past the end of the snapshot's arrays was first used after the snapshot was taken, so it's zeroed.
+	// Values by atom ID read as zero past the end of their arrays, but IDs for two-atom keys still exist, so those arrays are resized.
+	mFlags.assign(snapshot.flags.begin(), snapshot.flags.end());
+	mChatCounts.assign(snapshot.chatCounts.begin(), snapshot.chatCounts.end());
+	mTopicCounts.assign(snapshot.topicCounts.begin(), snapshot.topicCounts.end());
+	mTopicCounts.resize(mTopicCountIds.ids.size(), 0);
+	mNounVerbCounts.assign(snapshot.nounVerbCounts.begin(), snapshot.nounVerbCounts.end());
+	mNounVerbCounts.resize(mNounVerbCountIds.ids.size(), 0);
+	mGameVariables.assign(snapshot.gameVariables.begin(), snapshot.gameVariables.end());
 	
-	// Find and return, or return default.
-	auto it = mNounVerbCounts.find(key);
-	if(it != mNounVerbCounts.end())
+	// Anything could have changed.
+	ConditionCache::Changed(ConditionInput::Timeblock);
+	ConditionCache::ChangedAll(ConditionInput::Flag);
+	ConditionCache::ChangedAll(ConditionInput::ChatCount);
+	ConditionCache::ChangedAll(ConditionInput::TopicCount);
+	ConditionCache::ChangedAll(ConditionInput::NounVerbCount);
+	ConditionCache::ChangedAll(ConditionInput::GameVariable);
+}
+
+/*static*/ int GameProgress::GetValue(const std::vector<int>& values, Atom atom)
+{
+	return atom.GetId() < values.size() ? values[atom.GetId()] : 0;
+}
+
+/*static*/ int& GameProgress::GetOrAddValue(std::vector<int>& values, Atom atom)
+{
+	if(atom.GetId() >= values.size())
 	{
-		return it->second;
+		values.resize(atom.GetId() + 1, 0);
 	}
-	return 0;
+	return values[atom.GetId()];
 }
 
-void GameProgress::SetNounVerbCount(const std::string& noun, const std::string& verb, int count)
+/*static*/ int GameProgress::GetValue(const IdTable& ids, const std::vector<int>& values, U64 key)
 {
-	// Key is noun+verb.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + verb;
-	StringUtil::ToLower(key);
-	mNounVerbCounts[key] = count;
+	int id = ids.Find(key);
+	return id >= 0 ? values[id] : 0;
 }
 
-void GameProgress::IncNounVerbCount(const std::string& noun, const std::string& verb)
+/*static*/ int& GameProgress::GetOrAddValue(IdTable& ids, std::vector<int>& values, U64 key)
 {
-	// Key is noun+verb.
-	// Make sure it's all lowercase, for consistency.
-	std::string key = noun + verb;
-	StringUtil::ToLower(key);
-	++mNounVerbCounts[key];
+	int id = ids.Add(key);
+	if(id >= values.size())
+	{
+		values.resize(id + 1, 0);
+	}
+	return values[id];
 }
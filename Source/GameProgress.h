@@ -7,11 +7,16 @@
 // throughout the game. Keeps track of thinks like current/last location/time,
 // flag states, game logic variable states, noun/verb counts, etc.
 //
+// Values are stored in flat arrays. Flags, game variables, and chat counts are indexed directly by atom ID (see Atom::GetId).
+// Topic and noun/verb counts are keyed by two atoms, so they're given a dense integer ID the first time they're used instead.
+// So, all progress can be copied to or from a snapshot with a handful of memcpys (for save/load, or rewinding state in tests).
+//
 #pragma once
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
+#include "Atom.h"
 #include "Timeblock.h"
 #include "Type.h"
 
@@ -30,27 +35,84 @@ public:
     
     std::string GetTimeblockDisplayName() const;
 	
-	bool GetFlag(const std::string& flagName) const;
-	void SetFlag(const std::string& flagName);
-	void ClearFlag(const std::string& flagName);
+	// All names are case-insensitive. The atom versions avoid any string work, so prefer them in frequently called code.
+	bool GetFlag(const std::string& flagName) const { return GetFlag(Atom::Find(flagName)); }
+	bool GetFlag(Atom flagName) const;
+	void SetFlag(const std::string& flagName) { SetFlag(Atom(flagName)); }
+	void SetFlag(Atom flagName);
+	void ClearFlag(const std::string& flagName) { ClearFlag(Atom::Find(flagName)); }
+	void ClearFlag(Atom flagName);
+	
+	int GetGameVariable(const std::string& varName) const { return GetGameVariable(Atom::Find(varName)); }
+	int GetGameVariable(Atom varName) const;
+	void SetGameVariable(const std::string& varName, int value) { SetGameVariable(Atom(varName), value); }
+	void SetGameVariable(Atom varName, int value);
+	void IncGameVariable(const std::string& varName) { IncGameVariable(Atom(varName)); }
+	void IncGameVariable(Atom varName);
+	
+	int GetChatCount(const std::string& noun) const { return GetChatCount(Atom::Find(noun)); }
+	int GetChatCount(Atom noun) const;
+	void SetChatCount(const std::string& noun, int count) { SetChatCount(Atom(noun), count); }
+	void SetChatCount(Atom noun, int count);
+	void IncChatCount(const std::string& noun) { IncChatCount(Atom(noun)); }
+	void IncChatCount(Atom noun);
 	
-	int GetGameVariable(const std::string& varName) const;
-	void SetGameVariable(const std::string& varName, int value);
-	void IncGameVariable(const std::string& varName);
+	int GetTopicCount(const std::string& noun, const std::string& topic) const { return GetTopicCount(Atom::Find(noun), Atom::Find(topic)); }
+	int GetTopicCount(Atom noun, Atom topic) const;
+	void SetTopicCount(const std::string& noun, const std::string& topic, int count) { SetTopicCount(Atom(noun), Atom(topic), count); }
+	void SetTopicCount(Atom noun, Atom topic, int count);
+	void IncTopicCount(const std::string& noun, const std::string& topic) { IncTopicCount(Atom(noun), Atom(topic)); }
+	void IncTopicCount(Atom noun, Atom topic);
 	
-	int GetChatCount(const std::string& noun) const;
-	void SetChatCount(const std::string&, int count);
-	void IncChatCount(const std::string& noun);
+	int GetNounVerbCount(const std::string& noun, const std::string& verb) const { return GetNounVerbCount(Atom::Find(noun), Atom::Find(verb)); }
+	int GetNounVerbCount(Atom noun, Atom verb) const;
+	void SetNounVerbCount(const std::string& noun, const std::string& verb, int count) { SetNounVerbCount(Atom(noun), Atom(verb), count); }
+	void SetNounVerbCount(Atom noun, Atom verb, int count);
+	void IncNounVerbCount(const std::string& noun, const std::string& verb) { IncNounVerbCount(Atom(noun), Atom(verb)); }
+	void IncNounVerbCount(Atom noun, Atom verb);
 	
-	int GetTopicCount(const std::string& noun, const std::string& topic) const;
-	void SetTopicCount(const std::string& noun, const std::string& topic, int count);
-	void IncTopicCount(const std::string& noun, const std::string& topic);
+	// A copy of all game progress. Values are stored by ID, so a snapshot is only meaningful to the GameProgress it came from (in the same run).
+	struct Snapshot
+	{
+		int score = 0;
+		Timeblock timeblock;
+		Timeblock lastTimeblock;
+		std::vector<U32> flags;
+		std::vector<int> chatCounts;
+		std::vector<int> topicCounts;
+		std::vector<int> nounVerbCounts;
+		std::vector<int> gameVariables;
+	};
 	
-	int GetNounVerbCount(const std::string& noun, const std::string& verb) const;
-	void SetNounVerbCount(const std::string& noun, const std::string& verb, int count);
-	void IncNounVerbCount(const std::string& noun, const std::string& verb);
+	// Copies all progress into a snapshot. Reusing a snapshot reuses its memory.
+	void SaveSnapshot(Snapshot& snapshot) const;
+	
+	// Sets all progress back to what it was when the snapshot was taken.
+	// Anything first used after the snapshot was taken goes back to its default (cleared flag, zero count).
+	void RestoreSnapshot(const Snapshot& snapshot);
 	
 private:
+	// Assigns IDs (0, 1, 2, ...) to two-atom keys as they're first used, so values can be stored in flat arrays.
+	// IDs are never removed, so IDs in older snapshots stay valid as more are added.
+	struct IdTable
+	{
+		std::unordered_map<U64, int> ids;
+		
+		// Returns -1 if the key has no ID yet.
+		int Find(U64 key) const
+		{
+			auto it = ids.find(key);
+			return it != ids.end() ? it->second : -1;
+		}
+		
+		// Returns the key's ID, giving it one if needed.
+		int Add(U64 key)
+		{
+			return ids.emplace(key, static_cast<int>(ids.size())).first->second;
+		}
+	};
+	
+
 	// Score tracking.
     const int kMaxScore = 965; //TODO: Should be loaded from GAME.CFG
 	int mScore = 0;
@@ -59,23 +121,35 @@ private:
 	Timeblock mTimeblock;
 	Timeblock mLastTimeblock;
 	
-	// General-use true/false flags for game logic.
-	// Absence of a flag implies false; otherwise, true.
-	std::unordered_set<std::string> mGameFlags;
+	// General-use true/false flags for game logic, as bits indexed by atom ID. Flags are false until set.
+	std::vector<U32> mFlags;
 	
-	// Tracks the number of times the player has chatted with a noun.
-	std::unordered_map<std::string, int> mChatCounts;
+	// Tracks the number of times the player has chatted with a noun, by atom ID.
+	std::vector<int> mChatCounts;
 	
-	// Maps noun/topic combos to a count value.
 	// Tracks the number of times we've talked to a noun about a topic.
-	std::unordered_map<std::string, int> mTopicCounts;
+	// IDs are keyed by noun and topic atoms (see Atom::MakeKey).
+	IdTable mTopicCountIds;
+	std::vector<int> mTopicCounts;
 	
-	// Maps noun/verb to a count value.
 	// Tracks the number of times we've triggered a verb on a noun.
-	std::unordered_map<std::string, int> mNounVerbCounts;
-
-	// Maps a variable name to an integer value.
-	// For general game logic variables.
-	std::unordered_map<std::string, int> mGameVariables;
+	// IDs are keyed by noun and verb atoms (see Atom::MakeKey).
+	IdTable mNounVerbCountIds;
+	std::vector<int> mNounVerbCounts;
+	
+	// General game logic variables, by atom ID.
+	std::vector<int> mGameVariables;
+	
+	// Gets the value for an atom from values stored by atom ID. Atoms past the end of the values have a value of zero.
+	static int GetValue(const std::vector<int>& values, Atom atom);
+	
+	// Gets the value for an atom, growing the values (with zeros) if needed.
+	static int& GetOrAddValue(std::vector<int>& values, Atom atom);
+	
+	// Gets the value for a key from values stored by ID. Keys without an ID have a value of zero.
+	static int GetValue(const IdTable& ids, const std::vector<int>& values, U64 key);
+	
+	// Gets the value for a key, giving the key an ID (and a zero value) if needed.
+	static int& GetOrAddValue(IdTable& ids, std::vector<int>& values, U64 key);
 };
 
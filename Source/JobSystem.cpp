@@ -0,0 +1,159 @@
+//
+// JobSystem.cpp
+//
+// Clark Kromenaker
+//
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(int workerCount) :
+	mQueuedJobCount(0)
+{
+	// By default, leave one hardware thread for the main thread.
+	if(workerCount < 0)
+	{
+		workerCount = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+	}
+	
+	// Create queues first, since workers may start looking at them right away.
+	for(int i = 0; i < workerCount + 1; ++i)
+	{
+		mQueues.emplace_back(new JobQueue());
+	}
+	for(int i = 0; i < workerCount; ++i)
+	{
+		mThreads.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	// Tell workers to quit and wait for them to do so.
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+		mQuit = true;
+	}
+	mWakeCondition.notify_all();
+	for(auto& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+void JobSystem::ParallelFor(int count, const std::function<void(int)>& func)
+{
+	if(count <= 0) { return; }
+	
+	// With only one item or no workers, there's no point in queueing anything.
+	if(count == 1 || mThreads.empty())
+	{
+		for(int i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+	
+	// Split the work into a few jobs per thread. More jobs than threads gives stealing something to balance with.
+	int jobCount = std::min(count, GetThreadCount() * 4);
+	int jobSize = (count + jobCount - 1) / jobCount;
+	std::atomic<int> remaining(count);
+	
+	// Deal jobs out to all queues, round-robin.
+	int queueIndex = 0;
+	for(int begin = 0; begin < count; begin += jobSize)
+	{
+		Job job;
+		job.func = &func;
+		job.begin = begin;
+		job.end = std::min(begin + jobSize, count);
+		job.remaining = &remaining;
+		{
+			std::lock_guard<std::mutex> lock(mQueues[queueIndex]->mutex);
+			mQueues[queueIndex]->jobs.push_back(job);
+		}
+		++mQueuedJobCount;
+		queueIndex = (queueIndex + 1) % mQueues.size();
+	}
+	
+	// Wake up workers.
+	{
+		std::lock_guard<std::mutex> lock(mWakeMutex);
+	}
+	mWakeCondition.notify_all();
+	
+	// Help out until everything's done. Once there's nothing left to take, other threads are finishing up their last jobs.
+	Job job;
+	while(remaining > 0)
+	{
+		if(TakeJob(0, job))
+		{
+			RunJob(job);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WorkerLoop(int queueIndex)
+{
+	Job job;
+	while(true)
+	{
+		// Sleep until there's work to do (or we need to quit).
+		{
+			std::unique_lock<std::mutex> lock(mWakeMutex);
+			mWakeCondition.wait(lock, [this]() { return mQuit || mQueuedJobCount > 0; });
+			if(mQuit) { return; }
+		}
+		
+		// Do work until there's none left to take.
+		while(TakeJob(queueIndex, job))
+		{
+			RunJob(job);
+		}
+	}
+}
+
+bool JobSystem::TakeJob(int queueIndex, Job& job)
+{
+	// Look in our own queue first, taking the most recently added job.
+	{
+		JobQueue& queue = *mQueues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.jobs.empty())
+		{
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+			--mQueuedJobCount;
+			return true;
+		}
+	}
+	
+	// Our queue is empty, so steal the oldest job from another queue.
+	for(size_t i = 1; i < mQueues.size(); ++i)
+	{
+		JobQueue& queue = *mQueues[(queueIndex + i) % mQueues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if(!queue.jobs.empty())
+		{
+			job = queue.jobs.front();
+			queue.jobs.pop_front();
+			--mQueuedJobCount;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::RunJob(const Job& job)
+{
+	for(int i = job.begin; i < job.end; ++i)
+	{
+		(*job.func)(i);
+	}
+	*job.remaining -= (job.end - job.begin);
+}
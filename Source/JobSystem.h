@@ -0,0 +1,72 @@
+//
+// JobSystem.h
+//
+// Clark Kromenaker
+//
+// A small pool of worker threads for running independent pieces of work in parallel.
+//
+// Each thread (including the calling thread) has its own queue of jobs. Threads take work from the back of their own queue,
+// and when that runs dry, they "steal" from the front of other threads' queues. This keeps all threads busy even if
+// some jobs take much longer than others (e.g. one actor with a big animation and many with small ones).
+//
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+	// Creates the given number of worker threads. If negative, uses one less than the number of hardware threads.
+	// With zero worker threads, all work is simply done on the calling thread.
+	JobSystem(int workerCount = -1);
+	~JobSystem();
+	
+	// Calls func(i) for each i in [0, count), spread across worker threads and the calling thread.
+	// Doesn't return until all calls are done. Calls may happen in any order, so they must not depend on one another.
+	void ParallelFor(int count, const std::function<void(int)>& func);
+	
+	// Number of threads that do work during a ParallelFor, including the calling thread.
+	int GetThreadCount() const { return static_cast<int>(mThreads.size()) + 1; }
+	
+private:
+	// A range of indexes to call a function for.
+	struct Job
+	{
+		const std::function<void(int)>* func = nullptr;
+		int begin = 0;
+		int end = 0;
+		
+		// Counts down as indexes are completed; the ParallelFor is done when it reaches zero.
+		std::atomic<int>* remaining = nullptr;
+	};
+	
+	// A thread's queue of jobs. Mutex protected, since other threads may steal from it.
+	struct JobQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+	
+	// Worker threads.
+	std::vector<std::thread> mThreads;
+	
+	// One queue per worker thread, plus one (at index 0) for the thread calling ParallelFor.
+	std::vector<std::unique_ptr<JobQueue>> mQueues;
+	
+	// Used to put workers to sleep when there's no work to do, and to wake them when there is.
+	std::mutex mWakeMutex;
+	std::condition_variable mWakeCondition;
+	std::atomic<int> mQueuedJobCount;
+	bool mQuit = false;
+	
+	void WorkerLoop(int queueIndex);
+	
+	bool TakeJob(int queueIndex, Job& job);
+	void RunJob(const Job& job);
+};
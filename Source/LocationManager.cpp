@@ -5,6 +5,7 @@
 //
 #include "LocationManager.h"
 
+#include "ConditionCache.h"
 #include "GameProgress.h"
 #include "IniParser.h"
 #include "Localizer.h"
@@ -177,6 +178,7 @@ void LocationManager::SetLocation(const std::string& location)
 {
 	mLastLocation = mLocation;
 	mLocation = location;
+	ConditionCache::Changed(ConditionInput::Location);
 }
 
 std::string LocationManager::GetLocationDisplayName() const
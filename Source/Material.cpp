@@ -12,24 +12,43 @@
 // This is set to a default shader during Renderer init.
 Shader* Material::sDefaultShader = nullptr;
 
-Matrix4 Material::sCurrentViewMatrix;
-Matrix4 Material::sCurrentProjMatrix;
+FrameUniformBlock Material::sFrameUniforms;
+UniformBuffer* Material::sFrameUniformBuffer = nullptr;
+bool Material::sFrameUniformsChanged = true;
 
-float Material::sAlphaTestValue = 0.0f;
+namespace
+{
+    void ColorToFloats(const Color32& color, float* outFloats)
+    {
+        outFloats[0] = color.GetR() / 255.0f;
+        outFloats[1] = color.GetG() / 255.0f;
+        outFloats[2] = color.GetB() / 255.0f;
+        outFloats[3] = color.GetA() / 255.0f;
+    }
+}
 
 void Material::SetViewMatrix(const Matrix4& viewMatrix)
 {
-	sCurrentViewMatrix = viewMatrix;
+	sFrameUniforms.viewMatrix = viewMatrix;
+	sFrameUniforms.worldToProjMatrix = sFrameUniforms.projMatrix * sFrameUniforms.viewMatrix;
+	sFrameUniformsChanged = true;
 }
 
 void Material::SetProjMatrix(const Matrix4& projMatrix)
 {
-	sCurrentProjMatrix = projMatrix;
+	sFrameUniforms.projMatrix = projMatrix;
+	sFrameUniforms.worldToProjMatrix = sFrameUniforms.projMatrix * sFrameUniforms.viewMatrix;
+	sFrameUniformsChanged = true;
 }
 
 void Material::UseAlphaTest(bool use)
 {
-	sAlphaTestValue = use ? 0.1f : 0.0f;
+	float alphaTest = use ? 0.1f : 0.0f;
+	if(sFrameUniforms.alphaTest != alphaTest)
+	{
+		sFrameUniforms.alphaTest = alphaTest;
+		sFrameUniformsChanged = true;
+	}
 }
 
 Material::Material() : mShader(sDefaultShader)
@@ -43,34 +62,32 @@ Material::Material(Shader* shader) : mShader(shader)
 }
 
 void Material::Activate(const Matrix4& objectToWorldMatrix)
+{
+	Activate(objectToWorldMatrix, mShader);
+}
+
+void Material::Activate(const Matrix4& objectToWorldMatrix, Shader* shader)
 {
     // Must activate shader BEFORE setting uniforms to get correct results.
     // See https://stackoverflow.com/questions/42357380/why-must-i-use-a-shader-program-before-i-can-set-its-uniforms
-    mShader->Activate();
+    shader->Activate();
+    RefreshUniformHandles(shader);
+    
+	// Set built-in transform matrices and alpha test value.
+    shader->SetUniformMatrix4(shader->GetBuiltInUniforms().objectToWorldMatrix, objectToWorldMatrix);
+    ActivateFrameUniforms(shader);
     
-	// Set built-in transform matrices.
-    mShader->SetUniformMatrix4("gObjectToWorldMatrix", objectToWorldMatrix);
-    mShader->SetUniformMatrix4("gViewMatrix", sCurrentViewMatrix);
-    mShader->SetUniformMatrix4("gProjMatrix", sCurrentProjMatrix);
-	mShader->SetUniformMatrix4("gWorldToProjMatrix", sCurrentProjMatrix * sCurrentViewMatrix);
-	
-	// Set built-in alpha test value.
-	mShader->SetUniformFloat("gAlphaTest", sAlphaTestValue);
-	
     // Set user-defined color values.
-    for(auto& entry : mColors)
-    {
-        mShader->SetUniformColor(entry.first.c_str(), entry.second);
-    }
+    ActivateMaterialUniforms(shader);
     
     // Set user-defined textures.
     int textureUnit = 0;
     for(auto& entry : mTextures)
     {
-        if(entry.second != nullptr)
+        if(entry.second.value != nullptr)
         {
-            mShader->SetUniformInt(entry.first.c_str(), textureUnit);
-            entry.second->Activate(textureUnit);
+            shader->SetUniformInt(entry.second.handle, textureUnit);
+            entry.second.value->Activate(textureUnit);
             ++textureUnit;
         }
     }
@@ -80,12 +97,42 @@ void Material::Activate(const Matrix4& objectToWorldMatrix)
 
 void Material::SetColor(const std::string& name, const Color32& color)
 {
-    mColors[name] = color;
+    auto it = mColors.find(name);
+    if(it != mColors.end())
+    {
+        it->second.value = color;
+    }
+    else
+    {
+        mColors[name].value = color;
+        mHandleShader = nullptr;
+    }
+    
+    // Keep the material block up to date for colors that are in it.
+    if(name == "uColor")
+    {
+        ColorToFloats(color, mUniforms.color);
+        mUniformsChanged = true;
+    }
+    else if(name == "uReplaceColor")
+    {
+        ColorToFloats(color, mUniforms.replaceColor);
+        mUniformsChanged = true;
+    }
 }
 
 void Material::SetTexture(const std::string& name, Texture* texture)
 {
-    mTextures[name] = texture;
+    auto it = mTextures.find(name);
+    if(it != mTextures.end())
+    {
+        it->second.value = texture;
+    }
+    else
+    {
+        mTextures[name].value = texture;
+        mHandleShader = nullptr;
+    }
 }
 
 Texture* Material::GetTexture(const std::string& name) const
@@ -93,13 +140,98 @@ Texture* Material::GetTexture(const std::string& name) const
     auto it = mTextures.find(name);
     if(it != mTextures.end())
     {
-        return it->second;
+        return it->second.value;
     }
     return nullptr;
 }
 
-bool Material::IsTranslucent()
+U64 Material::GetInstancingKey() const
+{
+    // The key only describes the color. Any other color or texture (besides the diffuse texture) rules instancing out.
+    if(mColors.size() > 1 || mTextures.size() > 1) { return 0; }
+    if(!mTextures.empty() && mTextures.begin()->first != "uDiffuse") { return 0; }
+    
+    auto it = mColors.find("uColor");
+    Color32 color = it != mColors.end() ? it->second.value : Color32::White;
+    
+    // The top bit makes sure a valid key is never zero.
+    return (1ULL << 32) | (static_cast<U64>(color.GetR()) << 24) | (static_cast<U64>(color.GetG()) << 16) |
+           (static_cast<U64>(color.GetB()) << 8) | static_cast<U64>(color.GetA());
+}
+
+bool Material::IsTranslucent() const
 {
 	//TODO: Maybe use render queue value for this?
-	return false;
+	return mUniforms.color[3] < 1.0f;
+}
+
+void Material::RefreshUniformHandles(Shader* shader)
+{
+    // Usually, a material is drawn with the same shader every time, so the handles are still good.
+    if(shader == mHandleShader) { return; }
+    mHandleShader = shader;
+    
+    for(auto& entry : mColors)
+    {
+        entry.second.handle = shader->GetUniformHandle(entry.first.c_str());
+    }
+    for(auto& entry : mTextures)
+    {
+        entry.second.handle = shader->GetUniformHandle(entry.first.c_str());
+    }
+}
+
+void Material::ActivateFrameUniforms(Shader* shader)
+{
+    if(shader->HasFrameBlock())
+    {
+        // The frame buffer stays bound to its binding point, so it only needs to be updated when values change.
+        if(sFrameUniformBuffer == nullptr)
+        {
+            sFrameUniformBuffer = new UniformBuffer(sizeof(FrameUniformBlock));
+            sFrameUniformBuffer->Bind(UniformBuffer::kFrameBlockBinding);
+            sFrameUniformsChanged = true;
+        }
+        if(sFrameUniformsChanged)
+        {
+            sFrameUniformBuffer->SetData(&sFrameUniforms);
+            sFrameUniformsChanged = false;
+        }
+    }
+    else
+    {
+        // Fallback: set each value as a plain uniform.
+        const BuiltInUniformHandles& uniforms = shader->GetBuiltInUniforms();
+        shader->SetUniformMatrix4(uniforms.viewMatrix, sFrameUniforms.viewMatrix);
+        shader->SetUniformMatrix4(uniforms.projMatrix, sFrameUniforms.projMatrix);
+        shader->SetUniformMatrix4(uniforms.worldToProjMatrix, sFrameUniforms.worldToProjMatrix);
+        shader->SetUniformFloat(uniforms.alphaTest, sFrameUniforms.alphaTest);
+    }
+}
+
+void Material::ActivateMaterialUniforms(Shader* shader)
+{
+    if(shader->HasMaterialBlock())
+    {
+        // Colors only need to be uploaded when they change. A buffer shared with other copies of this material
+        // can't be changed without changing their colors too, so make a new one in that case.
+        if(mUniformsChanged || mUniformBuffer == nullptr)
+        {
+            if(mUniformBuffer == nullptr || mUniformBuffer.use_count() > 1)
+            {
+                mUniformBuffer = std::make_shared<UniformBuffer>(sizeof(MaterialUniformBlock));
+            }
+            mUniformBuffer->SetData(&mUniforms);
+            mUniformsChanged = false;
+        }
+        mUniformBuffer->Bind(UniformBuffer::kMaterialBlockBinding);
+    }
+    else
+    {
+        // Fallback: set each color as a plain uniform.
+        for(auto& entry : mColors)
+        {
+            shader->SetUniformColor(entry.second.handle, entry.second.value);
+        }
+    }
 }
@@ -7,13 +7,16 @@
 // It indicates the shader to use and any input parameters for the shader (texture, color, etc).
 //
 #pragma once
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
+#include "Atomics.h"
 #include "Color32.h"
 #include "Matrix4.h"
+#include "Shader.h"
+#include "UniformBuffer.h"
 
-class Shader;
 class Texture;
 
 class Material
@@ -29,6 +32,10 @@ public:
     
 	void Activate(const Matrix4& objectToWorldMatrix);
 	
+	// Same as above, but activates a different shader than the material's own (e.g. a variant that does vertex animation).
+	// The shader should use the same uniforms as the material's shader.
+	void Activate(const Matrix4& objectToWorldMatrix, Shader* shader);
+	
     void SetShader(Shader* shader) { mShader = shader; }
     Shader* GetShader() const { return mShader; }
     
@@ -44,18 +51,46 @@ public:
     void SetDiffuseTexture(Texture* texture) { SetTexture("uDiffuse", texture); }
     Texture* GetDiffuseTexture() const { return GetTexture("uDiffuse"); }
     
-	bool IsTranslucent();
+	// A material is translucent if its color isn't fully opaque.
+	// Texture alpha doesn't count - that is handled with alpha test.
+	bool IsTranslucent() const;
+	
+	// Identifies how the material looks, apart from its shader and diffuse texture, for instancing (see RenderQueueItem).
+	// Materials with equal keys look the same. Returns zero if the material has values the key can't describe.
+	U64 GetInstancingKey() const;
 	
 private:
-	static Matrix4 sCurrentViewMatrix;
-	static Matrix4 sCurrentProjMatrix;
-	static float sAlphaTestValue;
+	// Per-frame values (view/proj matrices, alpha test), shared by all materials.
+	// Shaders that use the frame block get these from a uniform buffer, which is only updated when the values change.
+	static FrameUniformBlock sFrameUniforms;
+	static UniformBuffer* sFrameUniformBuffer;
+	static bool sFrameUniformsChanged;
 	
     // Shader to use.
     Shader* mShader = nullptr;
     
-    std::unordered_map<std::string, Color32> mColors;
-    std::unordered_map<std::string, Texture*> mTextures;
+    // A color or texture, plus its uniform handle in "mHandleShader".
+    template<typename T> struct UniformValue
+    {
+        T value;
+        UniformHandle handle;
+    };
+    std::unordered_map<std::string, UniformValue<Color32>> mColors;
+    std::unordered_map<std::string, UniformValue<Texture*>> mTextures;
+    
+    // The shader that color and texture handles were last looked up in.
+    // Handles are looked up again when drawing with a different shader, or after adding a new color or texture.
+    Shader* mHandleShader = nullptr;
+    
+    // The colors in "MaterialBlock", and the uniform buffer holding them.
+    // The buffer is shared between copies of a material until one of them changes a color.
+    MaterialUniformBlock mUniforms;
+    std::shared_ptr<UniformBuffer> mUniformBuffer;
+    bool mUniformsChanged = true;
+    
+    void RefreshUniformHandles(Shader* shader);
+    void ActivateFrameUniforms(Shader* shader);
+    void ActivateMaterialUniforms(Shader* shader);
     
     //TODO: Opaque vs. transparent? Render queue value?
 };
@@ -44,7 +44,7 @@ Submesh* Mesh::AddSubmesh(const MeshDefinition& meshDefinition)
     return submesh;
 }
 
-bool Mesh::Raycast(const Ray& ray, RaycastHit& hitInfo)
+bool Mesh::Raycast(const Ray& ray, RaycastHit& hitInfo, const float* const* submeshPositions)
 {
 	// Check against Mesh's AABB to see if we hit it.
 	if(Collisions::TestRayAABB(ray, mAABB, hitInfo))
@@ -52,9 +52,10 @@ bool Mesh::Raycast(const Ray& ray, RaycastHit& hitInfo)
 		// If hit the AABB, do a per-triangle check as well for more precise detection.
 		// For example, Gabe's AABBs are pretty rough, so you can select him when clicking nowhere near him (a foot left of his arm).
 		// This isn't how the original game works, so I think they must do a per-triangle check as well.
-		for(auto& submesh : mSubmeshes)
+		for(int i = 0; i < mSubmeshes.size(); ++i)
 		{
-			if(submesh->Raycast(ray))
+			const float* positions = submeshPositions != nullptr ? submeshPositions[i] : nullptr;
+			if(mSubmeshes[i]->Raycast(ray, positions))
 			{
 				return true;
 			}
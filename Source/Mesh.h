@@ -43,7 +43,9 @@ public:
 	
 	const std::vector<Submesh*>& GetSubmeshes() const { return mSubmeshes; }
 	
-	bool Raycast(const Ray& ray, RaycastHit& hitInfo);
+	// If "submeshPositions" is given, it holds positions to test each submesh against, indexed by submesh (see Submesh::Raycast).
+	// Null entries mean to use that submesh's own positions.
+	bool Raycast(const Ray& ray, RaycastHit& hitInfo, const float* const* submeshPositions = nullptr);
 	
 private:
 	std::vector<Submesh*> mSubmeshes;
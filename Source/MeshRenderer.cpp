@@ -9,8 +9,11 @@
 #include "Debug.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "Services.h"
 #include "Texture.h"
+#include "VertexAnimation.h"
+#include "VertexAnimationBuffer.h"
 
 TYPE_DEF_CHILD(Component, MeshRenderer);
 
@@ -24,7 +27,7 @@ MeshRenderer::~MeshRenderer()
     Services::GetRenderer()->RemoveMeshRenderer(this);
 }
 
-void MeshRenderer::RenderOpaque()
+void MeshRenderer::AddToRenderQueue(RenderQueue& renderQueue, const Vector3& cameraPosition, const Vector3& cameraForward)
 {
 	// Don't render if actor is inactive or component is disabled.
 	if(!IsActiveAndEnabled()) { return; }
@@ -33,30 +36,46 @@ void MeshRenderer::RenderOpaque()
 	
 	int materialIndex = 0;
 	int maxMaterialIndex = static_cast<int>(mMaterials.size()) - 1;
-
+	
+	RenderQueueItem item;
+	item.meshRenderer = this;
 	for(int i = 0; i < mMeshes.size(); i++)
 	{
-		Matrix4 meshWorldTransformMatrix = actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix();
+		item.meshIndex = i;
+		item.worldTransform = actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix();
 		
-		auto submeshes = mMeshes[i]->GetSubmeshes();
+		// All submeshes of a mesh are sorted by the mesh's center.
+		Vector3 meshCenter = item.worldTransform.TransformPoint(mMeshes[i]->GetAABB().GetCenter());
+		item.depth = Vector3::Dot(meshCenter - cameraPosition, cameraForward);
+		
+		const std::vector<Submesh*>& submeshes = mMeshes[i]->GetSubmeshes();
 		for(int j = 0; j < submeshes.size(); j++)
 		{
 			Material& material = mMaterials[materialIndex];
+			item.material = &material;
+			item.submesh = submeshes[j];
+			item.submeshIndex = j;
+			item.shader = material.GetShader();
+			item.texture = material.GetDiffuseTexture();
+			
+			// Instanced draws use an instanced variant of the default shader, and can't also do vertex animation.
+			bool canInstance = material.GetShader() == Material::sDefaultShader &&
+							   !IsVertexAnimatedOnGPU(i, j, submeshes[j], material);
+			item.materialKey = canInstance ? material.GetInstancingKey() : 0;
 			
-			// Ignore translucent rendering.
-			if(!material.IsTranslucent())
+			if(material.IsTranslucent())
+			{
+				renderQueue.AddTranslucent(item);
+			}
+			else
 			{
-				// Activate material.
-				material.Activate(meshWorldTransformMatrix);
-				
-				// Render the submesh!
-				submeshes[j]->Render();
+				renderQueue.AddOpaque(item);
 			}
 			
 			// Draw debug axes if desired.
 			if(Debug::RenderSubmeshLocalAxes())
 			{
-				Debug::DrawAxes(meshWorldTransformMatrix);
+				Debug::DrawAxes(item.worldTransform);
 			}
 			
 			// Increase material index, but not above the max.
@@ -65,36 +84,13 @@ void MeshRenderer::RenderOpaque()
 	}
 }
 
-void MeshRenderer::RenderTranslucent()
+void MeshRenderer::Render(const RenderQueueItem& item)
 {
-	Matrix4 actorWorldTransform = GetOwner()->GetTransform()->GetLocalToWorldMatrix();
-	
-	int materialIndex = 0;
-	int maxMaterialIndex = static_cast<int>(mMaterials.size()) - 1;
+	// Activate material.
+	ActivateMaterial(*item.material, item.worldTransform, item.meshIndex, item.submeshIndex, item.submesh);
 	
-	for(int i = 0; i < mMeshes.size(); i++)
-	{
-		Matrix4 meshWorldTransform = actorWorldTransform * mMeshes[i]->GetMeshToLocalMatrix();
-		
-		auto submeshes = mMeshes[i]->GetSubmeshes();
-		for(int j = 0; j < submeshes.size(); j++)
-		{
-			Material& material = mMaterials[materialIndex];
-			
-			// Ignore opaque rendering.
-			if(material.IsTranslucent())
-			{
-				// Activate material.
-				material.Activate(meshWorldTransform);
-				
-				// Render the submesh!
-				submeshes[j]->Render();
-			}
-			
-			// Increase material index, but not above the max.
-			materialIndex = Math::Min(materialIndex + 1, maxMaterialIndex);
-		}
-	}
+	// Render the submesh!
+	item.submesh->Render();
 }
 
 void MeshRenderer::SetModel(Model* model)
@@ -187,13 +183,60 @@ Mesh* MeshRenderer::GetMesh(int index) const
 	return nullptr;
 }
 
+void MeshRenderer::SetVertexAnimation(VertexAnimationBuffer* buffer, float time, int framesPerSecond)
+{
+	mVertexAnimationBuffer = buffer;
+	mVertexAnimationTime = time;
+	mVertexAnimationFramesPerSecond = framesPerSecond;
+	mVertexAnimationPositionsDirty = (buffer != nullptr);
+}
+
+bool MeshRenderer::IsVertexAnimatedOnGPU(int meshIndex, int submeshIndex)
+{
+	Mesh* mesh = GetMesh(meshIndex);
+	Material* material = GetMaterial(meshIndex, submeshIndex);
+	if(mesh == nullptr || material == nullptr) { return false; }
+	
+	Submesh* submesh = mesh->GetSubmesh(submeshIndex);
+	if(submesh == nullptr) { return false; }
+	return IsVertexAnimatedOnGPU(meshIndex, submeshIndex, submesh, *material);
+}
+
 bool MeshRenderer::Raycast(const Ray& ray, RaycastHit& hitInfo)
 {
+	// If animating on the GPU, the submeshes' positions aren't what's on screen. Sample the current pose so the raycast hits what's on screen.
+	// No need to upload these - the GPU is rendering the animation already.
+	if(mVertexAnimationPositionsDirty)
+	{
+		VertexAnimation* animation = mVertexAnimationBuffer->GetAnimation();
+		mVertexAnimationPositions.resize(mMeshes.size());
+		for(int i = 0; i < mMeshes.size(); ++i)
+		{
+			const std::vector<Submesh*>& submeshes = mMeshes[i]->GetSubmeshes();
+			mVertexAnimationPositions[i].resize(submeshes.size());
+			for(int j = 0; j < submeshes.size(); ++j)
+			{
+				std::vector<float>& positions = mVertexAnimationPositions[i][j];
+				positions.clear();
+				if(IsVertexAnimatedOnGPU(i, j))
+				{
+					positions.resize(submeshes[j]->GetVertexCount() * 3);
+					animation->SampleVertexPose(mVertexAnimationTime, mVertexAnimationFramesPerSecond, i, j,
+												positions.data(), submeshes[j]->GetVertexCount());
+				}
+			}
+		}
+		mVertexAnimationPositionsDirty = false;
+	}
+	
 	Matrix4 localToWorldMatrix = GetOwner()->GetTransform()->GetLocalToWorldMatrix();
 	
 	// Raycast against triangles in the mesh.
-	for(auto& mesh : mMeshes)
+	std::vector<const float*> submeshPositions;
+	for(int i = 0; i < mMeshes.size(); ++i)
 	{
+		Mesh* mesh = mMeshes[i];
+		
 		// Calculate world->local space transform by creating object->local and inverting.
 		Matrix4 meshToWorldMatrix = localToWorldMatrix * mesh->GetMeshToLocalMatrix();
         Matrix4 worldToMeshMatrix = Matrix4::InverseTransform(meshToWorldMatrix);
@@ -204,8 +247,21 @@ bool MeshRenderer::Raycast(const Ray& ray, RaycastHit& hitInfo)
 		rayLocalDir.Normalize();
 		Ray localRay(rayLocalPos, rayLocalDir);
 		
+		// If animating on the GPU, test against the sampled pose of animated submeshes.
+		const float* const* positions = nullptr;
+		if(mVertexAnimationBuffer != nullptr && i < mVertexAnimationPositions.size() &&
+		   mVertexAnimationPositions[i].size() == mesh->GetSubmeshCount())
+		{
+			submeshPositions.clear();
+			for(auto& pose : mVertexAnimationPositions[i])
+			{
+				submeshPositions.push_back(pose.empty() ? nullptr : pose.data());
+			}
+			positions = submeshPositions.data();
+		}
+		
 		// See if the local ray intersects the local space triangles of the mesh.
-		if(mesh->Raycast(localRay, hitInfo))
+		if(mesh->Raycast(localRay, hitInfo, positions))
 		{
 			//TODO: Convert hit info back to world space.
 			return true;
@@ -230,3 +286,20 @@ void MeshRenderer::DebugDrawAABBs()
         Debug::DrawAABB(mesh->GetAABB(), Color32::Magenta, 60.0f, &meshToWorldMatrix);
 	}
 }
+
+bool MeshRenderer::IsVertexAnimatedOnGPU(int meshIndex, int submeshIndex, Submesh* submesh, Material& material) const
+{
+	// The vertex animation shader is a variant of the default shader, so only materials using the default shader can use it.
+	return mVertexAnimationBuffer != nullptr && material.GetShader() == Material::sDefaultShader &&
+		mVertexAnimationBuffer->HasKeyframes(meshIndex, submeshIndex, submesh->GetVertexCount());
+}
+
+void MeshRenderer::ActivateMaterial(Material& material, const Matrix4& objectToWorldMatrix, int meshIndex, int submeshIndex, Submesh* submesh)
+{
+	// Vertex animated submeshes use a shader that does the animation; all others use their material as-is.
+	if(!IsVertexAnimatedOnGPU(meshIndex, submeshIndex, submesh, material) ||
+	   !mVertexAnimationBuffer->Activate(material, objectToWorldMatrix, meshIndex, submeshIndex, mVertexAnimationTime, mVertexAnimationFramesPerSecond))
+	{
+		material.Activate(objectToWorldMatrix);
+	}
+}
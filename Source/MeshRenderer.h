@@ -16,7 +16,11 @@ class Mesh;
 class Model;
 class Ray;
 struct RaycastHit;
+class RenderQueue;
+struct RenderQueueItem;
+class Submesh;
 class Texture;
+class VertexAnimationBuffer;
 
 class MeshRenderer : public Component
 {
@@ -25,8 +29,11 @@ public:
     MeshRenderer(Actor* actor);
     ~MeshRenderer();
 	
-	void RenderOpaque();
-	void RenderTranslucent();
+	// Adds a render queue item for each submesh. Nothing is added if the renderer is inactive.
+	void AddToRenderQueue(RenderQueue& renderQueue, const Vector3& cameraPosition, const Vector3& cameraForward);
+	
+	// Draws a submesh, for a render queue item this renderer added.
+	void Render(const RenderQueueItem& item);
     
     void SetModel(Model* model);
     
@@ -42,6 +49,12 @@ public:
 	const std::vector<Mesh*>& GetMeshes() const { return mMeshes; }
 	Mesh* GetMesh(int index) const;
 	
+	// Plays a vertex animation on the GPU: submeshes with keyframes in the buffer are posed in the vertex shader at the given time.
+	// Pass null to go back to rendering the submeshes' own vertex positions.
+	void SetVertexAnimation(VertexAnimationBuffer* buffer, float time, int framesPerSecond);
+	VertexAnimationBuffer* GetVertexAnimation() const { return mVertexAnimationBuffer; }
+	bool IsVertexAnimatedOnGPU(int meshIndex, int submeshIndex);
+	
 	bool Raycast(const Ray& ray, RaycastHit& hitInfo);
 	
 	void DebugDrawAABBs();
@@ -59,4 +72,19 @@ private:
     // Each mesh *must have* a material!
 	// If a mesh has multiple submeshes, each submesh *must have* a material!
     std::vector<Material> mMaterials;
+	
+	// Vertex animation being done on the GPU, if any, and the time/rate to sample it at.
+	VertexAnimationBuffer* mVertexAnimationBuffer = nullptr;
+	float mVertexAnimationTime = 0.0f;
+	int mVertexAnimationFramesPerSecond = 15;
+	
+	// When animating on the GPU, the pose isn't sampled on the CPU every frame.
+	// Only if we need it (e.g. for raycasts) do we sample it, into these buffers rather than the submeshes.
+	// Submeshes can be shared with other mesh renderers, which shouldn't see this renderer's pose.
+	// Positions are indexed by [meshIndex][submeshIndex], and are empty for submeshes that aren't animated on the GPU.
+	std::vector<std::vector<std::vector<float>>> mVertexAnimationPositions;
+	bool mVertexAnimationPositionsDirty = false;
+	
+	bool IsVertexAnimatedOnGPU(int meshIndex, int submeshIndex, Submesh* submesh, Material& material) const;
+	void ActivateMaterial(Material& material, const Matrix4& objectToWorldMatrix, int meshIndex, int submeshIndex, Submesh* submesh);
 };
@@ -88,6 +88,10 @@ void NVC::ParseFromData(char *data, int dataLength)
 		StringUtil::RemoveAll(caseLabel, '\t'); //TODO: Still needed? We also do this in IniParser layer now.
 		StringUtil::Trim(caseLabel);
 		action.caseLabel = caseLabel;
+		
+		action.nounAtom = Atom(action.noun);
+		action.verbAtom = Atom(action.verb);
+		action.caseAtom = Atom(action.caseLabel);
         
         // From here, we have some optional stuff.
 		for(int i = 3; i < line.entries.size(); ++i)
@@ -160,7 +164,7 @@ void NVC::ParseFromData(char *data, int dataLength)
 				}
 				
 				// Compile and save script.
-				action.script = Services::GetSheep()->Compile("Case Evaluation", action.scriptText);
+				action.script = Services::GetSheep()->CompileCached("Case Evaluation", action.scriptText);
             }
 		}
         
@@ -15,6 +15,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Atom.h"
+
 class GKActor;
 class SheepScript;
 
@@ -31,6 +33,11 @@ struct Action
 	// Or, it can refer to a hard-coded global condition (e.g. ALL, GABE_ALL, GRACE_ALL).
     std::string caseLabel;
 	
+	// Noun, verb, and case as atoms, for quick comparisons and lookups.
+	Atom nounAtom;
+	Atom verbAtom;
+	Atom caseAtom;
+	
 	// If desired, an approach can be specified. Ego will "approach" the target
 	// before executing the associated script.
 	enum class Approach
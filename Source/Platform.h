@@ -17,6 +17,8 @@
 	#endif
 #elif defined(_WIN32)
 	#define PLATFORM_WINDOWS
+#elif defined(__linux__)
+	#define PLATFORM_LINUX
 #else
 	#error "Unknown Platform"
 #endif
@@ -0,0 +1,167 @@
+//
+// RenderQueue.cpp
+//
+// Clark Kromenaker
+//
+#include "RenderQueue.h"
+
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	// Converts a float to an unsigned int that sorts in the same order as the float.
+	// Positive floats sort correctly as ints once the sign bit is set; negative floats need all bits flipped.
+	U32 FloatToSortableInt(float value)
+	{
+		U32 bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+		return (bits & 0x80000000) ? ~bits : (bits | 0x80000000);
+	}
+}
+
+void RenderQueue::Clear()
+{
+	mOpaqueItems.clear();
+	mTranslucentItems.clear();
+	mOpaqueOrder.clear();
+	mTranslucentOrder.clear();
+	mInstanceGroups.clear();
+}
+
+void RenderQueue::AddOpaque(const RenderQueueItem& item)
+{
+	// Key is 12 bits of shader ID, 20 bits of texture ID, 20 bits of mesh ID, then 12 bits of material key ID.
+	// If there are ever more objects than fit, IDs wrap around - that only makes the grouping a bit worse.
+	U64 shaderId = GetId<const void*>(mShaderIds, item.shader) & 0xFFF;
+	U64 textureId = GetId<const void*>(mTextureIds, item.texture) & 0xFFFFF;
+	U64 meshId = GetId<const void*>(mMeshIds, item.submesh) & 0xFFFFF;
+	U64 materialId = GetId<U64>(mMaterialIds, item.materialKey) & 0xFFF;
+	
+	SortEntry entry;
+	entry.key = (shaderId << 52) | (textureId << 32) | (meshId << 12) | materialId;
+	entry.index = static_cast<U32>(mOpaqueItems.size());
+	mOpaqueOrder.push_back(entry);
+	mOpaqueItems.push_back(item);
+}
+
+void RenderQueue::AddTranslucent(const RenderQueueItem& item)
+{
+	// Farthest first, so the key is the depth, inverted.
+	SortEntry entry;
+	entry.key = ~FloatToSortableInt(item.depth);
+	entry.index = static_cast<U32>(mTranslucentItems.size());
+	mTranslucentOrder.push_back(entry);
+	mTranslucentItems.push_back(item);
+}
+
+void RenderQueue::Sort()
+{
+	RadixSort(mOpaqueOrder);
+	RadixSort(mTranslucentOrder);
+	BuildInstanceGroups();
+}
+
+void RenderQueue::BuildInstanceTransforms(std::vector<Matrix4>& outTransforms)
+{
+	outTransforms.clear();
+	for(InstanceGroup& group : mInstanceGroups)
+	{
+		if(group.count > 1)
+		{
+			group.firstInstance = static_cast<int>(outTransforms.size());
+			for(int i = 0; i < group.count; ++i)
+			{
+				outTransforms.push_back(GetOpaque(group.first + i).worldTransform);
+			}
+		}
+		else
+		{
+			group.firstInstance = -1;
+		}
+	}
+}
+
+template<typename T> /*static*/ U32 RenderQueue::GetId(std::unordered_map<T, U32>& ids, T object)
+{
+	auto it = ids.find(object);
+	if(it != ids.end())
+	{
+		return it->second;
+	}
+	U32 id = static_cast<U32>(ids.size());
+	ids[object] = id;
+	return id;
+}
+
+void RenderQueue::RadixSort(std::vector<SortEntry>& entries)
+{
+	if(entries.size() < 2) { return; }
+	mSortBuffer.resize(entries.size());
+	
+	// Least significant digit first, one byte at a time. Each pass is stable, so items with equal keys stay in the order added.
+	std::vector<SortEntry>* from = &entries;
+	std::vector<SortEntry>* to = &mSortBuffer;
+	for(int shift = 0; shift < 64; shift += 8)
+	{
+		// Count how many keys have each value for this byte.
+		U32 counts[256] = { 0 };
+		for(const SortEntry& entry : *from)
+		{
+			++counts[(entry.key >> shift) & 0xFF];
+		}
+		
+		// If every key has the same value for this byte, this pass wouldn't change anything.
+		// This happens a lot, since keys rarely use all their bits (e.g. translucent keys only use the lower 32).
+		if(counts[(from->front().key >> shift) & 0xFF] == from->size()) { continue; }
+		
+		// Turn counts into where each value's keys start in the output.
+		U32 offset = 0;
+		for(int i = 0; i < 256; ++i)
+		{
+			U32 count = counts[i];
+			counts[i] = offset;
+			offset += count;
+		}
+		
+		// Put each key in its place.
+		for(const SortEntry& entry : *from)
+		{
+			(*to)[counts[(entry.key >> shift) & 0xFF]++] = entry;
+		}
+		std::swap(from, to);
+	}
+	
+	// Make sure the result ends up back in "entries".
+	if(from != &entries)
+	{
+		entries.swap(mSortBuffer);
+	}
+}
+
+void RenderQueue::BuildInstanceGroups()
+{
+	mInstanceGroups.clear();
+	for(int i = 0; i < GetOpaqueCount(); ++i)
+	{
+		// Join the previous group if this item looks exactly like the items in it.
+		// Sort keys can wrap around, so compare the actual values, not just the keys.
+		if(!mInstanceGroups.empty())
+		{
+			InstanceGroup& group = mInstanceGroups.back();
+			const RenderQueueItem& first = GetOpaque(group.first);
+			const RenderQueueItem& item = GetOpaque(i);
+			if(item.materialKey != 0 && item.materialKey == first.materialKey &&
+			   item.shader == first.shader && item.texture == first.texture && item.submesh == first.submesh)
+			{
+				++group.count;
+				continue;
+			}
+		}
+		
+		InstanceGroup group;
+		group.first = i;
+		group.count = 1;
+		mInstanceGroups.push_back(group);
+	}
+}
@@ -0,0 +1,121 @@
+//
+// RenderQueue.h
+//
+// Clark Kromenaker
+//
+// Collects everything that needs to be drawn in a frame, and puts it in a good order for drawing.
+//
+// Opaque items are sorted by shader, then texture, then mesh, so consecutive draws share as much GL state as possible.
+// Translucent items are sorted back to front, so they blend correctly over whatever is behind them.
+//
+// After sorting, runs of opaque items that look identical (same shader, texture, mesh, and material key)
+// form "instance groups", which can be drawn with a single instanced draw call.
+//
+// The queue never looks inside the shaders, textures, or meshes it's given - they are only used as sort keys.
+// So, it doesn't need a GL context to work.
+//
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "Atomics.h"
+#include "Matrix4.h"
+
+class Material;
+class MeshRenderer;
+class Shader;
+class Submesh;
+class Texture;
+
+struct RenderQueueItem
+{
+	// What draws the item, and the details it needs to do so.
+	MeshRenderer* meshRenderer = nullptr;
+	Material* material = nullptr;
+	Submesh* submesh = nullptr;
+	int meshIndex = 0;
+	int submeshIndex = 0;
+	Matrix4 worldTransform;
+	
+	// What the item is sorted by.
+	Shader* shader = nullptr;
+	Texture* texture = nullptr;
+	
+	// Identifies everything else about the material that affects how the item looks (e.g. its color).
+	// Items with the same key (and shader/texture/mesh) can be instanced together. Zero means the item can't be instanced.
+	U64 materialKey = 0;
+	
+	// Distance from the camera, along the camera's forward direction.
+	float depth = 0.0f;
+};
+
+class RenderQueue
+{
+public:
+	// A run of consecutive (sorted) opaque items. Items in a group can be drawn together, if the group has more than one.
+	struct InstanceGroup
+	{
+		int first = 0;
+		int count = 0;
+		
+		// Index of the group's first transform in the instance transforms (see BuildInstanceTransforms).
+		// -1 if the group isn't drawn instanced.
+		int firstInstance = -1;
+	};
+	
+	// Removes all items, to start a new frame.
+	void Clear();
+	
+	void AddOpaque(const RenderQueueItem& item);
+	void AddTranslucent(const RenderQueueItem& item);
+	
+	// Sorts items added since "Clear". Must be called before getting items below.
+	void Sort();
+	
+	// Items, in sorted order.
+	int GetOpaqueCount() const { return static_cast<int>(mOpaqueOrder.size()); }
+	const RenderQueueItem& GetOpaque(int index) const { return mOpaqueItems[mOpaqueOrder[index].index]; }
+	
+	// Opaque items, in groups. Every opaque item is in exactly one group.
+	int GetInstanceGroupCount() const { return static_cast<int>(mInstanceGroups.size()); }
+	const InstanceGroup& GetInstanceGroup(int index) const { return mInstanceGroups[index]; }
+	
+	// Fills "outTransforms" with the world transforms of every group with more than one item (groups of one aren't worth instancing),
+	// one group after another, and sets each group's "firstInstance" to match.
+	void BuildInstanceTransforms(std::vector<Matrix4>& outTransforms);
+	
+	int GetTranslucentCount() const { return static_cast<int>(mTranslucentOrder.size()); }
+	const RenderQueueItem& GetTranslucent(int index) const { return mTranslucentItems[mTranslucentOrder[index].index]; }
+	
+private:
+	struct SortEntry
+	{
+		U64 key;
+		U32 index;
+	};
+	
+	// Items added this frame, in the order they were added.
+	std::vector<RenderQueueItem> mOpaqueItems;
+	std::vector<RenderQueueItem> mTranslucentItems;
+	
+	// Sort keys for each item, and the index of the item. Sorting these (rather than the items) means less copying.
+	std::vector<SortEntry> mOpaqueOrder;
+	std::vector<SortEntry> mTranslucentOrder;
+	
+	// Scratch space for the radix sort.
+	std::vector<SortEntry> mSortBuffer;
+	
+	// Groups of sorted opaque items that can be instanced.
+	std::vector<InstanceGroup> mInstanceGroups;
+	
+	// Shaders, textures, meshes, and material keys are given small IDs the first time they are seen, so they fit in a sort key.
+	// IDs are kept from frame to frame, so the same object sorts the same way every frame.
+	std::unordered_map<const void*, U32> mShaderIds;
+	std::unordered_map<const void*, U32> mTextureIds;
+	std::unordered_map<const void*, U32> mMeshIds;
+	std::unordered_map<U64, U32> mMaterialIds;
+	
+	template<typename T> static U32 GetId(std::unordered_map<T, U32>& ids, T object);
+	void BuildInstanceGroups();
+	void RadixSort(std::vector<SortEntry>& entries);
+};
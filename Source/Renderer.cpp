@@ -16,12 +16,15 @@
 #include "BSP.h"
 #include "Debug.h"
 #include "Camera.h"
+#include "GLState.h"
 #include "Matrix4.h"
 #include "MeshRenderer.h"
 #include "Model.h"
+#include "RenderQueue.h"
 #include "RenderTransforms.h"
 #include "Shader.h"
 #include "Skybox.h"
+#include "Submesh.h"
 #include "Texture.h"
 #include "UICanvas.h"
 
@@ -94,22 +97,6 @@ float full_quad_uvs[] = {
 
 Mesh* fullQuad = nullptr;
 
-float ui_quad_vertices[] = {
-	0.0f,  1.0f, 0.0f, // upper-left
-	1.0f,  1.0f, 0.0f, // upper-right
-	1.0f,  0.0f, 0.0f, // lower-right
-	0.0f,  0.0f, 0.0f, // lower-left
-};
-
-float ui_quad_uvs[] = {
-	0.0f, 0.0f,		// upper-left
-	1.0f, 0.0f,		// upper-right
-	1.0f, 1.0f,		// lower-right
-	0.0f, 1.0f		// lower-left
-};
-
-Mesh* uiQuad = nullptr;
-
 bool Renderer::Initialize()
 {
     // Init video subsystem.
@@ -163,6 +150,9 @@ bool Renderer::Initialize()
     // Clear any GLEW error.
     glGetError();
     
+    // New GL context, so any remembered GL state is meaningless.
+    mGLState.Invalidate();
+    
     // Our clear color will be BLACK!
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     
@@ -182,6 +172,10 @@ bool Renderer::Initialize()
 	if(defaultShader == nullptr) { return false; }
 	Material::sDefaultShader = defaultShader;
 	
+    // Load instanced variant of default shader. If it isn't available, meshes are drawn one at a time.
+    mInstancedShader = Services::GetAssets()->LoadShader("3D-Diffuse-Tex-Instanced", "3D-Diffuse-Tex");
+    glGenBuffers(1, &mInstanceBuffer);
+    
     // Load skybox shader and create material.
     Shader* skyboxShader = Services::GetAssets()->LoadShader("3D-Skybox");
     if(skyboxShader == nullptr) { return false; }
@@ -237,15 +231,6 @@ bool Renderer::Initialize()
 	fullQuad = new Mesh();
     Submesh* fullQuadSubmesh = fullQuad->AddSubmesh(meshDefinition);
 	fullQuadSubmesh->SetRenderMode(RenderMode::Triangles);
-	
-    // And a quad for UI usage...
-    meshDefinition.vertexCount = 4;
-    vertexData[0] = ui_quad_vertices;
-    vertexData[1] = ui_quad_uvs;
-    
-	uiQuad = new Mesh();
-    Submesh* uiQuadSubmesh = uiQuad->AddSubmesh(meshDefinition);
-	uiQuadSubmesh->SetRenderMode(RenderMode::Triangles);
     
     // Init succeeded!
     return true;
@@ -253,6 +238,8 @@ bool Renderer::Initialize()
 
 void Renderer::Shutdown()
 {
+    mGLState.OnBufferDeleted(mInstanceBuffer);
+    glDeleteBuffers(1, &mInstanceBuffer);
     SDL_GL_DeleteContext(mContext);
     SDL_DestroyWindow(mWindow);
     SDL_QuitSubSystem(SDL_INIT_VIDEO);
@@ -262,9 +249,9 @@ void Renderer::Render()
 {
 	// Enable opaque rendering (no blend, write to & test depth buffer).
 	// Do this BEFORE clear to avoid some glitchy graphics.
-	glDisable(GL_BLEND); // do not perform alpha blending (opaque rendering)
-	glDepthMask(GL_TRUE); // start writing to depth buffer
-	glEnable(GL_DEPTH_TEST); // do depth comparisons and update the depth buffer
+	mGLState.SetBlendEnabled(false); // do not perform alpha blending (opaque rendering)
+	mGLState.SetDepthWriteEnabled(true); // start writing to depth buffer
+	mGLState.SetDepthTestEnabled(true); // do depth comparisons and update the depth buffer
 	
 	// Clear color and depth buffers from last frame.
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -281,7 +268,7 @@ void Renderer::Render()
         // SKYBOX RENDERING
         // Draw the skybox first, which is just a little cube around the camera.
         // Don't write to depth mask, or else you can ONLY see skybox (b/c again, little cube).
-        glDepthMask(GL_FALSE); // stops writing to depth buffer
+        mGLState.SetDepthWriteEnabled(false); // stops writing to depth buffer
         if(mSkybox != nullptr)
         {
             // To get the "infinite distance" skybox effect, we need to use a look-at
@@ -290,7 +277,7 @@ void Renderer::Render()
             Material::SetProjMatrix(projectionMatrix);
             mSkybox->Render();
         }
-        glDepthMask(GL_TRUE); // start writing to depth buffer
+        mGLState.SetDepthWriteEnabled(true); // start writing to depth buffer
         
         // OPAQUE WORLD RENDERING
         // All opaque world rendering uses alpha test.
@@ -307,29 +294,46 @@ void Renderer::Render()
             mBSP->RenderOpaque(mCamera->GetOwner()->GetPosition(), mCamera->GetOwner()->GetForward());
         }
         
-        // OPAQUE MESH RENDERING
-        // Render opaque meshes (no particular order).
-        // Sorting is probably not worthwhile b/c BSP likely mostly filled the z-buffer at this point.
-        // And with the z-buffer, we can render opaque meshed correctly regardless of order.
+        // Gather all mesh draws for this frame and sort them.
+        Vector3 cameraPosition = mCamera->GetOwner()->GetPosition();
+        Vector3 cameraForward = mCamera->GetOwner()->GetForward();
+        mRenderQueue.Clear();
         for(auto& meshRenderer : mMeshRenderers)
         {
-            meshRenderer->RenderOpaque();
+            meshRenderer->AddToRenderQueue(mRenderQueue, cameraPosition, cameraForward);
         }
+        mRenderQueue.Sort();
+        
+        // OPAQUE MESH RENDERING
+        // Opaque meshes are sorted by shader/texture/mesh, to minimize state changes between draws.
+        // With the z-buffer, we can render opaque meshes correctly regardless of order.
+        RenderOpaqueMeshes();
         
         // Turn off alpha test.
         Material::UseAlphaTest(false);
         
         // TRANSLUCENT WORLD RENDERING
         // So far, GK3 doesn't seem to have any translucent geometry AT ALL!
-        // Everything is either opaque or alpha test.
-        // If we DO need translucent rendering, it probably can only be meshes or BSP, but not both.
-        //TODO: Any translucent world rendering.
+        // Everything is either opaque or alpha test. But meshes can be faded out by giving them a translucent color.
+        // Translucent meshes are drawn back to front, blended, and without writing depth (so they don't hide each other).
+        if(mRenderQueue.GetTranslucentCount() > 0)
+        {
+            mGLState.SetBlendEnabled(true);
+            mGLState.SetDepthWriteEnabled(false);
+            for(int i = 0; i < mRenderQueue.GetTranslucentCount(); ++i)
+            {
+                const RenderQueueItem& item = mRenderQueue.GetTranslucent(i);
+                item.meshRenderer->Render(item);
+            }
+            mGLState.SetBlendEnabled(false);
+            mGLState.SetDepthWriteEnabled(true);
+        }
     }
     
     // UI RENDERING (TRANSLUCENT)
-    glEnable(GL_BLEND); // do alpha blending
-    glDepthMask(GL_FALSE); // don't write to the depth buffer
-    glDisable(GL_DEPTH_TEST); // no depth test b/c UI draws over everything
+    mGLState.SetBlendEnabled(true); // do alpha blending
+    mGLState.SetDepthWriteEnabled(false); // don't write to the depth buffer
+    mGLState.SetDepthTestEnabled(false); // no depth test b/c UI draws over everything
     
     // UI uses a view/proj setup for now - world space for UI maps to pixel size of screen.
     // Bottom-left corner of screen is origin, +x is right, +y is up.
@@ -348,7 +352,7 @@ void Renderer::Render()
     // Switch back to opaque rendering for debug rendering.
     // Debug rendering happens after all else, so any previous function can ask for debug draws successfully.
     // Also, don't bother with depth write or depth test so debug lines aren't obfuscated!
-    glDisable(GL_BLEND); // do not perform alpha blending
+    mGLState.SetBlendEnabled(false); // do not perform alpha blending
     
     // Gotta reset view/proj again...
     Material::SetViewMatrix(viewMatrix);
@@ -363,6 +367,9 @@ void Renderer::Render()
     
 	// Present to window.
 	SDL_GL_SwapWindow(mWindow);
+	
+	// Save this frame's bind counts (see GLState).
+	mGLState.EndFrame();
 }
 
 void Renderer::AddMeshRenderer(MeshRenderer* mr)
@@ -387,3 +394,41 @@ void Renderer::SetSkybox(Skybox* skybox)
 		mSkybox->SetMaterial(mSkyboxMaterial);
 	}
 }
+
+void Renderer::RenderOpaqueMeshes()
+{
+    // Copy the transforms of every instanced group into the instance buffer, all at once.
+    // Without an instanced shader, nothing is instanced.
+    mInstanceTransforms.clear();
+    if(mInstancedShader != nullptr)
+    {
+        mRenderQueue.BuildInstanceTransforms(mInstanceTransforms);
+    }
+    if(!mInstanceTransforms.empty())
+    {
+        // A new buffer store each frame, so this doesn't wait on last frame's draws.
+        mGLState.BindArrayBuffer(mInstanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, mInstanceTransforms.size() * sizeof(Matrix4), &mInstanceTransforms[0], GL_STREAM_DRAW);
+    }
+    
+    // Draw each group, either as one instanced draw or item by item.
+    for(int i = 0; i < mRenderQueue.GetInstanceGroupCount(); ++i)
+    {
+        const RenderQueue::InstanceGroup& group = mRenderQueue.GetInstanceGroup(i);
+        if(mInstancedShader != nullptr && group.firstInstance >= 0)
+        {
+            // All items in the group look the same, so the first one's material works for all of them.
+            const RenderQueueItem& item = mRenderQueue.GetOpaque(group.first);
+            item.material->Activate(Matrix4::Identity, mInstancedShader);
+            item.submesh->RenderInstanced(mInstanceBuffer, group.firstInstance, group.count);
+        }
+        else
+        {
+            for(int j = 0; j < group.count; ++j)
+            {
+                const RenderQueueItem& item = mRenderQueue.GetOpaque(group.first + j);
+                item.meshRenderer->Render(item);
+            }
+        }
+    }
+}
@@ -11,8 +11,10 @@
 #include <SDL2/SDL.h>
 #include <GL/glew.h>
 
+#include "GLState.h"
 #include "Material.h"
 #include "Matrix4.h"
+#include "RenderQueue.h"
 #include "Vector2.h"
 
 class BSP;
@@ -44,6 +46,9 @@ public:
 	int GetWindowHeight() { return mScreenHeight; }
 	
 	Vector2 GetWindowSize() { return Vector2(static_cast<float>(mScreenWidth), static_cast<float>(mScreenHeight)); }
+	
+	// Tracks bound GL objects and enabled states, to skip redundant GL calls.
+	GLState& GetGLState() { return mGLState; }
     
 private:
     // Screen's width and height, in pixels.
@@ -56,11 +61,25 @@ private:
     // Context handle for rendering in OpenGL.
     SDL_GLContext mContext;
     
+    // Remembers GL state set for the context, so setting it again can be skipped.
+    GLState mGLState;
+    
     // Our camera in the scene - we currently only support one.
     Camera* mCamera = nullptr;
     
     // List of mesh components to render.
     std::vector<MeshRenderer*> mMeshRenderers;
+    
+    // Mesh draws for the current frame, sorted for drawing.
+    RenderQueue mRenderQueue;
+    
+    // For drawing groups of identical submeshes with one instanced draw: the instanced variant of the default shader,
+    // and a buffer with the object to world matrix of each instance drawn this frame.
+    Shader* mInstancedShader = nullptr;
+    GLuint mInstanceBuffer = GL_NONE;
+    std::vector<Matrix4> mInstanceTransforms;
+    
+    void RenderOpaqueMeshes();
 	
     // A BSP to render.
     BSP* mBSP = nullptr;
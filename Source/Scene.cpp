@@ -14,6 +14,7 @@
 #include "CharacterManager.h"
 #include "Collisions.h"
 #include "Color32.h"
+#include "ConditionCache.h"
 #include "Debug.h"
 #include "GameCamera.h"
 #include "GameProgress.h"
@@ -67,6 +68,9 @@ void Scene::Load()
 		return;
 	}
 	
+	// This scene has no ego until we determine it below, so anything cached for the previous ego is stale.
+	ConditionCache::Changed(ConditionInput::Ego);
+	
 	// Creating scene data loads SIFs, but does nothing else yet!
 	mSceneData = new SceneData(mLocation, mTimeblock.ToString());
 	
@@ -81,6 +85,7 @@ void Scene::Load()
 	else
 	{
 		mEgoName = egoSceneActor->noun;
+		ConditionCache::Changed(ConditionInput::Ego);
 	}
 	
 	// Set location.
@@ -174,7 +174,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         {
 			// Why is this called "Int Evaluation"? Not sure - but testing in GK3 seems to suggest it is...
 			general.conditionText = section.condition;
-			general.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			general.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Handle all key/value pairs in this block.
@@ -289,7 +289,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			cameraBlock.conditionText = section.condition;
-			cameraBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			cameraBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Handle creation of each camera in this block.
@@ -329,7 +329,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			cameraBlock.conditionText = section.condition;
-			cameraBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			cameraBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Handle creation of each camera in this block.
@@ -377,7 +377,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			cameraBlock.conditionText = section.condition;
-			cameraBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			cameraBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Handle creation of each camera in this block.
@@ -419,7 +419,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			cameraBlock.conditionText = section.condition;
-			cameraBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			cameraBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each camera in this block.
@@ -478,7 +478,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			positionBlock.conditionText = section.condition;
-			positionBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			positionBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each scene position.
@@ -522,7 +522,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			actorBlock.conditionText = section.condition;
-			actorBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+			actorBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each actor defined in the block.
@@ -599,7 +599,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			modelBlock.conditionText = section.condition;
-            modelBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+            modelBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each model defined in block.
@@ -678,7 +678,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			regionBlock.conditionText = section.condition;
-            regionBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+            regionBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each region.
@@ -713,7 +713,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			triggerBlock.conditionText = section.condition;
-            triggerBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+            triggerBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Create each trigger defined.
@@ -746,7 +746,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			soundtrackBlock.conditionText = section.condition;
-            soundtrackBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+            soundtrackBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
 		// Add soundtracks.
@@ -770,7 +770,7 @@ void SceneInitFile::ParseFromData(char *data, int dataLength)
         if(!section.condition.empty())
         {
 			actionBlock.conditionText = section.condition;
-            actionBlock.condition = Services::GetSheep()->Compile("Int Evaluation", section.condition);
+            actionBlock.condition = Services::GetSheep()->CompileCached("Int Evaluation", section.condition);
         }
         
         for(auto& line : section.lines)
@@ -5,12 +5,15 @@
 //
 #include "Shader.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
 #include "Color32.h"
+#include "GLState.h"
 #include "Matrix4.h"
+#include "UniformBuffer.h"
 #include "Vector3.h"
 #include "VertexDefinition.h"
 
@@ -57,15 +60,16 @@ Shader::Shader(const char* vertShaderPath, const char* fragShaderPath)
     glDetachShader(mProgram, fragmentShader);
     
     // After shader program is compiled and linked, it's possible to query the program
-    // to determine the uniforms that exist in the program.
-    
-    // This *may* be useful in the future so that a material knows what uniforms exist.
-    // But for now, we are assuming that the material has explicitly defined values for all uniforms.
-    //RefreshUniforms();
+    // to determine the uniforms that exist in the program. Save them, so setting uniforms doesn't need to ask GL.
+    RefreshUniforms();
 }
 
 Shader::~Shader()
 {
+    if(GLState::Instance() != nullptr)
+    {
+        GLState::Instance()->OnProgramDeleted(mProgram);
+    }
     glDeleteProgram(mProgram);
 }
 
@@ -73,62 +77,84 @@ void Shader::Activate()
 {
     if(mProgram != GL_NONE)
     {
-        glUseProgram(mProgram);
+        GLState::Instance()->UseProgram(mProgram);
+        
+        // Send any values that were set while this shader wasn't active.
+        if(mNeedsUpload)
+        {
+            for(Uniform& uniform : mUniforms)
+            {
+                if(uniform.needsUpload)
+                {
+                    UploadUniform(uniform);
+                }
+            }
+            mNeedsUpload = false;
+        }
     }
 }
 
-void Shader::SetUniformInt(const char* name, int value)
+UniformHandle Shader::GetUniformHandle(const char* name) const
 {
-    if(mProgram != GL_NONE)
+    // Shaders only have a handful of uniforms, so a linear search is fast enough (and doesn't allocate).
+    UniformHandle handle;
+    for(int i = 0; i < mUniforms.size(); ++i)
     {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniform1i(loc, value);
+        if(strcmp(mUniforms[i].name.c_str(), name) == 0)
+        {
+            handle.index = i;
+            break;
+        }
     }
+    return handle;
 }
 
-void Shader::SetUniformFloat(const char* name, float value)
+void Shader::SetUniformInt(UniformHandle handle, int value)
 {
-    if(mProgram != GL_NONE)
+    if(!handle.IsValid()) { return; }
+    Uniform& uniform = mUniforms[handle.index];
+    
+    // Ints are used for int/bool uniforms, as well as for the texture unit of sampler uniforms.
+    if(uniform.type != UniformType::Int && uniform.type != UniformType::Bool &&
+       uniform.type != UniformType::Texture2D && uniform.type != UniformType::TextureCube &&
+       uniform.type != UniformType::TextureBuffer)
     {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniform1f(loc, value);
+        return;
     }
+    
+    // Skip if value is unchanged.
+    if(uniform.hasValue && uniform.intValue == value) { return; }
+    uniform.hasValue = true;
+    uniform.intValue = value;
+    UploadUniform(uniform);
 }
 
-void Shader::SetUniformVector3(const char* name, const Vector3& vector)
+void Shader::SetUniformFloat(UniformHandle handle, float value)
 {
-    if(mProgram != GL_NONE)
-    {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform3f(vecLoc, vector.x, vector.y, vector.z);
-    }
+    SetUniformFloats(handle, UniformType::Float, &value, 1);
 }
 
-void Shader::SetUniformVector4(const char *name, const Vector4& vector)
+void Shader::SetUniformVector3(UniformHandle handle, const Vector3& vector)
 {
-    if(mProgram != GL_NONE)
-    {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform4f(vecLoc, vector.x, vector.y, vector.z, vector.w);
-    }
+    GLfloat values[3] = { vector.x, vector.y, vector.z };
+    SetUniformFloats(handle, UniformType::Vector3, values, 3);
 }
 
-void Shader::SetUniformMatrix4(const char* name, const Matrix4& mat)
+void Shader::SetUniformVector4(UniformHandle handle, const Vector4& vector)
 {
-    if(mProgram != GL_NONE)
-    {
-        GLuint loc = glGetUniformLocation(mProgram, name);
-        glUniformMatrix4fv(loc, 1, GL_FALSE, mat);
-    }
+    GLfloat values[4] = { vector.x, vector.y, vector.z, vector.w };
+    SetUniformFloats(handle, UniformType::Vector4, values, 4);
 }
 
-void Shader::SetUniformColor(const char* name, const Color32& color)
+void Shader::SetUniformMatrix4(UniformHandle handle, const Matrix4& mat)
 {
-    if(mProgram != GL_NONE)
-    {
-        GLuint vecLoc = glGetUniformLocation(mProgram, name);
-        glUniform4f(vecLoc, color.GetR() / 255.0f, color.GetG() / 255.0f, color.GetB() / 255.0f, color.GetA() / 255.0f);
-    }
+    SetUniformFloats(handle, UniformType::Matrix4, mat, 16);
+}
+
+void Shader::SetUniformColor(UniformHandle handle, const Color32& color)
+{
+    GLfloat values[4] = { color.GetR() / 255.0f, color.GetG() / 255.0f, color.GetB() / 255.0f, color.GetA() / 255.0f };
+    SetUniformFloats(handle, UniformType::Vector4, values, 4);
 }
 
 GLuint Shader::LoadAndCompileShaderFromFile(const char* filePath, GLuint shaderType)
@@ -147,6 +173,15 @@ GLuint Shader::LoadAndCompileShaderFromFile(const char* filePath, GLuint shaderT
     std::stringstream buffer;
     buffer << file.rdbuf();
     std::string fileContentsStr = buffer.str();
+    
+    // Let the shader know whether it can use uniform blocks, or must fall back to plain uniforms.
+    // The "#version" directive must come first, so the define goes on the line after it.
+    if(UniformBuffer::IsSupported())
+    {
+        std::size_t versionEnd = fileContentsStr.find('\n');
+        std::size_t insertPos = (fileContentsStr.compare(0, 8, "#version") == 0 && versionEnd != std::string::npos) ? versionEnd + 1 : 0;
+        fileContentsStr.insert(insertPos, "#define USE_UNIFORM_BUFFERS\n");
+    }
     const char* fileContents = fileContentsStr.c_str();
     
     // Create shader, load file contents into it, and compile it.
@@ -204,32 +239,34 @@ bool Shader::IsProgramLinked(GLuint program)
     return true;
 }
 
-/*
 void Shader::RefreshUniforms()
 {
-    // Save listing of uniforms used by this shader.
-    const GLsizei kMaxUniformNameLength = 32;
-    GLchar uniformNameBuffer[kMaxUniformNameLength];
+    mUniforms.clear();
+    mBuiltInUniforms = BuiltInUniformHandles();
+    if(mProgram == GL_NONE) { return; }
+    
+    // Allocate a buffer big enough for the longest uniform name.
+    GLint maxNameLength = 0;
+    glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<GLchar> uniformNameBuffer(maxNameLength + 1);
+    
     GLsizei uniformNameLength = 0;
-    GLsizei uniformSize = 0;
+    GLint uniformSize = 0;
     GLenum uniformType = GL_NONE;
     
     GLint uniformCount = 0;
     glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, &uniformCount);
-    for(GLuint i = 0; i < uniformCount; ++i)
+    mUniforms.reserve(uniformCount);
+    for(GLint i = 0; i < uniformCount; ++i)
     {
-        glGetActiveUniform(mProgram, i, kMaxUniformNameLength, &uniformNameLength, &uniformSize, &uniformType, uniformNameBuffer);
+        glGetActiveUniform(mProgram, i, static_cast<GLsizei>(uniformNameBuffer.size()), &uniformNameLength, &uniformSize, &uniformType, uniformNameBuffer.data());
         
         // If returned name length is 0, that means the uniform is not valid (compile/link failed?).
         if(uniformNameLength <= 0) { continue; }
         
-        // We only want to track user-defined uniforms.
-        // We want to ignore built-in OpenGL uniforms, which have "gl_" prefix.
-        // We want to ignore built-in G-Engine uniforms, which have a "g" prefix.
-        // So really, we can just ignore any uniform with a "g" prefix to cover both scenarios!
-        if(uniformNameLength > 0 && uniformNameBuffer[0] == 'g') { continue; }
-        printf("Uniform %d, Type %u, Name %s\n", i, uniformType, uniformNameBuffer);
-           
+        // Ignore built-in OpenGL uniforms, which have a "gl_" prefix. They can't be set anyway.
+        if(strncmp(uniformNameBuffer.data(), "gl_", 3) == 0) { continue; }
+        
         // Convert GLenum type to an actual enum type.
         UniformType type = UniformType::Unknown;
         switch(uniformType)
@@ -273,6 +310,9 @@ void Shader::RefreshUniforms()
         case GL_SAMPLER_CUBE:
             type = UniformType::TextureCube;
             break;
+        case GL_SAMPLER_BUFFER:
+            type = UniformType::TextureBuffer;
+            break;
             
         default:
             std::cout << "Unknown uniform type in shader: " << uniformType << std::endl;
@@ -284,9 +324,92 @@ void Shader::RefreshUniforms()
         {
             Uniform uniform;
             uniform.type = type;
-            uniform.name = std::string(uniformNameBuffer);
-            mUniforms.push_back(uniform);
+            uniform.name = std::string(uniformNameBuffer.data(), uniformNameLength);
+            
+            // Arrays are reported as "name[0]", but are usually referred to by just "name".
+            if(uniform.name.size() > 3 && uniform.name.compare(uniform.name.size() - 3, 3, "[0]") == 0)
+            {
+                uniform.name.resize(uniform.name.size() - 3);
+            }
+            uniform.location = glGetUniformLocation(mProgram, uniformNameBuffer.data());
+            
+            // Uniforms in a block have no location - they are set with a uniform buffer instead.
+            if(uniform.location >= 0)
+            {
+                mUniforms.push_back(uniform);
+            }
         }
     }
+    
+    // Look up built-in uniforms now, so they don't need to be found by name on every draw.
+    mBuiltInUniforms.objectToWorldMatrix = GetUniformHandle("gObjectToWorldMatrix");
+    mBuiltInUniforms.viewMatrix = GetUniformHandle("gViewMatrix");
+    mBuiltInUniforms.projMatrix = GetUniformHandle("gProjMatrix");
+    mBuiltInUniforms.worldToProjMatrix = GetUniformHandle("gWorldToProjMatrix");
+    mBuiltInUniforms.alphaTest = GetUniformHandle("gAlphaTest");
+    
+    // Connect any shared uniform blocks to their binding points.
+    mHasFrameBlock = BindUniformBlock(UniformBuffer::kFrameBlockName, UniformBuffer::kFrameBlockBinding);
+    mHasMaterialBlock = BindUniformBlock(UniformBuffer::kMaterialBlockName, UniformBuffer::kMaterialBlockBinding);
+}
+
+bool Shader::BindUniformBlock(const char* blockName, GLuint bindingPoint)
+{
+    if(!UniformBuffer::IsSupported()) { return false; }
+    
+    GLuint blockIndex = glGetUniformBlockIndex(mProgram, blockName);
+    if(blockIndex == GL_INVALID_INDEX) { return false; }
+    
+    glUniformBlockBinding(mProgram, blockIndex, bindingPoint);
+    return true;
+}
+
+void Shader::SetUniformFloats(UniformHandle handle, UniformType type, const GLfloat* values, int count)
+{
+    if(!handle.IsValid()) { return; }
+    Uniform& uniform = mUniforms[handle.index];
+    if(uniform.type != type) { return; }
+    
+    // Skip if value is unchanged.
+    if(uniform.hasValue && memcmp(uniform.floatValues, values, count * sizeof(GLfloat)) == 0) { return; }
+    uniform.hasValue = true;
+    memcpy(uniform.floatValues, values, count * sizeof(GLfloat));
+    UploadUniform(uniform);
+}
+
+void Shader::UploadUniform(Uniform& uniform)
+{
+    // GL sets uniforms on the program in use. If that isn't this one, wait until this shader is activated.
+    if(GLState::Instance()->GetProgram() != mProgram)
+    {
+        uniform.needsUpload = true;
+        mNeedsUpload = true;
+        return;
+    }
+    uniform.needsUpload = false;
+    
+    switch(uniform.type)
+    {
+    case UniformType::Int:
+    case UniformType::Bool:
+    case UniformType::Texture2D:
+    case UniformType::TextureCube:
+    case UniformType::TextureBuffer:
+        glUniform1i(uniform.location, uniform.intValue);
+        break;
+    case UniformType::Float:
+        glUniform1f(uniform.location, uniform.floatValues[0]);
+        break;
+    case UniformType::Vector3:
+        glUniform3fv(uniform.location, 1, uniform.floatValues);
+        break;
+    case UniformType::Vector4:
+        glUniform4fv(uniform.location, 1, uniform.floatValues);
+        break;
+    case UniformType::Matrix4:
+        glUniformMatrix4fv(uniform.location, 1, GL_FALSE, uniform.floatValues);
+        break;
+    default:
+        break;
+    }
 }
-*/
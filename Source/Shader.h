@@ -34,7 +34,8 @@ enum class UniformType
     Matrix4,
     
     Texture2D,
-    TextureCube
+    TextureCube,
+    TextureBuffer
     //TODO: Add more as needed
 };
 
@@ -43,8 +44,39 @@ struct Uniform
     // Type of the uniform.
     UniformType type = UniformType::Unknown;
     
-    // Uniform name.
+    // Uniform name. For arrays, this is the name without the "[0]" suffix.
     std::string name;
+    
+    // Location of the uniform in the shader program.
+    GLint location = -1;
+    
+    // The last value given to GL for this uniform. If the same value is set again, the GL call is skipped.
+    // Int/bool/texture uniforms use "intValue"; all others use "floatValues" (16 is enough for a 4x4 matrix).
+    bool hasValue = false;
+    bool needsUpload = false;
+    GLint intValue = 0;
+    GLfloat floatValues[16];
+};
+
+// A uniform in a specific shader, looked up once by name.
+// Setting a uniform by handle avoids the name lookup; an invalid handle (uniform not in the shader) is ignored.
+struct UniformHandle
+{
+    int index = -1;
+    
+    bool IsValid() const { return index >= 0; }
+};
+
+// Handles for the built-in uniforms Material sets on every draw.
+struct BuiltInUniformHandles
+{
+    UniformHandle objectToWorldMatrix;
+    
+    // Only used by shaders without the frame block (see UniformBuffer).
+    UniformHandle viewMatrix;
+    UniformHandle projMatrix;
+    UniformHandle worldToProjMatrix;
+    UniformHandle alphaTest;
 };
 
 class Shader
@@ -55,24 +87,61 @@ public:
     
     void Activate();
     
-	void SetUniformInt(const char* name, int value);
-	void SetUniformFloat(const char* name, float value);
+    // Finds a uniform by name. The handle is invalid if the shader has no such (active) uniform.
+    UniformHandle GetUniformHandle(const char* name) const;
+    const std::vector<Uniform>& GetUniforms() const { return mUniforms; }
+    
+    // Handles for the built-in uniforms, looked up once when the program is linked.
+    const BuiltInUniformHandles& GetBuiltInUniforms() const { return mBuiltInUniforms; }
+    
+    // Setting by name looks the uniform up in the uniform table; setting by handle skips that.
+    // The shader doesn't need to be active: if it isn't, the value is sent to GL the next time it is activated.
+	void SetUniformInt(const char* name, int value) { SetUniformInt(GetUniformHandle(name), value); }
+	void SetUniformInt(UniformHandle handle, int value);
+    
+	void SetUniformFloat(const char* name, float value) { SetUniformFloat(GetUniformHandle(name), value); }
+	void SetUniformFloat(UniformHandle handle, float value);
 	
-    void SetUniformVector3(const char* name, const Vector3& vector);
-	void SetUniformVector4(const char* name, const Vector4& vector);
+    void SetUniformVector3(const char* name, const Vector3& vector) { SetUniformVector3(GetUniformHandle(name), vector); }
+    void SetUniformVector3(UniformHandle handle, const Vector3& vector);
     
-    void SetUniformMatrix4(const char* name, const Matrix4& mat);
+	void SetUniformVector4(const char* name, const Vector4& vector) { SetUniformVector4(GetUniformHandle(name), vector); }
+	void SetUniformVector4(UniformHandle handle, const Vector4& vector);
     
-    void SetUniformColor(const char* name, const Color32& color);
+    void SetUniformMatrix4(const char* name, const Matrix4& mat) { SetUniformMatrix4(GetUniformHandle(name), mat); }
+    void SetUniformMatrix4(UniformHandle handle, const Matrix4& mat);
+    
+    void SetUniformColor(const char* name, const Color32& color) { SetUniformColor(GetUniformHandle(name), color); }
+    void SetUniformColor(UniformHandle handle, const Color32& color);
     
     bool IsGood() const { return mProgram != GL_NONE; }
     
+    // Whether the shader reads from the shared uniform blocks (see UniformBuffer).
+    // If not, the same values must be set as plain uniforms.
+    bool HasFrameBlock() const { return mHasFrameBlock; }
+    bool HasMaterialBlock() const { return mHasMaterialBlock; }
+    
 private:
     // Handle to the compiled and linked GL shader program.
     GLuint mProgram = GL_NONE;
     
-    // Uniforms for this shader, excluding "built-in" ones.
-    //std::vector<Uniform> mUniforms;
+    // All active uniforms in this shader, found when the program is linked.
+    // Also holds the last value set for each, so unchanged values don't need to be sent to GL again.
+    std::vector<Uniform> mUniforms;
+    BuiltInUniformHandles mBuiltInUniforms;
+    
+    // True if any uniform value was set while this shader wasn't active.
+    bool mNeedsUpload = false;
+    
+    // Whether the shader uses the shared uniform blocks.
+    bool mHasFrameBlock = false;
+    bool mHasMaterialBlock = false;
+    
+    void RefreshUniforms();
+    bool BindUniformBlock(const char* blockName, GLuint bindingPoint);
+    
+    void SetUniformFloats(UniformHandle handle, UniformType type, const GLfloat* values, int count);
+    void UploadUniform(Uniform& uniform);
     
     GLuint LoadAndCompileShaderFromFile(const char* filePath, GLuint shaderType);
     
@@ -11,6 +11,7 @@
 #include "Animator.h"
 #include "Camera.h"
 #include "CharacterManager.h"
+#include "ConditionCache.h"
 #include "DialogueManager.h"
 #include "FaceController.h"
 #include "GameCamera.h"
@@ -64,8 +65,8 @@ size_t CalcHashForSysFunc(const SysImport& sysImport)
 }
 
 // A list of every defined system function. Add to this by calling AddSysFuncDecl.
-// Functions are added by using RegFuncX macros, which in turn call AddSysFuncDecl and put function pointers into call maps.
-void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list<char> argTypes, bool waitable, bool dev)
+// Functions are added by using RegFuncX macros, which in turn call AddSysFuncDecl with a pointer to the function to call.
+void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list<char> argTypes, bool waitable, bool dev, SysFuncPtr function)
 {
 	SysFuncDecl sysFunc;
 	sysFunc.name = name;
@@ -76,6 +77,7 @@ void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list
 	}
 	sysFunc.waitable = waitable;
 	sysFunc.devOnly = dev;
+	sysFunc.function = function;
 	
 	sysFuncs.push_back(sysFunc);
 	
@@ -106,124 +108,14 @@ SysFuncDecl* GetSysFuncDecl(const SysImport* sysImport)
 	return nullptr;
 }
 
-// Maps from function name to a function pointer.
-// Each map is for a different number of arguments (0-8).
-std::map<std::string, Value (*)(const Value&)> map0;
-std::map<std::string, Value (*)(const Value&)> map1;
-std::map<std::string, Value (*)(const Value&, const Value&)> map2;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&)> map3;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&,
-                                const Value&)> map4;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&,
-                                const Value&, const Value&)> map5;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&,
-                                const Value&, const Value&, const Value&)> map6;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&,
-                                const Value&, const Value&, const Value&,
-                                const Value&)> map7;
-std::map<std::string, Value (*)(const Value&, const Value&, const Value&,
-                                const Value&, const Value&, const Value&,
-                                const Value&, const Value&)> map8;
-
-Value CallSysFunc(const std::string& name)
-{
-	auto it = map0.find(name);
-	if(it != map0.end())
-	{
-		return it->second(0);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc0 " << name << std::endl;
-		return Value(0);
-	}
-}
-
-Value CallSysFunc(const std::string& name, const Value& x1)
-{
-	auto it = map1.find(name);
-	if(it != map1.end())
-	{
-		return it->second(x1);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc1 " << name << std::endl;
-		return Value(0);
-	}
-}
-
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2)
-{
-	auto it = map2.find(name);
-	if(it != map2.end())
-	{
-		return it->second(x1, x2);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc2 " << name << std::endl;
-		return Value(0);
-	}
-}
+// Strings returned from system functions only need to last until the VM copies them (which it does right after the call).
+// So, only the latest one is kept. Reusing the same string means returning a string usually doesn't allocate.
+std::string sysFuncReturnString;
 
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3)
+const char* StoreSysFuncString(const std::string& str)
 {
-	auto it = map3.find(name);
-	if(it != map3.end())
-	{
-		return it->second(x1, x2, x3);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc3 " << name << std::endl;
-		return Value(0);
-	}
-}
-
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3,
-                  const Value& x4)
-{
-	auto it = map4.find(name);
-	if(it != map4.end())
-	{
-		return it->second(x1, x2, x3, x4);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc4 " << name << std::endl;
-		return Value(0);
-	}
-}
-
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3,
-                  const Value& x4, const Value& x5)
-{
-	auto it = map5.find(name);
-	if(it != map5.end())
-	{
-		return it->second(x1, x2, x3, x4, x5);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc5 " << name << std::endl;
-		return Value(0);
-	}
-}
-
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3,
-                  const Value& x4, const Value& x5, const Value& x6)
-{
-	auto it = map6.find(name);
-	if(it != map6.end())
-	{
-		return it->second(x1, x2, x3, x4, x5, x6);
-	}
-	else
-	{
-		std::cout << "Couldn't find SysFunc6 " << name << std::endl;
-		return Value(0);
-	}
+	sysFuncReturnString = str;
+	return sysFuncReturnString.c_str();
 }
 
 // Helper for reporting back to Sheep VM that an error occurred.
@@ -377,6 +269,7 @@ RegFunc1(GetEgoLocationCount, int, string, IMMEDIATE, REL_FUNC);
 
 std::string GetEgoName()
 {
+	ConditionCache::Read(ConditionInput::Ego);
 	return GEngine::Instance()->GetScene()->GetEgoName();
 }
 RegFunc0(GetEgoName, string, IMMEDIATE, REL_FUNC);
@@ -511,6 +404,7 @@ RegFunc1(IsActorOffstage, int, string, IMMEDIATE, REL_FUNC);
 
 int IsCurrentEgo(string actorName)
 {
+	ConditionCache::Read(ConditionInput::Ego);
 	const std::string& egoName = GEngine::Instance()->GetScene()->GetEgoName();
 	return StringUtil::EqualsIgnoreCase(egoName, actorName) ? 1 : 0;
 }
@@ -1517,6 +1411,30 @@ RegFunc2(Extract, void, string, string, IMMEDIATE, REL_FUNC);
 //DumpRawSheep
 //DumpSheepEngine
 
+shpvoid EnableSheepProfiler()
+{
+	// Starts a new profile; any previous results are thrown away.
+	Services::GetSheep()->GetProfiler().SetEnabled(true);
+	return 0;
+}
+RegFunc0(EnableSheepProfiler, void, IMMEDIATE, DEV_FUNC);
+
+shpvoid DisableSheepProfiler()
+{
+	// Results are kept, so they can still be dumped.
+	Services::GetSheep()->GetProfiler().SetEnabled(false);
+	return 0;
+}
+RegFunc0(DisableSheepProfiler, void, IMMEDIATE, DEV_FUNC);
+
+shpvoid DumpSheepProfile(std::string fileName)
+{
+	// Writes "fileName.csv" (totals) and "fileName.json" (Chrome trace).
+	Services::GetSheep()->GetProfiler().Dump(fileName.empty() ? "SheepProfile" : fileName);
+	return 0;
+}
+RegFunc1(DumpSheepProfile, void, string, IMMEDIATE, DEV_FUNC);
+
 //ExecCommand
 //FindCommand
 //HelpCommand
@@ -1626,11 +1544,12 @@ RegFunc1(SetTimerSeconds, void, float, WAITABLE, REL_FUNC);
 //DumpCaseLogic
 //ResetCaseLogic
 
-int GetFlag(std::string flagName)
+int GetFlag(Atom flagName)
 {
+	ConditionCache::Read(ConditionInput::Flag, flagName);
 	return Services::Get<GameProgress>()->GetFlag(flagName);
 }
-RegFunc1(GetFlag, int, string, IMMEDIATE, REL_FUNC);
+RegFunc1(GetFlag, int, AtomLookup, IMMEDIATE, REL_FUNC);
 
 /*
 int GetFlagInt(int flagEnum)
@@ -1644,19 +1563,19 @@ int GetFlagInt(int flagEnum)
 RegFunc1(GetFlagInt, int, int, IMMEDIATE, REL_FUNC);
 */
  
-shpvoid SetFlag(std::string flagName)
+shpvoid SetFlag(Atom flagName)
 {
 	Services::Get<GameProgress>()->SetFlag(flagName);
 	return 0;
 }
-RegFunc1(SetFlag, void, string, IMMEDIATE, REL_FUNC);
+RegFunc1(SetFlag, void, Atom, IMMEDIATE, REL_FUNC);
 
-shpvoid ClearFlag(std::string flagName)
+shpvoid ClearFlag(Atom flagName)
 {
 	Services::Get<GameProgress>()->ClearFlag(flagName);
 	return 0;
 }
-RegFunc1(ClearFlag, void, string, IMMEDIATE, REL_FUNC);
+RegFunc1(ClearFlag, void, Atom, IMMEDIATE, REL_FUNC);
 
 /*
 shpvoid DumpFlags()
@@ -1668,11 +1587,12 @@ RegFunc0(DumpFlags, void, IMMEDIATE, DEV_FUNC);
  
 //DumpNouns
 
-int GetChatCount(std::string noun)
+int GetChatCount(Atom noun)
 {
+	ConditionCache::Read(ConditionInput::ChatCount, noun);
 	return Services::Get<GameProgress>()->GetChatCount(noun);
 }
-RegFunc1(GetChatCount, int, string, IMMEDIATE, REL_FUNC);
+RegFunc1(GetChatCount, int, AtomLookup, IMMEDIATE, REL_FUNC);
 
 /*
 int GetChatCountInt(int nounEnum)
@@ -1684,38 +1604,40 @@ int GetChatCountInt(int nounEnum)
 RegFunc1(GetChatCountInt, int, int, IMMEDIATE, REL_FUNC);
 */
  
-shpvoid SetChatCount(std::string noun, int count)
+shpvoid SetChatCount(Atom noun, int count)
 {
 	Services::Get<GameProgress>()->SetChatCount(noun, count);
 	return 0;
 }
-RegFunc2(SetChatCount, void, string, int, IMMEDIATE, DEV_FUNC);
+RegFunc2(SetChatCount, void, Atom, int, IMMEDIATE, DEV_FUNC);
 
-int GetGameVariableInt(std::string varName)
+int GetGameVariableInt(Atom varName)
 {
+	ConditionCache::Read(ConditionInput::GameVariable, varName);
 	return Services::Get<GameProgress>()->GetGameVariable(varName);
 }
-RegFunc1(GetGameVariableInt, int, string, IMMEDIATE, REL_FUNC);
+RegFunc1(GetGameVariableInt, int, AtomLookup, IMMEDIATE, REL_FUNC);
 
-shpvoid IncGameVariableInt(std::string varName)
+shpvoid IncGameVariableInt(Atom varName)
 {
 	Services::Get<GameProgress>()->IncGameVariable(varName);
 	return 0;
 }
-RegFunc1(IncGameVariableInt, void, string, IMMEDIATE, REL_FUNC);
+RegFunc1(IncGameVariableInt, void, Atom, IMMEDIATE, REL_FUNC);
 
-shpvoid SetGameVariableInt(std::string varName, int value)
+shpvoid SetGameVariableInt(Atom varName, int value)
 {
 	Services::Get<GameProgress>()->SetGameVariable(varName, value);
 	return 0;
 }
-RegFunc2(SetGameVariableInt, void, string, int, IMMEDIATE, REL_FUNC);
+RegFunc2(SetGameVariableInt, void, Atom, int, IMMEDIATE, REL_FUNC);
 
-int GetNounVerbCount(std::string noun, std::string verb)
+int GetNounVerbCount(Atom noun, Atom verb)
 {
+	ConditionCache::Read(ConditionInput::NounVerbCount, Atom::MakeKey(noun, verb));
 	return Services::Get<GameProgress>()->GetNounVerbCount(noun, verb);
 }
-RegFunc2(GetNounVerbCount, int, string, string, IMMEDIATE, REL_FUNC);
+RegFunc2(GetNounVerbCount, int, AtomLookup, AtomLookup, IMMEDIATE, REL_FUNC);
 
 /*
 int GetNounVerbCountInt(int nounEnum, int verbEnum)
@@ -1727,38 +1649,38 @@ int GetNounVerbCountInt(int nounEnum, int verbEnum)
 RegFunc2(GetNounVerbCountInt, int, int, int, IMMEDIATE, REL_FUNC);
 */
  
-shpvoid IncNounVerbCount(string noun, string verb)
+shpvoid IncNounVerbCount(Atom noun, Atom verb)
 {
 	//TODO: Throw an error if the given noun corresponds to a "Topic".
 	Services::Get<GameProgress>()->IncNounVerbCount(noun, verb);
 	return 0;
 }
-RegFunc2(IncNounVerbCount, void, string, string, IMMEDIATE, REL_FUNC);
+RegFunc2(IncNounVerbCount, void, Atom, Atom, IMMEDIATE, REL_FUNC);
 
-shpvoid IncNounVerbCountBoth(string noun, string verb)
+shpvoid IncNounVerbCountBoth(Atom noun, Atom verb)
 {
 	//TODO: HelpCommand says this sets the noun/verb count for both Gabe and Grace.
 	//TODO: Does that imply SetNounVerbCount tracks per-Ego?
 	Services::Get<GameProgress>()->IncNounVerbCount(noun, verb);
 	return 0;
 }
-RegFunc2(IncNounVerbCountBoth, void, string, string, IMMEDIATE, REL_FUNC);
+RegFunc2(IncNounVerbCountBoth, void, Atom, Atom, IMMEDIATE, REL_FUNC);
 
-shpvoid SetNounVerbCount(string noun, string verb, int count)
+shpvoid SetNounVerbCount(Atom noun, Atom verb, int count)
 {
 	//TODO: Throw an error if the given noun corresponds to a "Topic".
 	Services::Get<GameProgress>()->SetNounVerbCount(noun, verb, count);
 	return 0;
 }
-RegFunc3(SetNounVerbCount, void, string, string, int, IMMEDIATE, REL_FUNC);
+RegFunc3(SetNounVerbCount, void, Atom, Atom, int, IMMEDIATE, REL_FUNC);
 
-shpvoid SetNounVerbCountBoth(string noun, string verb, int count)
+shpvoid SetNounVerbCountBoth(Atom noun, Atom verb, int count)
 {
 	//TODO: HelpCommand says this sets the noun/verb count for both Gabe and Grace.
 	//TODO: Does that imply SetNounVerbCount tracks per-Ego?
 	return SetNounVerbCount(noun, verb, count);
 }
-RegFunc3(SetNounVerbCountBoth, void, string, string, int, IMMEDIATE, REL_FUNC);
+RegFunc3(SetNounVerbCountBoth, void, Atom, Atom, int, IMMEDIATE, REL_FUNC);
 
 shpvoid TriggerNounVerb(std::string noun, std::string verb)
 {
@@ -1800,22 +1722,24 @@ shpvoid ChangeScore(std::string scoreValue)
 }
 RegFunc1(ChangeScore, void, string, IMMEDIATE, REL_FUNC);
 
-int GetTopicCount(std::string noun, std::string verb)
+int GetTopicCount(Atom noun, Atom verb)
 {
+	ConditionCache::Read(ConditionInput::TopicCount, Atom::MakeKey(noun, verb));
+	
 	//TODO: Validate noun. Must be a valid noun. Seems to include any scene nouns, inventory nouns, actor nouns.
-	if(!Services::Get<VerbManager>()->IsTopic(verb))
+	if(!Services::Get<VerbManager>()->IsTopic(verb.ToString()))
 	{
-		Services::GetReports()->Log("Error", "Error: '" + verb + " is not a valid verb name.");
+		Services::GetReports()->Log("Error", "Error: '" + verb.ToString() + " is not a valid verb name.");
 		return 0;
 	}
 	return Services::Get<GameProgress>()->GetTopicCount(noun, verb);
 }
-RegFunc2(GetTopicCount, int, string, string, IMMEDIATE, REL_FUNC);
+RegFunc2(GetTopicCount, int, AtomLookup, Atom, IMMEDIATE, REL_FUNC);
 
 int GetTopicCountInt(int nounEnum, int verbEnum)
 {
-	std::string noun = Services::Get<ActionManager>()->GetNoun(nounEnum);
-	std::string verb = Services::Get<ActionManager>()->GetVerb(verbEnum);
+	Atom noun(Services::Get<ActionManager>()->GetNoun(nounEnum));
+	Atom verb(Services::Get<ActionManager>()->GetVerb(verbEnum));
 	return GetTopicCount(noun, verb);
 }
 RegFunc2(GetTopicCountInt, int, int, int, IMMEDIATE, REL_FUNC);
@@ -1828,17 +1752,18 @@ int HasTopicsLeft(std::string noun)
 }
 RegFunc1(HasTopicsLeft, int, string, IMMEDIATE, REL_FUNC);
 
-shpvoid SetTopicCount(std::string noun, std::string verb, int count)
+shpvoid SetTopicCount(Atom noun, Atom verb, int count)
 {
 	//TODO: Validate noun or report error.
 	//TODO: Validate verb or report error.
 	Services::Get<GameProgress>()->SetTopicCount(noun, verb, count);
 	return 0;
 }
-RegFunc3(SetTopicCount, void, string, string, int, IMMEDIATE, DEV_FUNC);
+RegFunc3(SetTopicCount, void, Atom, Atom, int, IMMEDIATE, DEV_FUNC);
  
 int IsCurrentLocation(std::string location)
 {
+	ConditionCache::Read(ConditionInput::Location);
 	std::string currentLocation = Services::Get<LocationManager>()->GetLocation();
 	return StringUtil::EqualsIgnoreCase(currentLocation, location) ? 1 : 0;
 }
@@ -1846,6 +1771,7 @@ RegFunc1(IsCurrentLocation, int, string, IMMEDIATE, REL_FUNC);
 
 int IsCurrentTime(std::string timeblock)
 {
+	ConditionCache::Read(ConditionInput::Timeblock);
 	std::string currentTimeblock = Services::Get<GameProgress>()->GetTimeblock().ToString();
 	return StringUtil::EqualsIgnoreCase(currentTimeblock, timeblock) ? 1 : 0;
 }
@@ -1853,6 +1779,7 @@ RegFunc1(IsCurrentTime, int, string, IMMEDIATE, REL_FUNC);
 
 int WasLastLocation(std::string location)
 {
+	ConditionCache::Read(ConditionInput::Location);
 	std::string lastLocation = Services::Get<LocationManager>()->GetLastLocation();
 	return StringUtil::EqualsIgnoreCase(lastLocation, location) ? 1 : 0;
 }
@@ -1860,6 +1787,7 @@ RegFunc1(WasLastLocation, int, string, IMMEDIATE, REL_FUNC);
 
 int WasLastTime(std::string timeblock)
 {
+	ConditionCache::Read(ConditionInput::Timeblock);
 	std::string lastTimeblock = Services::Get<GameProgress>()->GetLastTimeblock().ToString();
 	return StringUtil::EqualsIgnoreCase(lastTimeblock, timeblock) ? 1 : 0;
 }
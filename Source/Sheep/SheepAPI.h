@@ -11,8 +11,14 @@
 #include <map>
 #include <string>
 
+#include "ConditionCache.h"
 #include "SheepScript.h"
-#include "Value.h"
+#include "SheepValue.h"
+
+// Generic signature for calling a system function.
+// Arguments are passed as an array, in order, with a length matching the function's argument count.
+// Each argument is already the type the function declares, so no conversion or allocation is needed to read it.
+typedef SheepValue (*SysFuncPtr)(const SheepValue* args);
 
 // A "full" system function declaration.
 // Contains extra data about a function that is helpful, but doesn't uniquely identify the function signature.
@@ -26,6 +32,9 @@ struct SysFuncDecl : public SysImport
 	// If true, this function can only work in dev builds.
 	bool devOnly = false;
 	
+	// Pointer to the generic function that converts arguments and calls the actual function.
+	SysFuncPtr function = nullptr;
+	
 	//TODO: For in-game help output, we may need to store argument names AND description text.
 	// For example, HelpCommand("AddStreamContent") outputs this:
 	/*
@@ -35,18 +44,42 @@ struct SysFuncDecl : public SysImport
 	*/
 };
 
-void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list<char> argTypes, bool waitable, bool dev);
+void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list<char> argTypes, bool waitable, bool dev, SysFuncPtr function);
 SysFuncDecl* GetSysFuncDecl(const std::string& name);
 SysFuncDecl* GetSysFuncDecl(const SysImport* sysImport);
 
-// Functions for calling functions of various argument lengths.
-Value CallSysFunc(const std::string& name);
-Value CallSysFunc(const std::string& name, const Value& x1);
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2);
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3);
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3, const Value& x4);
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3, const Value& x4, const Value& x5);
-Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, const Value& x3, const Value& x4, const Value& x5, const Value& x6);
+// Holds a string returned by a system function, so it outlives the function call.
+// It's only valid until the next system function returns a string - the VM copies it into the executing instance (see SheepInstance::StoreString).
+const char* StoreSysFuncString(const std::string& str);
+
+// Used by the below macros to read arguments and write return values for system functions.
+template<typename T> struct SysFuncArg;
+template<> struct SysFuncArg<int> { static int Get(const SheepValue& value) { return value.intValue; } };
+template<> struct SysFuncArg<float> { static float Get(const SheepValue& value) { return value.floatValue; } };
+template<> struct SysFuncArg<std::string> { static const char* Get(const SheepValue& value) { return value.stringValue; } };
+template<> struct SysFuncArg<Atom> { static Atom Get(const SheepValue& value) { return value.stringAtom.IsEmpty() ? Atom(value.stringValue) : value.stringAtom; } };
+
+// Tag for an "Atom" argument that is only used to look something up (e.g. GetFlag), so a string that isn't an atom yet doesn't become one.
+// Such a string can't name anything that was ever set, so it's passed as the empty atom.
+// But a condition that read it can't be cached: the empty atom doesn't change when that name is set later.
+struct AtomLookup;
+template<> struct SysFuncArg<AtomLookup>
+{
+	static Atom Get(const SheepValue& value)
+	{
+		if(!value.stringAtom.IsEmpty()) { return value.stringAtom; }
+		Atom atom = Atom::Find(value.stringValue);
+		if(atom.IsEmpty() && value.stringValue[0] != '\0')
+		{
+			ConditionCache::MarkUncacheable();
+		}
+		return atom;
+	}
+};
+
+inline SheepValue SysFuncReturn(int value) { return SheepValue(value); }
+inline SheepValue SysFuncReturn(float value) { return SheepValue(value); }
+inline SheepValue SysFuncReturn(const std::string& value) { return SheepValue(StoreSysFuncString(value)); }
 
 // These are used in the below macros to convert keywords into integers using ## macro operator.
 #define void_TYPE 0
@@ -54,76 +87,75 @@ Value CallSysFunc(const std::string& name, const Value& x1, const Value& x2, con
 #define float_TYPE 2
 #define string_TYPE 3
 
+// An "Atom" argument is a string in Sheep, but is passed to the function as an atom.
+// Useful for functions called often with names (nouns, verbs, flags), since string constants already have atoms.
+#define Atom_TYPE 3
+#define AtomLookup_TYPE 3
+
 // Macros that register functions of various argument lengths with the system.
-// Creates a function with same name as the actual function, but which uses generic "Value" args and return type.
+// Creates a function with same name as the actual function, but which uses generic "SheepValue" args and return type.
 // The generic function just calls the real function with correct argument types.
 
-// Also registers an entry in the function map with a pointer to the "generic function".
-// Flow is: Look Up in Map -> Calls Generic Function -> Calls Actual Function
-#define RegFunc0(name, ret, waitable, dev)          					\
-    Value name(const Value& x1) {                   					\
-        return name();                              					\
-    }                                               					\
-    struct name##_ {                                					\
-        name##_() {                                 					\
-            map0[#name]=&name;                      					\
-            AddSysFuncDecl(#name, ret##_TYPE, { }, waitable, dev); 		\
-        }                                           					\
+// Also registers a declaration with a pointer to the "generic function".
+// Sheep scripts resolve their imports to declarations at load time, so the flow is: Call Generic Function -> Calls Actual Function
+#define RegFunc0(name, ret, waitable, dev)                                              \
+    SheepValue name(const SheepValue* args) {                                           \
+        return SysFuncReturn(name());                                                   \
+    }                                                                                   \
+    struct name##_ {                                                                    \
+        name##_() {                                                                     \
+            AddSysFuncDecl(#name, ret##_TYPE, { }, waitable, dev, &name);               \
+        }                                                                               \
     } name##_instance
 
-#define RegFunc1(name, ret, t1, waitable, dev)                     		\
-    Value name(const Value& x1) {                   					\
-        return name(x1.to<t1>());                   					\
-    }                                               					\
-    struct name##_ {                                					\
-        name##_() {                                 					\
-            map1[#name]=&name;                      					\
-            AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE }, waitable, dev);			\
-        }                                           					\
+#define RegFunc1(name, ret, t1, waitable, dev)                                          \
+    SheepValue name(const SheepValue* args) {                                           \
+        return SysFuncReturn(name(SysFuncArg<t1>::Get(args[0])));                       \
+    }                                                                                   \
+    struct name##_ {                                                                    \
+        name##_() {                                                                     \
+            AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE }, waitable, dev, &name);     \
+        }                                                                               \
     } name##_instance
 
-#define RegFunc2(name, ret, t1, t2, waitable, dev)                      \
-    Value name(const Value& x1, const Value& x2) {          			\
-        return name(x1.to<t1>(), x2.to<t2>());              			\
-    }                                                       			\
-    struct name##_ {                                        			\
-        name##_() {                                         			\
-            map2[#name]=&name;                              			\
-            AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE }, waitable, dev); \
-        }                                                   			\
+#define RegFunc2(name, ret, t1, t2, waitable, dev)                                      \
+    SheepValue name(const SheepValue* args) {                                           \
+        return SysFuncReturn(name(SysFuncArg<t1>::Get(args[0]), SysFuncArg<t2>::Get(args[1]))); \
+    }                                                                                   \
+    struct name##_ {                                                                    \
+        name##_() {                                                                     \
+            AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE }, waitable, dev, &name); \
+        }                                                                               \
     } name##_instance
 
-#define RegFunc3(name, ret, t1, t2, t3, waitable, dev)                      \
-	Value name(const Value& x1, const Value& x2, const Value& x3) {          			\
-		return name(x1.to<t1>(), x2.to<t2>(), x3.to<t3>());              			\
-	}                                                       			\
-	struct name##_ {                                        			\
-		name##_() {                                         			\
-			map3[#name]=&name;                              			\
-			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE }, waitable, dev); \
-		}                                                   			\
+#define RegFunc3(name, ret, t1, t2, t3, waitable, dev)                                  \
+	SheepValue name(const SheepValue* args) {                                           \
+		return SysFuncReturn(name(SysFuncArg<t1>::Get(args[0]), SysFuncArg<t2>::Get(args[1]), SysFuncArg<t3>::Get(args[2]))); \
+	}                                                                                   \
+	struct name##_ {                                                                    \
+		name##_() {                                                                     \
+			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE }, waitable, dev, &name); \
+		}                                                                               \
 	} name##_instance
 
-#define RegFunc4(name, ret, t1, t2, t3, t4, waitable, dev)                      \
-	Value name(const Value& x1, const Value& x2, const Value& x3, const Value& x4) {          			\
-		return name(x1.to<t1>(), x2.to<t2>(), x3.to<t3>(), x4.to<t4>());              			\
-	}                                                       			\
-	struct name##_ {                                        			\
-		name##_() {                                         			\
-			map4[#name]=&name;                              			\
-			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE, t4##_TYPE }, waitable, dev); \
-		}                                                   			\
+#define RegFunc4(name, ret, t1, t2, t3, t4, waitable, dev)                              \
+	SheepValue name(const SheepValue* args) {                                           \
+		return SysFuncReturn(name(SysFuncArg<t1>::Get(args[0]), SysFuncArg<t2>::Get(args[1]), SysFuncArg<t3>::Get(args[2]), SysFuncArg<t4>::Get(args[3]))); \
+	}                                                                                   \
+	struct name##_ {                                                                    \
+		name##_() {                                                                     \
+			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE, t4##_TYPE }, waitable, dev, &name); \
+		}                                                                               \
 	} name##_instance
 
-#define RegFunc5(name, ret, t1, t2, t3, t4, t5, waitable, dev)                      \
-	Value name(const Value& x1, const Value& x2, const Value& x3, const Value& x4, const Value& x5) {          			\
-		return name(x1.to<t1>(), x2.to<t2>(), x3.to<t3>(), x4.to<t4>(), x5.to<t5>());              			\
-	}                                                       			\
-	struct name##_ {                                        			\
-		name##_() {                                         			\
-			map5[#name]=&name;                              			\
-			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE, t4##_TYPE, t5##_TYPE }, waitable, dev); \
-		}                                                   			\
+#define RegFunc5(name, ret, t1, t2, t3, t4, t5, waitable, dev)                          \
+	SheepValue name(const SheepValue* args) {                                           \
+		return SysFuncReturn(name(SysFuncArg<t1>::Get(args[0]), SysFuncArg<t2>::Get(args[1]), SysFuncArg<t3>::Get(args[2]), SysFuncArg<t4>::Get(args[3]), SysFuncArg<t5>::Get(args[4]))); \
+	}                                                                                   \
+	struct name##_ {                                                                    \
+		name##_() {                                                                     \
+			AddSysFuncDecl(#name, ret##_TYPE, { t1##_TYPE, t2##_TYPE, t3##_TYPE, t4##_TYPE, t5##_TYPE }, waitable, dev, &name); \
+		}                                                                               \
 	} name##_instance
 
 #define shpvoid int
@@ -438,6 +470,10 @@ shpvoid DumpCommands(); // DEV
 shpvoid DumpRawSheep(std::string sheepName); // DEV
 shpvoid DumpSheepEngine(); // DEV
 
+shpvoid EnableSheepProfiler(); // DEV
+shpvoid DisableSheepProfiler(); // DEV
+shpvoid DumpSheepProfile(std::string fileName); // DEV
+
 shpvoid ExecCommand(std::string sheepCommand); // DEV, WAIT
 shpvoid FindCommand(std::string commandGuess); // DEV
 shpvoid HelpCommand(std::string commandName); // DEV
@@ -500,28 +536,28 @@ shpvoid CommitCaseLogic(); // DEV
 shpvoid DumpCaseCode(); // DEV
 shpvoid ResetCaseLogic(); // DEV
 
-int GetFlag(std::string flagName);
+int GetFlag(Atom flagName);
 int GetFlagInt(int flagEnum);
-shpvoid SetFlag(std::string flagName);
-shpvoid ClearFlag(std::string flagName);
+shpvoid SetFlag(Atom flagName);
+shpvoid ClearFlag(Atom flagName);
 
 shpvoid DumpFlags(); // DEV
 shpvoid DumpNouns(); // DEV
 
-int GetChatCount(std::string noun);
+int GetChatCount(Atom noun);
 int GetChatCountInt(int nounEnum);
-shpvoid SetChatCount(std::string noun, int count); // DEV
+shpvoid SetChatCount(Atom noun, int count); // DEV
 
-int GetGameVariableInt(std::string varName);
-shpvoid IncGameVariableInt(std::string varName);
-shpvoid SetGameVariableInt(std::string varName, int value);
+int GetGameVariableInt(Atom varName);
+shpvoid IncGameVariableInt(Atom varName);
+shpvoid SetGameVariableInt(Atom varName, int value);
 
-int GetNounVerbCount(std::string noun, std::string verb);
+int GetNounVerbCount(Atom noun, Atom verb);
 int GetNounVerbCountInt(int nounEnum, int verbEnum);
-shpvoid IncNounVerbCount(std::string noun, std::string verb);
-shpvoid IncNounVerbCountBoth(std::string noun, std::string verb);
-shpvoid SetNounVerbCount(std::string noun, std::string verb, int count);
-shpvoid SetNounVerbCountBoth(std::string noun, std::string verb, int count);
+shpvoid IncNounVerbCount(Atom noun, Atom verb);
+shpvoid IncNounVerbCountBoth(Atom noun, Atom verb);
+shpvoid SetNounVerbCount(Atom noun, Atom verb, int count);
+shpvoid SetNounVerbCountBoth(Atom noun, Atom verb, int count);
 shpvoid TriggerNounVerb(std::string noun, std::string verb); // DEV
 
 int GetScore();
@@ -529,10 +565,10 @@ shpvoid IncreaseScore(int value);
 shpvoid SetScore(int score); // DEV
 shpvoid ChangeScore(std::string scoreValue);
 
-int GetTopicCount(std::string noun, std::string verb);
+int GetTopicCount(Atom noun, Atom verb);
 int GetTopicCountInt(int nounEnum, int verbEnum);
 int HasTopicsLeft(std::string noun);
-shpvoid SetTopicCount(std::string noun, std::string verb, int count); // DEV
+shpvoid SetTopicCount(Atom noun, Atom verb, int count); // DEV
 
 int IsCurrentLocation(std::string location);
 int IsCurrentTime(std::string timeblock);
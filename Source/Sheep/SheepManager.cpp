@@ -5,6 +5,8 @@
 //
 #include "SheepManager.h"
 
+#include <SDL2/SDL.h>
+
 #include "Services.h"
 #include "StringUtil.h"
 
@@ -26,7 +28,40 @@ SheepScript* SheepManager::Compile(const std::string& name, std::istream& stream
 SheepScript* SheepManager::CompileEval(const std::string& sheep)
 {
 	std::string fullSheep = StringUtil::Format(mEvalHusk, sheep.c_str());
-	return mCompiler.Compile("Case Evaluation", fullSheep);
+	return CompileCached("Case Evaluation", fullSheep);
+}
+
+SheepScript* SheepManager::CompileCached(const std::string& name, const std::string& sheep)
+{
+	// Use the cached copy if we can.
+	SheepScript* script = mScriptCache.Create(name, sheep);
+	if(script != nullptr) { return script; }
+	
+	// Otherwise, compile it and cache it for next time.
+	// A failed compile isn't cached, so any errors are reported every time.
+	script = mCompiler.Compile(name, sheep);
+	mScriptCache.Add(sheep, script);
+	return script;
+}
+
+/*static*/ std::string SheepManager::GetDefaultScriptCachePath()
+{
+	// Fall back on the working directory if there's no preferences directory for some reason.
+	std::string path = "SheepCache.bin";
+	char* prefPath = SDL_GetPrefPath("Kromenak", "GEngine");
+	if(prefPath != nullptr)
+	{
+		path = std::string(prefPath) + path;
+		SDL_free(prefPath);
+	}
+	return path;
+}
+
+bool SheepManager::SaveScriptCache(const std::string& filePath)
+{
+	// Only bother writing out the cache if something was added.
+	if(!mScriptCache.IsDirty()) { return true; }
+	return mScriptCache.Save(filePath);
 }
 
 void SheepManager::Execute(const std::string& sheepName, const std::string& functionName, std::function<void()> finishCallback)
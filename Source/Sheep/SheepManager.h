@@ -10,6 +10,7 @@
 #include <stack>
 
 #include "SheepCompiler.h"
+#include "SheepScriptCache.h"
 #include "SheepVM.h"
 
 class SheepManager
@@ -19,6 +20,17 @@ public:
     SheepScript* Compile(const std::string& name, const std::string& sheep);
     SheepScript* Compile(const std::string& name, std::istream& stream);
 	SheepScript* CompileEval(const std::string& sheep);
+	
+	// Like compile, but uses the compiled script cache if this exact sheep text has been compiled before.
+	// Intended for sheep embedded in assets (NVC/SIF logic and conditions), rather than one-off sheep (e.g. from the console).
+	SheepScript* CompileCached(const std::string& name, const std::string& sheep);
+	
+	// Loads or saves the compiled script cache.
+	// The default path is in the user's preferences directory, since the game's install directory may not be writable.
+	static std::string GetDefaultScriptCachePath();
+	void LoadScriptCache(const std::string& filePath) { mScriptCache.Load(filePath); }
+	bool SaveScriptCache(const std::string& filePath);
+	const SheepScriptCache& GetScriptCache() const { return mScriptCache; }
     
 	void Execute(const std::string& sheepName, const std::string& functionName, std::function<void()> finishCallback);
 	void Execute(SheepScript* script, std::function<void()> finishCallback);
@@ -30,11 +42,15 @@ public:
 	SheepThread* GetCurrentThread() const { return mVirtualMachine.GetCurrentThread(); }
 	bool IsAnyRunning() const { return mVirtualMachine.IsAnyRunning(); }
 	void FlagExecutionError() { mVirtualMachine.FlagExecutionError(); }
+	SheepProfiler& GetProfiler() { return mVirtualMachine.GetProfiler(); }
 	
 private:
 	// Compiles text-based sheep script into sheep bytecode, represented as a SheepScript asset.
     SheepCompiler mCompiler;
 	
+	// Compiled sheep from assets, so they don't need to be compiled again.
+	SheepScriptCache mScriptCache;
+	
 	// Executes binary bytecode sheep scripts.
 	SheepVM mVirtualMachine;
 	
@@ -0,0 +1,581 @@
+//
+// SheepOptimizer.cpp
+//
+// Clark Kromenaker
+//
+#include "SheepOptimizer.h"
+
+#include <climits>
+
+#include "GMath.h"
+#include "SheepScript.h"
+
+namespace
+{
+	bool IsBranch(SheepInstruction instruction)
+	{
+		// All branches (including branching superinstructions) keep their target in "intArg".
+		return instruction == SheepInstruction::Branch ||
+			   instruction == SheepInstruction::BranchGoto ||
+			   instruction == SheepInstruction::BranchIfZero ||
+			   instruction == SheepInstruction::CompareConstBranchI ||
+			   instruction == SheepInstruction::LoadCompareConstBranchI;
+	}
+
+	bool IsJump(SheepInstruction instruction)
+	{
+		return instruction == SheepInstruction::Branch || instruction == SheepInstruction::BranchGoto;
+	}
+
+	bool IsCompareI(SheepInstruction instruction)
+	{
+		switch(instruction)
+		{
+		case SheepInstruction::IsEqualI:
+		case SheepInstruction::IsNotEqualI:
+		case SheepInstruction::IsGreaterI:
+		case SheepInstruction::IsLessI:
+		case SheepInstruction::IsGreaterEqualI:
+		case SheepInstruction::IsLessEqualI:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	SheepInstruction InvertCompareI(SheepInstruction instruction)
+	{
+		switch(instruction)
+		{
+		case SheepInstruction::IsEqualI:
+			return SheepInstruction::IsNotEqualI;
+		case SheepInstruction::IsNotEqualI:
+			return SheepInstruction::IsEqualI;
+		case SheepInstruction::IsGreaterI:
+			return SheepInstruction::IsLessEqualI;
+		case SheepInstruction::IsLessI:
+			return SheepInstruction::IsGreaterEqualI;
+		case SheepInstruction::IsGreaterEqualI:
+			return SheepInstruction::IsLessI;
+		case SheepInstruction::IsLessEqualI:
+			return SheepInstruction::IsGreaterI;
+		default:
+			return instruction;
+		}
+	}
+
+	// Does a binary int instruction on two constants, the same way the VM would.
+	// Returns false if the instruction isn't one we can fold (division by zero is left alone, so the VM still reports it).
+	bool FoldI(SheepInstruction instruction, int int1, int int2, int& outResult)
+	{
+		// Add/subtract/multiply wrap on overflow, rather than being undefined.
+		unsigned int uint1 = static_cast<unsigned int>(int1);
+		unsigned int uint2 = static_cast<unsigned int>(int2);
+		switch(instruction)
+		{
+		case SheepInstruction::AddI:
+			outResult = static_cast<int>(uint1 + uint2);
+			return true;
+		case SheepInstruction::SubtractI:
+			outResult = static_cast<int>(uint1 - uint2);
+			return true;
+		case SheepInstruction::MultiplyI:
+			outResult = static_cast<int>(uint1 * uint2);
+			return true;
+		case SheepInstruction::DivideI:
+			if(int2 == 0 || (int1 == INT_MIN && int2 == -1)) { return false; }
+			outResult = int1 / int2;
+			return true;
+		case SheepInstruction::Modulo:
+			if(int2 == 0 || (int1 == INT_MIN && int2 == -1)) { return false; }
+			outResult = int1 % int2;
+			return true;
+		case SheepInstruction::And:
+			outResult = int1 && int2 ? 1 : 0;
+			return true;
+		case SheepInstruction::Or:
+			outResult = int1 || int2 ? 1 : 0;
+			return true;
+		default:
+			if(IsCompareI(instruction))
+			{
+				outResult = SheepOptimizer::CompareI(instruction, int1, int2) ? 1 : 0;
+				return true;
+			}
+			return false;
+		}
+	}
+
+	// Does a binary float instruction on two constants. The result is either a float or (for comparisons) an int.
+	bool FoldF(SheepInstruction instruction, float float1, float float2, SheepDecodedInstruction& outResult)
+	{
+		outResult.instruction = SheepInstruction::PushF;
+		switch(instruction)
+		{
+		case SheepInstruction::AddF:
+			outResult.floatArg = float1 + float2;
+			return true;
+		case SheepInstruction::SubtractF:
+			outResult.floatArg = float1 - float2;
+			return true;
+		case SheepInstruction::MultiplyF:
+			outResult.floatArg = float1 * float2;
+			return true;
+		case SheepInstruction::DivideF:
+			if(Math::AreEqual(float2, 0.0f)) { return false; }
+			outResult.floatArg = float1 / float2;
+			return true;
+		default:
+			break;
+		}
+
+		bool result = false;
+		switch(instruction)
+		{
+		case SheepInstruction::IsEqualF:
+			result = Math::AreEqual(float1, float2);
+			break;
+		case SheepInstruction::IsNotEqualF:
+			result = !Math::AreEqual(float1, float2);
+			break;
+		case SheepInstruction::IsGreaterF:
+			result = float1 > float2;
+			break;
+		case SheepInstruction::IsLessF:
+			result = float1 < float2;
+			break;
+		case SheepInstruction::IsGreaterEqualF:
+			result = float1 >= float2;
+			break;
+		case SheepInstruction::IsLessEqualF:
+			result = float1 <= float2;
+			break;
+		default:
+			return false;
+		}
+		outResult.instruction = SheepInstruction::PushI;
+		outResult.intArg = result ? 1 : 0;
+		return true;
+	}
+
+	// State for one optimization pass. Passes only mark instructions as removed; "Compact" actually removes them.
+	struct Pass
+	{
+		std::vector<SheepDecodedInstruction>& instructions;
+
+		// Instructions that execution can jump to from somewhere other than the previous instruction.
+		// A pattern can start at one of these, but can't contain one - otherwise, a jump would land in the middle of it.
+		std::vector<bool> isTarget;
+		std::vector<bool> removed;
+
+		Pass(std::vector<SheepDecodedInstruction>& instructions, const std::vector<int>& entryPoints) :
+			instructions(instructions),
+			isTarget(instructions.size(), false),
+			removed(instructions.size(), false)
+		{
+			for(int entryPoint : entryPoints)
+			{
+				isTarget[entryPoint] = true;
+			}
+			for(auto& instruction : instructions)
+			{
+				if(IsBranch(instruction.instruction))
+				{
+					isTarget[instruction.intArg] = true;
+				}
+			}
+		}
+
+		// Gets the instruction "offset" places after "index", if a pattern can include it. Returns null if not.
+		SheepDecodedInstruction* Get(int index, int offset)
+		{
+			int size = static_cast<int>(instructions.size());
+			for(int i = index; i <= index + offset; i++)
+			{
+				if(i >= size || removed[i] || (i > index && isTarget[i])) { return nullptr; }
+			}
+			return &instructions[index + offset];
+		}
+
+		bool Is(int index, int offset, SheepInstruction instruction)
+		{
+			SheepDecodedInstruction* decoded = Get(index, offset);
+			return decoded != nullptr && decoded->instruction == instruction;
+		}
+
+		void Remove(int index, int count)
+		{
+			for(int i = index; i < index + count; i++)
+			{
+				removed[i] = true;
+			}
+		}
+
+		// Index of the next instruction that hasn't been removed.
+		int Next(int index)
+		{
+			int size = static_cast<int>(instructions.size());
+			++index;
+			while(index < size && removed[index])
+			{
+				++index;
+			}
+			return index;
+		}
+	};
+
+	bool FoldConstants(Pass& pass)
+	{
+		bool changed = false;
+		int size = static_cast<int>(pass.instructions.size());
+		for(int i = 0; i < size; i++)
+		{
+			SheepDecodedInstruction* first = pass.Get(i, 0);
+			SheepDecodedInstruction* second = pass.Get(i, 1);
+			if(first == nullptr || second == nullptr) { continue; }
+			SheepDecodedInstruction* third = pass.Get(i, 2);
+
+			// Binary operations on two constants.
+			if(third != nullptr && first->instruction == SheepInstruction::PushI && second->instruction == SheepInstruction::PushI)
+			{
+				int result = 0;
+				if(FoldI(third->instruction, first->intArg, second->intArg, result))
+				{
+					first->intArg = result;
+					pass.Remove(i + 1, 2);
+					changed = true;
+					continue;
+				}
+			}
+			if(third != nullptr && first->instruction == SheepInstruction::PushF && second->instruction == SheepInstruction::PushF)
+			{
+				if(FoldF(third->instruction, first->floatArg, second->floatArg, *first))
+				{
+					pass.Remove(i + 1, 2);
+					changed = true;
+					continue;
+				}
+			}
+
+			// Unary operations on a constant.
+			bool folded = true;
+			if(first->instruction == SheepInstruction::PushI && second->instruction == SheepInstruction::NegateI)
+			{
+				first->intArg = static_cast<int>(0u - static_cast<unsigned int>(first->intArg));
+			}
+			else if(first->instruction == SheepInstruction::PushF && second->instruction == SheepInstruction::NegateF)
+			{
+				first->floatArg *= -1.0f;
+			}
+			else if(first->instruction == SheepInstruction::PushI && second->instruction == SheepInstruction::Not)
+			{
+				first->intArg = first->intArg == 0 ? 1 : 0;
+			}
+			else if(first->instruction == SheepInstruction::PushI && second->instruction == SheepInstruction::IToF && second->intArg == 0)
+			{
+				first->instruction = SheepInstruction::PushF;
+				first->floatArg = static_cast<float>(first->intArg);
+			}
+			else if(first->instruction == SheepInstruction::PushF && second->instruction == SheepInstruction::FToI && second->intArg == 0)
+			{
+				first->instruction = SheepInstruction::PushI;
+				first->intArg = static_cast<int>(first->floatArg);
+			}
+			else if(IsCompareI(first->instruction) && second->instruction == SheepInstruction::Not)
+			{
+				// A negated comparison is just the opposite comparison.
+				first->instruction = InvertCompareI(first->instruction);
+			}
+			else
+			{
+				folded = false;
+			}
+			if(folded)
+			{
+				pass.Remove(i + 1, 1);
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
+	bool SimplifyBranches(Pass& pass)
+	{
+		bool changed = false;
+		int size = static_cast<int>(pass.instructions.size());
+		for(int i = 0; i < size; i++)
+		{
+			SheepDecodedInstruction* decoded = pass.Get(i, 0);
+			if(decoded == nullptr) { continue; }
+
+			// A conditional branch on a constant either always or never branches.
+			if(decoded->instruction == SheepInstruction::PushI && pass.Is(i, 1, SheepInstruction::BranchIfZero))
+			{
+				if(decoded->intArg == 0)
+				{
+					pass.instructions[i + 1].instruction = SheepInstruction::Branch;
+					pass.Remove(i, 1);
+				}
+				else
+				{
+					pass.Remove(i, 2);
+				}
+				changed = true;
+				continue;
+			}
+
+			if(!IsBranch(decoded->instruction)) { continue; }
+
+			// If a branch lands on a jump, it may as well go straight to where the jump goes.
+			// Limit the hops, in case jumps form a loop.
+			for(int hops = 0; hops < size; hops++)
+			{
+				int target = decoded->intArg;
+				if(!IsJump(pass.instructions[target].instruction) || pass.instructions[target].intArg == target) { break; }
+				decoded->intArg = pass.instructions[target].intArg;
+				changed = true;
+			}
+
+			// A branch to the next instruction does nothing (though a conditional branch still pops the condition).
+			if(decoded->intArg == pass.Next(i))
+			{
+				if(IsJump(decoded->instruction))
+				{
+					pass.Remove(i, 1);
+					changed = true;
+				}
+				else if(decoded->instruction == SheepInstruction::BranchIfZero)
+				{
+					decoded->instruction = SheepInstruction::Pop;
+					decoded->intArg = 0;
+					changed = true;
+				}
+			}
+		}
+		return changed;
+	}
+
+	bool RemoveUnreachable(Pass& pass, const std::vector<int>& entryPoints)
+	{
+		int size = static_cast<int>(pass.instructions.size());
+		std::vector<bool> reached(size, false);
+
+		// Execution can start at any entry point. The final "ReturnV" is always kept, so scripts always end with one.
+		std::vector<int> toVisit = entryPoints;
+		toVisit.push_back(size - 1);
+		while(!toVisit.empty())
+		{
+			int index = toVisit.back();
+			toVisit.pop_back();
+
+			// Follow execution until it stops or reaches code we've already visited.
+			while(index < size && !reached[index])
+			{
+				reached[index] = true;
+
+				SheepInstruction instruction = pass.instructions[index].instruction;
+				if(IsBranch(instruction))
+				{
+					toVisit.push_back(pass.instructions[index].intArg);
+				}
+				if(IsJump(instruction) || instruction == SheepInstruction::ReturnV) { break; }
+				++index;
+			}
+		}
+
+		bool changed = false;
+		for(int i = 0; i < size; i++)
+		{
+			if(!reached[i] && !pass.removed[i])
+			{
+				pass.removed[i] = true;
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
+	void FuseInstructions(Pass& pass)
+	{
+		int size = static_cast<int>(pass.instructions.size());
+		for(int i = 0; i < size; i++)
+		{
+			SheepDecodedInstruction* decoded = pass.Get(i, 0);
+			if(decoded == nullptr) { continue; }
+
+			switch(decoded->instruction)
+			{
+			case SheepInstruction::LoadI:
+			{
+				// Comparing a variable to a constant, maybe to decide whether to branch.
+				SheepDecodedInstruction* compare = pass.Get(i, 2);
+				if(pass.Is(i, 1, SheepInstruction::PushI) && compare != nullptr && IsCompareI(compare->instruction))
+				{
+					int varIndex = decoded->intArg;
+					decoded->compare = compare->instruction;
+					if(pass.Is(i, 3, SheepInstruction::BranchIfZero))
+					{
+						decoded->instruction = SheepInstruction::LoadCompareConstBranchI;
+						decoded->intArg = pass.instructions[i + 3].intArg;
+						decoded->intArg2 = varIndex;
+						decoded->intArg3 = pass.instructions[i + 1].intArg;
+						pass.Remove(i + 1, 3);
+					}
+					else
+					{
+						decoded->instruction = SheepInstruction::LoadCompareConstI;
+						decoded->intArg2 = pass.instructions[i + 1].intArg;
+						pass.Remove(i + 1, 2);
+					}
+				}
+				break;
+			}
+			case SheepInstruction::PushI:
+			{
+				SheepDecodedInstruction* next = pass.Get(i, 1);
+				if(next == nullptr) { break; }
+
+				// Comparing to a constant, maybe to decide whether to branch.
+				if(IsCompareI(next->instruction))
+				{
+					int constant = decoded->intArg;
+					decoded->compare = next->instruction;
+					if(pass.Is(i, 2, SheepInstruction::BranchIfZero))
+					{
+						decoded->instruction = SheepInstruction::CompareConstBranchI;
+						decoded->intArg = pass.instructions[i + 2].intArg;
+						decoded->intArg2 = constant;
+						pass.Remove(i + 1, 2);
+					}
+					else
+					{
+						decoded->instruction = SheepInstruction::CompareConstI;
+						pass.Remove(i + 1, 1);
+					}
+					break;
+				}
+
+				// Calling a system function: the constant is the argument count.
+				// Void functions are always followed by a "Pop" of their (unused) result.
+				SheepInstruction fused = SheepInstruction::SitnSpin;
+				int removeCount = 1;
+				switch(next->instruction)
+				{
+				case SheepInstruction::CallSysFunctionV:
+					if(pass.Is(i, 2, SheepInstruction::Pop))
+					{
+						fused = SheepInstruction::CallSysFunctionArgsV;
+						removeCount = 2;
+					}
+					break;
+				case SheepInstruction::CallSysFunctionI:
+					fused = SheepInstruction::CallSysFunctionArgsI;
+					break;
+				case SheepInstruction::CallSysFunctionF:
+					fused = SheepInstruction::CallSysFunctionArgsF;
+					break;
+				case SheepInstruction::CallSysFunctionS:
+					fused = SheepInstruction::CallSysFunctionArgsS;
+					break;
+				default:
+					break;
+				}
+				if(fused != SheepInstruction::SitnSpin)
+				{
+					decoded->instruction = fused;
+					decoded->intArg2 = decoded->intArg;
+					decoded->intArg = next->intArg;
+					pass.Remove(i + 1, removeCount);
+				}
+				break;
+			}
+			case SheepInstruction::PushS:
+				if(pass.Is(i, 1, SheepInstruction::GetString))
+				{
+					decoded->instruction = SheepInstruction::PushStringConst;
+					pass.Remove(i + 1, 1);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	// Removes instructions marked as removed, and updates branch targets, entry points, and the index mapping to match.
+	void Compact(Pass& pass, std::vector<int>& entryPoints, std::vector<int>& indexMap)
+	{
+		// Each instruction's new index is the number of instructions kept before it.
+		// A removed instruction maps to the next kept instruction, which is where execution would have ended up anyway.
+		int size = static_cast<int>(pass.instructions.size());
+		std::vector<int> newIndexes(size);
+		int kept = 0;
+		for(int i = 0; i < size; i++)
+		{
+			newIndexes[i] = kept;
+			if(!pass.removed[i])
+			{
+				pass.instructions[kept] = pass.instructions[i];
+				++kept;
+			}
+		}
+		pass.instructions.resize(kept);
+
+		for(auto& instruction : pass.instructions)
+		{
+			if(IsBranch(instruction.instruction))
+			{
+				instruction.intArg = newIndexes[instruction.intArg];
+			}
+		}
+		for(int& entryPoint : entryPoints)
+		{
+			entryPoint = newIndexes[entryPoint];
+		}
+		for(int& index : indexMap)
+		{
+			index = newIndexes[index];
+		}
+	}
+}
+
+std::vector<int> SheepOptimizer::Optimize(std::vector<SheepDecodedInstruction>& instructions, const std::vector<int>& entryPoints)
+{
+	std::vector<int> indexMap(instructions.size());
+	for(int i = 0; i < indexMap.size(); i++)
+	{
+		indexMap[i] = i;
+	}
+	if(instructions.empty()) { return indexMap; }
+
+	// Each optimization can expose more (e.g. folding a condition to a constant makes a branch removable, which makes code unreachable).
+	// So, keep going until nothing changes.
+	std::vector<int> entries = entryPoints;
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		{
+			Pass pass(instructions, entries);
+			changed |= FoldConstants(pass);
+			Compact(pass, entries, indexMap);
+		}
+		{
+			Pass pass(instructions, entries);
+			changed |= SimplifyBranches(pass);
+			Compact(pass, entries, indexMap);
+		}
+		{
+			Pass pass(instructions, entries);
+			changed |= RemoveUnreachable(pass, entries);
+			Compact(pass, entries, indexMap);
+		}
+	}
+
+	// Finally, replace common sequences with superinstructions.
+	// This is done last, since the other optimizations only understand plain instructions.
+	Pass pass(instructions, entries);
+	FuseInstructions(pass);
+	Compact(pass, entries, indexMap);
+	return indexMap;
+}
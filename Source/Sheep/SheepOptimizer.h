@@ -0,0 +1,48 @@
+//
+// SheepOptimizer.h
+//
+// Clark Kromenaker
+//
+// Optimizes decoded sheep instructions before they are executed.
+//
+// Sheep compilers (ours and the original game's) generate very literal stack code.
+// The optimizer folds constant expressions, removes branches with known outcomes and code that can't be reached,
+// and replaces common instruction sequences with superinstructions, so the VM does less work per line of sheep.
+//
+#pragma once
+#include <vector>
+
+#include "SheepVM.h"
+
+struct SheepDecodedInstruction;
+
+namespace SheepOptimizer
+{
+	// Optimizes instructions in place. Branch targets must be instruction indexes.
+	// Entry points are indexes that execution can start at (e.g. function starts).
+	// The last instruction is always kept, so a script still ends with "ReturnV".
+	// Returns a mapping from each old instruction index to its new index.
+	std::vector<int> Optimize(std::vector<SheepDecodedInstruction>& instructions, const std::vector<int>& entryPoints);
+
+	// Does an int comparison instruction (IsEqualI, IsLessI, etc). Used when executing compare superinstructions.
+	inline bool CompareI(SheepInstruction compare, int int1, int int2)
+	{
+		switch(compare)
+		{
+		case SheepInstruction::IsEqualI:
+			return int1 == int2;
+		case SheepInstruction::IsNotEqualI:
+			return int1 != int2;
+		case SheepInstruction::IsGreaterI:
+			return int1 > int2;
+		case SheepInstruction::IsLessI:
+			return int1 < int2;
+		case SheepInstruction::IsGreaterEqualI:
+			return int1 >= int2;
+		case SheepInstruction::IsLessEqualI:
+			return int1 <= int2;
+		default:
+			return false;
+		}
+	}
+}
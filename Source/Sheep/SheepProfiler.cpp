@@ -0,0 +1,177 @@
+//
+// SheepProfiler.cpp
+//
+// Clark Kromenaker
+//
+#include "SheepProfiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "SheepAPI.h"
+
+namespace
+{
+	double ToMicroseconds(SheepProfiler::Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::micro>(duration).count();
+	}
+
+	// Names come from scripts, so escape anything that would break a JSON string.
+	std::string EscapeJSON(const std::string& str)
+	{
+		std::string escaped;
+		escaped.reserve(str.size());
+		for(char c : str)
+		{
+			if(c == '"' || c == '\\')
+			{
+				escaped += '\\';
+				escaped += c;
+			}
+			else if(static_cast<unsigned char>(c) < 0x20)
+			{
+				escaped += ' ';
+			}
+			else
+			{
+				escaped += c;
+			}
+		}
+		return escaped;
+	}
+
+	template<typename Stats>
+	void WriteCSVRows(std::ofstream& out, const char* type, std::vector<std::pair<std::string, Stats>>& rows, bool hasInstructions)
+	{
+		// Most expensive first.
+		std::sort(rows.begin(), rows.end(), [](const std::pair<std::string, Stats>& a, const std::pair<std::string, Stats>& b) {
+			return a.second.time > b.second.time;
+		});
+		for(auto& row : rows)
+		{
+			double totalMicroseconds = ToMicroseconds(row.second.time);
+			out << type << "," << row.first << "," << row.second.count << ",";
+			if(hasInstructions)
+			{
+				out << row.second.instructionCount;
+			}
+			out << "," << totalMicroseconds / 1000.0 << "," << (row.second.count > 0 ? totalMicroseconds / row.second.count : 0.0) << "\n";
+		}
+	}
+}
+
+void SheepProfiler::SetEnabled(bool enabled)
+{
+	if(enabled && !mEnabled)
+	{
+		mFunctionStats.clear();
+		mSysFuncStats.clear();
+		mTraceEvents.clear();
+		mStartTime = Now();
+	}
+	mEnabled = enabled;
+}
+
+void SheepProfiler::RecordRun(const std::string& scriptName, const std::string& functionName, int instructionCount,
+							  Clock::time_point start, Clock::time_point end)
+{
+	Stats& stats = mFunctionStats[std::make_pair(scriptName, functionName)];
+	++stats.count;
+	stats.instructionCount += instructionCount;
+	stats.time += end - start;
+
+	if(mTraceEvents.size() < kMaxTraceEvents)
+	{
+		mTraceEvents.push_back({ scriptName + ":" + functionName, false, start, end - start });
+	}
+}
+
+void SheepProfiler::RecordSysFunc(const SysFuncDecl* sysFunc, Clock::time_point start, Clock::time_point end)
+{
+	Stats& stats = mSysFuncStats[sysFunc];
+	++stats.count;
+	stats.time += end - start;
+
+	if(mTraceEvents.size() < kMaxTraceEvents)
+	{
+		mTraceEvents.push_back({ sysFunc->name, true, start, end - start });
+	}
+}
+
+U64 SheepProfiler::GetInstructionCount() const
+{
+	U64 instructionCount = 0;
+	for(auto& entry : mFunctionStats)
+	{
+		instructionCount += entry.second.instructionCount;
+	}
+	return instructionCount;
+}
+
+bool SheepProfiler::WriteCSV(const std::string& filePath) const
+{
+	std::ofstream out(filePath, std::ios::out);
+	if(!out.good()) { return false; }
+
+	// Total up per-script stats from the per-function stats.
+	std::map<std::string, Stats> scriptStats;
+	std::vector<std::pair<std::string, Stats>> functionRows;
+	for(auto& entry : mFunctionStats)
+	{
+		Stats& stats = scriptStats[entry.first.first];
+		stats.count += entry.second.count;
+		stats.instructionCount += entry.second.instructionCount;
+		stats.time += entry.second.time;
+		functionRows.emplace_back(entry.first.first + ":" + entry.first.second, entry.second);
+	}
+	std::vector<std::pair<std::string, Stats>> scriptRows(scriptStats.begin(), scriptStats.end());
+
+	std::vector<std::pair<std::string, Stats>> sysFuncRows;
+	for(auto& entry : mSysFuncStats)
+	{
+		sysFuncRows.emplace_back(entry.first->name, entry.second);
+	}
+
+	out << "Type,Name,Count,Instructions,Total (ms),Average (us)\n";
+	WriteCSVRows(out, "Script", scriptRows, true);
+	WriteCSVRows(out, "Function", functionRows, true);
+	WriteCSVRows(out, "SysFunc", sysFuncRows, false);
+	return out.good();
+}
+
+bool SheepProfiler::WriteChromeTrace(const std::string& filePath) const
+{
+	std::ofstream out(filePath, std::ios::out);
+	if(!out.good()) { return false; }
+
+	// Each event is a "complete" event (has a start and duration), with times in microseconds.
+	out << "{\"traceEvents\":[";
+	for(int i = 0; i < mTraceEvents.size(); i++)
+	{
+		const TraceEvent& event = mTraceEvents[i];
+		out << (i > 0 ? ",\n" : "\n");
+		out << "{\"name\":\"" << EscapeJSON(event.name) << "\",\"cat\":\"" << (event.sysFunc ? "SysFunc" : "Sheep")
+			<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ToMicroseconds(event.start - mStartTime)
+			<< ",\"dur\":" << ToMicroseconds(event.duration) << "}";
+	}
+	out << "\n]}\n";
+	return out.good();
+}
+
+void SheepProfiler::Dump(const std::string& filePath) const
+{
+	if(!WriteCSV(filePath + ".csv"))
+	{
+		std::cout << "Could not write sheep profile to " << filePath << ".csv" << std::endl;
+	}
+	if(!WriteChromeTrace(filePath + ".json"))
+	{
+		std::cout << "Could not write sheep profile to " << filePath << ".json" << std::endl;
+	}
+	if(mTraceEvents.size() >= kMaxTraceEvents)
+	{
+		std::cout << "Sheep profile trace was truncated after " << kMaxTraceEvents << " events." << std::endl;
+	}
+}
@@ -0,0 +1,81 @@
+//
+// SheepProfiler.h
+//
+// Clark Kromenaker
+//
+// Records where sheep execution time goes: per script, per function, and per system function.
+//
+// Profiling is off by default. When it's on, the VM reports each run of a thread and each system function call here.
+// Results can be written as CSV (totals) or as Chrome trace JSON (a timeline, viewable in chrome://tracing).
+//
+#pragma once
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Atomics.h"
+
+struct SysFuncDecl;
+
+class SheepProfiler
+{
+public:
+	typedef std::chrono::steady_clock Clock;
+	static Clock::time_point Now() { return Clock::now(); }
+
+	// Turning profiling on clears any previous results.
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const { return mEnabled; }
+
+	// Records one run of a thread, from when the VM started executing it until it finished or blocked.
+	// A function that waits is split into several runs. Times include any sheep or system functions called.
+	void RecordRun(const std::string& scriptName, const std::string& functionName, int instructionCount,
+				   Clock::time_point start, Clock::time_point end);
+
+	// Records one system function call.
+	void RecordSysFunc(const SysFuncDecl* sysFunc, Clock::time_point start, Clock::time_point end);
+
+	// Total number of instructions executed since profiling was turned on.
+	U64 GetInstructionCount() const;
+
+	// Writes results to a file. Returns false if the file couldn't be written.
+	bool WriteCSV(const std::string& filePath) const;
+	bool WriteChromeTrace(const std::string& filePath) const;
+
+	// Writes both results files, with the given path plus ".csv" and ".json".
+	void Dump(const std::string& filePath) const;
+
+private:
+	// Trace events use a lot of memory, so stop recording them after a while (totals are still recorded).
+	static const int kMaxTraceEvents = 1000000;
+
+	struct Stats
+	{
+		U64 count = 0;
+		U64 instructionCount = 0;
+		Clock::duration time = Clock::duration::zero();
+	};
+
+	struct TraceEvent
+	{
+		std::string name;
+		bool sysFunc = false;
+		Clock::time_point start;
+		Clock::duration duration;
+	};
+
+	bool mEnabled = false;
+
+	// When profiling started; trace event times are relative to this.
+	Clock::time_point mStartTime;
+
+	// Stats per script name and function name. Per-script stats are totaled from these when written.
+	std::map<std::pair<std::string, std::string>, Stats> mFunctionStats;
+
+	// Stats per system function.
+	std::unordered_map<const SysFuncDecl*, Stats> mSysFuncStats;
+
+	std::vector<TraceEvent> mTraceEvents;
+};
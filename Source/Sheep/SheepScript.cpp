@@ -9,19 +9,28 @@
 #include <iostream>
 
 #include "BinaryReader.h"
+#include "BinaryWriter.h"
+#include "ConditionCache.h"
+#include "SheepAPI.h"
+#include "SheepOptimizer.h"
 #include "SheepScriptBuilder.h"
 #include "StringUtil.h"
 
 SheepScript::SheepScript(std::string name, char* data, int dataLength) : Asset(name)
 {
     ParseFromData(data, dataLength);
+	ResolveSysImports();
+	DecodeBytecode();
 }
 
 SheepScript::SheepScript(const std::string& name, SheepScriptBuilder& builder) : Asset(name)
 {
     // Just copy these directly.
     mSysImports = builder.GetSysImports();
-    mStringConsts = builder.GetStringConsts();
+    for(auto& entry : builder.GetStringConsts())
+	{
+		mStringConsts[entry.first] = { entry.second, Atom(entry.second) };
+	}
     mVariables = builder.GetVariables();
     mFunctions = builder.GetFunctions();
 	
@@ -30,6 +39,174 @@ SheepScript::SheepScript(const std::string& name, SheepScriptBuilder& builder) :
     mBytecodeLength = (int)bytecodeVec.size();
     mBytecode = new char[mBytecodeLength];
     std::copy(bytecodeVec.begin(), bytecodeVec.end(), mBytecode);
+	ResolveSysImports();
+	DecodeBytecode();
+}
+
+SheepScript::SheepScript(const std::string& name, BinaryReader& reader) : Asset(name)
+{
+	// If data is cut off or corrupt, don't run any of it.
+	if(!Read(reader))
+	{
+		std::cout << "Compiled sheep data for " << name << " is invalid!" << std::endl;
+		mSysImports.clear();
+		mStringConsts.clear();
+		mVariables.clear();
+		mFunctions.clear();
+		delete[] mBytecode;
+		mBytecode = nullptr;
+		mBytecodeLength = 0;
+		mReadFailed = true;
+	}
+	ResolveSysImports();
+	DecodeBytecode();
+}
+
+SheepScript::~SheepScript()
+{
+	// Cached condition results are keyed by script address. Another script could be created at this address later.
+	ConditionCache::Clear();
+}
+
+bool SheepScript::Read(BinaryReader& reader)
+{
+	// Counts and lengths come from a file that may be truncated or out of date, so check them against the data left before using them.
+	// Otherwise, a bad count or length could cause a huge allocation, or reads past the end of the data.
+	auto countFits = [&reader](int count, int minItemSize) {
+		return reader.OK() && count >= 0 && static_cast<int64_t>(count) * minItemSize <= reader.GetRemaining();
+	};
+	
+	// Imports: name, return type, and argument types.
+	int sysImportCount = reader.ReadInt();
+	if(!countFits(sysImportCount, 4)) { return false; }
+	for(int i = 0; i < sysImportCount; i++)
+	{
+		SysImport sysImport;
+		int nameLength = reader.ReadUShort();
+		if(!countFits(nameLength, 1)) { return false; }
+		sysImport.name = reader.ReadString(nameLength);
+		sysImport.returnType = reader.ReadByte();
+		
+		int argumentCount = reader.ReadUByte();
+		if(!countFits(argumentCount, 1)) { return false; }
+		for(int j = 0; j < argumentCount; j++)
+		{
+			sysImport.argumentTypes.push_back(reader.ReadByte());
+		}
+		mSysImports.push_back(sysImport);
+	}
+	
+	// String constants: offset and text.
+	int stringConstCount = reader.ReadInt();
+	if(!countFits(stringConstCount, 8)) { return false; }
+	for(int i = 0; i < stringConstCount; i++)
+	{
+		int offset = reader.ReadInt();
+		int length = reader.ReadInt();
+		if(!countFits(length, 1)) { return false; }
+		std::string str = reader.ReadString(length);
+		mStringConsts[offset] = { str, Atom(str) };
+	}
+	
+	// Variables: type and default value. As with SHP files, string defaults aren't stored.
+	int variableCount = reader.ReadInt();
+	if(!countFits(variableCount, 1)) { return false; }
+	for(int i = 0; i < variableCount; i++)
+	{
+		SheepValue value(static_cast<SheepValueType>(reader.ReadUByte()));
+		if(value.type == SheepValueType::Int)
+		{
+			value.intValue = reader.ReadInt();
+		}
+		else if(value.type == SheepValueType::Float)
+		{
+			value.floatValue = reader.ReadFloat();
+		}
+		else if(value.type == SheepValueType::String)
+		{
+			value.stringValue = nullptr;
+		}
+		else
+		{
+			return false;
+		}
+		mVariables.push_back(value);
+	}
+	
+	// Functions: lowercase name and bytecode offset.
+	int functionCount = reader.ReadInt();
+	if(!countFits(functionCount, 6)) { return false; }
+	for(int i = 0; i < functionCount; i++)
+	{
+		int nameLength = reader.ReadUShort();
+		if(!countFits(nameLength, 1)) { return false; }
+		std::string functionName = reader.ReadString(nameLength);
+		mFunctions[functionName] = reader.ReadInt();
+	}
+	
+	// And finally, the bytecode.
+	int bytecodeLength = reader.ReadInt();
+	if(!countFits(bytecodeLength, 1)) { return false; }
+	if(bytecodeLength > 0)
+	{
+		mBytecodeLength = bytecodeLength;
+		mBytecode = new char[mBytecodeLength];
+		reader.Read(mBytecode, mBytecodeLength);
+	}
+	return reader.OK();
+}
+
+void SheepScript::Write(BinaryWriter& writer) const
+{
+	// See above constructor for the order and meaning of everything written here.
+	writer.WriteInt(static_cast<int>(mSysImports.size()));
+	for(auto& sysImport : mSysImports)
+	{
+		writer.WriteUShort(static_cast<uint16_t>(sysImport.name.size()));
+		writer.WriteString(sysImport.name);
+		writer.WriteSByte(sysImport.returnType);
+		writer.WriteUByte(static_cast<uint8_t>(sysImport.argumentTypes.size()));
+		for(char argumentType : sysImport.argumentTypes)
+		{
+			writer.WriteSByte(argumentType);
+		}
+	}
+	
+	writer.WriteInt(static_cast<int>(mStringConsts.size()));
+	for(auto& entry : mStringConsts)
+	{
+		writer.WriteInt(entry.first);
+		writer.WriteInt(static_cast<int>(entry.second.text.size()));
+		writer.WriteString(entry.second.text);
+	}
+	
+	writer.WriteInt(static_cast<int>(mVariables.size()));
+	for(auto& value : mVariables)
+	{
+		writer.WriteUByte(static_cast<uint8_t>(value.type));
+		if(value.type == SheepValueType::Int)
+		{
+			writer.WriteInt(value.intValue);
+		}
+		else if(value.type == SheepValueType::Float)
+		{
+			writer.WriteFloat(value.floatValue);
+		}
+	}
+	
+	writer.WriteInt(static_cast<int>(mFunctions.size()));
+	for(auto& entry : mFunctions)
+	{
+		writer.WriteUShort(static_cast<uint16_t>(entry.first.size()));
+		writer.WriteString(entry.first);
+		writer.WriteInt(entry.second);
+	}
+	
+	writer.WriteInt(mBytecodeLength);
+	if(mBytecodeLength > 0)
+	{
+		writer.Write(mBytecode, mBytecodeLength);
+	}
 }
 
 SysImport* SheepScript::GetSysImport(int index)
@@ -38,7 +215,13 @@ SysImport* SheepScript::GetSysImport(int index)
     return &mSysImports[index];
 }
 
-std::string* SheepScript::GetStringConst(int offset)
+SysFuncDecl* SheepScript::GetSysFunc(int index) const
+{
+	if(index < 0 || index >= mSysFuncs.size()) { return nullptr; }
+	return mSysFuncs[index];
+}
+
+const SheepStringConst* SheepScript::GetStringConst(int offset) const
 {
     auto it = mStringConsts.find(offset);
     if(it != mStringConsts.end())
@@ -62,6 +245,12 @@ int SheepScript::GetFunctionOffset(std::string functionName)
     return -1;
 }
 
+int SheepScript::GetInstructionIndex(int bytecodeOffset) const
+{
+	if(bytecodeOffset < 0 || bytecodeOffset >= mInstructionIndexes.size()) { return -1; }
+	return mInstructionIndexes[bytecodeOffset];
+}
+
 void SheepScript::Dump()
 {
     std::cout << "Dumping sheep " << mName << std::endl << std::endl;
@@ -193,7 +382,7 @@ void SheepScript::ParseStringConstsSection(BinaryReader& reader)
             endOffset = dataBaseOffset + contentSize;
         }
         std::string str = reader.ReadString(endOffset - startOffset);
-        mStringConsts[startOffset - dataBaseOffset] = str;
+        mStringConsts[startOffset - dataBaseOffset] = { str, Atom(str) };
     }
 }
 
@@ -304,3 +493,128 @@ void SheepScript::ParseCodeSection(BinaryReader& reader)
     mBytecode = new char[mBytecodeLength];
     reader.Read(mBytecode, mBytecodeLength);
 }
+
+void SheepScript::ResolveSysImports()
+{
+	mSysFuncs.clear();
+	for(auto& sysImport : mSysImports)
+	{
+		// A script can import a function we haven't implemented yet. That's OK as long as it isn't called.
+		// If it is called, the VM will output an error and continue.
+		SysFuncDecl* sysFunc = GetSysFuncDecl(&sysImport);
+		if(sysFunc == nullptr || sysFunc->function == nullptr)
+		{
+			sysFunc = nullptr;
+		}
+		mSysFuncs.push_back(sysFunc);
+	}
+}
+
+void SheepScript::DecodeBytecode()
+{
+	mInstructions.clear();
+	mInstructionIndexes.assign(mBytecodeLength + 1, -1);
+	
+	// Decode each instruction and its argument (if any).
+	if(mBytecode != nullptr)
+	{
+		BinaryReader reader(mBytecode, mBytecodeLength);
+		while(reader.OK())
+		{
+			SheepDecodedInstruction decoded;
+			decoded.bytecodeOffset = reader.GetPosition();
+			
+			unsigned char instruction = reader.ReadUByte();
+			if(!reader.OK()) { break; }
+			decoded.instruction = static_cast<SheepInstruction>(instruction);
+			
+			// Read argument, if this instruction has one.
+			switch(decoded.instruction)
+			{
+			case SheepInstruction::CallSysFunctionV:
+			case SheepInstruction::CallSysFunctionI:
+			case SheepInstruction::CallSysFunctionF:
+			case SheepInstruction::CallSysFunctionS:
+			case SheepInstruction::Branch:
+			case SheepInstruction::BranchGoto:
+			case SheepInstruction::BranchIfZero:
+			case SheepInstruction::StoreI:
+			case SheepInstruction::StoreF:
+			case SheepInstruction::StoreS:
+			case SheepInstruction::LoadI:
+			case SheepInstruction::LoadF:
+			case SheepInstruction::LoadS:
+			case SheepInstruction::PushI:
+			case SheepInstruction::PushS:
+			case SheepInstruction::IToF:
+			case SheepInstruction::FToI:
+				decoded.intArg = reader.ReadInt();
+				break;
+			case SheepInstruction::PushF:
+				decoded.floatArg = reader.ReadFloat();
+				break;
+			default:
+				// Unknown instructions (including unused 0x0C) all use the unused 0x0C value, so the VM only needs to handle one invalid value.
+				// The original value is kept as the argument for error output.
+				if(instruction == 0x0C || instruction >= kSheepInstructionCount)
+				{
+					decoded.instruction = static_cast<SheepInstruction>(0x0C);
+					decoded.intArg = instruction;
+				}
+				break;
+			}
+			
+			// If the argument was cut off, the bytecode is truncated; just stop there.
+			if(!reader.OK()) { break; }
+			
+			mInstructionIndexes[decoded.bytecodeOffset] = static_cast<int>(mInstructions.size());
+			mInstructions.push_back(decoded);
+		}
+	}
+	
+	// Always end with a return, so execution can never run past the end (or branch to the end and keep going).
+	SheepDecodedInstruction end;
+	end.instruction = SheepInstruction::ReturnV;
+	end.bytecodeOffset = mBytecodeLength;
+	mInstructionIndexes[mBytecodeLength] = static_cast<int>(mInstructions.size());
+	mInstructions.push_back(end);
+	
+	// Convert branch targets from bytecode offsets to instruction indexes.
+	for(auto& decoded : mInstructions)
+	{
+		if(decoded.instruction == SheepInstruction::Branch ||
+		   decoded.instruction == SheepInstruction::BranchGoto ||
+		   decoded.instruction == SheepInstruction::BranchIfZero)
+		{
+			int targetIndex = GetInstructionIndex(decoded.intArg);
+			if(targetIndex < 0)
+			{
+				std::cout << "Invalid branch target " << decoded.intArg << " in " << mName << std::endl;
+				targetIndex = static_cast<int>(mInstructions.size()) - 1;
+			}
+			decoded.intArg = targetIndex;
+		}
+	}
+	
+	// Optimize the decoded instructions. Execution can start at the beginning or at any function.
+	mUnoptimizedInstructionCount = static_cast<int>(mInstructions.size());
+	std::vector<int> entryPoints = { 0 };
+	for(auto& entry : mFunctions)
+	{
+		int index = GetInstructionIndex(entry.second);
+		if(index >= 0)
+		{
+			entryPoints.push_back(index);
+		}
+	}
+	std::vector<int> indexMap = SheepOptimizer::Optimize(mInstructions, entryPoints);
+	
+	// Instruction indexes changed, so bytecode offsets need to map to the new indexes.
+	for(int& index : mInstructionIndexes)
+	{
+		if(index >= 0)
+		{
+			index = indexMap[index];
+		}
+	}
+}
@@ -14,7 +14,9 @@
 #include "SheepVM.h"
 
 class BinaryReader;
+class BinaryWriter;
 class SheepScriptBuilder;
+struct SysFuncDecl;
 
 struct SysImport
 {
@@ -43,30 +45,87 @@ struct SysImport
 	*/
 };
 
+// A string constant in a script.
+// The atom is created when the script loads, so system functions can use it without any string operations.
+struct SheepStringConst
+{
+	std::string text;
+	Atom atom;
+};
+
+// A single bytecode instruction, decoded ahead of time so the VM doesn't need to parse bytecode during execution.
+// Any argument is stored directly. For branches, the argument is the index of the target instruction (rather than a bytecode offset).
+struct SheepDecodedInstruction
+{
+	SheepInstruction instruction = SheepInstruction::SitnSpin;
+	
+	// For compare superinstructions, the comparison to do (e.g. IsEqualI).
+	SheepInstruction compare = SheepInstruction::SitnSpin;
+	
+	union
+	{
+		int intArg = 0;
+		float floatArg;
+	};
+	
+	// Extra arguments, only used by superinstructions.
+	int intArg2 = 0;
+	int intArg3 = 0;
+	
+	// Where this instruction was in the original bytecode (for debugging).
+	int bytecodeOffset = 0;
+};
+
 class SheepScript : public Asset
 {
 public:
     SheepScript(std::string name, char* data, int dataLength);
     SheepScript(const std::string& name, SheepScriptBuilder& builder);
+	
+	// Reads or writes a compiled script in the compact format used by the compiled script cache (see SheepScriptCache).
+	// This is not the same format as GK3's compiled SHP files.
+	SheepScript(const std::string& name, BinaryReader& reader);
+	~SheepScript();
+	
+	void Write(BinaryWriter& writer) const;
+	
+	// False if the script was read from compiled data that was truncated or corrupt. An invalid script has no functions or bytecode.
+	bool IsValid() const { return !mReadFailed; }
     
     SysImport* GetSysImport(int index);
+	
+	// Gets the system function declaration for an import, resolved when the script was loaded.
+	// Returns null if the index is invalid or the script imports a function that isn't declared.
+	SysFuncDecl* GetSysFunc(int index) const;
     
-    std::string* GetStringConst(int offset);
+    const SheepStringConst* GetStringConst(int offset) const;
     
-    std::vector<SheepValue> GetVariables() { return mVariables; }
+    const std::vector<SheepValue>& GetVariables() const { return mVariables; }
     
     int GetFunctionOffset(std::string functionName); 
     
     char* GetBytecode() { return mBytecode; }
     int GetBytecodeLength() { return mBytecodeLength; }
+	
+	// Bytecode decoded into instructions. There's always at least one instruction, and the last is always "ReturnV".
+	// Instructions are optimized after decoding, so this may be fewer instructions than the bytecode has.
+	const std::vector<SheepDecodedInstruction>& GetInstructions() const { return mInstructions; }
+	int GetUnoptimizedInstructionCount() const { return mUnoptimizedInstructionCount; }
+	
+	// Converts a bytecode offset (e.g. a function offset) to an instruction index. Returns -1 if not the start of an instruction.
+	int GetInstructionIndex(int bytecodeOffset) const;
     
     void Dump();
     
 private:
     std::vector<SysImport> mSysImports;
+	
+	// System function declarations for each import (same indexes as imports).
+	// Resolving on load means no lookups by name or hash are needed during execution.
+	std::vector<SysFuncDecl*> mSysFuncs;
     
     // String constants, keyed by data offset, since that's how bytecode identifies them.
-    std::unordered_map<int, std::string> mStringConsts;
+    std::unordered_map<int, SheepStringConst> mStringConsts;
     
     // Represents variable ordering, types, and default values.
     // Bytecode only cares about the index of the variable.
@@ -79,6 +138,17 @@ private:
     // Just pass this to the VM and aaaaawayyyyy we go!
     char* mBytecode = nullptr;
     int mBytecodeLength = 0;
+	
+	// The bytecode, decoded into instructions when the script is loaded.
+	std::vector<SheepDecodedInstruction> mInstructions;
+	int mUnoptimizedInstructionCount = 0;
+	
+	// Maps each bytecode offset to the index of the instruction starting there, or -1 if no instruction starts there.
+	// Has one more entry than the bytecode length, so the end of the bytecode is a valid offset (it maps to the final "ReturnV").
+	std::vector<int> mInstructionIndexes;
+	
+	// True if reading compiled data failed.
+	bool mReadFailed = false;
     
     void ParseFromData(char* data, int dataLength);
     void ParseSysImportsSection(BinaryReader& reader);
@@ -86,4 +156,9 @@ private:
     void ParseVariablesSection(BinaryReader& reader);
     void ParseFunctionsSection(BinaryReader& reader);
     void ParseCodeSection(BinaryReader& reader);
+	
+	bool Read(BinaryReader& reader);
+	
+	void ResolveSysImports();
+	void DecodeBytecode();
 };
@@ -0,0 +1,139 @@
+//
+// SheepScriptCache.cpp
+//
+// Clark Kromenaker
+//
+#include "SheepScriptCache.h"
+
+#include <iostream>
+
+#include "BinaryReader.h"
+#include "BinaryWriter.h"
+#include "SheepScript.h"
+
+/*static*/ const std::string SheepScriptCache::kIdentifier = "GK3ShpCache";
+/*static*/ const int SheepScriptCache::kVersion = 1;
+
+namespace
+{
+	// Reads a length-prefixed block of bytes. Unlike BinaryReader::ReadString, this keeps any null bytes.
+	bool ReadBlock(BinaryReader& reader, std::string& outBlock)
+	{
+		int length = reader.ReadInt();
+		if(!reader.OK() || length < 0 || length > reader.GetRemaining()) { return false; }
+
+		outBlock.resize(length);
+		if(length > 0)
+		{
+			reader.Read(&outBlock[0], length);
+		}
+		return reader.OK();
+	}
+
+	void WriteBlock(BinaryWriter& writer, const std::string& block)
+	{
+		writer.WriteInt(static_cast<int>(block.size()));
+		writer.WriteString(block);
+	}
+}
+
+bool SheepScriptCache::Load(const std::string& filePath)
+{
+	mEntries.clear();
+	mDirty = false;
+
+	BinaryReader reader(filePath);
+	if(!reader.OK()) { return false; }
+
+	// Make sure this is a cache file, and the version we expect.
+	// If the version is different, the cache will just be rebuilt as scripts are compiled.
+	std::string identifier = reader.ReadString(static_cast<int>(kIdentifier.size()));
+	int version = reader.ReadInt();
+	if(identifier != kIdentifier || version != kVersion)
+	{
+		std::cout << "Sheep cache " << filePath << " is out of date - ignoring it." << std::endl;
+		return false;
+	}
+
+	// Each entry is at least two lengths, so a count bigger than that means the file is corrupt.
+	int entryCount = reader.ReadInt();
+	if(entryCount < 0 || entryCount > reader.GetRemaining() / 8)
+	{
+		std::cout << "Sheep cache " << filePath << " is corrupt - ignoring it." << std::endl;
+		return false;
+	}
+	for(int i = 0; i < entryCount; i++)
+	{
+		Entry entry;
+		if(!ReadBlock(reader, entry.sheep) || !ReadBlock(reader, entry.data))
+		{
+			std::cout << "Sheep cache " << filePath << " is truncated - ignoring it." << std::endl;
+			mEntries.clear();
+			return false;
+		}
+		mEntries[Hash(entry.sheep)] = std::move(entry);
+	}
+	return true;
+}
+
+bool SheepScriptCache::Save(const std::string& filePath)
+{
+	BinaryWriter writer(filePath.c_str());
+	if(!writer.OK()) { return false; }
+
+	writer.WriteString(kIdentifier);
+	writer.WriteInt(kVersion);
+	writer.WriteInt(static_cast<int>(mEntries.size()));
+	for(auto& entry : mEntries)
+	{
+		WriteBlock(writer, entry.second.sheep);
+		WriteBlock(writer, entry.second.data);
+	}
+
+	if(!writer.OK()) { return false; }
+	mDirty = false;
+	return true;
+}
+
+SheepScript* SheepScriptCache::Create(const std::string& name, const std::string& sheep) const
+{
+	auto it = mEntries.find(Hash(sheep));
+	if(it == mEntries.end() || it->second.sheep != sheep) { return nullptr; }
+
+	const std::string& data = it->second.data;
+	BinaryReader reader(data.data(), static_cast<unsigned int>(data.size()));
+	SheepScript* script = new SheepScript(name, reader);
+	
+	// If the cached data is bad, return null so the script is compiled again (which replaces the bad data).
+	if(!script->IsValid())
+	{
+		delete script;
+		return nullptr;
+	}
+	return script;
+}
+
+void SheepScriptCache::Add(const std::string& sheep, const SheepScript* script)
+{
+	if(script == nullptr) { return; }
+
+	BinaryWriter writer;
+	script->Write(writer);
+
+	Entry& entry = mEntries[Hash(sheep)];
+	entry.sheep = sheep;
+	entry.data = writer.GetMemory();
+	mDirty = true;
+}
+
+/*static*/ U64 SheepScriptCache::Hash(const std::string& sheep)
+{
+	// FNV-1a, 64-bit.
+	U64 hash = 14695981039346656037ull;
+	for(char c : sheep)
+	{
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
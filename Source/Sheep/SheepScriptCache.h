@@ -0,0 +1,59 @@
+//
+// SheepScriptCache.h
+//
+// Clark Kromenaker
+//
+// Compiled sheep scripts, keyed by their source text and saved to disk.
+//
+// Game assets contain thousands of small sheep snippets (NVC case logic, SIF conditions, etc).
+// Compiling them requires running the full compiler, every time an asset is loaded.
+// With this cache, a snippet is only compiled once - after that, the compiled script is loaded from the cache.
+//
+#pragma once
+#include <string>
+#include <unordered_map>
+
+#include "Atomics.h"
+
+class SheepScript;
+
+class SheepScriptCache
+{
+public:
+	// Reads or writes the cache file. A cache file from a different version is ignored.
+	bool Load(const std::string& filePath);
+	bool Save(const std::string& filePath);
+
+	// Creates a new script from the cache, if the sheep text has been compiled before. Returns null if not, or if the cached data is invalid.
+	SheepScript* Create(const std::string& name, const std::string& sheep) const;
+
+	// Adds a compiled script to the cache.
+	void Add(const std::string& sheep, const SheepScript* script);
+
+	// True if the cache has changed since it was loaded or saved.
+	bool IsDirty() const { return mDirty; }
+
+	int GetCount() const { return static_cast<int>(mEntries.size()); }
+
+private:
+	// Identifies cache files, and the version of the cache format.
+	// Increment the version whenever the compiler or compiled script format changes, so old caches are thrown away.
+	static const std::string kIdentifier;
+	static const int kVersion;
+
+	struct Entry
+	{
+		// The source text, to detect hash collisions.
+		std::string sheep;
+
+		// Compiled script data (see SheepScript::Write).
+		std::string data;
+	};
+
+	// Entries, keyed by hash of the source text.
+	std::unordered_map<U64, Entry> mEntries;
+
+	bool mDirty = false;
+
+	static U64 Hash(const std::string& sheep);
+};
@@ -42,19 +42,21 @@ void SheepStack::PushStringOffset(int val)
 	
 	mStack[mStackSize - 1].type = SheepValueType::String;
 	mStack[mStackSize - 1].intValue = val;
+	mStack[mStackSize - 1].stringAtom = Atom();
 	
 	#ifdef SHEEP_DEBUG
 	std::cout << "SHEEP STACK: Push 1 (Stack Size = " << mStackSize << ")" << std::endl;
 	#endif
 }
 
-void SheepStack::PushString(const char* str)
+void SheepStack::PushString(const char* str, Atom atom)
 {
 	mStackSize++;
 	assert(mStackSize < kMaxStackSize);
 	
 	mStack[mStackSize - 1].type = SheepValueType::String;
 	mStack[mStackSize - 1].stringValue = str;
+	mStack[mStackSize - 1].stringAtom = atom;
 	
 	#ifdef SHEEP_DEBUG
 	std::cout << "SHEEP STACK: Push 1 (Stack Size = " << mStackSize << ")" << std::endl;
@@ -16,6 +16,24 @@ std::string SheepThread::GetName() const
 	return ":" + mFunctionName;
 }
 
+std::function<void()> SheepThread::AddWait()
+{
+	if(!mInWaitBlock) { return nullptr; }
+	mWaitCounter++;
+	
+	// This thread may finish and be reused before the wait completes (e.g. if execution is stopped early).
+	// So, use the handle to make sure it's still the same thread before notifying it.
+	SheepVM* vm = mVirtualMachine;
+	SheepThreadHandle handle = mHandle;
+	return [vm, handle]() {
+		SheepThread* thread = vm->GetThread(handle);
+		if(thread != nullptr)
+		{
+			thread->OnWaitCompleted();
+		}
+	};
+}
+
 void SheepThread::OnWaitCompleted()
 {
 	assert(mInWaitBlock);
@@ -16,19 +16,30 @@
 class SheepVM;
 class SheepInstance;
 
+// Identifies a thread in the VM's thread pool.
+// Threads are reused once they finish, so the generation is used to detect a handle to a thread that has since finished.
+struct SheepThreadHandle
+{
+	int index = -1;
+	unsigned int generation = 0;
+};
+
 struct SheepThread
 {
 	// Reference to this thread's virtual machine.
 	SheepVM* mVirtualMachine = nullptr;
 	
+	// This thread's handle in the VM's thread pool.
+	SheepThreadHandle mHandle;
+	
 	// The sheep attached to this thread.
 	SheepInstance* mContext = nullptr;
 	
 	// Each thread has its own stack.
 	SheepStack mStack;
 	
-	// Current code offset for attached sheep (aka the instruction pointer).
-	int mCodeOffset = 0;
+	// Index of the next instruction to execute in the attached sheep's decoded instructions (aka the instruction pointer).
+	int mInstructionIndex = 0;
 	
 	// Info about the function being executed (mainly for debugging).
 	std::string mFunctionName;
@@ -53,12 +64,7 @@ struct SheepThread
 	
 	std::string GetName() const;
 	
-	std::function<void()> AddWait()
-	{
-		if(!mInWaitBlock) { return nullptr; }
-		mWaitCounter++;
-		return std::bind(&SheepThread::OnWaitCompleted, this);
-	}
+	std::function<void()> AddWait();
 	
 private:
 	void OnWaitCompleted();
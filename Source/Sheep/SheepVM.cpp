@@ -7,15 +7,31 @@
 
 #include <iostream>
 
-#include "BinaryReader.h"
+#include "ConditionCache.h"
 #include "GMath.h"
 #include "SheepAPI.h"
+#include "SheepOptimizer.h"
 #include "SheepScript.h"
 #include "Services.h"
 #include "StringUtil.h"
 
 //#define SHEEP_DEBUG
 
+// Uncomment to log each thread's lifecycle (start, block, release, exit) to the "SheepMachine" report stream.
+// Off by default, since building these messages costs a lot more than running a short script.
+//#define SHEEP_TRACE
+
+#ifdef SHEEP_TRACE
+	#define SHEEP_TRACE_LOG(thread, message) Services::GetReports()->Log("SheepMachine", "Sheep " + (thread)->GetName() + (message))
+#else
+	#define SHEEP_TRACE_LOG(thread, message)
+#endif
+
+// GCC and Clang support "computed goto", which allows for faster instruction dispatch.
+#if defined(__GNUC__) || defined(__clang__)
+	#define SHEEP_COMPUTED_GOTO
+#endif
+
 std::string SheepInstance::GetName()
 {
 	if(mSheepScript != nullptr)
@@ -25,15 +41,26 @@ std::string SheepInstance::GetName()
 	return "";
 }
 
-SheepVM::~SheepVM()
+const char* SheepInstance::StoreString(const std::string& str)
 {
-	for(auto& instance : mSheepInstances)
-	{
-		delete instance;
-	}
-	for(auto& thread : mSheepThreads)
+	return mStrings.insert(str).first->c_str();
+}
+
+void SheepInstance::TrimStrings()
+{
+	auto it = mStrings.begin();
+	while(it != mStrings.end())
 	{
-		delete thread;
+		bool inUse = false;
+		for(auto& variable : mVariables)
+		{
+			if(variable.type == SheepValueType::String && variable.stringValue == it->c_str())
+			{
+				inUse = true;
+				break;
+			}
+		}
+		it = inUse ? std::next(it) : mStrings.erase(it);
 	}
 }
 
@@ -78,6 +105,25 @@ void SheepVM::Execute(SheepScript* script, int bytecodeOffset, std::function<voi
 }
 
 bool SheepVM::Evaluate(SheepScript* script, int n, int v)
+{
+	// If this condition was evaluated before, and nothing it read has changed since, the result is the same.
+	bool result = false;
+	if(ConditionCache::TryGet(script, n, v, result))
+	{
+		return result;
+	}
+	
+	// Otherwise, evaluate it for real, keeping track of what it reads.
+	bool recording = ConditionCache::BeginRecord();
+	result = EvaluateInternal(script, n, v);
+	if(recording)
+	{
+		ConditionCache::EndRecord(script, n, v, result);
+	}
+	return result;
+}
+
+bool SheepVM::EvaluateInternal(SheepScript* script, int n, int v)
 {
 	// Get an execution context.
 	SheepInstance* instance = GetInstance(script);
@@ -121,13 +167,13 @@ bool SheepVM::Evaluate(SheepScript* script, int n, int v)
     return false;
 }
 
-bool SheepVM::IsAnyRunning() const
+SheepThread* SheepVM::GetThread(const SheepThreadHandle& handle)
 {
-	for(auto& thread : mSheepThreads)
-	{
-		if(thread->mRunning) { return true; }
-	}
-	return false;
+	if(handle.index < 0 || handle.index >= mThreadPool.size()) { return nullptr; }
+	
+	// If generation doesn't match, the thread this handle referred to has finished.
+	SheepThread* thread = &mThreadPool[handle.index];
+	return thread->mHandle.generation == handle.generation ? thread : nullptr;
 }
 
 SheepInstance* SheepVM::GetInstance(SheepScript* script)
@@ -138,101 +184,146 @@ SheepInstance* SheepVM::GetInstance(SheepScript* script)
 	// If an instance already exists for this sheep, just reuse that one.
 	// This *might* be important b/c we want variables in the same script to be shared.
 	// Ex: call IncCounter$ in same sheep, the counter variable should still be incremented after returning.
-	for(auto& instance : mSheepInstances)
+	auto it = mInstancesByScript.find(script);
+	if(it != mInstancesByScript.end())
 	{
-		if(instance->mSheepScript == script)
-		{
-			return instance;
-		}
+		return it->second;
 	}
 	
 	// Try to reuse an execution context that is no longer being used.
+	// Instances in the free list may have been used again since being added - skip any of those.
 	SheepInstance* context = nullptr;
-	for(auto& instance : mSheepInstances)
+	while(context == nullptr && !mFreeInstances.empty())
 	{
+		SheepInstance* instance = mFreeInstances.back();
+		mFreeInstances.pop_back();
+		instance->mInFreeList = false;
 		if(instance->mReferenceCount == 0)
 		{
 			context = instance;
-			break;
 		}
 	}
 	
 	// Create a new instance if we have to.
 	if(context == nullptr)
 	{
-		context = new SheepInstance();
-		mSheepInstances.push_back(context);
+		mInstancePool.emplace_back();
+		context = &mInstancePool.back();
+	}
+	
+	// Any previous script no longer has an instance.
+	if(context->mSheepScript != nullptr)
+	{
+		mInstancesByScript.erase(context->mSheepScript);
 	}
 	context->mSheepScript = script;
+	mInstancesByScript[script] = context;
 	
 	// Create copy of variables for assignment during execution.
+	// Since instances are reused, this usually doesn't need to allocate.
 	context->mVariables = script->GetVariables();
+	
+	// Stored strings were only used by the previous script's variables.
+	context->mStrings.clear();
 	return context;
 }
 
-SheepThread* SheepVM::GetThread()
+void SheepVM::ReleaseInstance(SheepInstance* instance)
+{
+	instance->mReferenceCount--;
+	
+	// Once not referenced, the instance can be reused.
+	// But it stays associated with its script until then, in case the same script executes again.
+	if(instance->mReferenceCount == 0 && !instance->mInFreeList)
+	{
+		instance->mInFreeList = true;
+		mFreeInstances.push_back(instance);
+	}
+}
+
+SheepThread* SheepVM::AcquireThread()
 {
 	// Recycle a previously used thread, if possible.
-	SheepThread* useThread = nullptr;
-	for(auto& thread : mSheepThreads)
+	if(!mFreeThreads.empty())
 	{
-		if(!thread->mRunning)
-		{
-			useThread = thread;
-			break;
-		}
+		SheepThread* thread = &mThreadPool[mFreeThreads.back()];
+		mFreeThreads.pop_back();
+		
+		// Get rid of anything left on the stack by the last execution.
+		thread->mStack.Clear();
+		return thread;
 	}
 	
 	// If needed, create a new thread instead.
-	if(useThread == nullptr)
-	{
-		useThread = new SheepThread();
-		useThread->mVirtualMachine = this;
-		mSheepThreads.push_back(useThread);
-	}
-	return useThread;
+	mThreadPool.emplace_back();
+	SheepThread* thread = &mThreadPool.back();
+	thread->mVirtualMachine = this;
+	thread->mHandle.index = static_cast<int>(mThreadPool.size()) - 1;
+	return thread;
 }
 
-Value SheepVM::CallSysFunc(SheepThread* thread, SysImport* sysImport)
+void SheepVM::ReleaseThread(SheepThread* thread)
 {
-	// Retrieve system function declaration for the system function import.
-	// We need the full declaration to know whether this is a waitable function!
-	SysFuncDecl* sysFunc = GetSysFuncDecl(sysImport);
+	// Invalidate any handles to this thread.
+	thread->mHandle.generation++;
+	
+	// Reset state, but leave the stack alone - Evaluate reads the result after the thread finishes.
+	thread->mContext = nullptr;
+	thread->mWaitCallback = nullptr;
+	thread->mWaitCounter = 0;
+	thread->mInWaitBlock = false;
+	thread->mBlocked = false;
+	mFreeThreads.push_back(thread->mHandle.index);
+}
+
+template<bool kProfile>
+SheepValue SheepVM::CallSysFunc(SheepThread* thread, SysImport* sysImport, SysFuncDecl* sysFunc, int argCount)
+{
+	// The system function declaration was resolved when the script was loaded.
+	// If it's null, the script uses a function that we don't know about.
 	if(sysFunc == nullptr)
 	{
 		std::cout << "Sheep uses undeclared function " << sysImport->name << std::endl;
-		return Value(0);
+		thread->mStack.Pop(argCount);
+		return SheepValue(0);
 	}
 	
-	// Number on top of stack is argument count.
-	// Make sure it matches the argument count from the system function declaration.
-	int argCount = thread->mStack.Pop().intValue;
+	// Make sure the argument count matches the argument count from the system function declaration.
 	assert(argCount == sysFunc->argumentTypes.size());
 	
-	// Retrieve the arguments, of the expected types, from the stack.
-	std::vector<Value> args;
+	// The arguments are on the top of the stack, in order.
+	// Rather than copying them, the system function reads them straight from the stack.
+	// Since they're about to be popped anyway, convert them in place to the types the function expects.
+	SheepValue* args = argCount > 0 ? &thread->mStack.Peek(argCount - 1) : nullptr;
 	for(int i = 0; i < argCount; i++)
 	{
-		SheepValue& sheepValue = thread->mStack.Peek(argCount - 1 - i);
-		//SheepValue sheepValue = mStack[mStackSize - (argCount - i)];
+		SheepValue& arg = args[i];
 		int argType = sysFunc->argumentTypes[i];
 		switch(argType)
 		{
 		case 1:
-			args.push_back(sheepValue.GetInt());
+			if(arg.type != SheepValueType::Int)
+			{
+				arg = SheepValue(arg.GetInt());
+			}
 			break;
 		case 2:
-			args.push_back(sheepValue.GetFloat());
+			if(arg.type != SheepValueType::Float)
+			{
+				arg = SheepValue(arg.GetFloat());
+			}
 			break;
 		case 3:
-			args.push_back(sheepValue.GetString());
+			if(arg.type != SheepValueType::String)
+			{
+				arg = SheepValue(thread->mContext->StoreString(arg.GetString()));
+			}
 			break;
 		default:
 			std::cout << "Invalid arg type: " << argType << std::endl;
 			break;
 		}
 	}
-	thread->mStack.Pop(argCount);
 	
 	/*
 	{
@@ -240,19 +331,7 @@ Value SheepVM::CallSysFunc(SheepThread* thread, SysImport* sysImport)
 		std::cout << "SysFunc " << sysFunc->name << "(";
 		for(int i = 0; i < argCount; i++)
 		{
-			switch(sysFunc->argumentTypes[i])
-			{
-			case 1:
-				std::cout << args[i].to<int>();
-				break;
-			case 2:
-				std::cout << args[i].to<float>();
-				break;
-			case 3:
-				std::cout << args[i].to<std::string>();
-				break;
-			}
-
+			std::cout << args[i].GetString();
 			if(i < argCount - 1)
 			{
 				std::cout << ", ";
@@ -262,35 +341,29 @@ Value SheepVM::CallSysFunc(SheepThread* thread, SysImport* sysImport)
 	}
 	*/
 	
-	// Based on argument count, call the appropriate function variant.
-	Value v = Value(0);
-	switch(argCount)
+	// Call the function directly - no need to look it up.
+	// If a condition is being recorded for the cache, the function must report what it reads.
+	SheepProfiler::Clock::time_point startTime;
+	if(kProfile)
+	{
+		startTime = SheepProfiler::Now();
+	}
+	SheepValue v;
+	if(ConditionCache::IsRecording())
+	{
+		ConditionCache::BeginCall();
+		v = sysFunc->function(args);
+		ConditionCache::EndCall();
+	}
+	else
 	{
-	case 0:
-		v = ::CallSysFunc(sysFunc->name);
-		break;
-	case 1:
-		v = ::CallSysFunc(sysFunc->name, args[0]);
-		break;
-	case 2:
-		v = ::CallSysFunc(sysFunc->name, args[0], args[1]);
-		break;
-	case 3:
-		v = ::CallSysFunc(sysFunc->name, args[0], args[1], args[2]);
-		break;
-	case 4:
-		v = ::CallSysFunc(sysFunc->name, args[0], args[1], args[2], args[3]);
-		break;
-	case 5:
-		v = ::CallSysFunc(sysFunc->name, args[0], args[1], args[2], args[3], args[4]);
-		break;
-	case 6:
-		v = ::CallSysFunc(sysFunc->name, args[0], args[1], args[2], args[3], args[4], args[5]);
-		break;
-	default:
-		std::cout << "SheepVM: Unimplemented arg count: " << argCount << std::endl;
-		break;
+		v = sysFunc->function(args);
 	}
+	if(kProfile)
+	{
+		mProfiler.RecordSysFunc(sysFunc, startTime, SheepProfiler::Now());
+	}
+	thread->mStack.Pop(argCount);
 	
 	// Output a general execution exception if we encountered a problem in the sys func call.
 	if(mExecutionError)
@@ -323,15 +396,30 @@ SheepThread* SheepVM::ExecuteInternal(SheepInstance* instance, int bytecodeOffse
 	}
 	
 	// Create a sheep thread to perform the execution.
-	SheepThread* thread = GetThread();
+	SheepThread* thread = AcquireThread();
 	thread->mContext = instance;
 	thread->mWaitCallback = finishCallback;
-	thread->mCodeOffset = bytecodeOffset;
+	
+	// Convert bytecode offset to an index in the script's decoded instructions.
+	// If the offset is bad, use the last instruction (always a return), so the thread just ends immediately.
+	thread->mInstructionIndex = instance->mSheepScript->GetInstructionIndex(bytecodeOffset);
+	if(thread->mInstructionIndex < 0)
+	{
+		std::cout << "Invalid bytecode offset " << bytecodeOffset << " in " << instance->GetName() << std::endl;
+		thread->mInstructionIndex = static_cast<int>(instance->mSheepScript->GetInstructions().size()) - 1;
+	}
 	
 	// Save name and start offset (for debugging/info).
 	thread->mFunctionName = functionName;
 	thread->mFunctionStartOffset = bytecodeOffset;
 	
+	// If no other thread is using the instance, no stack holds its strings anymore. Only keep the ones that variables still point to.
+	// This isn't done when the last thread finishes, since the finished thread's result may still be read (see EvaluateInternal).
+	if(instance->mReferenceCount == 0)
+	{
+		instance->TrimStrings();
+	}
+	
 	// The thread is using this execution context.
 	instance->mReferenceCount++;
 	
@@ -341,6 +429,21 @@ SheepThread* SheepVM::ExecuteInternal(SheepInstance* instance, int bytecodeOffse
 }
 
 void SheepVM::ExecuteInternal(SheepThread* thread)
+{
+	// Profiling needs extra bookkeeping per instruction, so it uses its own copy of the interpreter.
+	// When profiling is off, this branch is all it costs.
+	if(mProfiler.IsEnabled())
+	{
+		ExecuteThread<true>(thread);
+	}
+	else
+	{
+		ExecuteThread<false>(thread);
+	}
+}
+
+template<bool kProfile>
+void SheepVM::ExecuteThread(SheepThread* thread)
 {
 	// Store previous thread and set passed in thead as the currently executing thread.
 	SheepThread* prevThread = mCurrentThread;
@@ -350,170 +453,207 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 	if(!thread->mRunning)
 	{
 		thread->mRunning = true;
-		Services::GetReports()->Log("SheepMachine", "Sheep " + thread->GetName() + " created and starting");
+		SHEEP_TRACE_LOG(thread, " created and starting");
 	}
 	else if(thread->mInWaitBlock)
 	{
 		thread->mBlocked = false;
 		thread->mInWaitBlock = false;
-		Services::GetReports()->Log("SheepMachine", "Sheep " + thread->GetName() + " released at line -1");
+		SHEEP_TRACE_LOG(thread, " released at line -1");
 	}
 	
 	// Get instance/script we'll be using.
 	SheepInstance* instance = thread->mContext;
 	SheepScript* script = instance->mSheepScript;
 	
-    // Get bytecode and generate a binary reader for easier parsing.
-    char* bytecode = script->GetBytecode();
-    int bytecodeLength = script->GetBytecodeLength();
-    
-    // Create reader for the bytecode.
-    BinaryReader reader(bytecode, bytecodeLength);
-    if(!reader.OK()) { return; }
-    
-    // Skip ahead to desired offset.
-    reader.Skip(thread->mCodeOffset);
-    
-    // Read each byte in turn, interpret and execute the instruction.
-	bool stopReading = false;
-	while(!stopReading)
-    {
-		// Read instruction.
-        char instruction = reader.ReadUByte();
-		
-		// Break when read instruction fails (perhaps due to reading past end of file/mem stream).
-		if(!reader.OK()) { break; }
-		
-		// Perform the action associated with each instruction.
-        switch((SheepInstruction)instruction)
-        {
-            case SheepInstruction::SitnSpin:
+	// Get the script's decoded instructions. Decoding was done when the script was loaded, so we can just execute.
+	// Scripts always end with a "ReturnV" instruction, so we can't run off the end.
+	const std::vector<SheepDecodedInstruction>& instructions = script->GetInstructions();
+	const SheepDecodedInstruction* instruction = nullptr;
+	int pc = thread->mInstructionIndex;
+	
+	// When profiling, count instructions executed and time the whole run.
+	int instructionCount = 0;
+	SheepProfiler::Clock::time_point startTime;
+	if(kProfile)
+	{
+		startTime = SheepProfiler::Now();
+	}
+	
+	// Execute each instruction in turn.
+	// When possible, use "threaded" dispatch: each instruction jumps directly to the next instruction's code,
+	// rather than going back through a loop/switch. This is a lot friendlier to the CPU's branch predictor.
+	// With other compilers, we fall back to a switch inside a loop.
+	#ifdef SHEEP_COMPUTED_GOTO
+	static const void* dispatchTable[] = {
+		&&Label_SitnSpin, &&Label_Yield,
+		&&Label_CallSysFunctionV, &&Label_CallSysFunctionI, &&Label_CallSysFunctionF, &&Label_CallSysFunctionS,
+		&&Label_Branch, &&Label_BranchGoto, &&Label_BranchIfZero,
+		&&Label_BeginWait, &&Label_EndWait, &&Label_ReturnV, &&Label_Invalid,
+		&&Label_StoreI, &&Label_StoreF, &&Label_StoreS, &&Label_LoadI, &&Label_LoadF, &&Label_LoadS,
+		&&Label_PushI, &&Label_PushF, &&Label_PushS, &&Label_Pop,
+		&&Label_AddI, &&Label_AddF, &&Label_SubtractI, &&Label_SubtractF,
+		&&Label_MultiplyI, &&Label_MultiplyF, &&Label_DivideI, &&Label_DivideF, &&Label_NegateI, &&Label_NegateF,
+		&&Label_IsEqualI, &&Label_IsEqualF, &&Label_IsNotEqualI, &&Label_IsNotEqualF,
+		&&Label_IsGreaterI, &&Label_IsGreaterF, &&Label_IsLessI, &&Label_IsLessF,
+		&&Label_IsGreaterEqualI, &&Label_IsGreaterEqualF, &&Label_IsLessEqualI, &&Label_IsLessEqualF,
+		&&Label_IToF, &&Label_FToI, &&Label_Modulo, &&Label_And, &&Label_Or, &&Label_Not,
+		&&Label_GetString, &&Label_DebugBreakpoint,
+		&&Label_PushStringConst,
+		&&Label_CallSysFunctionArgsV, &&Label_CallSysFunctionArgsI, &&Label_CallSysFunctionArgsF, &&Label_CallSysFunctionArgsS,
+		&&Label_CompareConstI, &&Label_LoadCompareConstI, &&Label_CompareConstBranchI, &&Label_LoadCompareConstBranchI
+	};
+	static_assert(sizeof(dispatchTable) / sizeof(dispatchTable[0]) == kSheepDecodedInstructionCount, "Dispatch table doesn't match instruction count!");
+	#define SHEEP_CASE(name) Label_##name:
+	#define SHEEP_DEFAULT Label_Invalid:
+	#define SHEEP_NEXT() if(kProfile) { ++instructionCount; } instruction = &instructions[pc++]; goto *dispatchTable[static_cast<int>(instruction->instruction)]
+	SHEEP_NEXT();
+	{
+	#else
+	#define SHEEP_CASE(name) case SheepInstruction::name:
+	#define SHEEP_DEFAULT default:
+	#define SHEEP_NEXT() continue
+	while(true)
+	{
+		if(kProfile) { ++instructionCount; }
+		instruction = &instructions[pc++];
+		switch(instruction->instruction)
+		{
+	#endif
+            SHEEP_CASE(SitnSpin)
             {
                 // No-op; do nothing.
 				#ifdef SHEEP_DEBUG
 				std::cout << "SitnSpin" << std::endl;
 				#endif
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::Yield:
+            SHEEP_CASE(Yield)
             {
                 // Not totally sure what this instruction does.
 				// Maybe it yields sheep execution until next frame?
 				#ifdef SHEEP_DEBUG
 				std::cout << "Yield" << std::endl;
 				#endif
-				stopReading = true;
-                break;
+				goto StopExecution;
             }
-            case SheepInstruction::CallSysFunctionV:
+            SHEEP_CASE(CallSysFunctionV)
             {
-                int functionIndex = reader.ReadInt();
-                SysImport* sysFunc = script->GetSysImport(functionIndex);
-				if(sysFunc == nullptr)
+                int functionIndex = instruction->intArg;
+                SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
 				{
 					std::cout << "Invalid function index " << functionIndex << std::endl;
-					break;
+					SHEEP_NEXT();
 				}
 				
 				#ifdef SHEEP_DEBUG
-				std::cout << "CallSysFuncV " << sysFunc->name << std::endl;
+				std::cout << "CallSysFuncV " << sysImport->name << std::endl;
 				#endif
 				
 				// Execute the system function.
-                Value value = CallSysFunc(thread, sysFunc);
+				// Number on top of stack is argument count.
+				int argCount = thread->mStack.Pop().intValue;
+                SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), argCount);
 				
 				// Though this is void return, we still push type of "shpvoid" onto stack.
 				// The compiler generates an extra "Pop" instruction after a CallSysFunctionV.
 				// This matches how the original game's compiler generated instructions!
-				thread->mStack.PushInt(value.to<shpvoid>());
-                break;
+				thread->mStack.PushInt(value.GetInt());
+                SHEEP_NEXT();
             }
-            case SheepInstruction::CallSysFunctionI:
+            SHEEP_CASE(CallSysFunctionI)
             {
-                int functionIndex = reader.ReadInt();
-                SysImport* sysFunc = script->GetSysImport(functionIndex);
-				if(sysFunc == nullptr)
+                int functionIndex = instruction->intArg;
+                SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
 				{
 					std::cout << "Invalid function index " << functionIndex << std::endl;
-					break;
+					SHEEP_NEXT();
 				}
 				
 				#ifdef SHEEP_DEBUG
-				std::cout << "CallSysFuncI " << sysFunc->name << std::endl;
+				std::cout << "CallSysFuncI " << sysImport->name << std::endl;
 				#endif
 				
 				// Execute the system function.
-                Value value = CallSysFunc(thread, sysFunc);
+				// Number on top of stack is argument count.
+				int argCount = thread->mStack.Pop().intValue;
+                SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), argCount);
 				
 				// Push the int result onto the stack.
-				thread->mStack.PushInt(value.to<int>());
-                break;
+				thread->mStack.PushInt(value.GetInt());
+                SHEEP_NEXT();
             }
-            case SheepInstruction::CallSysFunctionF:
+            SHEEP_CASE(CallSysFunctionF)
             {
-                int functionIndex = reader.ReadInt();
-                SysImport* sysFunc = script->GetSysImport(functionIndex);
-				if(sysFunc == nullptr)
+                int functionIndex = instruction->intArg;
+                SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
 				{
 					std::cout << "Invalid function index " << functionIndex << std::endl;
-					break;
+					SHEEP_NEXT();
 				}
 				
 				#ifdef SHEEP_DEBUG
-				std::cout << "CallSysFuncF " << sysFunc->name << std::endl;
+				std::cout << "CallSysFuncF " << sysImport->name << std::endl;
 				#endif
 				
 				// Execute the system function.
-                Value value = CallSysFunc(thread, sysFunc);
+				// Number on top of stack is argument count.
+				int argCount = thread->mStack.Pop().intValue;
+                SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), argCount);
 				
 				// Push the float result onto the stack.
-				thread->mStack.PushFloat(value.to<float>());
-                break;
+				thread->mStack.PushFloat(value.GetFloat());
+                SHEEP_NEXT();
             }
-            case SheepInstruction::CallSysFunctionS:
+            SHEEP_CASE(CallSysFunctionS)
             {
-                int functionIndex = reader.ReadInt();
-                SysImport* sysFunc = script->GetSysImport(functionIndex);
-				if(sysFunc == nullptr)
+                int functionIndex = instruction->intArg;
+                SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
 				{
 					std::cout << "Invalid function index " << functionIndex << std::endl;
-					break;
+					SHEEP_NEXT();
 				}
 				
 				#ifdef SHEEP_DEBUG
-				std::cout << "CallSysFuncS " << sysFunc->name << std::endl;
+				std::cout << "CallSysFuncS " << sysImport->name << std::endl;
 				#endif
 				
 				// Execute the system function.
-                Value value = CallSysFunc(thread, sysFunc);
+				// Number on top of stack is argument count.
+				int argCount = thread->mStack.Pop().intValue;
+                SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), argCount);
 				
 				// Push the string result onto the stack.
-				thread->mStack.PushString(value.to<std::string>().c_str()); //TODO: Seems like this could cause problems? Where is value's string coming from? What if it is deallocated???
-                break;
+				// A returned string is only valid until the next system function returns one, so the instance keeps a copy.
+				thread->mStack.PushString(thread->mContext->StoreString(value.GetString()));
+                SHEEP_NEXT();
             }
-            case SheepInstruction::Branch:
+            SHEEP_CASE(Branch)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "Branch" << std::endl;
 				#endif
-				int branchAddress = reader.ReadInt();
-				reader.Seek(branchAddress);
-                break;
+				int branchAddress = instruction->intArg;
+				pc = branchAddress;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::BranchGoto:
+            SHEEP_CASE(BranchGoto)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "BranchGoto" << std::endl;
 				#endif
-				int branchAddress = reader.ReadInt();
-				reader.Seek(branchAddress);
-                break;
+				int branchAddress = instruction->intArg;
+				pc = branchAddress;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::BranchIfZero:
+            SHEEP_CASE(BranchIfZero)
             {
-				// Regardless of whether we do branch, we need to pull
-				// the branch address from the reader.
-				int branchAddress = reader.ReadInt();
+				// Branch targets were converted to instruction indexes when the script was loaded.
+				int branchAddress = instruction->intArg;
 				
 				#ifdef SHEEP_DEBUG
 				std::cout << "BranchIfZero" << std::endl;
@@ -524,19 +664,19 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				SheepValue& result = thread->mStack.Pop();
 				if(result.intValue == 0)
 				{
-					reader.Seek(branchAddress);
+					pc = branchAddress;
 				}
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::BeginWait:
+            SHEEP_CASE(BeginWait)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "BeginWait" << std::endl;
 				#endif
 				thread->mInWaitBlock = true;
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::EndWait:
+            SHEEP_CASE(EndWait)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "EndWait " << thread->mInWaitBlock << ", " << thread->mWaitCounter << std::endl;
@@ -546,15 +686,15 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				if(thread->mWaitCounter > 0)
 				{
 					thread->mBlocked = true;
-					stopReading = true;
+					goto StopExecution;
 				}
 				else
 				{
 					thread->mInWaitBlock = false;
 				}
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::ReturnV:
+            SHEEP_CASE(ReturnV)
             {
                 // This means we've reached the end of the executing function.
                 // So, we just return to the caller, for realz.
@@ -562,12 +702,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "ReturnV" << std::endl;
 				#endif
 				thread->mRunning = false;
-				stopReading = true;
-				break;
+				goto StopExecution;
             }
-            case SheepInstruction::StoreI:
+            SHEEP_CASE(StoreI)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -578,11 +717,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 					SheepValue& value = thread->mStack.Pop();
 					instance->mVariables[varIndex].intValue = value.intValue;
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::StoreF:
+            SHEEP_CASE(StoreF)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -593,11 +732,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 					SheepValue& value = thread->mStack.Pop();
                     instance->mVariables[varIndex].floatValue = value.floatValue;
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::StoreS:
+            SHEEP_CASE(StoreS)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -607,12 +746,13 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
                     assert(instance->mVariables[varIndex].type == SheepValueType::String);
 					SheepValue& value = thread->mStack.Pop();
                     instance->mVariables[varIndex].stringValue = value.stringValue;
+					instance->mVariables[varIndex].stringAtom = value.stringAtom;
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::LoadI:
+            SHEEP_CASE(LoadI)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -622,11 +762,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
                     assert(instance->mVariables[varIndex].type == SheepValueType::Int);
 					thread->mStack.PushInt(instance->mVariables[varIndex].intValue);
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::LoadF:
+            SHEEP_CASE(LoadF)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -636,11 +776,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
                     assert(instance->mVariables[varIndex].type == SheepValueType::Float);
 					thread->mStack.PushFloat(instance->mVariables[varIndex].floatValue);
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::LoadS:
+            SHEEP_CASE(LoadS)
             {
-                int varIndex = reader.ReadInt();
+                int varIndex = instruction->intArg;
                 if(varIndex >= 0 && varIndex < instance->mVariables.size())
                 {
 					#ifdef SHEEP_DEBUG
@@ -648,59 +788,59 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 					#endif
 					
                     assert(instance->mVariables[varIndex].type == SheepValueType::String);
-					thread->mStack.PushString(instance->mVariables[varIndex].stringValue);
+					thread->mStack.PushString(instance->mVariables[varIndex].stringValue, instance->mVariables[varIndex].stringAtom);
                 }
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::PushI:
+            SHEEP_CASE(PushI)
             {
-                int int1 = reader.ReadInt();
+                int int1 = instruction->intArg;
 				#ifdef SHEEP_DEBUG
 				std::cout << "PushI " << int1 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::PushF:
+            SHEEP_CASE(PushF)
             {
-                float float1 = reader.ReadFloat();
+                float float1 = instruction->floatArg;
 				#ifdef SHEEP_DEBUG
 				std::cout << "PushF " << float1 << std::endl;
 				#endif
 				thread->mStack.PushFloat(float1);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::PushS:
+            SHEEP_CASE(PushS)
             {
-                int stringConstOffset = reader.ReadInt();
+                int stringConstOffset = instruction->intArg;
 				#ifdef SHEEP_DEBUG
 				std::cout << "PushS " << stringConstOffset << std::endl;
 				#endif
 				thread->mStack.PushStringOffset(stringConstOffset);
-                break;
+                SHEEP_NEXT();
             }
-			case SheepInstruction::GetString:
+			SHEEP_CASE(GetString)
 			{
 				SheepValue& offsetValue = thread->mStack.Pop();
-				std::string* stringPtr = script->GetStringConst(offsetValue.intValue);
-				if(stringPtr != nullptr)
+				const SheepStringConst* stringConst = script->GetStringConst(offsetValue.intValue);
+				if(stringConst != nullptr)
 				{
-					thread->mStack.PushString(stringPtr->c_str());
+					thread->mStack.PushString(stringConst->text.c_str(), stringConst->atom);
 				}
 				#ifdef SHEEP_DEBUG
 				std::cout << "GetString " << thread->mStack.Peek().stringValue << std::endl;
 				#endif
-				break;
+				SHEEP_NEXT();
 			}
-            case SheepInstruction::Pop:
+            SHEEP_CASE(Pop)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "Pop" << std::endl;
 				#endif
 				thread->mStack.Pop(1);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::AddI:
+            SHEEP_CASE(AddI)
             {
                 assert(thread->mStack.Size() >= 2);
 				int int1 = thread->mStack.Peek(1).intValue;
@@ -711,9 +851,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "AddI " << int1 << " + " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 + int2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::AddF:
+            SHEEP_CASE(AddF)
             {
 				assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -724,9 +864,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "AddF " << float1 << " + " << float2 << std::endl;
 				#endif
 				thread->mStack.PushFloat(float1 + float2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::SubtractI:
+            SHEEP_CASE(SubtractI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -737,9 +877,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "SubtractI " << int1 << " - " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 - int2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::SubtractF:
+            SHEEP_CASE(SubtractF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -750,9 +890,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "SubtractF " << float1 << " - " << float2 << std::endl;
 				#endif
 				thread->mStack.PushFloat(float1 - float2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::MultiplyI:
+            SHEEP_CASE(MultiplyI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -763,9 +903,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "MultiplyI " << int1 << " * " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 * int2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::MultiplyF:
+            SHEEP_CASE(MultiplyF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -776,9 +916,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "MultiplyF " << float1 << " * " << float2 << std::endl;
 				#endif
 				thread->mStack.PushFloat(float1 * float2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::DivideI:
+            SHEEP_CASE(DivideI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -798,9 +938,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 					std::cout << "Divide by zero!" << std::endl;
 					thread->mStack.PushInt(0);
 				}
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::DivideF:
+            SHEEP_CASE(DivideF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -820,9 +960,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 					std::cout << "Divide by zero!" << std::endl;
 					thread->mStack.PushFloat(0.0f);
 				}
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::NegateI:
+            SHEEP_CASE(NegateI)
             {
                 assert(thread->mStack.Size() >= 1);
 				
@@ -830,9 +970,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "NegateI " << thread->mStack.Peek(0).intValue << std::endl;
 				#endif
                 thread->mStack.Peek(0).intValue *= -1;
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::NegateF:
+            SHEEP_CASE(NegateF)
             {
                 assert(thread->mStack.Size() >= 1);
 				
@@ -840,9 +980,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "NegateF " << thread->mStack.Peek(0).floatValue << std::endl;
 				#endif
                 thread->mStack.Peek(0).floatValue *= -1.0f;
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsEqualI:
+            SHEEP_CASE(IsEqualI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -853,9 +993,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsEqualI " << int1 << " == " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 == int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsEqualF:
+            SHEEP_CASE(IsEqualF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -866,9 +1006,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsEqualF " << float1 << " == " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(Math::AreEqual(float1, float2) ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsNotEqualI:
+            SHEEP_CASE(IsNotEqualI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -879,9 +1019,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsNotEqualI " << int1 << " != " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 != int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsNotEqualF:
+            SHEEP_CASE(IsNotEqualF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -892,9 +1032,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsNotEqualF " << float1 << " != " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(!Math::AreEqual(float1, float2) ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsGreaterI:
+            SHEEP_CASE(IsGreaterI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -905,9 +1045,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsGreaterI " << int1 << " > " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 > int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsGreaterF:
+            SHEEP_CASE(IsGreaterF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -918,9 +1058,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsGreaterF " << float1 << " > " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(float1 > float2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-			case SheepInstruction::IsLessI:
+			SHEEP_CASE(IsLessI)
 			{
 				assert(thread->mStack.Size() >= 2);
 				int int1 = thread->mStack.Peek(1).intValue;
@@ -931,9 +1071,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsLessI " << int1 << " < " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 < int2 ? 1 : 0);
-				break;
+				SHEEP_NEXT();
 			}
-			case SheepInstruction::IsLessF:
+			SHEEP_CASE(IsLessF)
 			{
 				assert(thread->mStack.Size() >= 2);
 				float float1 = thread->mStack.Peek(1).floatValue;
@@ -944,9 +1084,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsLessF " << float1 << " < " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(float1 < float2 ? 1 : 0);
-				break;
+				SHEEP_NEXT();
 			}
-            case SheepInstruction::IsGreaterEqualI:
+            SHEEP_CASE(IsGreaterEqualI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -957,9 +1097,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsGreaterEqualI " << int1 << " >= " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 >= int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsGreaterEqualF:
+            SHEEP_CASE(IsGreaterEqualF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -970,9 +1110,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsGreaterEqualF " << float1 << " >= " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(float1 >= float2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsLessEqualI:
+            SHEEP_CASE(IsLessEqualI)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -983,9 +1123,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsLessEqualI " << int1 << " <= " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 <= int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IsLessEqualF:
+            SHEEP_CASE(IsLessEqualF)
             {
                 assert(thread->mStack.Size() >= 2);
                 float float1 = thread->mStack.Peek(1).floatValue;
@@ -996,11 +1136,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "IsLessEqualF " << float1 << " <= " << float2 << std::endl;
 				#endif
 				thread->mStack.PushInt(float1 <= float2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::IToF:
+            SHEEP_CASE(IToF)
             {
-                int index = reader.ReadInt();
+                int index = instruction->intArg;
 				SheepValue& value = thread->mStack.Peek(index);
 				
 				#ifdef SHEEP_DEBUG
@@ -1008,11 +1148,11 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				#endif
                 value.floatValue = value.intValue;
                 value.type = SheepValueType::Float;
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::FToI:
+            SHEEP_CASE(FToI)
             {
-                int index = reader.ReadInt();
+                int index = instruction->intArg;
 				SheepValue& value = thread->mStack.Peek(index);
 				
 				#ifdef SHEEP_DEBUG
@@ -1020,9 +1160,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				#endif
                 value.intValue = value.floatValue;
                 value.type = SheepValueType::Int;
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::Modulo:
+            SHEEP_CASE(Modulo)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -1033,9 +1173,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "Modulo " << int1 << " % " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 % int2);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::And:
+            SHEEP_CASE(And)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -1046,9 +1186,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "And " << int1 << " && " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 && int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::Or:
+            SHEEP_CASE(Or)
             {
                 assert(thread->mStack.Size() >= 2);
                 int int1 = thread->mStack.Peek(1).intValue;
@@ -1059,9 +1199,9 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "Or " << int1 << " || " << int2 << std::endl;
 				#endif
 				thread->mStack.PushInt(int1 || int2 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::Not:
+            SHEEP_CASE(Not)
             {
                 assert(thread->mStack.Size() >= 1);
 				int int1 = thread->mStack.Peek(0).intValue;
@@ -1070,51 +1210,208 @@ void SheepVM::ExecuteInternal(SheepThread* thread)
 				std::cout << "Not " << int1 << std::endl;
 				#endif
                 thread->mStack.Peek(0).intValue = (int1 == 0 ? 1 : 0);
-                break;
+                SHEEP_NEXT();
             }
-            case SheepInstruction::DebugBreakpoint:
+            SHEEP_CASE(DebugBreakpoint)
             {
 				#ifdef SHEEP_DEBUG
 				std::cout << "DebugBreakpoint" << std::endl;
 				#endif
 				//TODO: Break in Xcode/VS.
-                break;
+                SHEEP_NEXT();
             }
-            default:
+			
+			// Superinstructions, which replace common instruction sequences (see SheepOptimizer).
+			// Each does the same thing as its sequence, just without the stack traffic in between.
+			SHEEP_CASE(PushStringConst)
+			{
+				const SheepStringConst* stringConst = script->GetStringConst(instruction->intArg);
+				if(stringConst != nullptr)
+				{
+					thread->mStack.PushString(stringConst->text.c_str(), stringConst->atom);
+				}
+				#ifdef SHEEP_DEBUG
+				std::cout << "PushStringConst " << thread->mStack.Peek().stringValue << std::endl;
+				#endif
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CallSysFunctionArgsV)
+			{
+				int functionIndex = instruction->intArg;
+				SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
+				{
+					std::cout << "Invalid function index " << functionIndex << std::endl;
+					SHEEP_NEXT();
+				}
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CallSysFuncArgsV " << sysImport->name << std::endl;
+				#endif
+				
+				// The result would just be popped, so don't bother pushing it.
+				CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), instruction->intArg2);
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CallSysFunctionArgsI)
+			{
+				int functionIndex = instruction->intArg;
+				SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
+				{
+					std::cout << "Invalid function index " << functionIndex << std::endl;
+					SHEEP_NEXT();
+				}
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CallSysFuncArgsI " << sysImport->name << std::endl;
+				#endif
+				
+				SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), instruction->intArg2);
+				thread->mStack.PushInt(value.GetInt());
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CallSysFunctionArgsF)
+			{
+				int functionIndex = instruction->intArg;
+				SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
+				{
+					std::cout << "Invalid function index " << functionIndex << std::endl;
+					SHEEP_NEXT();
+				}
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CallSysFuncArgsF " << sysImport->name << std::endl;
+				#endif
+				
+				SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), instruction->intArg2);
+				thread->mStack.PushFloat(value.GetFloat());
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CallSysFunctionArgsS)
+			{
+				int functionIndex = instruction->intArg;
+				SysImport* sysImport = script->GetSysImport(functionIndex);
+				if(sysImport == nullptr)
+				{
+					std::cout << "Invalid function index " << functionIndex << std::endl;
+					SHEEP_NEXT();
+				}
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CallSysFuncArgsS " << sysImport->name << std::endl;
+				#endif
+				
+				SheepValue value = CallSysFunc<kProfile>(thread, sysImport, script->GetSysFunc(functionIndex), instruction->intArg2);
+				thread->mStack.PushString(thread->mContext->StoreString(value.GetString()));
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CompareConstI)
+			{
+				assert(thread->mStack.Size() >= 1);
+				int int1 = thread->mStack.Pop().intValue;
+				int int2 = instruction->intArg;
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CompareConstI " << int1 << ", " << int2 << std::endl;
+				#endif
+				thread->mStack.PushInt(SheepOptimizer::CompareI(instruction->compare, int1, int2) ? 1 : 0);
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(LoadCompareConstI)
+			{
+				int varIndex = instruction->intArg;
+				int int1 = varIndex >= 0 && varIndex < instance->mVariables.size() ? instance->mVariables[varIndex].intValue : 0;
+				int int2 = instruction->intArg2;
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "LoadCompareConstI " << int1 << ", " << int2 << std::endl;
+				#endif
+				thread->mStack.PushInt(SheepOptimizer::CompareI(instruction->compare, int1, int2) ? 1 : 0);
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(CompareConstBranchI)
+			{
+				assert(thread->mStack.Size() >= 1);
+				int int1 = thread->mStack.Pop().intValue;
+				int int2 = instruction->intArg2;
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "CompareConstBranchI " << int1 << ", " << int2 << std::endl;
+				#endif
+				
+				// Branch if the comparison is false.
+				if(!SheepOptimizer::CompareI(instruction->compare, int1, int2))
+				{
+					pc = instruction->intArg;
+				}
+				SHEEP_NEXT();
+			}
+			SHEEP_CASE(LoadCompareConstBranchI)
+			{
+				int varIndex = instruction->intArg2;
+				int int1 = varIndex >= 0 && varIndex < instance->mVariables.size() ? instance->mVariables[varIndex].intValue : 0;
+				int int2 = instruction->intArg3;
+				
+				#ifdef SHEEP_DEBUG
+				std::cout << "LoadCompareConstBranchI " << int1 << ", " << int2 << std::endl;
+				#endif
+				
+				// Branch if the comparison is false.
+				if(!SheepOptimizer::CompareI(instruction->compare, int1, int2))
+				{
+					pc = instruction->intArg;
+				}
+				SHEEP_NEXT();
+			}
+            SHEEP_DEFAULT
             {
-				std::cout << "Unaccounted for Sheep Instruction: " << (int)instruction << std::endl;
-                break;
+				// Unknown instructions are decoded as "Invalid", with the original value as the argument.
+				std::cout << "Unaccounted for Sheep Instruction: " << instruction->intArg << std::endl;
+                SHEEP_NEXT();
             }
-        }
-    }
-	
-	// Update thread's code offset value.
-	thread->mCodeOffset = reader.GetPosition();
+	#ifdef SHEEP_COMPUTED_GOTO
+	}
+	#else
+		}
+	}
+	#endif
+	#undef SHEEP_CASE
+	#undef SHEEP_DEFAULT
+	#undef SHEEP_NEXT
 	
-	// If reached end of file, assume the thread is no longer running.
-	if(!reader.OK())
+StopExecution:
+	// Save where we are, in case the thread is resumed later.
+	thread->mInstructionIndex = pc;
+	if(kProfile)
 	{
-		thread->mRunning = false;
+		mProfiler.RecordRun(script->GetName(), thread->mFunctionName, instructionCount, startTime, SheepProfiler::Now());
 	}
 	
 	// If thread is no longer running, notify anyone who was waiting for the thread to finish.
 	// If we get here and the thread IS running, it means the thread was blocked due to a wait!
 	if(!thread->mRunning)
 	{
-		Services::GetReports()->Log("SheepMachine", "Sheep " + thread->GetName() + " is exiting");
+		SHEEP_TRACE_LOG(thread, " is exiting");
 		
 		// Thread is no longer using execution context.
-		thread->mContext->mReferenceCount--;
+		ReleaseInstance(thread->mContext);
+		
+		// The thread is done, so it can be reused.
+		// Grab the wait callback first, since releasing clears it.
+		std::function<void()> waitCallback = thread->mWaitCallback;
+		ReleaseThread(thread);
 		
 		// Call my wait callback - someone might have been waiting for this thread to finish.
-		if(thread->mWaitCallback)
+		if(waitCallback)
 		{
-			thread->mWaitCallback();
+			waitCallback();
 		}
 	}
 	else if(thread->mInWaitBlock)
 	{
-		Services::GetReports()->Log("SheepMachine", "Sheep " + thread->GetName() + " is blocked at line -1");
+		SHEEP_TRACE_LOG(thread, " is blocked at line -1");
 	}
 	else
 	{
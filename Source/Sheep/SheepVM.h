@@ -6,15 +6,19 @@
 // A virtual machine for executing Sheep bytecode.
 //
 #pragma once
+#include <deque>
 #include <functional>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "SheepProfiler.h"
 #include "SheepThread.h"
 #include "SheepValue.h"
-#include "Value.h"
 
 class SheepScript;
+struct SysFuncDecl;
 struct SysImport;
 
 // GK3 calls these "Object Code" instances.
@@ -28,6 +32,11 @@ struct SheepInstance
 	// These'll likely be modified during execution.
 	std::vector<SheepValue> mVariables;
 	
+	// Strings created during execution (e.g. returned by system functions).
+	// Stack values and variables only hold pointers to strings, so the strings themselves are kept here.
+	// A set is used so each unique string is only stored once, and pointers stay valid as more are added.
+	std::unordered_set<std::string> mStrings;
+	
 	// For debugging, the last time this object was in use during a sheep thread execution.
 	uint32_t mLastUsedTimeMs = 0;
 	
@@ -35,7 +44,16 @@ struct SheepInstance
 	// For example, if one function calls another in the same SheepScript.
 	int mReferenceCount = 0;
 	
+	// If true, this instance is in the VM's free list (though it may have been reused since being added).
+	bool mInFreeList = false;
+	
 	std::string GetName();
+	
+	// Stores a string for as long as this instance's stack values or variables may point to it.
+	const char* StoreString(const std::string& str);
+	
+	// Frees stored strings that no variable points to. Only safe when no thread is using the instance.
+	void TrimStrings();
 };
 
 // Notify Links?
@@ -94,41 +112,82 @@ enum class SheepInstruction
     Or                  = 0x31,
     Not                 = 0x32, // 50
     GetString           = 0x33,
-    DebugBreakpoint     = 0x34
+    DebugBreakpoint     = 0x34,
+	
+	// Superinstructions: these never appear in bytecode.
+	// The optimizer (see SheepOptimizer) replaces common instruction sequences with these after decoding.
+	PushStringConst         = 0x35, // PushS, GetString
+	CallSysFunctionArgsV    = 0x36, // PushI (arg count), CallSysFunctionV, Pop
+	CallSysFunctionArgsI    = 0x37, // PushI (arg count), CallSysFunctionI
+	CallSysFunctionArgsF    = 0x38, // PushI (arg count), CallSysFunctionF
+	CallSysFunctionArgsS    = 0x39, // PushI (arg count), CallSysFunctionS
+	CompareConstI           = 0x3A, // PushI, IsXXXI
+	LoadCompareConstI       = 0x3B, // LoadI, PushI, IsXXXI
+	CompareConstBranchI     = 0x3C, // PushI, IsXXXI, BranchIfZero
+	LoadCompareConstBranchI = 0x3D  // LoadI, PushI, IsXXXI, BranchIfZero
 };
 
+// Number of instructions that can appear in bytecode.
+const int kSheepInstructionCount = 0x35;
+
+// Number of instructions, including superinstructions.
+const int kSheepDecodedInstructionCount = 0x3E;
+
 class SheepVM
 {
 	friend struct SheepThread;
 public:
 	SheepVM() = default;
-	~SheepVM();
     
 	void Execute(SheepScript* script, std::function<void()> finishCallback);
 	void Execute(SheepScript* script, const std::string& functionName, std::function<void()> finishCallback);
 	void Execute(SheepScript* script, int bytecodeOffset, std::function<void()> finishCallback);
 	
+	// Evaluates a condition. Results are cached and reused until something the condition read changes (see ConditionCache).
     bool Evaluate(SheepScript* script, int n, int v);
 	
 	SheepThread* GetCurrentThread() const { return mCurrentThread; }
-	bool IsAnyRunning() const;
+	SheepThread* GetThread(const SheepThreadHandle& handle);
+	bool IsAnyRunning() const { return mThreadPool.size() > mFreeThreads.size(); }
 	
 	void FlagExecutionError() { mExecutionError = true; }
 	
+	// Opt-in profiling of execution time and system function calls.
+	SheepProfiler& GetProfiler() { return mProfiler; }
+	
 private:
-	std::vector<SheepInstance*> mSheepInstances;
-	std::vector<SheepThread*> mSheepThreads;
+	// Instances and threads are pooled and reused, since a lot of them are created and destroyed (e.g. when evaluating conditions).
+	// Deques are used so pointers stay valid as the pools grow.
+	std::deque<SheepInstance> mInstancePool;
+	std::deque<SheepThread> mThreadPool;
+	
+	// Instances that aren't referenced by any thread, and threads that aren't running.
+	// Instances are only pulled from here when a new script needs one, so an unused instance keeps its variables as long as possible.
+	std::vector<SheepInstance*> mFreeInstances;
+	std::vector<int> mFreeThreads;
+	
+	// Maps a script to the instance currently used to execute it.
+	std::unordered_map<SheepScript*, SheepInstance*> mInstancesByScript;
 	
 	SheepThread* mCurrentThread = nullptr;
 	
 	bool mExecutionError = false;
+	
+	SheepProfiler mProfiler;
 		
 	SheepInstance* GetInstance(SheepScript* script);
-	SheepThread* GetThread();
+	void ReleaseInstance(SheepInstance* instance);
+	
+	SheepThread* AcquireThread();
+	void ReleaseThread(SheepThread* thread);
 	
-    Value CallSysFunc(SheepThread* thread, SysImport* sysImport);
+	// Execution is templated on whether profiling is on, so profiling costs nothing when it's off.
+	template<bool kProfile> SheepValue CallSysFunc(SheepThread* thread, SysImport* sysImport, SysFuncDecl* sysFunc, int argCount);
 	
 	SheepThread* ExecuteInternal(SheepScript* script, int bytecodeOffset, const std::string& functionName, std::function<void()> finishCallback);
 	SheepThread* ExecuteInternal(SheepInstance* instance, int bytecodeOffset, const std::string& functionName, std::function<void()> finishCallback);
 	void ExecuteInternal(SheepThread* thread);
+	template<bool kProfile> void ExecuteThread(SheepThread* thread);
+	
+	bool EvaluateInternal(SheepScript* script, int n, int v);
 };
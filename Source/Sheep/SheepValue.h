@@ -8,6 +8,8 @@
 #pragma once
 #include <string>
 
+#include "Atom.h"
+
 enum class SheepValueType
 {
     Void,
@@ -19,6 +21,12 @@ enum class SheepValueType
 struct SheepValue
 {
     SheepValueType type = SheepValueType::Int;
+	
+	// For strings, the string as an atom, if it was known ahead of time (e.g. string constants).
+	// Lets system functions that want an atom skip looking up the string. Empty if not known.
+	// It's declared before the union so it fills what would otherwise be padding after the type.
+	Atom stringAtom;
+	
     union
     {
         int intValue;
@@ -31,6 +39,7 @@ struct SheepValue
     SheepValue(int i) { type = SheepValueType::Int; intValue = i; }
     SheepValue(float f) { type = SheepValueType::Float; floatValue = f; }
     SheepValue(const char* s) { type = SheepValueType::String; stringValue = s; }
+	SheepValue(const char* s, Atom atom) { type = SheepValueType::String; stringValue = s; stringAtom = atom; }
 	~SheepValue() { }
 	
 	// Helpers for implicit conversions between Int/Float when needed.
@@ -93,3 +102,6 @@ struct SheepValue
 		}
 	}
 };
+
+// Every stack slot and variable is a SheepValue, so make sure the atom didn't make it any bigger than a type and a pointer.
+static_assert(sizeof(SheepValue) <= 16, "SheepValue is bigger than expected");
@@ -5,6 +5,7 @@
 //
 #include "Skybox.h"
 
+#include "GLState.h"
 #include "Mesh.h"
 #include "Services.h"
 #include "Texture.h"
@@ -88,9 +89,8 @@ void Skybox::Render()
     
     if(mCubemapTextureId == GL_NONE)
     {
-        glActiveTexture(GL_TEXTURE0);
         glGenTextures(1, &mCubemapTextureId);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, mCubemapTextureId);
+        GLState::Instance()->BindTexture(0, GL_TEXTURE_CUBE_MAP, mCubemapTextureId);
         
         // Create each texture for the cubemap.
         // Note that we MUST create 6 textures, or the cubemap will not display properly.
@@ -145,8 +145,7 @@ void Skybox::Render()
 	mMaterial->Activate(Matrix4::Identity);
 	
 	// Activate and bind the cubemap texture.
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, mCubemapTextureId);
+    GLState::Instance()->BindTexture(0, GL_TEXTURE_CUBE_MAP, mCubemapTextureId);
 	
 	// Render the skybox.
     mSkyboxMesh->Render();
@@ -9,6 +9,7 @@
 #pragma once
 #include <algorithm>
 #include <cctype>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
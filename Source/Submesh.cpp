@@ -62,6 +62,23 @@ void Submesh::Render(unsigned int offset, unsigned int count) const
 	}
 }
 
+void Submesh::RenderInstanced(GLuint instanceBuffer, unsigned int firstInstance, unsigned int instanceCount) const
+{
+	switch(mRenderMode)
+	{
+    default:
+    case RenderMode::Triangles:
+        mVertexArray.DrawInstanced(GL_TRIANGLES, instanceBuffer, firstInstance, instanceCount);
+        break;
+    case RenderMode::TriangleFan:
+        mVertexArray.DrawInstanced(GL_TRIANGLE_FAN, instanceBuffer, firstInstance, instanceCount);
+        break;
+    case RenderMode::Lines:
+        mVertexArray.DrawInstanced(GL_LINES, instanceBuffer, firstInstance, instanceCount);
+        break;
+	}
+}
+
 Vector3 Submesh::GetVertexPosition(int index) const
 {
 	// Handle error cases.
@@ -112,7 +129,7 @@ bool Submesh::GetTriangle(int index, Vector3& p0, Vector3& p1, Vector3& p2) cons
 	return false;
 }
 
-bool Submesh::Raycast(const Ray& ray)
+bool Submesh::Raycast(const Ray& ray, const float* positions)
 {
 	if(mRenderMode != RenderMode::Triangles || mIndexes == nullptr)
 	{
@@ -120,12 +137,24 @@ bool Submesh::Raycast(const Ray& ray)
 		return false;
 	}
 	
+	if(positions == nullptr)
+	{
+		positions = mPositions;
+	}
+	if(positions == nullptr)
+	{
+		return false;
+	}
+	
     RaycastHit hitInfo;
 	for(int i = 0; i < mIndexCount; i += 3)
 	{
-		Vector3 vert1 = GetVertexPosition(mIndexes[i]);
-		Vector3 vert2 = GetVertexPosition(mIndexes[i + 1]);
-		Vector3 vert3 = GetVertexPosition(mIndexes[i + 2]);
+		const float* p1 = positions + mIndexes[i] * 3;
+		const float* p2 = positions + mIndexes[i + 1] * 3;
+		const float* p3 = positions + mIndexes[i + 2] * 3;
+		Vector3 vert1(p1[0], p1[1], p1[2]);
+		Vector3 vert2(p2[0], p2[1], p2[2]);
+		Vector3 vert3(p3[0], p3[1], p3[2]);
 		
 		if(Collisions::TestRayTriangle(ray, vert1, vert2, vert3, hitInfo))
 		{
@@ -155,6 +184,14 @@ void Submesh::SetPositions(float* positions, bool createCopy)
     mVertexArray.ChangeVertexData(VertexAttribute::Semantic::Position, mPositions);
 }
 
+void Submesh::RefreshPositions()
+{
+    if(mPositions != nullptr)
+    {
+        mVertexArray.ChangeVertexData(VertexAttribute::Semantic::Position, mPositions);
+    }
+}
+
 void Submesh::SetColors(float* colors, bool createCopy)
 {
     // Size of array is assumed to be correct based on vertex count.
@@ -33,6 +33,9 @@ public:
 	void Render() const;
 	void Render(unsigned int offset, unsigned int count) const;
 	
+	// Renders several instances of the submesh, with per-instance transforms from an instance buffer (see VertexArray::DrawInstanced).
+	void RenderInstanced(GLuint instanceBuffer, unsigned int firstInstance, unsigned int instanceCount) const;
+	
 	unsigned int GetVertexCount() const { return mVertexCount; }
 	Vector3 GetVertexPosition(int index) const;
     bool GetVertexNormal(int index, Vector3& n) const;
@@ -40,11 +43,16 @@ public:
 	int GetTriangleCount() const;
 	bool GetTriangle(int index, Vector3& p0, Vector3& p1, Vector3& p2) const;
 	
-	bool Raycast(const Ray& ray);
+	// Tests the ray against the submesh's triangles. If "positions" is given, it's used in place of the submesh's own positions
+	// (e.g. a pose of an animation), and must hold the same number of vertices.
+	bool Raycast(const Ray& ray, const float* positions = nullptr);
     
     void SetPositions(float* positions, bool createCopy = false);
     float* GetPositions() { return mPositions; }
     
+    // If position data is modified in place (via GetPositions), call this to upload the changes to the GPU.
+    void RefreshPositions();
+    
     void SetNormals(float* normals, bool createCopy = false);
     float* GetNormals() { return mNormals; }
     
@@ -5,14 +5,100 @@
 //
 #include "TextLayout.h"
 
+#include <functional>
+#include <unordered_map>
+
 #include "Font.h"
 #include "StringUtil.h"
 
-TextLayout::CharInfo& TextLayout::CharInfo::operator=(const TextLayout::CharInfo& other)
+namespace
 {
-	glyph = other.glyph;
-	pos = other.pos;
-	return *this;
+	// Everything a shared text layout depends on.
+	struct SharedLayoutKey
+	{
+		Rect rect;
+		Font* font = nullptr;
+		HorizontalAlignment ha = HorizontalAlignment::Left;
+		VerticalAlignment va = VerticalAlignment::Bottom;
+		HorizontalOverflow ho = HorizontalOverflow::Overflow;
+		VerticalOverflow vo = VerticalOverflow::Overflow;
+		std::string text;
+	};
+	
+	struct SharedLayout
+	{
+		SharedLayoutKey key;
+		std::shared_ptr<TextLayout> layout;
+	};
+	
+	// Shared layouts, mapped by hash of their key. Multiple keys can have the same hash, so the full key is checked on lookup.
+	std::unordered_multimap<size_t, SharedLayout> sharedLayouts;
+	
+	// When this many layouts are cached, layouts that no label is using are removed.
+	const size_t kMaxSharedLayouts = 256;
+	
+	size_t HashCombine(size_t hash, size_t value)
+	{
+		return hash ^ (value + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+	}
+}
+
+/*static*/ std::shared_ptr<const TextLayout> TextLayout::GetShared(const Rect& rect, Font* font,
+																	HorizontalAlignment ha, VerticalAlignment va,
+																	HorizontalOverflow ho, VerticalOverflow vo,
+																	const std::string& text)
+{
+	// Hash everything the layout depends on. This doesn't allocate, so finding an existing layout doesn't either.
+	size_t hash = std::hash<std::string>()(text);
+	hash = HashCombine(hash, std::hash<Font*>()(font));
+	hash = HashCombine(hash, std::hash<float>()(rect.x));
+	hash = HashCombine(hash, std::hash<float>()(rect.y));
+	hash = HashCombine(hash, std::hash<float>()(rect.width));
+	hash = HashCombine(hash, std::hash<float>()(rect.height));
+	hash = HashCombine(hash, static_cast<size_t>(ha) | static_cast<size_t>(va) << 2 | static_cast<size_t>(ho) << 4 | static_cast<size_t>(vo) << 6);
+	
+	// Use an existing layout, if there's one with the exact same settings.
+	auto range = sharedLayouts.equal_range(hash);
+	for(auto it = range.first; it != range.second; ++it)
+	{
+		const SharedLayoutKey& key = it->second.key;
+		if(key.font == font && key.rect == rect && key.ha == ha && key.va == va && key.ho == ho && key.vo == vo && key.text == text)
+		{
+			return it->second.layout;
+		}
+	}
+	
+	// Make room, if needed, by removing layouts no one is using anymore.
+	if(sharedLayouts.size() >= kMaxSharedLayouts)
+	{
+		for(auto it = sharedLayouts.begin(); it != sharedLayouts.end();)
+		{
+			if(it->second.layout.use_count() == 1)
+			{
+				it = sharedLayouts.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+	
+	// Create a new layout.
+	SharedLayout sharedLayout;
+	sharedLayout.key.rect = rect;
+	sharedLayout.key.font = font;
+	sharedLayout.key.ha = ha;
+	sharedLayout.key.va = va;
+	sharedLayout.key.ho = ho;
+	sharedLayout.key.vo = vo;
+	sharedLayout.key.text = text;
+	sharedLayout.layout = std::make_shared<TextLayout>(rect, font, ha, va, ho, vo);
+	sharedLayout.layout->AddLine(text);
+	
+	std::shared_ptr<const TextLayout> layout = sharedLayout.layout;
+	sharedLayouts.emplace(hash, std::move(sharedLayout));
+	return layout;
 }
 
 TextLayout::TextLayout(const Rect& rect, Font* font,
@@ -28,6 +114,23 @@ TextLayout::TextLayout(const Rect& rect, Font* font,
 	
 }
 
+void TextLayout::Reset(const Rect& rect, Font* font,
+	HorizontalAlignment ha, VerticalAlignment va,
+	HorizontalOverflow ho, VerticalOverflow vo)
+{
+	mRect = rect;
+	mFont = font;
+	mHorizontalAlignment = ha;
+	mVerticalAlignment = va;
+	mHorizontalOverflow = ho;
+	mVerticalOverflow = vo;
+	
+	// Clearing keeps the vector's memory around for the new layout.
+	mLineCount = 0;
+	mCharInfos.clear();
+	mNextCharPos = Vector2::Zero;
+}
+
 void TextLayout::AddLine(const std::string& line)
 {
 	// Handle receiving text that has line breaks in it by...splitting and calling recursively!
@@ -52,7 +155,7 @@ void TextLayout::AddLine(const std::string& line)
     int lineWidth = 0;
     for(size_t i = 0; i < line.size(); ++i)
     {
-        Glyph& glyph = mFont->GetGlyph(line[i]);
+        const Glyph& glyph = mFont->GetGlyph(line[i]);
         lineWidth += glyph.width;
     }
 	
@@ -103,7 +206,7 @@ void TextLayout::AddLine(const std::string& line)
     // Determine CharInfo for each text character: the glyph and position of the glyph for rendering.
 	for(size_t i = 0; i < line.size(); ++i)
 	{
-		Glyph& glyph = mFont->GetGlyph(line[i]);
+		const Glyph& glyph = mFont->GetGlyph(line[i]);
 		
 		float leftX = xPos;
 		float rightX = xPos + glyph.width;
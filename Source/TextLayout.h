@@ -14,6 +14,8 @@
 // 2) Instead of splitting text using \n, we can just detect it and go to a new line as we parse the text.
 //
 #pragma once
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "Rect.h"
@@ -53,25 +55,36 @@ class TextLayout
 public:
 	struct CharInfo
 	{
-		CharInfo(Glyph& glyph, Vector2 pos) : glyph(glyph), pos(pos) { }
-		CharInfo& operator=(const CharInfo& other);
+		CharInfo(const Glyph& glyph, Vector2 pos) : glyph(&glyph), pos(pos) { }
 		
-        // Glyph to use when rendering this text character.
-		Glyph& glyph;
+        // Glyph to use when rendering this text character (owned by the font).
+		const Glyph* glyph = nullptr;
         
         // Position of the text character (bottom-left corner).
 		Vector2 pos;
 	};
 	
+	// Lays out a single string of text, or returns an existing layout of the same text with the same settings.
+	// Labels that switch between a few strings (or show the same string) share layouts, rather than redoing them.
+	static std::shared_ptr<const TextLayout> GetShared(const Rect& rect, Font* font,
+													   HorizontalAlignment ha, VerticalAlignment va,
+													   HorizontalOverflow ho, VerticalOverflow vo,
+													   const std::string& text);
+	
     TextLayout() = default;
 	TextLayout(const Rect& rect, Font* font,
 			   HorizontalAlignment ha, VerticalAlignment va,
 			   HorizontalOverflow ho, VerticalOverflow vo);
 	
-	TextLayout(TextLayout& other) = default;
+	TextLayout(const TextLayout& other) = default;
 	TextLayout(TextLayout&& other) = default;
 	TextLayout& operator=(const TextLayout& other) = default;
 	
+	// Removes all text and changes layout settings. Memory from the previous layout is reused.
+	void Reset(const Rect& rect, Font* font,
+			   HorizontalAlignment ha, VerticalAlignment va,
+			   HorizontalOverflow ho, VerticalOverflow vo);
+	
 	void AddLine(const std::string& line);
 	
 	int GetCharCount() const { return (int)mCharInfos.size(); }
@@ -11,6 +11,7 @@
 
 #include "BinaryReader.h"
 #include "BinaryWriter.h"
+#include "GLState.h"
 #include "GMath.h"
 
 Texture Texture::White(2, 2, Color32::White);
@@ -62,6 +63,10 @@ Texture::~Texture()
 {
 	if(mTextureId != GL_NONE)
 	{
+		if(GLState::Instance() != nullptr)
+		{
+			GLState::Instance()->OnTextureDeleted(mTextureId);
+		}
 		glDeleteTextures(1, &mTextureId);
 	}
 	if(mPalette != nullptr)
@@ -83,15 +88,13 @@ Texture::~Texture()
 
 void Texture::Activate(int textureUnit)
 {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    
     if(mDirty)
     {
         UploadToGPU();
         mDirty = false;
     }
     
-    glBindTexture(GL_TEXTURE_2D, mTextureId);
+    GLState::Instance()->BindTexture(textureUnit, GL_TEXTURE_2D, mTextureId);
 }
 
 void Texture::Deactivate()
@@ -175,7 +178,7 @@ void Texture::Blit(Texture* source, int destX, int destY)
 	
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source->mTextureId, 0);
 	
-	glBindTexture(GL_TEXTURE_2D, mTextureId);
+	GLState::Instance()->BindTexture(GL_TEXTURE_2D, mTextureId);
 	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, destX, destY, 0, 0, source->GetWidth(), source->GetHeight());
 	
 	glBindFramebuffer(GL_FRAMEBUFFER, GL_NONE);
@@ -289,7 +292,7 @@ void Texture::UploadToGPU()
 	{
 		// Generate and bind the texture object in OpenGL.
 		glGenTextures(1, &mTextureId);
-		glBindTexture(GL_TEXTURE_2D, mTextureId);
+		GLState::Instance()->BindTexture(GL_TEXTURE_2D, mTextureId);
 		
 		// Load texture data into texture object.
         // OpenGL assumes that pixel data is from bottom-left, BUT our pixels array is from top-left!
@@ -312,7 +315,7 @@ void Texture::UploadToGPU()
 	else
 	{
 		// Update texture data on GPU.
-		glBindTexture(GL_TEXTURE_2D, mTextureId);
+		GLState::Instance()->BindTexture(GL_TEXTURE_2D, mTextureId);
 		glTexSubImage2D(GL_TEXTURE_2D, 0,
 						0, 0, mWidth, mHeight,
 						GL_RGBA, GL_UNSIGNED_BYTE, mPixels);
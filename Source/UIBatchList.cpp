@@ -0,0 +1,104 @@
+//
+// UIBatchList.cpp
+//
+// Clark Kromenaker
+//
+#include "UIBatchList.h"
+
+#include <algorithm>
+
+namespace
+{
+	// True if the two rects share some area. Unlike Rect::Overlaps, rects that only touch at an edge don't count.
+	// Neighboring UI elements often touch, and they can still be drawn in any order.
+	bool OverlapsInterior(const Rect& a, const Rect& b)
+	{
+		return a.x < b.x + b.width && b.x < a.x + a.width &&
+			   a.y < b.y + b.height && b.y < a.y + a.height;
+	}
+}
+
+void UIBatchList::Clear()
+{
+	// Empty out batches, but keep their memory around for next time.
+	for(int i = 0; i < mBatchCount; ++i)
+	{
+		mBatches[i].vertices.clear();
+	}
+	mBatchCount = 0;
+	mQuadCount = 0;
+}
+
+void UIBatchList::SetLook(Shader* shader, Texture* texture, const Color32& replaceColor)
+{
+	mShader = shader;
+	mTexture = texture;
+	mReplaceColor = replaceColor;
+}
+
+void UIBatchList::AddQuad(const Vector3& upperLeft, const Vector3& upperRight, const Vector3& lowerRight, const Vector3& lowerLeft,
+						  const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color)
+{
+	// Calculate bounds of the quad, for overlap checks.
+	float minX = std::min(std::min(upperLeft.x, upperRight.x), std::min(lowerRight.x, lowerLeft.x));
+	float minY = std::min(std::min(upperLeft.y, upperRight.y), std::min(lowerRight.y, lowerLeft.y));
+	float maxX = std::max(std::max(upperLeft.x, upperRight.x), std::max(lowerRight.x, lowerLeft.x));
+	float maxY = std::max(std::max(upperLeft.y, upperRight.y), std::max(lowerRight.y, lowerLeft.y));
+	Rect quadBounds(minX, minY, maxX - minX, maxY - minY);
+
+	// Find (or create) the batch this quad goes in, and grow the batch's bounds to include it.
+	Batch& batch = GetBatch(quadBounds);
+	if(batch.vertices.empty())
+	{
+		batch.bounds = quadBounds;
+	}
+	else
+	{
+		Vector2 min(std::min(batch.bounds.x, minX), std::min(batch.bounds.y, minY));
+		Vector2 max(std::max(batch.bounds.x + batch.bounds.width, maxX), std::max(batch.bounds.y + batch.bounds.height, maxY));
+		batch.bounds = Rect(min, max);
+	}
+
+	// Add the vertices. Order is upper-left, upper-right, lower-right, lower-left (same as the UI quad mesh).
+	float r = color.GetR() / 255.0f;
+	float g = color.GetG() / 255.0f;
+	float b = color.GetB() / 255.0f;
+	float a = color.GetA() / 255.0f;
+	batch.vertices.push_back({ upperLeft.x, upperLeft.y, upperLeft.z, r, g, b, a, upperLeftUV.x, upperLeftUV.y });
+	batch.vertices.push_back({ upperRight.x, upperRight.y, upperRight.z, r, g, b, a, lowerRightUV.x, upperLeftUV.y });
+	batch.vertices.push_back({ lowerRight.x, lowerRight.y, lowerRight.z, r, g, b, a, lowerRightUV.x, lowerRightUV.y });
+	batch.vertices.push_back({ lowerLeft.x, lowerLeft.y, lowerLeft.z, r, g, b, a, upperLeftUV.x, lowerRightUV.y });
+	++mQuadCount;
+}
+
+UIBatchList::Batch& UIBatchList::GetBatch(const Rect& quadBounds)
+{
+	// Look back through batches for one with the same look.
+	// A quad can only move back to an earlier batch if it doesn't overlap anything drawn after that batch.
+	// Otherwise, drawing it early would put it under something it was supposed to be on top of.
+	for(int i = mBatchCount - 1; i >= 0; --i)
+	{
+		Batch& batch = mBatches[i];
+		if(batch.shader == mShader && batch.texture == mTexture && batch.replaceColor == mReplaceColor)
+		{
+			return batch;
+		}
+		if(OverlapsInterior(batch.bounds, quadBounds))
+		{
+			break;
+		}
+	}
+
+	// Need a new batch. Reuse an old one if possible, so its vertex memory is reused too.
+	if(mBatchCount == mBatches.size())
+	{
+		mBatches.emplace_back();
+	}
+	Batch& batch = mBatches[mBatchCount];
+	++mBatchCount;
+
+	batch.shader = mShader;
+	batch.texture = mTexture;
+	batch.replaceColor = mReplaceColor;
+	return batch;
+}
@@ -0,0 +1,80 @@
+//
+// UIBatchList.h
+//
+// Clark Kromenaker
+//
+// Groups UI quads into batches that share a shader, texture, and replace color, for UIBatcher to draw.
+//
+// A quad can join an earlier batch with the same look, as long as it doesn't overlap
+// anything added after that batch - so the result looks the same as drawing every quad in order.
+//
+// The list never looks inside the shaders or textures it's given - they are only used to compare looks.
+// So, it doesn't need a GL context to work.
+//
+#pragma once
+#include <vector>
+
+#include "Color32.h"
+#include "Rect.h"
+#include "Vector2.h"
+#include "Vector3.h"
+
+class Shader;
+class Texture;
+
+class UIBatchList
+{
+public:
+	struct Vertex
+	{
+		float x, y, z;
+		float r, g, b, a;
+		float u, v;
+	};
+
+	struct Batch
+	{
+		// What quads in the batch look like.
+		Shader* shader = nullptr;
+		Texture* texture = nullptr;
+		Color32 replaceColor;
+
+		// World space bounds of all quads in the batch, for overlap checks.
+		Rect bounds;
+
+		// Four vertices per quad.
+		std::vector<Vertex> vertices;
+	};
+
+	// Removes all quads. Batch memory is kept, so it can be reused.
+	void Clear();
+
+	// Sets what subsequently added quads look like.
+	void SetLook(Shader* shader, Texture* texture, const Color32& replaceColor);
+
+	// Adds a quad. Corners are in world space; UVs are specified for the upper-left and lower-right corners.
+	void AddQuad(const Vector3& upperLeft, const Vector3& upperRight, const Vector3& lowerRight, const Vector3& lowerLeft,
+				 const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color);
+
+	// Batches, in draw order.
+	int GetBatchCount() const { return mBatchCount; }
+	const Batch& GetBatch(int index) const { return mBatches[index]; }
+
+	// Total number of quads, across all batches.
+	int GetQuadCount() const { return mQuadCount; }
+
+private:
+	// Only the first "mBatchCount" batches are in use.
+	// Batches past that are kept around so their vertex memory can be reused.
+	std::vector<Batch> mBatches;
+	int mBatchCount = 0;
+
+	int mQuadCount = 0;
+
+	// Current look, as set by "SetLook".
+	Shader* mShader = nullptr;
+	Texture* mTexture = nullptr;
+	Color32 mReplaceColor;
+
+	Batch& GetBatch(const Rect& quadBounds);
+};
@@ -0,0 +1,128 @@
+//
+// UIBatcher.cpp
+//
+// Clark Kromenaker
+//
+#include "UIBatcher.h"
+
+#include <algorithm>
+
+#include "Services.h"
+#include "Shader.h"
+#include "Texture.h"
+
+/*static*/ Shader* UIBatcher::sDefaultShader = nullptr;
+
+/*static*/ Shader* UIBatcher::GetDefaultShader()
+{
+	// Cached, since this is needed for almost every widget, every frame.
+	if(sDefaultShader == nullptr)
+	{
+		sDefaultShader = Services::GetAssets()->LoadShader("UI-Batch", "3D-Diffuse-Tex");
+	}
+	return sDefaultShader;
+}
+
+void UIBatcher::Begin()
+{
+	// Any quads left over from an unfinished frame are thrown away.
+	mBatches.Clear();
+	mDrawCount = 0;
+	SetTexture(nullptr);
+}
+
+void UIBatcher::SetTexture(Texture* texture, Shader* shader, const Color32& replaceColor)
+{
+	mBatches.SetLook(shader != nullptr ? shader : GetDefaultShader(), texture != nullptr ? texture : &Texture::White, replaceColor);
+}
+
+void UIBatcher::AddQuad(const Vector3& upperLeft, const Vector3& upperRight, const Vector3& lowerRight, const Vector3& lowerLeft,
+						const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color)
+{
+	// If indexes can't address any more quads, draw what we have so far and start over.
+	if(mBatches.GetQuadCount() >= kMaxQuads)
+	{
+		Flush();
+	}
+	mBatches.AddQuad(upperLeft, upperRight, lowerRight, lowerLeft, upperLeftUV, lowerRightUV, color);
+}
+
+void UIBatcher::AddQuad(const Matrix4& transform, const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color)
+{
+	AddQuad(transform.TransformPoint(Vector3(0.0f, 1.0f, 0.0f)),
+			transform.TransformPoint(Vector3(1.0f, 1.0f, 0.0f)),
+			transform.TransformPoint(Vector3(1.0f, 0.0f, 0.0f)),
+			transform.TransformPoint(Vector3(0.0f, 0.0f, 0.0f)),
+			upperLeftUV, lowerRightUV, color);
+}
+
+void UIBatcher::End()
+{
+	Flush();
+}
+
+void UIBatcher::Flush()
+{
+	int quadCount = mBatches.GetQuadCount();
+	if(quadCount > 0)
+	{
+		// Make sure the vertex buffer is big enough. Grow it generously, so this doesn't happen often.
+		if(quadCount > mQuadCapacity)
+		{
+			mQuadCapacity = std::min(kMaxQuads, std::max(quadCount, std::max(mQuadCapacity * 2, 256)));
+
+			// Every quad uses the same index pattern, so the index buffer never needs to change after this.
+			std::vector<unsigned short> indexes;
+			indexes.reserve(mQuadCapacity * 6);
+			for(int i = 0; i < mQuadCapacity; ++i)
+			{
+				unsigned short vertexIndex = static_cast<unsigned short>(i * 4);
+				indexes.push_back(vertexIndex);
+				indexes.push_back(vertexIndex + 1);
+				indexes.push_back(vertexIndex + 2);
+				indexes.push_back(vertexIndex + 2);
+				indexes.push_back(vertexIndex + 3);
+				indexes.push_back(vertexIndex);
+			}
+
+			MeshDefinition meshDefinition;
+			meshDefinition.meshUsage = MeshUsage::Dynamic;
+			meshDefinition.vertexDefinition.layout = VertexDefinition::Layout::Interleaved;
+			meshDefinition.vertexDefinition.attributes.push_back(VertexAttribute::Position);
+			meshDefinition.vertexDefinition.attributes.push_back(VertexAttribute::Color);
+			meshDefinition.vertexDefinition.attributes.push_back(VertexAttribute::UV1);
+			meshDefinition.vertexCount = mQuadCapacity * 4;
+			meshDefinition.indexCount = mQuadCapacity * 6;
+			meshDefinition.indexData = &indexes[0];
+			mVertexArray = VertexArray(meshDefinition);
+		}
+
+		// Put all batches' vertices in draw order, and upload them all at once.
+		mVertices.clear();
+		for(int i = 0; i < mBatches.GetBatchCount(); ++i)
+		{
+			const UIBatchList::Batch& batch = mBatches.GetBatch(i);
+			mVertices.insert(mVertices.end(), batch.vertices.begin(), batch.vertices.end());
+		}
+		mVertexArray.ChangeVertexData(&mVertices[0], static_cast<unsigned int>(mVertices.size()));
+
+		// One draw per batch. Positions are already in world space, so no object transform is needed.
+		unsigned int indexOffset = 0;
+		for(int i = 0; i < mBatches.GetBatchCount(); ++i)
+		{
+			const UIBatchList::Batch& batch = mBatches.GetBatch(i);
+			mMaterial.SetShader(batch.shader);
+			mMaterial.SetDiffuseTexture(batch.texture);
+			mMaterial.SetColor("uReplaceColor", batch.replaceColor);
+			mMaterial.Activate(Matrix4::Identity);
+
+			unsigned int indexCount = static_cast<unsigned int>(batch.vertices.size() / 4 * 6);
+			mVertexArray.DrawTriangles(indexOffset, indexCount);
+			indexOffset += indexCount;
+			++mDrawCount;
+		}
+	}
+
+	// Empty out batches, but keep their memory around for next time.
+	mBatches.Clear();
+}
@@ -0,0 +1,74 @@
+//
+// UIBatcher.h
+//
+// Clark Kromenaker
+//
+// Collects the quads of all widgets on a canvas (images, buttons, text glyphs)
+// into one streaming vertex buffer, and draws them with as few draw calls as possible.
+//
+// Quads are grouped into batches that share a shader, texture, and replace color (see UIBatchList).
+//
+#pragma once
+#include <vector>
+
+#include "Color32.h"
+#include "Material.h"
+#include "Matrix4.h"
+#include "UIBatchList.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "VertexArray.h"
+
+class Shader;
+class Texture;
+
+class UIBatcher
+{
+public:
+	// The default UI shader: the texture multiplied by the quad's color.
+	static Shader* GetDefaultShader();
+
+	// Starts a new frame of UI quads.
+	void Begin();
+
+	// Sets what subsequently added quads look like. If shader is null, the default UI shader is used.
+	// The shader must use the "UI-Batch" vertex shader, since batched quads are in world space and use vertex colors.
+	void SetTexture(Texture* texture, Shader* shader = nullptr, const Color32& replaceColor = Color32::White);
+
+	// Adds a quad. Corners are in world space; UVs are specified for the upper-left and lower-right corners.
+	void AddQuad(const Vector3& upperLeft, const Vector3& upperRight, const Vector3& lowerRight, const Vector3& lowerLeft,
+				 const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color);
+	
+	// Same as above, but the quad is the unit square (0,0) to (1,1), transformed to world space.
+	void AddQuad(const Matrix4& transform, const Vector2& upperLeftUV, const Vector2& lowerRightUV, const Color32& color);
+
+	// Uploads and draws all quads added since "Begin".
+	void End();
+
+	// Number of draw calls made by the last "End" (for debugging/profiling).
+	int GetDrawCount() const { return mDrawCount; }
+
+private:
+	static Shader* sDefaultShader;
+	
+	// Indexes are 16-bit, so a single upload can hold at most this many quads.
+	// If a canvas has more, it is drawn in several uploads.
+	static const int kMaxQuads = 65536 / 4;
+
+	// Batches for the current frame. Their memory is reused from frame to frame.
+	UIBatchList mBatches;
+
+	// All batches are copied into this, in draw order, before uploading.
+	std::vector<UIBatchList::Vertex> mVertices;
+
+	// The streaming vertex buffer, and how many quads it can hold.
+	VertexArray mVertexArray;
+	int mQuadCapacity = 0;
+
+	// Used to set shader uniforms for each batch.
+	Material mMaterial;
+
+	int mDrawCount = 0;
+
+	void Flush();
+};
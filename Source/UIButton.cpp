@@ -6,14 +6,10 @@
 #include "UIButton.h"
 
 #include "Actor.h"
-#include "Camera.h"
-#include "Debug.h"
-#include "Mesh.h"
 #include "Services.h"
 #include "RectTransform.h"
 #include "Texture.h"
-
-extern Mesh* uiQuad;
+#include "UIBatcher.h"
 
 TYPE_DEF_CHILD(UIWidget, UIButton);
 
@@ -23,7 +19,7 @@ UIButton::UIButton(Actor* owner) : UIWidget(owner)
     SetReceivesInput(true);
 }
 
-void UIButton::Render()
+void UIButton::Render(UIBatcher& batcher)
 {
 	if(!IsActiveAndEnabled()) { return; }
 	
@@ -60,12 +56,9 @@ void UIButton::Render()
 	// Make sure widget size matches texture size.
 	GetRectTransform()->SetSizeDelta(texture->GetWidth(), texture->GetHeight());
 	
-	// Set texture.
-	mMaterial.SetDiffuseTexture(texture);
-	
 	// Render.
-	mMaterial.Activate(GetWorldTransformWithSizeForRendering());
-	uiQuad->Render();
+	batcher.SetTexture(texture);
+	batcher.AddQuad(GetWorldTransformWithSizeForRendering(), Vector2::Zero, Vector2::One, Color32::White);
 }
 
 void UIButton::OnPointerEnter()
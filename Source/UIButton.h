@@ -11,7 +11,6 @@
 #include <functional>
 
 #include "CallbackFunction.h"
-#include "Material.h"
 
 class Texture;
 
@@ -21,7 +20,7 @@ class UIButton : public UIWidget
 public:
 	UIButton(Actor* actor);
 	
-	void Render() override;
+	void Render(UIBatcher& batcher) override;
 	
 	void SetUpTexture(Texture* texture) { mUpTexture = texture; }
 	void SetDownTexture(Texture* texture) { mDownTexture = texture; }
@@ -55,9 +54,6 @@ private:
 	// If not, it appears as a "disabled" button (e.g. grayed out) if a disabled texture is provided.
 	bool mCanInteract = true;
 	
-	// Material used for rendering.
-	Material mMaterial;
-	
 	// Callback to execute when the button is pressed.
 	std::function<void()> mPressCallback;
 	
@@ -95,6 +95,16 @@ UICanvas::~UICanvas()
 }
 
 void UICanvas::Render()
+{
+	if(IsActiveAndEnabled())
+	{
+		mBatcher.Begin();
+		Render(mBatcher);
+		mBatcher.End();
+	}
+}
+
+void UICanvas::Render(UIBatcher& batcher)
 {
 	if(IsActiveAndEnabled())
 	{
@@ -102,7 +112,7 @@ void UICanvas::Render()
 		{
 			if(widget->IsActiveAndEnabled())
 			{
-				widget->Render();
+				widget->Render(batcher);
 			}
 		}
 	}
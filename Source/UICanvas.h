@@ -12,6 +12,8 @@
 #pragma once
 #include "UIWidget.h"
 
+#include "UIBatcher.h"
+
 class UICanvas : public UIWidget
 {
 	TYPE_DECL_CHILD();
@@ -23,7 +25,9 @@ public:
 	UICanvas(Actor* owner);
 	~UICanvas();
 	
-	void Render() override;
+	// Draws all widgets on the canvas.
+	void Render();
+	void Render(UIBatcher& batcher) override;
 	
 	void AddWidget(UIWidget* widget);
 	void RemoveWidget(UIWidget* widget);
@@ -39,4 +43,7 @@ private:
 	
 	// All widgets on this canvas.
 	std::vector<UIWidget*> mWidgets;
+	
+	// Collects quads from all widgets, so the whole canvas is drawn with as few draw calls as possible.
+	UIBatcher mBatcher;
 };
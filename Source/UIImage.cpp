@@ -6,20 +6,8 @@
 #include "UIImage.h"
 
 #include "Actor.h"
-#include "Camera.h"
-#include "Debug.h"
-#include "Mesh.h"
 #include "Texture.h"
-
-extern Mesh* uiQuad;
-
-//HACK: Need to revert quad UVs after rendering with repeat.
-static float quad_uvs[] = {
-	0.0f, 0.0f,		// upper-left
-	1.0f, 0.0f,		// upper-right
-	1.0f, 1.0f,		// lower-right
-	0.0f, 1.0f		// lower-left
-};
+#include "UIBatcher.h"
 
 TYPE_DEF_CHILD(UIWidget, UIImage);
 
@@ -29,77 +17,61 @@ UIImage::UIImage(Actor* owner) : UIWidget(owner)
     SetTexture(&Texture::White);
 }
 
-void UIImage::Render()
+void UIImage::Render(UIBatcher& batcher)
 {
 	if(!IsActiveAndEnabled()) { return; }
 	
-	// Activate material and set world transform.
-	mMaterial.Activate(GetWorldTransformWithSizeForRendering());
+	// We need a texture to render (and calculate repeats for tiled rendering).
+	// If none is specified, use plain ol' white.
+	Texture* texture = mTexture;
+	if(texture == nullptr)
+	{
+		texture = &Texture::White;
+	}
+	batcher.SetTexture(texture);
 	
 	// Render based on desired render mode.
+	Vector2 lowerRightUV(1.0f, 1.0f);
 	switch(mRenderMode)
 	{
 		case RenderMode::Normal:
 		{
-			uiQuad->Render();
 			break;
 		}
 		case RenderMode::Tiled:
 		{
-            // We need a texture to render (and calculate repeats for tiled rendering).
-            // If none is specified, use plain ol' white.
-            Texture* texture = mMaterial.GetDiffuseTexture();
-            if(texture == nullptr)
-            {
-                texture = &Texture::White;
-            }
-            
-			// Determine how many repeats are needed.
+			// Determine how many repeats are needed; UVs past 1 repeat the texture.
 			Vector2 size = GetRectTransform()->GetSize();
-			float repeatX = size.x / texture->GetWidth();
-			float repeatY = size.y / texture->GetHeight();
-			
-			// Adjust UVs for repeating textures.
-			float repeat_uvs[] = {
-				0.0f,    0.0f,		// upper-left
-				repeatX, 0.0f,		// upper-right
-				repeatX, repeatY,	// lower-right
-				0.0f,    repeatY	// lower-left
-			};
-			uiQuad->GetSubmesh(0)->SetUV1s(repeat_uvs);
-			
-			// Render.
-			uiQuad->Render();
-			
-			// Revert to "normal" UVs.
-			uiQuad->GetSubmesh(0)->SetUV1s(quad_uvs);
+			lowerRightUV.x = size.x / texture->GetWidth();
+			lowerRightUV.y = size.y / texture->GetHeight();
+			break;
 		}
 		//TODO: Nine-slice?
 	}
+	batcher.AddQuad(GetWorldTransformWithSizeForRendering(), Vector2::Zero, lowerRightUV, mColor);
 }
 
 void UIImage::SetTexture(Texture* texture)
 {
-	mMaterial.SetDiffuseTexture(texture);
+	mTexture = texture;
 }
 
 void UIImage::SetTextureAndSize(Texture *texture)
 {
-	mMaterial.SetDiffuseTexture(texture);
+	mTexture = texture;
 	SetSizeToTextureSize();
 }
 
 void UIImage::SetSizeToTextureSize()
 {
 	// Need a texture to do this!
-	Texture* texture = mMaterial.GetDiffuseTexture();
-	if(texture == nullptr) { return; }
+	if(mTexture == nullptr) { return; }
 	
 	// Set size from texture.
-	GetRectTransform()->SetSizeDelta(texture->GetWidth(), texture->GetHeight());
+	GetRectTransform()->SetSizeDelta(mTexture->GetWidth(), mTexture->GetHeight());
 }
 
 void UIImage::SetColor(const Color32& color)
 {
-	mMaterial.SetColor(color);
+	mColor = color;
 }
@@ -8,9 +8,9 @@
 #pragma once
 #include "UIWidget.h"
 
-#include "Material.h"
+#include "Color32.h"
 
-class Color32;
+class Texture;
 
 class UIImage : public UIWidget
 {
@@ -25,7 +25,7 @@ class UIImage : public UIWidget
 public:
     UIImage(Actor* actor);
 	
-    void Render() override;
+    void Render(UIBatcher& batcher) override;
 	
 	void SetTexture(Texture* texture);
 	void SetTextureAndSize(Texture* texture);
@@ -37,6 +37,9 @@ public:
 	void SetRenderMode(RenderMode mode) { mRenderMode = mode; }
 	
 private:
-	Material mMaterial;
+	// Texture to display, and color to multiply it by.
+	Texture* mTexture = nullptr;
+	Color32 mColor = Color32::White;
+	
 	RenderMode mRenderMode = RenderMode::Normal;
 };
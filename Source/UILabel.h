@@ -8,15 +8,15 @@
 #pragma once
 #include "UIWidget.h"
 
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Color32.h"
-#include "Material.h"
 #include "TextLayout.h"
 
 class Font;
-class Mesh;
 
 class UILabel : public UIWidget
 {
@@ -24,7 +24,7 @@ class UILabel : public UIWidget
 public:
 	UILabel(Actor* owner);
 	
-	void Render() override;
+	void Render(UIBatcher& batcher) override;
 	
 	void SetFont(Font* font);
 	Font* GetFont() const { return mFont; }
@@ -32,22 +32,28 @@ public:
     void SetColor(const Color32& color);
     Color32 GetColor() const { return mColor; }
     
-	void SetHorizonalAlignment(HorizontalAlignment ha) { mHorizontalAlignment = ha; }
-	void SetVerticalAlignment(VerticalAlignment va) { mVerticalAlignment = va; }
+	void SetHorizonalAlignment(HorizontalAlignment ha) { mHorizontalAlignment = ha; SetDirty(); }
+	void SetVerticalAlignment(VerticalAlignment va) { mVerticalAlignment = va; SetDirty(); }
 	
-	void SetHorizontalOverflow(HorizontalOverflow ho) { mHorizontalOverflow = ho; }
-	void SetVerticalOverflow(VerticalOverflow vo) { mVerticalOverflow = vo; }
+	void SetHorizontalOverflow(HorizontalOverflow ho) { mHorizontalOverflow = ho; SetDirty(); }
+	HorizontalOverflow GetHorizontalOverflow() const { return mHorizontalOverflow; }
+	void SetVerticalOverflow(VerticalOverflow vo) { mVerticalOverflow = vo; SetDirty(); }
 	
 	void SetText(std::string text);
 	std::string GetText() const { return mText; }
     
 protected:
 	Vector2 GetCharPos(int index) const;
-	Vector2 GetNextCharPos() const { return mTextLayout.GetNextCharPos(); }
+	Vector2 GetNextCharPos() const { return GetTextLayout().GetNextCharPos(); }
 	
+	// Subclasses can lay out something other than the label's text. If so, they must turn off layout sharing.
 	virtual void PopulateTextLayout(TextLayout& textLayout);
+	void SetShareLayout(bool shareLayout) { mShareLayout = shareLayout; SetDirty(); }
 	
-	void SetDirty() { mNeedMeshRegen = true; }
+	void SetDirty() { mNeedLayout = true; }
+	
+	// Adds a quad for each char in the layout, moved up by "offsetY". Chars that would extend above "maxY" are skipped.
+	void AddGlyphs(UIBatcher& batcher, const TextLayout& textLayout, float offsetY = 0.0f, float maxY = std::numeric_limits<float>::max());
 	
 private:
 	// The font used to display the label.
@@ -65,18 +71,18 @@ private:
 	std::string mText;
 	
 	// Helper for laying out text within the available space with desired alignment/overflow.
+	// Most labels use a layout shared with any other label showing the same text, so changing text back and forth is cheap.
+	// Labels that lay out their own text (via PopulateTextLayout) use their own layout instead.
+	bool mShareLayout = true;
+	std::shared_ptr<const TextLayout> mSharedTextLayout;
 	TextLayout mTextLayout;
     
     // Text color.
     Color32 mColor = Color32::White;
 	
-	// Material used for rendering.
-	Material mMaterial;
-	
-	// Mesh used for rendering.
-	// This is generated from the desired text before rendering.
-	Mesh* mMesh = nullptr;
-	bool mNeedMeshRegen = false;
+	// If true, the text layout must be regenerated before rendering.
+	bool mNeedLayout = true;
 	
-	void GenerateMesh();
+	const TextLayout& GetTextLayout() const { return mSharedTextLayout != nullptr ? *mSharedTextLayout : mTextLayout; }
+	void GenerateLayout();
 };
@@ -5,9 +5,10 @@
 //
 #include "UITextBuffer.h"
 
+#include <algorithm>
 #include <string>
-#include <vector>
 
+#include "Font.h"
 #include "Services.h"
 
 TYPE_DEF_CHILD(UILabel, UITextBuffer);
@@ -17,38 +18,67 @@ UITextBuffer::UITextBuffer(Actor* owner) : UILabel(owner)
 	
 }
 
-void UITextBuffer::OnUpdate(float deltaTime)
+void UITextBuffer::Render(UIBatcher& batcher)
 {
-	auto& scrollback = Services::GetConsole()->GetScrollback();
-	if(mLastBufferLength != scrollback.size())
+	if(!IsActiveAndEnabled()) { return; }
+	
+	// Need font to render.
+	Font* font = GetFont();
+	if(font == nullptr) { return; }
+	
+	// If font or horizontal extents changed, cached layouts are no good anymore.
+	Rect rect = GetRectTransform()->GetRect();
+	if(font != mLayoutFont || rect.x != mLayoutMinX || rect.width != mLayoutWidth)
 	{
-		SetDirty();
+		mLineLayouts.clear();
+		mLayoutFont = font;
+		mLayoutMinX = rect.x;
+		mLayoutWidth = rect.width;
 	}
-	mLastBufferLength = (int)scrollback.size();
-}
-
-void UITextBuffer::PopulateTextLayout(TextLayout& textLayout)
-{
-	auto& scrollback = Services::GetConsole()->GetScrollback();
 	
-	int startIndex = (int)scrollback.size() - mLineOffset - mLineCount;
-	if(startIndex < 0)
+	// Mark all layouts as not visible. Any still not visible after this frame are removed below.
+	for(auto& entry : mLineLayouts)
 	{
-		startIndex = 0;
+		entry.second.visible = false;
 	}
 	
-	int endIndex = startIndex + mLineCount;
-	for(int i = startIndex; i < endIndex; ++i)
+	// Going from the newest visible line to older ones, stack lines upwards from the bottom of the rect.
+	// Stop once all available rows are filled. The oldest visible line may wrap, and only some of its rows may fit.
+	Console* console = Services::GetConsole();
+	int lineCount = console->GetScrollbackLength();
+	U64 firstLineId = console->GetScrollbackAddCount() - lineCount;
+	int lineHeight = font->GetGlyphHeight();
+	float maxY = rect.GetMax().y;
+	int rowCount = 0;
+	for(int i = lineCount - 1 - mLineOffset; i >= 0 && rowCount < mLineCount; --i)
 	{
-		// Stop if we run out of scrollback data.
-		if(i >= scrollback.size()) { break; }
+		// Lay out this line, if it wasn't visible last time.
+		auto it = mLineLayouts.find(firstLineId + i);
+		if(it == mLineLayouts.end())
+		{
+			it = mLineLayouts.emplace(firstLineId + i, LineLayout()).first;
+			it->second.layout = TextLayout(Rect(rect.x, 0.0f, rect.width, 0.0f), font,
+										   HorizontalAlignment::Left, VerticalAlignment::Bottom,
+										   GetHorizontalOverflow(), VerticalOverflow::Overflow);
+			it->second.layout.AddLine(console->GetScrollbackLine(i));
+		}
+		it->second.visible = true;
 		
-		// Add this line to the layout!
-		textLayout.AddLine(scrollback[i]);
-		
-		// Scrollback will wrap lines that are too long, so a single line in the scrollback
-		// might take up two or more in the actual text buffer, depending on resolution and rect settings.
-		// So, check if line count meets desired line count and break out if so.
-		if(textLayout.GetLineCount() >= mLineCount) { break; }
+		// Draw it above lines drawn so far.
+		AddGlyphs(batcher, it->second.layout, rect.y + rowCount * lineHeight, maxY);
+		rowCount += std::max(it->second.layout.GetLineCount(), 1);
+	}
+	
+	// Forget layouts of lines that scrolled out of view.
+	for(auto it = mLineLayouts.begin(); it != mLineLayouts.end();)
+	{
+		if(!it->second.visible)
+		{
+			it = mLineLayouts.erase(it);
+		}
+		else
+		{
+			++it;
+		}
 	}
 }
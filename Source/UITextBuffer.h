@@ -9,22 +9,26 @@
 // Initial/primary use is implementing a scrollback buffer for
 // an in-game console UI.
 //
+// The buffer can be huge, so only visible lines are laid out and drawn.
+// Each line's layout is cached while it's visible, so adding lines or scrolling only lays out newly visible lines.
+//
 #pragma once
 #include "UILabel.h"
 
+#include <unordered_map>
+
+#include "Atomics.h"
+
 class UITextBuffer : public UILabel
 {
 	TYPE_DECL_CHILD();
 public:
 	UITextBuffer(Actor* owner);
 	
-	void SetLineCount(int lineCount) { mLineCount = lineCount; SetDirty(); }
-	void SetLineOffset(int lineOffset) { mLineOffset = lineOffset; SetDirty(); }
+	void Render(UIBatcher& batcher) override;
 	
-protected:
-	void OnUpdate(float deltaTime) override;
-	
-	void PopulateTextLayout(TextLayout& textLayout) override;
+	void SetLineCount(int lineCount) { mLineCount = lineCount; }
+	void SetLineOffset(int lineOffset) { mLineOffset = lineOffset; }
 	
 private:
 	// Number of lines to display in the buffer.
@@ -33,6 +37,18 @@ private:
 	// Offset from the end of the buffer to display.
 	int mLineOffset = 0;
 	
-	// Last recorded buffer length; to determine whether we need to update the layout!
-	int mLastBufferLength = 0;
+	// Layouts of visible scrollback lines, keyed by the line's add count (which uniquely identifies it; see Console).
+	// Each line is laid out on its own, with its last row at y=0.
+	struct LineLayout
+	{
+		TextLayout layout;
+		bool visible = false;
+	};
+	std::unordered_map<U64, LineLayout> mLineLayouts;
+	
+	// Line layouts depend on the font and the rect's horizontal extents (and overflow, which isn't expected to change).
+	// If those change, all lines must be laid out again.
+	Font* mLayoutFont = nullptr;
+	float mLayoutMinX = 0.0f;
+	float mLayoutWidth = 0.0f;
 };
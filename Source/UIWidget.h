@@ -11,6 +11,8 @@
 
 #include "RectTransform.h"
 
+class UIBatcher;
+
 class UIWidget : public Component
 {
     TYPE_DECL_CHILD();
@@ -18,7 +20,8 @@ public:
     UIWidget(Actor* actor);
     virtual ~UIWidget();
     
-	virtual void Render() = 0;
+	// Widgets don't draw themselves; they add their quads to the canvas's batcher, which draws them all at once.
+	virtual void Render(UIBatcher& batcher) = 0;
 	
 	virtual void OnPointerEnter() { }
 	virtual void OnPointerExit() { }
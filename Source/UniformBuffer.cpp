@@ -0,0 +1,40 @@
+//
+// UniformBuffer.cpp
+//
+// Clark Kromenaker
+//
+#include "UniformBuffer.h"
+
+/*static*/ const char* UniformBuffer::kFrameBlockName = "FrameBlock";
+/*static*/ const char* UniformBuffer::kMaterialBlockName = "MaterialBlock";
+
+/*static*/ bool UniformBuffer::IsSupported()
+{
+	return GLEW_VERSION_3_1 || GLEW_ARB_uniform_buffer_object;
+}
+
+UniformBuffer::UniformBuffer(unsigned int size) :
+	mSize(size)
+{
+	glGenBuffers(1, &mBuffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, mSize, nullptr, GL_DYNAMIC_DRAW);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	glDeleteBuffers(1, &mBuffer);
+}
+
+void UniformBuffer::SetData(const void* data)
+{
+	// Blocks are small and may be rewritten several times a frame while earlier draws still read the old contents.
+	// Giving GL a new buffer store each time (rather than writing into the current one) avoids waiting on those draws.
+	glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+	glBufferData(GL_UNIFORM_BUFFER, mSize, data, GL_DYNAMIC_DRAW);
+}
+
+void UniformBuffer::Bind(GLuint bindingPoint)
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, mBuffer);
+}
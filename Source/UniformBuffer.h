@@ -0,0 +1,71 @@
+//
+// UniformBuffer.h
+//
+// Clark Kromenaker
+//
+// A GPU buffer that holds the values of a uniform block, so a whole group of uniforms
+// can be given to a shader by binding the buffer, rather than setting uniforms one at a time.
+//
+// All shaders share two blocks (std140 layout), declared identically in each shader that uses them:
+// - "FrameBlock" holds values that are the same for every draw in a part of the frame (camera matrices, alpha test).
+// - "MaterialBlock" holds a material's colors.
+//
+// If uniform buffers aren't supported, shaders are compiled without "USE_UNIFORM_BUFFERS" defined,
+// and fall back to plain uniforms with the same names.
+//
+#pragma once
+#include <GL/glew.h>
+
+#include "Matrix4.h"
+
+// CPU-side copy of "FrameBlock". Must match the std140 layout declared in the shaders.
+struct FrameUniformBlock
+{
+	Matrix4 viewMatrix;
+	Matrix4 projMatrix;
+	Matrix4 worldToProjMatrix;
+	float alphaTest = 0.0f;
+	float padding[3] = { 0.0f, 0.0f, 0.0f };
+};
+static_assert(sizeof(FrameUniformBlock) == 208, "FrameUniformBlock doesn't match std140 layout of FrameBlock");
+
+// CPU-side copy of "MaterialBlock". Must match the std140 layout declared in the shaders.
+struct MaterialUniformBlock
+{
+	float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	float replaceColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+static_assert(sizeof(MaterialUniformBlock) == 32, "MaterialUniformBlock doesn't match std140 layout of MaterialBlock");
+
+class UniformBuffer
+{
+public:
+	// Names of the shared blocks, and the binding point each is always bound to.
+	static const char* kFrameBlockName;
+	static const char* kMaterialBlockName;
+	static const GLuint kFrameBlockBinding = 0;
+	static const GLuint kMaterialBlockBinding = 1;
+	
+	// Whether the GL driver supports uniform buffers. Requires an active GL context.
+	static bool IsSupported();
+	
+	UniformBuffer(unsigned int size);
+	~UniformBuffer();
+	
+	// UniformBuffers contain handles to GPU resources, so don't allow copying!
+	UniformBuffer(const UniformBuffer& other) = delete;
+	UniformBuffer& operator=(const UniformBuffer& other) = delete;
+	
+	// Replaces the contents of the buffer. Size must be the size the buffer was created with.
+	void SetData(const void* data);
+	
+	// Binds the buffer to a binding point, so shader blocks bound to that point read from this buffer.
+	void Bind(GLuint bindingPoint);
+	
+private:
+	// Handle to the GL buffer.
+	GLuint mBuffer = GL_NONE;
+	
+	// Size of the buffer, in bytes.
+	unsigned int mSize = 0;
+};
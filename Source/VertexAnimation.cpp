@@ -7,8 +7,8 @@
 
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 #include <vector>
-#include <unordered_map>
 
 #include "BinaryReader.h"
 #include "GMath.h"
@@ -16,158 +16,272 @@
 
 //#define DEBUG_OUTPUT
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define VERTEX_ANIMATION_SSE
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define VERTEX_ANIMATION_NEON
+#endif
+
+namespace
+{
+	// Dequantizes and lerps "count" values from "from" to "to" and writes them to "out".
+	// Vertex positions are just packed values, so there's no need to treat them as Vector3 here - we can do 4 values at a time.
+	//
+	// Since offset/scale are the same for both keyframes, we can fold them into the lerp:
+	// out = offset + (scale * ((1 - t) * from + t * to)) = offset + ((1 - t) * scale * from) + (t * scale * to)
+	void DequantizeLerp(const uint16_t* from, const uint16_t* to, float t, float offset, float scale, float* out, int count)
+	{
+		const float fromScale = (1.0f - t) * scale;
+		const float toScale = t * scale;
+		
+		int i = 0;
+		#if defined(VERTEX_ANIMATION_SSE)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 offsetVec = _mm_set1_ps(offset);
+		const __m128 fromScaleVec = _mm_set1_ps(fromScale);
+		const __m128 toScaleVec = _mm_set1_ps(toScale);
+		for(; i + 4 <= count; i += 4)
+		{
+			// Load 4 ushorts and widen them to 4 floats.
+			__m128 fromVec = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(from + i)), zero));
+			__m128 toVec = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(to + i)), zero));
+			__m128 result = _mm_add_ps(offsetVec, _mm_add_ps(_mm_mul_ps(fromScaleVec, fromVec), _mm_mul_ps(toScaleVec, toVec)));
+			_mm_storeu_ps(out + i, result);
+		}
+		#elif defined(VERTEX_ANIMATION_NEON)
+		const float32x4_t offsetVec = vdupq_n_f32(offset);
+		const float32x4_t fromScaleVec = vdupq_n_f32(fromScale);
+		const float32x4_t toScaleVec = vdupq_n_f32(toScale);
+		for(; i + 4 <= count; i += 4)
+		{
+			// Load 4 ushorts and widen them to 4 floats.
+			float32x4_t fromVec = vcvtq_f32_u32(vmovl_u16(vld1_u16(from + i)));
+			float32x4_t toVec = vcvtq_f32_u32(vmovl_u16(vld1_u16(to + i)));
+			float32x4_t result = vaddq_f32(offsetVec, vaddq_f32(vmulq_f32(fromScaleVec, fromVec), vmulq_f32(toScaleVec, toVec)));
+			vst1q_f32(out + i, result);
+		}
+		#endif
+		
+		// Handle any leftovers (or everything, if no SIMD is available).
+		for(; i < count; ++i)
+		{
+			out[i] = offset + (fromScale * from[i]) + (toScale * to[i]);
+		}
+	}
+}
+
 VertexAnimation::VertexAnimation(std::string name, char* data, int dataLength) : Asset(name)
 {
     ParseFromData(data, dataLength);
 }
 
-Vector3 VertexAnimation::SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex)
+VertexAnimation::~VertexAnimation()
 {
-	float duration = GetDuration(framesPerSecond);
-	float localTime = time;
-	if(localTime > duration)
+	if(mBuffer != nullptr && mBufferDeleter != nullptr)
 	{
-		localTime = Math::Mod(time, duration);
+		mBufferDeleter(mBuffer);
 	}
-	
-	float currentPoseTime = 0.0f;
-    float nextPoseTime = 0.0f;
-	
-	// Find the first vertex pose defined for this mesh/submesh.
-	VertexAnimationVertexPose* firstVertexPose = nullptr;
-	auto it = mVertexPoses.find(meshIndex);
-	if(it != mVertexPoses.end())
-	{
-		auto it2 = it->second.find(submeshIndex);
-		if(it2 != it->second.end())
-		{
-			firstVertexPose = it2->second;
-		}
-	}
-	
-	// If no vertex pose was found, we'll have to return an error state.
-	if(firstVertexPose == nullptr)
+}
+
+Vector3 VertexAnimation::SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex)
+{
+	// If no vertex keyframes exist for this mesh/submesh, we'll have to return an error state.
+	const VertexAnimationVertexKeyframes* keyframes = GetVertexKeyframes(meshIndex, submeshIndex);
+	if(keyframes == nullptr || vertexIndex < 0 || vertexIndex >= keyframes->mVertexCount)
 	{
 		return Vector3::Zero;
 	}
 	
-	// Calculate how many seconds should be used for a single frame - used later.
-    float secondsPerFrame = 1.0f / framesPerSecond;
-	
-	// Determine the poses right before the desired local time on the animation.
-    VertexAnimationVertexPose* currentVertexPose = firstVertexPose;
-    while(currentVertexPose->mNext != nullptr)
-    {
-        currentPoseTime = secondsPerFrame * currentVertexPose->mFrameNumber;
-        nextPoseTime = secondsPerFrame * currentVertexPose->mNext->mFrameNumber;
-        if(nextPoseTime > localTime) { break; }
-		
-        currentVertexPose = currentVertexPose->mNext;
-    }
-	
-	// Get the next pose, after the desired local time.
-	// If it doesn't exist, loop back to the first pose.
-    VertexAnimationVertexPose* nextVertexPose = currentVertexPose->mNext;
-    if(nextVertexPose == nullptr)
-    {
-		nextVertexPose = currentVertexPose;
-		nextPoseTime = currentPoseTime;
-    }
-    
-    // Determine our "t" value between the current and next pose.
-    float t = 1.0f;
-    if(!Math::IsZero(nextPoseTime - currentPoseTime))
-    {
-        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
-    }
-    assert(t >= 0.0f && t <= 1.0f);
+	// Determine the keyframes on either side of the desired time.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 1.0f;
+	FindKeyframes(keyframes->mFrameNumbers, GetLocalTime(time, framesPerSecond), framesPerSecond, currentIndex, nextIndex, t);
 	
     // Now calculate interpolated positions between current and next poses for this time t.
-	return Vector3::Lerp(currentVertexPose->mVertexPositions[vertexIndex], nextVertexPose->mVertexPositions[vertexIndex], t);
+	return Vector3::Lerp(keyframes->GetPosition(currentIndex, vertexIndex), keyframes->GetPosition(nextIndex, vertexIndex), t);
 }
 
 VertexAnimationVertexPose VertexAnimation::SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex)
 {
-	float duration = GetDuration(framesPerSecond);
-	float localTime = time;
-	if(localTime > duration)
+	// If no vertex keyframes exist for this mesh/submesh, we'll have to return an error state.
+	VertexAnimationVertexPose pose;
+	const VertexAnimationVertexKeyframes* keyframes = GetVertexKeyframes(meshIndex, submeshIndex);
+	if(keyframes == nullptr)
 	{
-		localTime = Math::Mod(time, duration);
+		pose.mFrameNumber = -1;
+		return pose;
 	}
 	
-    float currentPoseTime = 0.0f;
-    float nextPoseTime = 0.0f;
+	// Determine the keyframes on either side of the desired time.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 1.0f;
+	FindKeyframes(keyframes->mFrameNumbers, GetLocalTime(time, framesPerSecond), framesPerSecond, currentIndex, nextIndex, t);
+	pose.mFrameNumber = keyframes->mFrameNumbers[currentIndex];
 	
-	// Find the first vertex pose defined for this mesh/submesh.
-	VertexAnimationVertexPose* firstVertexPose = nullptr;
-	auto it = mVertexPoses.find(meshIndex);
-	if(it != mVertexPoses.end())
+    // Now calculate interpolated positions between current and next poses for this time t.
+	// Vector3 is tightly packed floats, so we can lerp straight into the pose's positions.
+	pose.mVertexPositions.resize(keyframes->mVertexCount);
+	DequantizeLerp(keyframes->GetPositions(currentIndex), keyframes->GetPositions(nextIndex), t, keyframes->mOffset, keyframes->mScale,
+				   reinterpret_cast<float*>(pose.mVertexPositions.data()), keyframes->mVertexCount * 3);
+    return pose;
+}
+
+bool VertexAnimation::SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex, float* outPositions, int vertexCount)
+{
+	// Need keyframes for this mesh/submesh, and they must match the vertex count of the buffer.
+	const VertexAnimationVertexKeyframes* keyframes = GetVertexKeyframes(meshIndex, submeshIndex);
+	if(keyframes == nullptr || outPositions == nullptr || keyframes->mVertexCount != vertexCount)
 	{
-		auto it2 = it->second.find(submeshIndex);
-		if(it2 != it->second.end())
-		{
-			firstVertexPose = it2->second;
-		}
+		return false;
 	}
 	
-	// If no vertex pose was found, we'll have to return an error state.
-	if(firstVertexPose == nullptr)
+	// Determine the keyframes on either side of the desired time.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 1.0f;
+	FindKeyframes(keyframes->mFrameNumbers, GetLocalTime(time, framesPerSecond), framesPerSecond, currentIndex, nextIndex, t);
+	
+    // Now calculate interpolated positions between current and next poses for this time t.
+	DequantizeLerp(keyframes->GetPositions(currentIndex), keyframes->GetPositions(nextIndex), t, keyframes->mOffset, keyframes->mScale,
+				   outPositions, vertexCount * 3);
+	return true;
+}
+
+bool VertexAnimation::FindVertexKeyframes(float time, int framesPerSecond, int meshIndex, int submeshIndex, int& currentIndex, int& nextIndex, float& t) const
+{
+	const VertexAnimationVertexKeyframes* keyframes = GetVertexKeyframes(meshIndex, submeshIndex);
+	if(keyframes == nullptr)
+	{
+		return false;
+	}
+	FindKeyframes(keyframes->mFrameNumbers, GetLocalTime(time, framesPerSecond), framesPerSecond, currentIndex, nextIndex, t);
+	return true;
+}
+
+VertexAnimationTransformPose VertexAnimation::SampleTransformPose(float time, int framesPerSecond, int meshIndex)
+{
+	// If no transform keyframes exist for this mesh, return an error state.
+	VertexAnimationTransformPose pose;
+	if(meshIndex < 0 || meshIndex >= mTransformKeyframes.size() || mTransformKeyframes[meshIndex].mPoses.empty())
 	{
-		VertexAnimationVertexPose pose;
 		pose.mFrameNumber = -1;
 		return pose;
 	}
 	
-	// Calculate how many seconds should be used for a single frame - used later.
-    float secondsPerFrame = 1.0f / framesPerSecond;
-	
-	// Determine the poses right before the desired local time on the animation.
-    VertexAnimationVertexPose* currentVertexPose = firstVertexPose;
-    while(currentVertexPose->mNext != nullptr)
-    {
-        currentPoseTime = secondsPerFrame * currentVertexPose->mFrameNumber;
-        nextPoseTime = secondsPerFrame * currentVertexPose->mNext->mFrameNumber;
-        if(nextPoseTime > localTime) { break; }
-		
-        currentVertexPose = currentVertexPose->mNext;
-    }
-	
-	// Get the next pose, after the desired local time.
-	// If it doesn't exist, loop back to the first pose.
-    VertexAnimationVertexPose* nextVertexPose = currentVertexPose->mNext;
-    if(nextVertexPose == nullptr)
-    {
-		// Clamp approach.
-		nextVertexPose = currentVertexPose;
-		nextPoseTime = currentPoseTime;
-		
-		// Loop approach.
-        //nextVertexPose = firstVertexPose;
-        //nextPoseTime = GetDuration(framesPerSecond);
-    }
-    
-    // Determine our "t" value between the current and next pose.
-    float t = 1.0f;
-    if(!Math::IsZero(nextPoseTime - currentPoseTime))
-    {
-        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
-    }
-    assert(t >= 0.0f && t <= 1.0f);
+	// Determine between which two transform poses the desired local time is located.
+	// E.g. if local time is 50% between pose 5 and 6, we  want to interpolate 50% between those two poses.
+	const VertexAnimationTransformKeyframes& keyframes = mTransformKeyframes[meshIndex];
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 1.0f;
+	FindKeyframes(keyframes.mFrameNumbers, GetLocalTime(time, framesPerSecond), framesPerSecond, currentIndex, nextIndex, t);
 	
-    // Now calculate interpolated positions between current and next poses for this time t.
-	VertexAnimationVertexPose pose;
-    for(int i = 0; i < currentVertexPose->mVertexPositions.size(); i++)
-    {
-        pose.mVertexPositions.push_back(Vector3::Lerp(currentVertexPose->mVertexPositions[i], nextVertexPose->mVertexPositions[i], t));
-    }
+	// Finally, create a pose with lerp/slerp that is interpolated between the two poses.
+	const VertexAnimationTransformPose& currentTransformPose = keyframes.mPoses[currentIndex];
+	const VertexAnimationTransformPose& nextTransformPose = keyframes.mPoses[nextIndex];
+	pose.mFrameNumber = currentTransformPose.mFrameNumber;
+    pose.mLocalPosition = Vector3::Lerp(currentTransformPose.mLocalPosition, nextTransformPose.mLocalPosition, t);
+	pose.mLocalScale = Vector3::Lerp(currentTransformPose.mLocalScale, nextTransformPose.mLocalScale, t);
+    Quaternion::Slerp(pose.mLocalRotation, currentTransformPose.mLocalRotation, nextTransformPose.mLocalRotation, t);
     return pose;
 }
 
-VertexAnimationTransformPose VertexAnimation::SampleTransformPose(float time, int framesPerSecond, int meshIndex)
+size_t VertexAnimation::GetVertexDataSize() const
 {
-	// Calculate how many seconds should be used for a single frame.
-	float secondsPerFrame = 1.0f / framesPerSecond;
+	size_t size = 0;
+	for(auto& meshKeyframes : mVertexKeyframes)
+	{
+		for(auto& keyframes : meshKeyframes)
+		{
+			size += sizeof(VertexAnimationVertexKeyframes);
+			size += keyframes.mFrameNumbers.capacity() * sizeof(int);
+			size += keyframes.mPositions.capacity() * sizeof(uint16_t);
+		}
+	}
+	return size;
+}
+
+size_t VertexAnimation::GetUnquantizedVertexDataSize() const
+{
+	// Same as above, but with a float per component (and no offset/scale).
+	size_t size = 0;
+	for(auto& meshKeyframes : mVertexKeyframes)
+	{
+		for(auto& keyframes : meshKeyframes)
+		{
+			size += sizeof(VertexAnimationVertexKeyframes) - (2 * sizeof(float));
+			size += keyframes.mFrameNumbers.capacity() * sizeof(int);
+			size += keyframes.mPositions.size() * sizeof(float);
+		}
+	}
+	return size;
+}
+
+const VertexAnimationVertexKeyframes* VertexAnimation::GetVertexKeyframes(int meshIndex, int submeshIndex) const
+{
+	if(meshIndex < 0 || meshIndex >= mVertexKeyframes.size()) { return nullptr; }
+	if(submeshIndex < 0 || submeshIndex >= mVertexKeyframes[meshIndex].size()) { return nullptr; }
 	
+	const VertexAnimationVertexKeyframes& keyframes = mVertexKeyframes[meshIndex][submeshIndex];
+	return keyframes.mFrameNumbers.empty() ? nullptr : &keyframes;
+}
+
+VertexAnimationVertexKeyframes& VertexAnimation::GetOrCreateVertexKeyframes(int meshIndex, int submeshIndex)
+{
+	if(meshIndex >= mVertexKeyframes.size())
+	{
+		mVertexKeyframes.resize(meshIndex + 1);
+	}
+	if(submeshIndex >= mVertexKeyframes[meshIndex].size())
+	{
+		mVertexKeyframes[meshIndex].resize(submeshIndex + 1);
+	}
+	return mVertexKeyframes[meshIndex][submeshIndex];
+}
+
+void VertexAnimation::QuantizeVertexKeyframes(const std::vector<std::vector<std::vector<Vector3>>>& positions)
+{
+	for(int i = 0; i < positions.size(); ++i)
+	{
+		for(int j = 0; j < positions[i].size(); ++j)
+		{
+			const std::vector<Vector3>& submeshPositions = positions[i][j];
+			if(submeshPositions.empty()) { continue; }
+			
+			// Find the min/max component value over all keyframes for this submesh.
+			float min = submeshPositions[0].x;
+			float max = submeshPositions[0].x;
+			for(auto& position : submeshPositions)
+			{
+				min = Math::Min(min, Math::Min(position.x, Math::Min(position.y, position.z)));
+				max = Math::Max(max, Math::Max(position.x, Math::Max(position.y, position.z)));
+			}
+			
+			// Map that range onto the full range of a ushort.
+			VertexAnimationVertexKeyframes& keyframes = mVertexKeyframes[i][j];
+			keyframes.mOffset = min;
+			keyframes.mScale = (max - min) / 65535.0f;
+			float invScale = Math::IsZero(keyframes.mScale) ? 0.0f : (1.0f / keyframes.mScale);
+			
+			keyframes.mPositions.resize(submeshPositions.size() * 3);
+			for(int k = 0; k < submeshPositions.size(); ++k)
+			{
+				for(int l = 0; l < 3; ++l)
+				{
+					float quantized = Math::Round((submeshPositions[k][l] - min) * invScale);
+					keyframes.mPositions[k * 3 + l] = static_cast<uint16_t>(Math::Clamp(quantized, 0.0f, 65535.0f));
+				}
+			}
+		}
+	}
+}
+
+float VertexAnimation::GetLocalTime(float time, int framesPerSecond) const
+{
 	// Caller may pass in a global time that extends beyond the local time of this particular animation.
 	// Desire here is for the animation to "loop", so we calculate how many seconds in we are.
 	float duration = GetDuration(framesPerSecond);
@@ -176,51 +290,37 @@ VertexAnimationTransformPose VertexAnimation::SampleTransformPose(float time, in
 	{
 		localTime = Math::Mod(time, duration);
 	}
+	return localTime;
+}
+
+/*static*/ void VertexAnimation::FindKeyframes(const std::vector<int>& frameNumbers, float localTime, int framesPerSecond, int& currentIndex, int& nextIndex, float& t)
+{
+	// Calculate how many seconds should be used for a single frame.
+	float secondsPerFrame = 1.0f / framesPerSecond;
 	
-	// Determine between which two transform poses the desired local time is located.
-	// E.g. if local time is 50% between pose 5 and 6, we  want to interpolate 50% between those two poses.
-    float currentPoseTime = 0.0f;
-    float nextPoseTime = 0.0f;
-    VertexAnimationTransformPose* firstTransformPose = mTransformPoses[meshIndex];
-    VertexAnimationTransformPose* currentTransformPose = firstTransformPose;
-    while(currentTransformPose->mNext != nullptr)
-    {
-        currentPoseTime = secondsPerFrame * currentTransformPose->mFrameNumber;
-        nextPoseTime = secondsPerFrame * currentTransformPose->mNext->mFrameNumber;
-        if(nextPoseTime > localTime) { break; }
-        
-        // Move on to next one.
-        currentTransformPose = currentTransformPose->mNext;
-    }
+	// Binary search for the first keyframe AFTER the desired local time.
+	// The keyframe right before that one is our "current" keyframe.
+	auto it = std::upper_bound(frameNumbers.begin(), frameNumbers.end(), localTime, [secondsPerFrame](float time, int frameNumber) {
+		return time < secondsPerFrame * frameNumber;
+	});
+	currentIndex = Math::Max(static_cast<int>(it - frameNumbers.begin()) - 1, 0);
 	
-	// If there is no "next" pose, we can either loop to the first pose, or "clamp" on the last pose.
+	// If there is no "next" keyframe, we can either loop to the first keyframe, or "clamp" on the last keyframe.
 	// Testing suggests GK3 expects the "clamp" approach, but more generally, a parameter for this might make sense.
-    VertexAnimationTransformPose* nextTransformPose = currentTransformPose->mNext;
-    if(nextTransformPose == nullptr)
-    {
-		// Clamp approach.
-		nextTransformPose = currentTransformPose;
-		nextPoseTime = currentPoseTime;
-		
-		// Loop approach.
-        //nextTransformPose = firstTransformPose;
-        //nextPoseTime = GetDuration(framesPerSecond);
-    }
+	nextIndex = currentIndex + 1;
+	if(nextIndex >= frameNumbers.size())
+	{
+		nextIndex = currentIndex;
+	}
 	
-    // Determine our "t" value between the prev and next pose.
-    float t = 1.0f;
+    // Determine our "t" value between the current and next keyframe.
+	float currentPoseTime = secondsPerFrame * frameNumbers[currentIndex];
+	float nextPoseTime = secondsPerFrame * frameNumbers[nextIndex];
+	t = 1.0f;
 	if(!Math::IsZero(nextPoseTime - currentPoseTime))
-    {
-        t = (localTime - currentPoseTime) / (nextPoseTime - currentPoseTime);
-    }
-    assert(t >= 0.0f && t <= 1.0f);
-	
-	// Finally, create a pose with lerp/slerp that is interpolated between the two poses.
-    VertexAnimationTransformPose pose;
-    pose.mLocalPosition = Vector3::Lerp(currentTransformPose->mLocalPosition, nextTransformPose->mLocalPosition, t);
-	pose.mLocalScale = Vector3::Lerp(currentTransformPose->mLocalScale, nextTransformPose->mLocalScale, t);
-    Quaternion::Slerp(pose.mLocalRotation, currentTransformPose->mLocalRotation, nextTransformPose->mLocalRotation, t);
-    return pose;
+	{
+		t = Math::Clamp((localTime - currentPoseTime) / (nextPoseTime - currentPoseTime), 0.0f, 1.0f);
+	}
 }
 
 void VertexAnimation::ParseFromData(char *data, int dataLength)
@@ -269,9 +369,15 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
         offsets.push_back(reader.ReadUInt());
     }
     
-    std::unordered_map<int, VertexAnimationVertexPose*> lastVertexPoseLookup;
-    std::unordered_map<int, VertexAnimationTransformPose*> lastTransformPoseLookup;
-	
+    // Keyframe tables exist for every mesh, even if the animation has no data for some of them.
+    mVertexKeyframes.resize(meshCount);
+    mTransformKeyframes.resize(meshCount);
+    
+    // While parsing, vertex positions are kept as full floats, indexed by [meshIndex][submeshIndex].
+    // Compressed data is relative to the previous keyframe, so this avoids accumulating quantization error.
+    // Once everything is read, positions are quantized for long-term storage.
+    std::vector<std::vector<std::vector<Vector3>>> vertexPositions(meshCount);
+    
 	// Read in data for each keyframe.
     for(int i = 0; i < mFrameCount; i++)
     {
@@ -322,37 +428,31 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     std::cout << "        Submesh Index: " << submeshIndex << std::endl;
                     #endif
 					
-					// This is a pretty sorry hash...but assuming we'll never
-					// have more than 1000 submeshes (pretty likely for GK3), this'll do OK.
-                    int hash = meshIndex * 1000 + submeshIndex;
-					
-					// Create a vertex pose for this frame and stick it in our dictionary and linked list.
-                    VertexAnimationVertexPose* vertexPose = new VertexAnimationVertexPose();
-                    vertexPose->mFrameNumber = i;
-                    if(i == 0)
-                    {
-                        mVertexPoses[meshIndex][submeshIndex] = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-                    else
-                    {
-                        lastVertexPoseLookup[hash]->mNext = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-                    
                     // 2 bytes: Vertex count.
                     unsigned short vertexCount = reader.ReadUShort();
                     #ifdef DEBUG_OUTPUT
                     std::cout << "        Vertex Count: " << vertexCount << std::endl;
                     #endif
                     
+                    // Append a keyframe to this submesh's keyframe table.
+                    VertexAnimationVertexKeyframes& keyframes = GetOrCreateVertexKeyframes(meshIndex, submeshIndex);
+                    assert(keyframes.mFrameNumbers.empty() || keyframes.mVertexCount == vertexCount);
+                    keyframes.mVertexCount = vertexCount;
+                    keyframes.mFrameNumbers.push_back(i);
+                    
+                    if(submeshIndex >= vertexPositions[meshIndex].size())
+                    {
+                        vertexPositions[meshIndex].resize(submeshIndex + 1);
+                    }
+                    std::vector<Vector3>& positions = vertexPositions[meshIndex][submeshIndex];
+                    
                     // Next, three floats per vertex (X, Y, Z).
                     for(int k = 0; k < vertexCount; k++)
                     {
                         float x = reader.ReadFloat();
 						float z = reader.ReadFloat();
                         float y = reader.ReadFloat();
-                        vertexPose->mVertexPositions.push_back(Vector3(x, y, z));
+                        positions.push_back(Vector3(x, y, z));
                     }
                 }
                 // Identifier 1 also is vertex data, but in a compressed format.
@@ -372,30 +472,30 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     std::cout << "        Submesh Index: " << submeshIndex << std::endl;
                     #endif
                     
-                    // Find position data from last recorded frame.
-                    int hash = meshIndex * 1000 + submeshIndex;
-                    std::vector<Vector3>& prevPositions = lastVertexPoseLookup[hash]->mVertexPositions;
-					
-					// Create a vertex pose to hold this new data and insert it into the vertex pose chain.
-                    VertexAnimationVertexPose* vertexPose = new VertexAnimationVertexPose();
-                    vertexPose->mFrameNumber = i;
-                    if(i == 0)
-                    {
-						mVertexPoses[meshIndex][submeshIndex] = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-                    else
-                    {
-                        lastVertexPoseLookup[hash]->mNext = vertexPose;
-                        lastVertexPoseLookup[hash] = vertexPose;
-                    }
-					
                     // 2 bytes: Vertex count.
                     unsigned short vertexCount = reader.ReadUShort();
                     #ifdef DEBUG_OUTPUT
                     std::cout << "        Vertex Count: " << vertexCount << std::endl;
                     #endif
                     
+                    // Compressed data is stored as deltas from the previous keyframe in this submesh's keyframe table.
+                    // If there is no previous keyframe (shouldn't happen), deltas are applied to the origin.
+                    VertexAnimationVertexKeyframes& keyframes = GetOrCreateVertexKeyframes(meshIndex, submeshIndex);
+                    assert(keyframes.mFrameNumbers.empty() || keyframes.mVertexCount == vertexCount);
+                    if(submeshIndex >= vertexPositions[meshIndex].size())
+                    {
+                        vertexPositions[meshIndex].resize(submeshIndex + 1);
+                    }
+                    std::vector<Vector3>& positions = vertexPositions[meshIndex][submeshIndex];
+                    
+                    int prevOffset = keyframes.mFrameNumbers.empty() ? -1 : static_cast<int>(positions.size()) - vertexCount;
+                    keyframes.mVertexCount = vertexCount;
+                    keyframes.mFrameNumbers.push_back(i);
+                    positions.resize(positions.size() + vertexCount);
+                    
+                    // Note that positions may have been reallocated by the resize, so only access them through the vector.
+                    int offset = static_cast<int>(positions.size()) - vertexCount;
+                    
                     // Next ((VertexCount/4) + 1) bytes: Compression info for vertex data.
                     // Every 2 bits indicates how the vertex at that index is compressed.
                     unsigned short compressionInfoSize = (vertexCount / 4) + 1;
@@ -431,11 +531,13 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     // Now that we have deciphered how each vertex is compressed, we can read in each vertex.
                     for(int k = 0; k < vertexCount; k++)
                     {
+                        Vector3 prevPosition = prevOffset >= 0 ? positions[prevOffset + k] : Vector3::Zero;
+                        
 						// 0 means no vertex data, so just use whatever we had for the previous frame.
 						// If the vertex data hasn't changed since last frame, it isn't stored, to save space.
                         if(vertexDataFormat[k] == 0)
                         {
-                            vertexPose->mVertexPositions.push_back(prevPositions[k]);
+                            positions[offset + k] = prevPosition;
                         }
                         // 1 means (X, Y, Z) are compressed in next 3 bytes.
 						// This tends to be used for storing vertex position delta for internal vertices in a mesh.
@@ -444,7 +546,7 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = DecompressFloatFromByte(reader.ReadByte());
 							float z = DecompressFloatFromByte(reader.ReadByte());
                             float y = DecompressFloatFromByte(reader.ReadByte());
-                            vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+                            positions[offset + k] = prevPosition + Vector3(x, y, z);
                         }
                         // 2 means (X, Y, Z) are compressed in next 3 ushorts.
 						// This tends to be used for storing vertex position deltas where meshes meet (like a knee or elbow).
@@ -453,7 +555,7 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = DecompressFloatFromUShort(reader.ReadUShort());
 							float z = DecompressFloatFromUShort(reader.ReadUShort());
 							float y = DecompressFloatFromUShort(reader.ReadUShort());
-							vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+							positions[offset + k] = prevPosition + Vector3(x, y, z);
                         }
                         // 3 means (X, Y, Z) are not compressed - just floats.
                         else if(vertexDataFormat[k] == 3)
@@ -461,7 +563,7 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                             float x = reader.ReadFloat();
 							float z = reader.ReadFloat();
                             float y = reader.ReadFloat();
-                            vertexPose->mVertexPositions.push_back(prevPositions[k] + Vector3(x, y, z));
+                            positions[offset + k] = prevPosition + Vector3(x, y, z);
                         }
                     }
                     
@@ -519,21 +621,13 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
                     std::cout << "        Mesh Position: " << meshPos << std::endl;
                     #endif
                     
-                    VertexAnimationTransformPose* transformPose = new VertexAnimationTransformPose();
-                    transformPose->mFrameNumber = i;
-                    transformPose->mLocalPosition = meshPos;
-                    transformPose->mLocalRotation = rotQuat;
-					transformPose->mLocalScale = scale;
-                    if(i == 0)
-                    {
-                        mTransformPoses.push_back(transformPose);
-                        lastTransformPoseLookup[meshIndex] = transformPose;
-                    }
-                    else
-                    {
-                        lastTransformPoseLookup[meshIndex]->mNext = transformPose;
-                        lastTransformPoseLookup[meshIndex] = transformPose;
-                    }
+                    VertexAnimationTransformPose transformPose;
+                    transformPose.mFrameNumber = i;
+                    transformPose.mLocalPosition = meshPos;
+                    transformPose.mLocalRotation = rotQuat;
+					transformPose.mLocalScale = scale;
+                    mTransformKeyframes[meshIndex].mFrameNumbers.push_back(i);
+                    mTransformKeyframes[meshIndex].mPoses.push_back(transformPose);
                 }
                 // Identifier 3 is min/max data.
                 else if(dataId == 3)
@@ -566,6 +660,12 @@ void VertexAnimation::ParseFromData(char *data, int dataLength)
             } // while(byteCount > 0)
         } // iterate mesh groups
     } // iterate keyframes
+    
+    // Convert parsed vertex positions to their more compact in-memory format.
+    QuantizeVertexKeyframes(vertexPositions);
+    #ifdef DEBUG_OUTPUT
+    std::cout << "  Vertex Data Size: " << GetVertexDataSize() << " bytes (" << GetUnquantizedVertexDataSize() << " bytes unquantized)" << std::endl;
+    #endif
 }
 
 float VertexAnimation::DecompressFloatFromByte(unsigned char val)
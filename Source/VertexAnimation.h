@@ -11,18 +11,19 @@
 #pragma once
 #include "Asset.h"
 
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
 
 #include "Matrix4.h"
 #include "Vector3.h"
 
+class VertexAnimationBuffer;
+
 struct VertexAnimationVertexPose
 {
     int mFrameNumber = 0;
     
     std::vector<Vector3> mVertexPositions;
-    VertexAnimationVertexPose* mNext = nullptr;
 };
 
 struct VertexAnimationTransformPose
@@ -32,8 +33,6 @@ struct VertexAnimationTransformPose
     Quaternion mLocalRotation;
     Vector3 mLocalPosition;
 	Vector3 mLocalScale;
-	
-    VertexAnimationTransformPose* mNext = nullptr;
     
     Matrix4 GetMeshToLocalMatrix()
     {
@@ -43,10 +42,43 @@ struct VertexAnimationTransformPose
     }
 };
 
+// All vertex keyframes for a single submesh, stored contiguously.
+// Frame numbers are sorted ascending, and positions for keyframe N start at index (N * vertexCount * 3).
+//
+// To save memory, positions are quantized to 16-bits per component, relative to the submesh's bounds over the whole animation.
+// The same offset/scale is used for all three axes: position = offset + (scale * quantizedValue).
+struct VertexAnimationVertexKeyframes
+{
+    int mVertexCount = 0;
+    
+    float mOffset = 0.0f;
+    float mScale = 0.0f;
+    
+    std::vector<int> mFrameNumbers;
+    std::vector<uint16_t> mPositions;
+    
+    int GetKeyframeCount() const { return static_cast<int>(mFrameNumbers.size()); }
+    const uint16_t* GetPositions(int keyframeIndex) const { return &mPositions[keyframeIndex * mVertexCount * 3]; }
+    
+    Vector3 GetPosition(int keyframeIndex, int vertexIndex) const
+    {
+        const uint16_t* position = GetPositions(keyframeIndex) + (vertexIndex * 3);
+        return Vector3(mOffset + mScale * position[0], mOffset + mScale * position[1], mOffset + mScale * position[2]);
+    }
+};
+
+// All transform keyframes for a single mesh, with frame numbers sorted ascending.
+struct VertexAnimationTransformKeyframes
+{
+    std::vector<int> mFrameNumbers;
+    std::vector<VertexAnimationTransformPose> mPoses;
+};
+
 class VertexAnimation : public Asset
 {
 public:
     VertexAnimation(std::string name, char* data, int dataLength);
+	~VertexAnimation();
     
 	// Queries the position of a single vertex at a particular time of the animation.
 	Vector3 SampleVertexPosition(float time, int framesPerSecond, int meshIndex, int submeshIndex, int vertexIndex);
@@ -54,6 +86,14 @@ public:
 	// Queries positions of ALL vertices for a submesh at a particular time of the animation.
 	VertexAnimationVertexPose SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex);
 	
+	// Same as above, but writes packed (X, Y, Z) positions directly into a caller-provided buffer, with no allocations.
+	// Returns false (and leaves the buffer untouched) if there's no data for the submesh, or the vertex count doesn't match.
+	bool SampleVertexPose(float time, int framesPerSecond, int meshIndex, int submeshIndex, float* outPositions, int vertexCount);
+	
+	// Finds the pair of vertex keyframes on either side of a time, and how far between them (0-1) the time is.
+	// Useful for interpolating elsewhere (e.g. on the GPU). Returns false if there's no data for the submesh.
+	bool FindVertexKeyframes(float time, int framesPerSecond, int meshIndex, int submeshIndex, int& currentIndex, int& nextIndex, float& t) const;
+	
 	// Queries a mesh's transform properties (position, rotation, scale) at a particular time of the animation.
 	VertexAnimationTransformPose SampleTransformPose(float time, int framesPerSecond, int meshIndex);
     
@@ -63,7 +103,20 @@ public:
 	
 	const std::string& GetModelName() const { return mModelName; }
 	
+	// Direct access to vertex keyframe data. Returns null if the submesh has no vertex data in this animation.
+	int GetMeshCount() const { return static_cast<int>(mVertexKeyframes.size()); }
+	int GetSubmeshCount(int meshIndex) const { return meshIndex >= 0 && meshIndex < GetMeshCount() ? static_cast<int>(mVertexKeyframes[meshIndex].size()) : 0; }
+	const VertexAnimationVertexKeyframes* GetVertexKeyframes(int meshIndex, int submeshIndex) const;
+	
+	// Memory used by vertex keyframe data, in bytes.
+	// The "unquantized" size is how much the same data would take if stored as full floats.
+	size_t GetVertexDataSize() const;
+	size_t GetUnquantizedVertexDataSize() const;
+	
 private:
+	friend class VertexAnimationBuffer; // To create and own the GPU-side copy of the keyframes.
+	
+
     // The number of frames in this animation.
     int mFrameCount = 0;
 	
@@ -71,13 +124,27 @@ private:
 	// If we ever play the animation on a mismatched model, the graphics will probably glitch out.
 	std::string mModelName;
     
-	// Each array element is the FIRST vertex pose for each mesh/submesh index.
-	// Subsequent poses for the mesh are stored in the "next" of the first pose.
-	std::unordered_map<int, std::unordered_map<int, VertexAnimationVertexPose*>> mVertexPoses;
+	// Vertex keyframes, indexed by [meshIndex][submeshIndex].
+	// A submesh with no vertex data in the animation has an empty keyframe table.
+	std::vector<std::vector<VertexAnimationVertexKeyframes>> mVertexKeyframes;
+	
+	// Transform keyframes, indexed by meshIndex.
+	std::vector<VertexAnimationTransformKeyframes> mTransformKeyframes;
+	
+	// GPU-side copy of the vertex keyframes, created the first time the animation is played on the GPU (see VertexAnimationBuffer).
+	// It's owned by the animation, so it's deleted when the animation is unloaded. Deleting it needs GL, so the deleter comes with it.
+	// Once creation has been tried, "mBufferCreated" is set, even if it failed - failing again every frame would be pointless.
+	VertexAnimationBuffer* mBuffer = nullptr;
+	void (*mBufferDeleter)(VertexAnimationBuffer*) = nullptr;
+	bool mBufferCreated = false;
+	
+	VertexAnimationVertexKeyframes& GetOrCreateVertexKeyframes(int meshIndex, int submeshIndex);
+	
+	void QuantizeVertexKeyframes(const std::vector<std::vector<std::vector<Vector3>>>& positions);
+	
+	float GetLocalTime(float time, int framesPerSecond) const;
 	
-	// Each element of array is the FIRST transform poses for each mesh index.
-	// Subsequent poses for the mesh are stored in the "next" of the first pose.
-    std::vector<VertexAnimationTransformPose*> mTransformPoses;
+	static void FindKeyframes(const std::vector<int>& frameNumbers, float localTime, int framesPerSecond, int& currentIndex, int& nextIndex, float& t);
     
     void ParseFromData(char* data, int dataLength);
     
@@ -0,0 +1,179 @@
+//
+// VertexAnimationBuffer.cpp
+//
+// Clark Kromenaker
+//
+#include "VertexAnimationBuffer.h"
+
+#include <iostream>
+
+#include "GLState.h"
+#include "Material.h"
+#include "Services.h"
+#include "Shader.h"
+#include "VertexAnimation.h"
+
+Shader* VertexAnimationBuffer::sShader = nullptr;
+UniformHandle VertexAnimationBuffer::sKeyframesUniform;
+UniformHandle VertexAnimationBuffer::sFromUniform;
+UniformHandle VertexAnimationBuffer::sToUniform;
+UniformHandle VertexAnimationBuffer::sTUniform;
+UniformHandle VertexAnimationBuffer::sOffsetUniform;
+UniformHandle VertexAnimationBuffer::sScaleUniform;
+
+VertexAnimationBuffer* VertexAnimationBuffer::Get(VertexAnimation* animation)
+{
+	if(animation == nullptr) { return nullptr; }
+	
+	// Return existing buffer (or null, if making one already failed).
+	// The buffer lives in the animation, so it's deleted when the animation is - even if unloaded and a new one is loaded at the same address.
+	if(animation->mBufferCreated)
+	{
+		return animation->mBuffer;
+	}
+	
+	// The vertex animation shader uses the same fragment shader as regular meshes.
+	if(sShader == nullptr)
+	{
+		sShader = Services::GetAssets()->LoadShader("3D-Diffuse-Tex-VertexAnim", "3D-Diffuse-Tex");
+		if(sShader != nullptr)
+		{
+			sKeyframesUniform = sShader->GetUniformHandle("uVertexAnimKeyframes");
+			sFromUniform = sShader->GetUniformHandle("uVertexAnimFrom");
+			sToUniform = sShader->GetUniformHandle("uVertexAnimTo");
+			sTUniform = sShader->GetUniformHandle("uVertexAnimT");
+			sOffsetUniform = sShader->GetUniformHandle("uVertexAnimOffset");
+			sScaleUniform = sShader->GetUniformHandle("uVertexAnimScale");
+		}
+	}
+	
+	// Create and upload. If anything goes wrong, remember that so we fall back to CPU animation from now on.
+	VertexAnimationBuffer* buffer = nullptr;
+	if(sShader != nullptr)
+	{
+		buffer = new VertexAnimationBuffer(animation);
+		if(!buffer->Upload())
+		{
+			delete buffer;
+			buffer = nullptr;
+		}
+	}
+	animation->mBuffer = buffer;
+	animation->mBufferDeleter = &VertexAnimationBuffer::Delete;
+	animation->mBufferCreated = true;
+	return buffer;
+}
+
+/*static*/ void VertexAnimationBuffer::Delete(VertexAnimationBuffer* buffer)
+{
+	delete buffer;
+}
+
+VertexAnimationBuffer::VertexAnimationBuffer(VertexAnimation* animation) :
+	mAnimation(animation)
+{
+	
+}
+
+VertexAnimationBuffer::~VertexAnimationBuffer()
+{
+	if(mTexture != GL_NONE)
+	{
+		if(GLState::Instance() != nullptr)
+		{
+			GLState::Instance()->OnTextureDeleted(mTexture);
+		}
+		glDeleteTextures(1, &mTexture);
+	}
+	if(mBuffer != GL_NONE)
+	{
+		glDeleteBuffers(1, &mBuffer);
+	}
+}
+
+bool VertexAnimationBuffer::HasKeyframes(int meshIndex, int submeshIndex, int vertexCount) const
+{
+	const VertexAnimationVertexKeyframes* keyframes = mAnimation->GetVertexKeyframes(meshIndex, submeshIndex);
+	return keyframes != nullptr && keyframes->mVertexCount == vertexCount;
+}
+
+bool VertexAnimationBuffer::Activate(Material& material, const Matrix4& objectToWorldMatrix, int meshIndex, int submeshIndex, float time, int framesPerSecond)
+{
+	// Figure out which keyframes to interpolate between.
+	int currentIndex = 0;
+	int nextIndex = 0;
+	float t = 1.0f;
+	if(!mAnimation->FindVertexKeyframes(time, framesPerSecond, meshIndex, submeshIndex, currentIndex, nextIndex, t))
+	{
+		return false;
+	}
+	const VertexAnimationVertexKeyframes* keyframes = mAnimation->GetVertexKeyframes(meshIndex, submeshIndex);
+	int submeshOffset = mSubmeshOffsets[meshIndex][submeshIndex];
+	int keyframeSize = keyframes->mVertexCount * 3;
+	
+	// Activate material with the vertex animation shader; this sets all the usual uniforms (transforms, color, textures).
+	material.Activate(objectToWorldMatrix, sShader);
+	
+	// Bind keyframe data.
+	GLState::Instance()->BindTexture(kTextureUnit, GL_TEXTURE_BUFFER, mTexture);
+	sShader->SetUniformInt(sKeyframesUniform, kTextureUnit);
+	
+	// Set keyframes and interpolation amount.
+	sShader->SetUniformInt(sFromUniform, submeshOffset + currentIndex * keyframeSize);
+	sShader->SetUniformInt(sToUniform, submeshOffset + nextIndex * keyframeSize);
+	sShader->SetUniformFloat(sTUniform, t);
+	
+	// The shader reads normalized values (0-1), so scale needs to account for that when dequantizing.
+	sShader->SetUniformFloat(sOffsetUniform, keyframes->mOffset);
+	sShader->SetUniformFloat(sScaleUniform, keyframes->mScale * 65535.0f);
+	return true;
+}
+
+bool VertexAnimationBuffer::Upload()
+{
+	// Pack all submesh keyframes into one array, remembering where each submesh starts.
+	std::vector<uint16_t> data;
+	mSubmeshOffsets.resize(mAnimation->GetMeshCount());
+	for(int i = 0; i < mAnimation->GetMeshCount(); ++i)
+	{
+		mSubmeshOffsets[i].resize(mAnimation->GetSubmeshCount(i), -1);
+		for(int j = 0; j < mAnimation->GetSubmeshCount(i); ++j)
+		{
+			const VertexAnimationVertexKeyframes* keyframes = mAnimation->GetVertexKeyframes(i, j);
+			if(keyframes != nullptr)
+			{
+				mSubmeshOffsets[i][j] = static_cast<int>(data.size());
+				data.insert(data.end(), keyframes->mPositions.begin(), keyframes->mPositions.end());
+			}
+		}
+	}
+	
+	// Nothing to do if the animation has no vertex data at all (e.g. transform-only animations).
+	if(data.empty())
+	{
+		return false;
+	}
+	
+	// Buffer textures have a max size, which can be fairly small on some implementations.
+	GLint maxTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+	if(data.size() > static_cast<size_t>(maxTexels))
+	{
+		std::cout << "Vertex animation " << mAnimation->GetName() << " is too big for a buffer texture ("
+				  << data.size() << " > " << maxTexels << ") - it will be animated on the CPU." << std::endl;
+		return false;
+	}
+	
+	// Upload keyframe data. This never changes, so it can be static.
+	glGenBuffers(1, &mBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, mBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, data.size() * sizeof(uint16_t), data.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, GL_NONE);
+	
+	// Create a texture to read the buffer in the shader as normalized 16-bit values.
+	glGenTextures(1, &mTexture);
+	GLState::Instance()->BindTexture(GL_TEXTURE_BUFFER, mTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R16, mBuffer);
+	GLState::Instance()->BindTexture(GL_TEXTURE_BUFFER, GL_NONE);
+	return true;
+}
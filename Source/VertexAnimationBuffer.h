@@ -0,0 +1,73 @@
+//
+// VertexAnimationBuffer.h
+//
+// Clark Kromenaker
+//
+// GPU-side copy of a vertex animation's keyframes, so vertex animations can be interpolated in a vertex shader.
+//
+// All vertex keyframes of an animation are uploaded ONCE to a buffer texture, in their quantized 16-bit form.
+// When rendering, only the pair of keyframes and the interpolation amount are passed to the shader.
+// This avoids re-uploading vertex positions for every animated submesh every frame.
+//
+#pragma once
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "Shader.h"
+
+class Material;
+class Matrix4;
+class VertexAnimation;
+
+class VertexAnimationBuffer
+{
+public:
+	// Gets the buffer for an animation, creating and uploading it on first use.
+	// Returns null if the animation can't be played on the GPU (no vertex data, too big for a buffer texture, shader unavailable, etc).
+	static VertexAnimationBuffer* Get(VertexAnimation* animation);
+	
+	~VertexAnimationBuffer();
+	
+	// Whether a submesh with the given vertex count can be animated by this buffer.
+	bool HasKeyframes(int meshIndex, int submeshIndex, int vertexCount) const;
+	
+	// Activates the material using the vertex animation shader, and sets up the keyframes to interpolate for the given time.
+	// Returns false if there's no data for this submesh; in that case, nothing was activated.
+	bool Activate(Material& material, const Matrix4& objectToWorldMatrix, int meshIndex, int submeshIndex, float time, int framesPerSecond);
+	
+	VertexAnimation* GetAnimation() const { return mAnimation; }
+	
+private:
+	// Texture unit used for the keyframe buffer texture. Kept high to stay clear of units used by materials.
+	static const int kTextureUnit = 7;
+	
+	// Shader used to render vertex animated submeshes.
+	static Shader* sShader;
+	
+	// Handles to the shader's vertex animation uniforms, looked up once when the shader is loaded.
+	static UniformHandle sKeyframesUniform;
+	static UniformHandle sFromUniform;
+	static UniformHandle sToUniform;
+	static UniformHandle sTUniform;
+	static UniformHandle sOffsetUniform;
+	static UniformHandle sScaleUniform;
+	
+	// The animation this buffer holds data for.
+	VertexAnimation* mAnimation = nullptr;
+	
+	// Handles to the GL buffer holding the keyframe data, and the buffer texture used to read it in the shader.
+	GLuint mBuffer = GL_NONE;
+	GLuint mTexture = GL_NONE;
+	
+	// Offset (in texels) of each submesh's first keyframe in the buffer, indexed by [meshIndex][submeshIndex].
+	// If a submesh has no vertex data, the offset is -1.
+	std::vector<std::vector<int>> mSubmeshOffsets;
+	
+	VertexAnimationBuffer(VertexAnimation* animation);
+	
+	// Buffers are owned by their animation, which deletes them with this (see VertexAnimation::mBuffer).
+	static void Delete(VertexAnimationBuffer* buffer);
+	
+	bool Upload();
+};
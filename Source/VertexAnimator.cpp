@@ -5,18 +5,62 @@
 //
 #include "VertexAnimator.h"
 
-#include <vector>
+#include <algorithm>
+#include <cstring>
 
 #include "Actor.h"
+#include "JobSystem.h"
 #include "Mesh.h"
 #include "MeshRenderer.h"
 #include "VertexAnimation.h"
+#include "VertexAnimationBuffer.h"
 
 TYPE_DEF_CHILD(Component, VertexAnimator);
 
+bool VertexAnimator::sUseGPU = true;
+std::vector<VertexAnimator*> VertexAnimator::sVertexAnimators;
+
+void VertexAnimator::TakePendingSamples(JobSystem& jobSystem)
+{
+	// Prepare on this thread, since it may need to touch the mesh renderer or GPU.
+	static std::vector<VertexAnimator*> pending;
+	pending.clear();
+	for(auto& animator : sVertexAnimators)
+	{
+		if(animator->mSamplePending)
+		{
+			animator->PrepareSample();
+			pending.push_back(animator);
+		}
+	}
+	
+	// The actual sampling of keyframes is the slow part, and only writes to each animator's own staging data.
+	// So each animator can be sampled in parallel.
+	jobSystem.ParallelFor(static_cast<int>(pending.size()), [](int index) {
+		pending[index]->SampleToStaging();
+	});
+	
+	// Apply and upload the results back on this thread.
+	for(auto& animator : pending)
+	{
+		animator->ApplySample();
+		animator->mSamplePending = false;
+	}
+}
+
 VertexAnimator::VertexAnimator(Actor* owner) : Component(owner)
 {
 	mMeshRenderer = owner->GetComponent<MeshRenderer>();
+	sVertexAnimators.push_back(this);
+}
+
+VertexAnimator::~VertexAnimator()
+{
+	auto it = std::find(sVertexAnimators.begin(), sVertexAnimators.end(), this);
+	if(it != sVertexAnimators.end())
+	{
+		sVertexAnimators.erase(it);
+	}
 }
 
 void VertexAnimator::Start(VertexAnimation* anim, int framesPerSecond, std::function<void()> stopCallback)
@@ -39,7 +83,7 @@ void VertexAnimator::Start(VertexAnimation* anim, int framesPerSecond, std::func
 	mVertexAnimationTimer = time;
 
 	// Sample animation at current timer value.
-	TakeSample(mVertexAnimation, mVertexAnimationTimer);
+	TakeSample(mVertexAnimation, mVertexAnimationTimer, true);
 }
 
 void VertexAnimator::Stop(VertexAnimation* anim)
@@ -47,6 +91,19 @@ void VertexAnimator::Stop(VertexAnimation* anim)
 	// Stop if animation matches playing one OR null was passed in.
 	if(mVertexAnimation != nullptr && (mVertexAnimation == anim || anim == nullptr))
 	{
+		// If animating on the GPU, the submeshes' own positions are stale.
+		// Sample the pose we stopped at on the CPU, so the mesh stays in that pose after the animation is done.
+		// If a sample is already pending, just make sure it's done on the CPU.
+		if(mSamplePending)
+		{
+			mSampleAllowGPU = false;
+		}
+		else if(mMeshRenderer->GetVertexAnimation() != nullptr)
+		{
+			float animDuration = mVertexAnimation->GetDuration(mFramesPerSecond);
+			TakeSample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration), false);
+		}
+		
 		// Fire stop callback if an animation was in progress.
 		if(mStopCallback != nullptr)
 		{
@@ -64,7 +121,7 @@ void VertexAnimator::Sample(VertexAnimation* animation, int frame)
 	if(animation != nullptr)
 	{
 		//TODO: Should not assume 15.0f here, probably?
-		TakeSample(animation, frame * (1.0f / 15.0f));
+		TakeSample(animation, frame * (1.0f / 15.0f), false);
 	}
 }
 
@@ -76,9 +133,10 @@ void VertexAnimator::OnUpdate(float deltaTime)
 		// Increment animation timer.
 		mVertexAnimationTimer += deltaTime;
 		
-		// Sample animation at current timer value, clamping to anim duration.
+		// Request a sample at current timer value, clamping to anim duration.
+		// This is taken later in the frame, along with all other animators (see TakePendingSamples).
 		float animDuration = mVertexAnimation->GetDuration(mFramesPerSecond);
-		TakeSample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration));
+		RequestSample(mVertexAnimation, Math::Clamp(mVertexAnimationTimer, 0.0f, animDuration), true);
 		
 		// If at the end of the animation, clear animation.
 		// GK3 doesn't really have the concept of a "looping" animation. Looping is handled by higher-level control scripts.
@@ -89,27 +147,107 @@ void VertexAnimator::OnUpdate(float deltaTime)
 	}
 }
 
-void VertexAnimator::TakeSample(VertexAnimation* animation, float time)
+void VertexAnimator::TakeSample(VertexAnimation* animation, float time, bool allowGPU)
+{
+	// Do all steps immediately. This also replaces any pending sample.
+	RequestSample(animation, time, allowGPU);
+	PrepareSample();
+	SampleToStaging();
+	ApplySample();
+	mSamplePending = false;
+}
+
+void VertexAnimator::RequestSample(VertexAnimation* animation, float time, bool allowGPU)
+{
+	mSampleAnimation = animation;
+	mSampleTime = time;
+	mSampleAllowGPU = allowGPU;
+	mSamplePending = true;
+}
+
+void VertexAnimator::PrepareSample()
+{
+	// If possible, let the GPU do vertex animation. Keyframes are uploaded once, and only the time is updated here.
+	// Otherwise (or for one-off samples), make sure the mesh renderer goes back to using the submesh positions we sample.
+	VertexAnimationBuffer* buffer = (mSampleAllowGPU && sUseGPU) ? VertexAnimationBuffer::Get(mSampleAnimation) : nullptr;
+	mMeshRenderer->SetVertexAnimation(buffer, mSampleTime, mFramesPerSecond);
+	
+	// Make sure there's a staging entry for each mesh and submesh, and figure out which need sampling on the CPU.
+	const std::vector<Mesh*>& meshes = mMeshRenderer->GetMeshes();
+	mMeshSamples.resize(meshes.size());
+	
+	int submeshCount = 0;
+	for(auto& mesh : meshes)
+	{
+		submeshCount += mesh->GetSubmeshCount();
+	}
+	mSubmeshSamples.resize(submeshCount);
+	
+	int submeshSampleIndex = 0;
+	for(int i = 0; i < meshes.size(); i++)
+	{
+		for(int j = 0; j < meshes[i]->GetSubmeshCount(); j++)
+		{
+			mSubmeshSamples[submeshSampleIndex].animatedOnGPU = (buffer != nullptr && mMeshRenderer->IsVertexAnimatedOnGPU(i, j));
+			++submeshSampleIndex;
+		}
+	}
+}
+
+void VertexAnimator::SampleToStaging()
 {
 	// Iterate through each mesh and sample it in the vertex animation.
 	// We need to sample both vertex poses and transform poses to get the right result.
-	const std::vector<Mesh*> meshes = mMeshRenderer->GetMeshes();
+	// This may run on any thread, so it must only write to staging data!
+	const std::vector<Mesh*>& meshes = mMeshRenderer->GetMeshes();
+	int submeshSampleIndex = 0;
+	for(int i = 0; i < meshes.size(); i++)
+	{
+		const std::vector<Submesh*>& submeshes = meshes[i]->GetSubmeshes();
+		for(int j = 0; j < submeshes.size(); j++)
+		{
+			// Nothing to do here if this submesh is animated on the GPU.
+			SubmeshSample& submeshSample = mSubmeshSamples[submeshSampleIndex++];
+			submeshSample.sampled = false;
+			if(submeshSample.animatedOnGPU) { continue; }
+			
+			// Staging buffers are kept around, so this only allocates the first time (or if vertex count changes).
+			int vertexCount = submeshes[j]->GetVertexCount();
+			submeshSample.positions.resize(vertexCount * 3);
+			submeshSample.sampled = mSampleAnimation->SampleVertexPose(mSampleTime, mFramesPerSecond, i, j,
+																	   submeshSample.positions.data(), vertexCount);
+		}
+		
+		VertexAnimationTransformPose transformSample = mSampleAnimation->SampleTransformPose(mSampleTime, mFramesPerSecond, i);
+		mMeshSamples[i].sampled = (transformSample.mFrameNumber >= 0);
+		if(mMeshSamples[i].sampled)
+		{
+			mMeshSamples[i].meshToLocalMatrix = transformSample.GetMeshToLocalMatrix();
+		}
+	}
+}
+
+void VertexAnimator::ApplySample()
+{
+	// Copy sampled positions into the submeshes and upload them.
+	const std::vector<Mesh*>& meshes = mMeshRenderer->GetMeshes();
+	int submeshSampleIndex = 0;
 	for(int i = 0; i < meshes.size(); i++)
 	{
 		const std::vector<Submesh*>& submeshes = meshes[i]->GetSubmeshes();
 		for(int j = 0; j < submeshes.size(); j++)
 		{
-			VertexAnimationVertexPose sample = animation->SampleVertexPose(time, mFramesPerSecond, i, j);
-			if(sample.mFrameNumber >= 0)
+			SubmeshSample& submeshSample = mSubmeshSamples[submeshSampleIndex++];
+			if(submeshSample.sampled && submeshes[j]->GetPositions() != nullptr)
 			{
-                submeshes[j]->SetPositions(reinterpret_cast<float*>(sample.mVertexPositions.data()), true);
+				memcpy(submeshes[j]->GetPositions(), submeshSample.positions.data(), submeshSample.positions.size() * sizeof(float));
+				submeshes[j]->RefreshPositions();
 			}
 		}
 		
-		VertexAnimationTransformPose transformSample = animation->SampleTransformPose(time, mFramesPerSecond, i);
-		if(transformSample.mFrameNumber >= 0)
+		if(mMeshSamples[i].sampled)
 		{
-			meshes[i]->SetMeshToLocalMatrix(transformSample.GetMeshToLocalMatrix());
+			meshes[i]->SetMeshToLocalMatrix(mMeshSamples[i].meshToLocalMatrix);
 		}
 	}
 }
@@ -9,7 +9,11 @@
 #include "Component.h"
 
 #include <functional>
+#include <vector>
 
+#include "Matrix4.h"
+
+class JobSystem;
 class MeshRenderer;
 class VertexAnimation;
 
@@ -34,7 +38,16 @@ class VertexAnimator : public Component
 {
 	TYPE_DECL_CHILD();
 public:
+	// If true, vertex animations are interpolated on the GPU when possible, rather than sampled and uploaded every frame.
+	static void SetUseGPU(bool useGPU) { sUseGPU = useGPU; }
+	static bool GetUseGPU() { return sUseGPU; }
+	
+	// Takes samples requested by all vertex animators this frame.
+	// Sampling is done in parallel on the job system, and results are applied (and uploaded) on the calling thread.
+	static void TakePendingSamples(JobSystem& jobSystem);
+	
 	VertexAnimator(Actor* owner);
+	~VertexAnimator();
 	
 	void Start(VertexAnimation* anim, int framesPerSecond, std::function<void()> stopCallback);
 	void Start(VertexAnimation* anim, int framesPerSecond, std::function<void()> stopCallback, float time);
@@ -48,6 +61,11 @@ protected:
 	void OnUpdate(float deltaTime) override;
 	
 private:
+	static bool sUseGPU;
+	
+	// All vertex animators that exist, for processing pending samples.
+	static std::vector<VertexAnimator*> sVertexAnimators;
+	
 	// The mesh renderer that will be animated.
 	MeshRenderer* mMeshRenderer = nullptr;
 	
@@ -64,5 +82,32 @@ private:
 	// Timer for tracking progress on vertex animation.
 	float mVertexAnimationTimer = 0.0f;
 	
-	void TakeSample(VertexAnimation* animation, float time);
+	// A sample to take, either requested for later (pending) or being taken right now.
+	VertexAnimation* mSampleAnimation = nullptr;
+	float mSampleTime = 0.0f;
+	bool mSampleAllowGPU = false;
+	bool mSamplePending = false;
+	
+	// Sampled data is staged here, so sampling can happen on any thread.
+	// Applying it to the meshes (which uploads to the GPU) then happens on the main thread.
+	struct SubmeshSample
+	{
+		std::vector<float> positions;
+		bool animatedOnGPU = false;
+		bool sampled = false;
+	};
+	struct MeshSample
+	{
+		Matrix4 meshToLocalMatrix;
+		bool sampled = false;
+	};
+	std::vector<SubmeshSample> mSubmeshSamples; // In order of meshes, then submeshes.
+	std::vector<MeshSample> mMeshSamples;
+	
+	void TakeSample(VertexAnimation* animation, float time, bool allowGPU);
+	void RequestSample(VertexAnimation* animation, float time, bool allowGPU);
+	
+	void PrepareSample();
+	void SampleToStaging();
+	void ApplySample();
 };
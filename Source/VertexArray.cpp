@@ -6,6 +6,9 @@
 #include "VertexArray.h"
 
 #include <iostream>
+#include <utility>
+
+#include "GLState.h"
 
 // Some OpenGL calls take in array indexes/offsets as pointers.
 // This macro just makes the syntax clearer for the reader.
@@ -16,7 +19,7 @@ VertexArray::VertexArray(const MeshDefinition& data) :
 {
     // Generate and bind VBO.
     glGenBuffers(1, &mVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    GLState::Instance()->BindArrayBuffer(mVBO);
     
     // Determine VBO usage and size.
     GLenum usage = (mData.meshUsage == MeshUsage::Static) ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
@@ -61,13 +64,10 @@ VertexArray::VertexArray(const MeshDefinition& data) :
         glBufferData(GL_ARRAY_BUFFER, size, data.vertexData, usage);
     }
     
-    // If index data was provided, populate IBO.
-    RefreshIBOContents(mData.indexData, mData.indexCount);
-    
     // Generate and bind VAO object.
     {
         glGenVertexArrays(1, &mVAO);
-        glBindVertexArray(mVAO);
+        GLState::Instance()->BindVertexArray(mVAO);
         
         // Stride can be calculated once and used over and over.
         // For packed data, stride is zero. For interleaved data, stride is size of vertex.
@@ -94,6 +94,10 @@ VertexArray::VertexArray(const MeshDefinition& data) :
         }
     }
     
+    // If index data was provided, populate IBO.
+    // The index buffer binding is part of the VAO's state, so this must happen after the VAO is created.
+    RefreshIBOContents(mData.indexData, mData.indexCount);
+    
     // Clear vertex data and index data pointers.
     // Remember, we can only assume those pointers are valid during construction anyway.
     mData.vertexData = nullptr;
@@ -102,6 +106,14 @@ VertexArray::VertexArray(const MeshDefinition& data) :
 
 VertexArray::~VertexArray()
 {
+    if(GLState::Instance() != nullptr)
+    {
+        GLState::Instance()->OnBufferDeleted(mVBO);
+        if(mVAO != GL_NONE)
+        {
+            GLState::Instance()->OnVertexArrayDeleted(mVAO);
+        }
+    }
     glDeleteBuffers(1, &mVBO);
     glDeleteVertexArrays(1, &mVAO);
     glDeleteBuffers(1, &mIBO);
@@ -114,21 +126,19 @@ VertexArray::VertexArray(VertexArray&& other)
 
 VertexArray& VertexArray::operator=(VertexArray&& other)
 {
+    // Swap handles, rather than just taking the other's handles.
+    // That way, any handles this VA already had are deleted when "other" is destroyed, rather than leaking.
     mData = other.mData;
-    mVBO = other.mVBO;
-    mVAO = other.mVAO;
-    mIBO = other.mIBO;
-    
-    other.mVBO = GL_NONE;
-    other.mVAO = GL_NONE;
-    other.mIBO = GL_NONE;
+    std::swap(mVBO, other.mVBO);
+    std::swap(mVAO, other.mVAO);
+    std::swap(mIBO, other.mIBO);
     return *this;
 }
 
 void VertexArray::ChangeVertexData(void* data)
 {
     // Assuming that the data is the correct size to fill the entire buffer.
-    glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+    GLState::Instance()->BindArrayBuffer(mVBO);
     glBufferSubData(GL_ARRAY_BUFFER, 0, mData.vertexCount * mData.vertexDefinition.CalculateSize(), data);
 }
 
@@ -153,7 +163,7 @@ void VertexArray::ChangeVertexData(VertexAttribute::Semantic semantic, void *dat
         // Update sub-data, if semantic matches.
         if(attribute.semantic == semantic)
         {
-            glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+            GLState::Instance()->BindArrayBuffer(mVBO);
             glBufferSubData(GL_ARRAY_BUFFER, offset, attributeSize, data);
             return;
         }
@@ -163,6 +173,32 @@ void VertexArray::ChangeVertexData(VertexAttribute::Semantic semantic, void *dat
     }
 }
 
+void VertexArray::ChangeVertexData(void* data, unsigned int vertexCount)
+{
+    // Only a prefix of the buffer can be updated if the data is interleaved.
+    if(mData.vertexDefinition.layout == VertexDefinition::Layout::Packed)
+    {
+        std::cout << "WARNING: You can only update a range of vertices when using interleaved data!" << std::endl;
+        return;
+    }
+    if(vertexCount > mData.vertexCount)
+    {
+        std::cout << "WARNING: Tried to change " << vertexCount << " vertices, but vertex array only holds " << mData.vertexCount << std::endl;
+        vertexCount = mData.vertexCount;
+    }
+    
+    GLState::Instance()->BindArrayBuffer(mVBO);
+    
+    // For dynamic data, "orphan" the old buffer contents before writing.
+    // The GPU may still be drawing from the old contents; this lets the driver hand us fresh memory instead of waiting for it.
+    GLsizeiptr size = mData.vertexCount * mData.vertexDefinition.CalculateSize();
+    if(mData.meshUsage == MeshUsage::Dynamic)
+    {
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * mData.vertexDefinition.CalculateSize(), data);
+}
+
 void VertexArray::ChangeIndexData(unsigned short* indexes, unsigned int count)
 {
     // If changing existing buffer contents, but the count is different, we must create delete old buffer and make a new one.
@@ -226,15 +262,12 @@ void VertexArray::Draw(GLenum mode) const
 
 void VertexArray::Draw(GLenum mode, unsigned int offset, unsigned int count) const
 {
-    // Bind vertex array object.
-    glBindVertexArray(mVAO);
+    // Bind vertex array object. This also binds the index buffer, if any.
+    GLState::Instance()->BindVertexArray(mVAO);
     
     // Draw method depends on whether we have indexes or not.
     if(mIBO != GL_NONE)
     {
-        // Bind index buffer.
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
-        
         // Draw "count" indices at offset.
         glDrawElements(mode, count, GL_UNSIGNED_SHORT, BUFFER_OFFSET(offset * sizeof(GLushort)));
     }
@@ -245,10 +278,50 @@ void VertexArray::Draw(GLenum mode, unsigned int offset, unsigned int count) con
     }
 }
                     
+void VertexArray::DrawInstanced(GLenum mode, GLuint instanceBuffer, unsigned int firstInstance, unsigned int instanceCount) const
+{
+    GLState::Instance()->BindVertexArray(mVAO);
+    
+    // Point the instance transform attribute at this draw's matrices, advancing once per instance (not per vertex).
+    // GL 3.3 can't offset the instance index of a draw, so the offset goes in the attribute pointer instead.
+    // A matrix attribute is really four vec4 attributes, one per column.
+    const GLsizei kMatrixSize = 16 * sizeof(GLfloat);
+    const GLsizei kColumnSize = 4 * sizeof(GLfloat);
+    GLuint attributeId = static_cast<GLuint>(VertexAttribute::Semantic::InstanceTransform);
+    GLState::Instance()->BindArrayBuffer(instanceBuffer);
+    for(GLuint i = 0; i < 4; ++i)
+    {
+        glEnableVertexAttribArray(attributeId + i);
+        glVertexAttribPointer(attributeId + i, 4, GL_FLOAT, GL_FALSE, kMatrixSize, BUFFER_OFFSET(firstInstance * kMatrixSize + i * kColumnSize));
+        glVertexAttribDivisor(attributeId + i, 1);
+    }
+    
+    if(mIBO != GL_NONE)
+    {
+        unsigned int count = mData.indexCount;
+        glDrawElementsInstanced(mode, count, GL_UNSIGNED_SHORT, BUFFER_OFFSET(0), instanceCount);
+    }
+    else
+    {
+        glDrawArraysInstanced(mode, 0, mData.vertexCount, instanceCount);
+    }
+    
+    // The instance attributes are part of the vertex array's state, so turn them back off.
+    // Otherwise, later non-instanced draws with this vertex array would still read from the instance buffer.
+    for(GLuint i = 0; i < 4; ++i)
+    {
+        glVertexAttribDivisor(attributeId + i, 0);
+        glDisableVertexAttribArray(attributeId + i);
+    }
+}
+
 void VertexArray::RefreshIBOContents(unsigned short* indexData, int indexCount)
 {
     if(indexData != nullptr && indexCount > 0)
     {
+        // Binding the index buffer changes the bound VAO, so make sure it's ours.
+        GLState::Instance()->BindVertexArray(mVAO);
+        
         // Either create new buffer and fill with index data,
         // Or populate existing buffer with new data.
         if(mIBO == GL_NONE)
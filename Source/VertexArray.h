@@ -64,6 +64,10 @@ public:
     void ChangeVertexData(void* data);
     void ChangeVertexData(VertexAttribute::Semantic semantic, void* data);
     
+    // Replaces only the first "vertexCount" vertices (interleaved data only).
+    // Useful for streaming data that changes size each frame into a buffer with some spare capacity.
+    void ChangeVertexData(void* data, unsigned int vertexCount);
+    
     void ChangeIndexData(unsigned short* indexes, unsigned int count);
     
     void DrawTriangles() const;
@@ -81,6 +85,10 @@ public:
     void Draw(GLenum mode) const;
     void Draw(GLenum mode, unsigned int offset, unsigned int count) const;
     
+    // Draws the whole vertex array "instanceCount" times.
+    // Each instance's object to world matrix is read from "instanceBuffer" (a buffer of Matrix4), starting at "firstInstance".
+    void DrawInstanced(GLenum mode, GLuint instanceBuffer, unsigned int firstInstance, unsigned int instanceCount) const;
+    
 private:
     // Definition data passed in.
     // Note that vertex/index data pointers SHOULD NOT be considered valid after construction!
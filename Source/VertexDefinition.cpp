@@ -10,7 +10,8 @@ const char* gAttributeNames[] = {
     "vNormal",
     "vColor",
     "vUV1",
-    "vUV2"
+    "vUV2",
+    "vInstanceTransform"
 };
 
 VertexAttribute VertexAttribute::Position {
@@ -30,6 +30,10 @@ struct VertexAttribute
         Color,
         UV1,
         UV2,
+        
+        // Per-instance object to world matrix, for instanced draws (see VertexArray::DrawInstanced).
+        // A matrix uses four attribute locations, so this must stay last.
+        InstanceTransform,
         SemanticCount
     };
     
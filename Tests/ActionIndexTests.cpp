@@ -0,0 +1,270 @@
+//
+// ActionIndexTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for ActionIndex class.
+//
+#include "catch.hh"
+#include "ActionIndex.h"
+
+#include <algorithm>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "NVC.h"
+
+namespace
+{
+	const Atom kAnyObject("ANY_OBJECT");
+	const Atom kAnyInvItem("ANY_INV_ITEM");
+
+	Action MakeAction(const std::string& noun, const std::string& verb, const std::string& caseLabel)
+	{
+		Action action;
+		action.noun = noun;
+		action.verb = verb;
+		action.caseLabel = caseLabel;
+		action.nounAtom = Atom(noun);
+		action.verbAtom = Atom(verb);
+		action.caseAtom = Atom(caseLabel);
+		return action;
+	}
+
+	// Active action sets, and the types of each verb (as VerbManager would report them).
+	struct ActionSets
+	{
+		std::vector<std::vector<Action>> sets;
+		std::unordered_map<Atom, int> verbTypes;
+
+		ActionIndex BuildIndex() const
+		{
+			ActionIndex index;
+			for(int i = 0; i < (int)sets.size(); ++i)
+			{
+				for(const Action& action : sets[i])
+				{
+					auto it = verbTypes.find(action.verbAtom);
+					index.Add(&action, i, it != verbTypes.end() ? it->second : 0);
+				}
+			}
+			return index;
+		}
+
+		bool IsType(Atom verb, VerbType verbType) const
+		{
+			auto it = verbTypes.find(verb);
+			return it != verbTypes.end() && (it->second & ActionIndex::GetVerbTypeFlag(verbType)) != 0;
+		}
+	};
+
+	// The linear scans ActionManager used before it had an index, to compare the index against.
+	// Action set order and file order decide priority, exactly as before.
+	namespace Linear
+	{
+		const Action* GetExecuteAction(const ActionSets& actionSets, Atom noun, Atom verb, const ActionIndex::CaseCheck& isCaseMet)
+		{
+			// Only the first action for the noun/verb in each action set is a candidate; the last valid candidate is used.
+			const Action* candidate = nullptr;
+			for(auto& actionSet : actionSets.sets)
+			{
+				auto it = std::find_if(actionSet.begin(), actionSet.end(), [noun, verb](const Action& action) {
+					return action.nounAtom == noun && action.verbAtom == verb;
+				});
+				if(it != actionSet.end() && isCaseMet(&(*it), VerbType::Normal))
+				{
+					candidate = &(*it);
+				}
+			}
+			return candidate;
+		}
+
+		const Action* GetAction(const ActionSets& actionSets, Atom noun, Atom verb, bool verbIsInventoryItem, const ActionIndex::CaseCheck& isCaseMet)
+		{
+			// From most general to most specific, the last valid candidate is used.
+			std::vector<std::pair<Atom, Atom>> passes;
+			if(verbIsInventoryItem) { passes.emplace_back(kAnyObject, kAnyInvItem); }
+			passes.emplace_back(kAnyObject, verb);
+			if(verbIsInventoryItem) { passes.emplace_back(noun, kAnyInvItem); }
+			passes.emplace_back(noun, verb);
+
+			const Action* candidate = nullptr;
+			for(auto& pass : passes)
+			{
+				for(auto& actionSet : actionSets.sets)
+				{
+					for(auto& action : actionSet)
+					{
+						if(action.nounAtom == pass.first && action.verbAtom == pass.second && isCaseMet(&action, VerbType::Normal))
+						{
+							candidate = &action;
+						}
+					}
+				}
+			}
+			return candidate;
+		}
+
+		std::vector<const Action*> GetActionBarActions(const ActionSets& actionSets, Atom noun, VerbType verbType, const ActionIndex::CaseCheck& isCaseMet)
+		{
+			std::unordered_map<Atom, const Action*> verbToAction;
+			for(auto& actionSet : actionSets.sets)
+			{
+				// ANY_OBJECT actions first, then actions for the noun (which can replace them).
+				// Within an action set, only the first valid action for each verb is used.
+				for(Atom pass : { kAnyObject, noun })
+				{
+					std::unordered_set<Atom> usedVerbs;
+					for(auto& action : actionSet)
+					{
+						if(action.nounAtom != pass || action.verbAtom == kAnyInvItem) { continue; }
+						if(usedVerbs.find(action.verbAtom) != usedVerbs.end()) { continue; }
+						if(actionSets.IsType(action.verbAtom, verbType) && isCaseMet(&action, verbType))
+						{
+							verbToAction[action.verbAtom] = &action;
+							usedVerbs.insert(action.verbAtom);
+						}
+					}
+				}
+			}
+
+			std::vector<const Action*> actions;
+			for(auto& entry : verbToAction)
+			{
+				actions.push_back(entry.second);
+			}
+			return actions;
+		}
+	}
+
+	std::vector<const Action*> GetActionBarActions(const ActionIndex& index, Atom noun, VerbType verbType, const ActionIndex::CaseCheck& isCaseMet)
+	{
+		std::vector<const Action*> actions;
+		index.GetActionBarActions(noun, verbType, isCaseMet, &actions);
+		return actions;
+	}
+
+	// The action bar's order isn't important, only which actions are on it.
+	std::vector<const Action*> Sorted(std::vector<const Action*> actions)
+	{
+		std::sort(actions.begin(), actions.end());
+		return actions;
+	}
+}
+
+TEST_CASE("Action index prefers specific actions and later action sets")
+{
+	ActionSets actionSets;
+	actionSets.verbTypes[Atom("LOOK")] = ActionIndex::GetVerbTypeFlag(VerbType::Normal);
+	actionSets.verbTypes[Atom("KEY")] = ActionIndex::GetVerbTypeFlag(VerbType::Inventory);
+	actionSets.sets.push_back({
+		MakeAction("ANY_OBJECT", "LOOK", "ALL"),
+		MakeAction("CANDY", "LOOK", "C1"),
+		MakeAction("ANY_OBJECT", "ANY_INV_ITEM", "ALL")
+	});
+	actionSets.sets.push_back({
+		MakeAction("ANY_OBJECT", "LOOK", "C2"),
+		MakeAction("CANDY", "ANY_INV_ITEM", "C1")
+	});
+	ActionIndex index = actionSets.BuildIndex();
+
+	std::unordered_set<Atom> metCases { Atom("ALL"), Atom("C1"), Atom("C2") };
+	ActionIndex::CaseCheck isCaseMet = [&metCases](const Action* action, VerbType verbType) {
+		return metCases.find(action->caseAtom) != metCases.end();
+	};
+	Atom candy("CANDY");
+	Atom look("LOOK");
+	Atom key("KEY");
+
+	// An exact noun/verb match beats a wildcard, even from an earlier action set...
+	REQUIRE(index.GetAction(candy, look, false, isCaseMet) == &actionSets.sets[0][1]);
+	REQUIRE(index.GetAction(candy, key, true, isCaseMet) == &actionSets.sets[1][1]);
+
+	// ...but on the action bar, later action sets win.
+	REQUIRE(GetActionBarActions(index, candy, VerbType::Normal, isCaseMet) == std::vector<const Action*> { &actionSets.sets[1][0] });
+
+	// When later cases aren't met, earlier actions are used.
+	metCases.erase(Atom("C2"));
+	REQUIRE(GetActionBarActions(index, candy, VerbType::Normal, isCaseMet) == std::vector<const Action*> { &actionSets.sets[0][1] });
+	metCases.erase(Atom("C1"));
+	REQUIRE(GetActionBarActions(index, candy, VerbType::Normal, isCaseMet) == std::vector<const Action*> { &actionSets.sets[0][0] });
+	REQUIRE(index.GetAction(candy, key, true, isCaseMet) == &actionSets.sets[0][2]);
+
+	// ANY_INV_ITEM only matches a specific inventory item.
+	REQUIRE(!index.GetActionBarActions(candy, VerbType::Inventory, isCaseMet, nullptr));
+	REQUIRE(index.GetAction(candy, key, false, isCaseMet) == nullptr);
+
+	index.Clear();
+	REQUIRE(index.GetAction(candy, look, false, isCaseMet) == nullptr);
+}
+
+TEST_CASE("Action index finds the same actions as scanning every action set")
+{
+	// Few nouns, verbs, and cases, so there's lots of overlap between wildcard and specific actions.
+	const std::vector<std::string> nouns { "CANDY", "DOOR", "ANY_OBJECT" };
+	const std::vector<std::string> verbs { "LOOK", "TALK", "KEY", "GUN", "T_BUCHELLI", "ANY_INV_ITEM" };
+	const std::vector<std::string> cases { "ALL", "C1", "C2", "TOPIC_ONLY" };
+
+	ActionSets actionSets;
+	actionSets.verbTypes[Atom("LOOK")] = ActionIndex::GetVerbTypeFlag(VerbType::Normal);
+	actionSets.verbTypes[Atom("TALK")] = ActionIndex::GetVerbTypeFlag(VerbType::Normal) | ActionIndex::GetVerbTypeFlag(VerbType::Topic);
+	actionSets.verbTypes[Atom("KEY")] = ActionIndex::GetVerbTypeFlag(VerbType::Inventory);
+	actionSets.verbTypes[Atom("GUN")] = ActionIndex::GetVerbTypeFlag(VerbType::Inventory);
+	actionSets.verbTypes[Atom("T_BUCHELLI")] = ActionIndex::GetVerbTypeFlag(VerbType::Topic);
+
+	// Like some global conditions, a case can depend on the type of verb being asked for.
+	std::unordered_set<Atom> metCases;
+	ActionIndex::CaseCheck isCaseMet = [&metCases](const Action* action, VerbType verbType) {
+		if(action->caseAtom == Atom("TOPIC_ONLY")) { return verbType == VerbType::Topic; }
+		return metCases.find(action->caseAtom) != metCases.end();
+	};
+
+	std::vector<Atom> queryNouns { Atom("CANDY"), Atom("DOOR"), kAnyObject, Atom("NOT_IN_ANY_SET") };
+	std::vector<Atom> queryVerbs { Atom("LOOK"), Atom("TALK"), Atom("KEY"), Atom("GUN"), Atom("T_BUCHELLI"), kAnyInvItem, Atom("NOT_IN_ANY_SET") };
+
+	std::mt19937 random(1234);
+	for(int trial = 0; trial < 200; ++trial)
+	{
+		actionSets.sets.clear();
+		int actionSetCount = 1 + random() % 5;
+		for(int i = 0; i < actionSetCount; ++i)
+		{
+			std::vector<Action> actionSet;
+			int actionCount = random() % 12;
+			for(int j = 0; j < actionCount; ++j)
+			{
+				actionSet.push_back(MakeAction(nouns[random() % nouns.size()], verbs[random() % verbs.size()], cases[random() % cases.size()]));
+			}
+			actionSets.sets.push_back(actionSet);
+		}
+		ActionIndex index = actionSets.BuildIndex();
+
+		for(int caseTrial = 0; caseTrial < 4; ++caseTrial)
+		{
+			metCases.clear();
+			for(auto& caseLabel : cases)
+			{
+				if(random() % 2 == 0) { metCases.insert(Atom(caseLabel)); }
+			}
+
+			for(Atom noun : queryNouns)
+			{
+				for(Atom verb : queryVerbs)
+				{
+					REQUIRE(index.GetExecuteAction(noun, verb, isCaseMet) == Linear::GetExecuteAction(actionSets, noun, verb, isCaseMet));
+
+					bool verbIsInventoryItem = actionSets.IsType(verb, VerbType::Inventory);
+					REQUIRE(index.GetAction(noun, verb, verbIsInventoryItem, isCaseMet) == Linear::GetAction(actionSets, noun, verb, verbIsInventoryItem, isCaseMet));
+				}
+
+				for(VerbType verbType : { VerbType::Normal, VerbType::Inventory, VerbType::Topic })
+				{
+					std::vector<const Action*> expected = Linear::GetActionBarActions(actionSets, noun, verbType, isCaseMet);
+					REQUIRE(Sorted(GetActionBarActions(index, noun, verbType, isCaseMet)) == Sorted(expected));
+					REQUIRE(index.GetActionBarActions(noun, verbType, isCaseMet, nullptr) == !expected.empty());
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,55 @@
+//
+// AtomTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for Atom class.
+//
+#include "catch.hh"
+#include "Atom.h"
+
+#include <unordered_map>
+
+TEST_CASE("Atom ignores case but keeps first spelling")
+{
+	Atom door("AtomTest_Door");
+	REQUIRE(!door.IsEmpty());
+	REQUIRE(door == Atom("atomtest_door"));
+	REQUIRE(door == Atom("ATOMTEST_DOOR"));
+	REQUIRE(door.ToString() == "AtomTest_Door");
+	REQUIRE(Atom("atomtest_door").ToString() == "AtomTest_Door");
+	
+	// Different strings give different atoms.
+	Atom open("AtomTest_Open");
+	REQUIRE(door != open);
+	
+	// Empty string is always the empty atom.
+	REQUIRE(Atom("").IsEmpty());
+	REQUIRE(Atom() == Atom(""));
+	REQUIRE(Atom(static_cast<const char*>(nullptr)).IsEmpty());
+}
+
+TEST_CASE("Atom find doesn't create atoms")
+{
+	REQUIRE(Atom::Find("AtomTest_NeverCreated").IsEmpty());
+	
+	Atom created("AtomTest_Created");
+	REQUIRE(Atom::Find("atomtest_created") == created);
+}
+
+TEST_CASE("Atom pair keys are unique per order")
+{
+	Atom noun("AtomTest_Noun");
+	Atom verb("AtomTest_Verb");
+	REQUIRE(Atom::MakeKey(noun, verb) != Atom::MakeKey(verb, noun));
+	REQUIRE(Atom::MakeKey(noun, verb) == Atom::MakeKey(Atom("atomtest_noun"), Atom("ATOMTEST_VERB")));
+	
+	// Unlike concatenating strings, splitting a name differently doesn't collide.
+	REQUIRE(Atom::MakeKey(Atom("AtomTest_ab"), Atom("c")) != Atom::MakeKey(Atom("AtomTest_a"), Atom("bc")));
+	
+	// Atoms work as keys in unordered containers.
+	std::unordered_map<Atom, int> counts;
+	++counts[noun];
+	++counts[Atom("ATOMTEST_NOUN")];
+	REQUIRE(counts[noun] == 2);
+}
@@ -0,0 +1,121 @@
+//
+// ConditionCacheTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for ConditionCache class.
+//
+#include "catch.hh"
+#include "ConditionCache.h"
+
+namespace
+{
+	// Pretends to evaluate a condition that reads some flags, the way SheepVM does.
+	int evaluateCount = 0;
+	bool EvaluateFlags(const void* condition, int n, std::initializer_list<Atom> flags, bool callsUntracked = false)
+	{
+		bool result = false;
+		if(ConditionCache::TryGet(condition, n, 0, result))
+		{
+			return result;
+		}
+
+		++evaluateCount;
+		bool recording = ConditionCache::BeginRecord();
+		for(Atom flag : flags)
+		{
+			ConditionCache::BeginCall();
+			ConditionCache::Read(ConditionInput::Flag, flag);
+			ConditionCache::EndCall();
+		}
+		if(callsUntracked)
+		{
+			ConditionCache::BeginCall();
+			ConditionCache::EndCall();
+		}
+		result = n != 0;
+		if(recording)
+		{
+			ConditionCache::EndRecord(condition, n, 0, result);
+		}
+		return result;
+	}
+}
+
+TEST_CASE("Condition cache reuses results until inputs change")
+{
+	ConditionCache::Clear();
+	int condition = 0;
+	Atom flagA("ConditionCacheTest_FlagA");
+	Atom flagB("ConditionCacheTest_FlagB");
+
+	evaluateCount = 0;
+	REQUIRE(EvaluateFlags(&condition, 1, { flagA }));
+	REQUIRE(EvaluateFlags(&condition, 1, { flagA }));
+	REQUIRE(evaluateCount == 1);
+
+	// Different arguments are cached separately.
+	REQUIRE(!EvaluateFlags(&condition, 0, { flagA }));
+	REQUIRE(evaluateCount == 2);
+
+	// Changing something the condition didn't read doesn't invalidate it.
+	ConditionCache::Changed(ConditionInput::Flag, flagB);
+	ConditionCache::Changed(ConditionInput::GameVariable, flagA);
+	EvaluateFlags(&condition, 1, { flagA });
+	REQUIRE(evaluateCount == 2);
+
+	// Changing something it did read does.
+	ConditionCache::Changed(ConditionInput::Flag, flagA);
+	EvaluateFlags(&condition, 1, { flagA });
+	REQUIRE(evaluateCount == 3);
+	EvaluateFlags(&condition, 1, { flagA });
+	REQUIRE(evaluateCount == 3);
+
+	// So does changing all values of that input at once.
+	ConditionCache::ChangedAll(ConditionInput::Flag);
+	EvaluateFlags(&condition, 1, { flagA });
+	REQUIRE(evaluateCount == 4);
+}
+
+TEST_CASE("Condition cache doesn't cache untracked calls")
+{
+	ConditionCache::Clear();
+	int condition = 0;
+	Atom flag("ConditionCacheTest_Flag");
+
+	evaluateCount = 0;
+	EvaluateFlags(&condition, 1, { flag }, true);
+	EvaluateFlags(&condition, 1, { flag }, true);
+	REQUIRE(evaluateCount == 2);
+
+	// Nested recording isn't supported, so the outer condition isn't cached either.
+	REQUIRE(ConditionCache::BeginRecord());
+	REQUIRE(!ConditionCache::BeginRecord());
+	ConditionCache::EndRecord(&condition, 1, 0, true);
+	bool result = false;
+	REQUIRE(!ConditionCache::TryGet(&condition, 1, 0, result));
+	REQUIRE(!ConditionCache::IsRecording());
+}
+
+TEST_CASE("Condition cache doesn't grow past its maximum size")
+{
+	ConditionCache::Clear();
+	int condition = 0;
+	Atom flag("ConditionCacheTest_Flag");
+
+	// Each n is a separate result. Once the cache is full, adding another throws the others away.
+	evaluateCount = 0;
+	for(int n = 0; n < static_cast<int>(ConditionCache::kMaxEntries); ++n)
+	{
+		EvaluateFlags(&condition, n, { flag });
+	}
+	REQUIRE(ConditionCache::GetEntryCount() == ConditionCache::kMaxEntries);
+	EvaluateFlags(&condition, -1, { flag });
+	REQUIRE(ConditionCache::GetEntryCount() == 1);
+
+	// The result that caused the clear is still cached.
+	EvaluateFlags(&condition, -1, { flag });
+	REQUIRE(evaluateCount == static_cast<int>(ConditionCache::kMaxEntries) + 1);
+	ConditionCache::Clear();
+	REQUIRE(ConditionCache::GetEntryCount() == 0);
+}
@@ -0,0 +1,221 @@
+//
+// GLStateTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for GLState class.
+//
+#include "catch.hh"
+#include "GLState.h"
+
+namespace
+{
+	// GL calls made by GLState, and the last value given to each.
+	struct GLCalls
+	{
+		int useProgram = 0;
+		int bindVertexArray = 0;
+		int bindBuffer = 0;
+		int activeTexture = 0;
+		int bindTexture = 0;
+		int enable = 0;
+		int disable = 0;
+		int depthMask = 0;
+
+		GLuint lastProgram = 0;
+		GLuint lastVertexArray = 0;
+		GLuint lastBuffer = 0;
+		GLenum lastActiveTexture = 0;
+		GLuint lastTexture = 0;
+		GLenum lastCapability = 0;
+		GLboolean lastDepthMask = GL_FALSE;
+
+		int GetTotal() const { return useProgram + bindVertexArray + bindBuffer + activeTexture + bindTexture + enable + disable + depthMask; }
+	};
+	GLCalls calls;
+
+	void GLAPIENTRY FakeUseProgram(GLuint program) { ++calls.useProgram; calls.lastProgram = program; }
+	void GLAPIENTRY FakeBindVertexArray(GLuint vertexArray) { ++calls.bindVertexArray; calls.lastVertexArray = vertexArray; }
+	void GLAPIENTRY FakeBindBuffer(GLenum target, GLuint buffer)
+	{
+		REQUIRE(target == GL_ARRAY_BUFFER);
+		++calls.bindBuffer;
+		calls.lastBuffer = buffer;
+	}
+	void GLAPIENTRY FakeActiveTexture(GLenum texture) { ++calls.activeTexture; calls.lastActiveTexture = texture; }
+}
+
+// GLState only calls a few GL functions, so the tests stand in for them, and no GL context is needed.
+// GL 1.1 functions are regular functions; later ones are function pointers that GLEW normally loads.
+PFNGLUSEPROGRAMPROC __glewUseProgram = FakeUseProgram;
+PFNGLBINDVERTEXARRAYPROC __glewBindVertexArray = FakeBindVertexArray;
+PFNGLBINDBUFFERPROC __glewBindBuffer = FakeBindBuffer;
+PFNGLACTIVETEXTUREPROC __glewActiveTexture = FakeActiveTexture;
+
+void GLAPIENTRY glBindTexture(GLenum target, GLuint texture) { ++calls.bindTexture; calls.lastTexture = texture; }
+void GLAPIENTRY glEnable(GLenum cap) { ++calls.enable; calls.lastCapability = cap; }
+void GLAPIENTRY glDisable(GLenum cap) { ++calls.disable; calls.lastCapability = cap; }
+void GLAPIENTRY glDepthMask(GLboolean flag) { ++calls.depthMask; calls.lastDepthMask = flag; }
+
+TEST_CASE("GL state skips binding what's already bound")
+{
+	calls = GLCalls();
+	GLState state;
+	REQUIRE(GLState::Instance() == &state);
+
+	state.UseProgram(1);
+	state.UseProgram(1);
+	REQUIRE(calls.useProgram == 1);
+	REQUIRE(state.GetProgram() == 1);
+	state.UseProgram(2);
+	REQUIRE(calls.useProgram == 2);
+	REQUIRE(calls.lastProgram == 2);
+
+	state.BindVertexArray(3);
+	state.BindVertexArray(3);
+	REQUIRE(calls.bindVertexArray == 1);
+
+	// The array buffer binding doesn't change with the vertex array.
+	state.BindArrayBuffer(4);
+	state.BindVertexArray(5);
+	state.BindArrayBuffer(4);
+	REQUIRE(calls.bindBuffer == 1);
+	REQUIRE(calls.lastBuffer == 4);
+
+	// Counts are reported for the last completed frame.
+	REQUIRE(state.GetBindsIssued() == 0);
+	state.EndFrame();
+	REQUIRE(state.GetBindsIssued() == 5);
+	REQUIRE(state.GetBindsSkipped() == 3);
+	state.UseProgram(2);
+	state.EndFrame();
+	REQUIRE(state.GetBindsIssued() == 0);
+	REQUIRE(state.GetBindsSkipped() == 1);
+
+	// After invalidating, everything goes to GL again.
+	state.Invalidate();
+	state.UseProgram(2);
+	state.BindVertexArray(5);
+	state.BindArrayBuffer(4);
+	REQUIRE(calls.useProgram == 3);
+	REQUIRE(calls.bindVertexArray == 3);
+	REQUIRE(calls.bindBuffer == 2);
+}
+
+TEST_CASE("GL state remembers textures per unit and target")
+{
+	calls = GLCalls();
+	GLState state;
+
+	state.BindTexture(0, GL_TEXTURE_2D, 5);
+	state.BindTexture(0, GL_TEXTURE_2D, 5);
+	REQUIRE(calls.activeTexture == 1);
+	REQUIRE(calls.bindTexture == 1);
+
+	// The same texture on another unit is a different binding.
+	state.BindTexture(1, GL_TEXTURE_2D, 5);
+	REQUIRE(calls.activeTexture == 2);
+	REQUIRE(calls.lastActiveTexture == GL_TEXTURE1);
+	REQUIRE(calls.bindTexture == 2);
+
+	// A texture that's already bound to a unit doesn't even need the unit to be made active.
+	state.BindTexture(0, GL_TEXTURE_2D, 5);
+	REQUIRE(calls.activeTexture == 2);
+	REQUIRE(calls.bindTexture == 2);
+
+	// Binding without a unit uses the active unit (unit 1), and each target has its own binding.
+	state.BindTexture(GL_TEXTURE_2D, 5);
+	REQUIRE(calls.bindTexture == 2);
+	state.BindTexture(GL_TEXTURE_CUBE_MAP, 5);
+	REQUIRE(calls.bindTexture == 3);
+	state.BindTexture(1, GL_TEXTURE_CUBE_MAP, 5);
+	REQUIRE(calls.activeTexture == 2);
+	REQUIRE(calls.bindTexture == 3);
+
+	// Targets that aren't remembered always go to GL.
+	state.BindTexture(GL_TEXTURE_3D, 5);
+	state.BindTexture(GL_TEXTURE_3D, 5);
+	REQUIRE(calls.bindTexture == 5);
+}
+
+TEST_CASE("GL state forgets deleted objects")
+{
+	calls = GLCalls();
+	GLState state;
+
+	state.UseProgram(1);
+	state.BindVertexArray(2);
+	state.BindArrayBuffer(4);
+	state.BindTexture(0, GL_TEXTURE_2D, 3);
+	state.BindTexture(1, GL_TEXTURE_2D, 3);
+	int callCount = calls.GetTotal();
+
+	// Deleting an object that isn't bound changes nothing.
+	state.OnProgramDeleted(10);
+	state.OnVertexArrayDeleted(10);
+	state.OnBufferDeleted(10);
+	state.OnTextureDeleted(10);
+	state.UseProgram(1);
+	state.BindVertexArray(2);
+	state.BindArrayBuffer(4);
+	state.BindTexture(0, GL_TEXTURE_2D, 3);
+	REQUIRE(calls.GetTotal() == callCount);
+
+	// GL unbinds deleted vertex arrays, buffers, and textures, so binding zero can be skipped.
+	state.OnVertexArrayDeleted(2);
+	state.BindVertexArray(0);
+	state.OnBufferDeleted(4);
+	state.BindArrayBuffer(0);
+	state.OnTextureDeleted(3);
+	state.BindTexture(0, GL_TEXTURE_2D, 0);
+	state.BindTexture(1, GL_TEXTURE_2D, 0);
+	REQUIRE(calls.GetTotal() == callCount);
+
+	// A new object may get a deleted object's handle, so it must be bound again.
+	state.BindVertexArray(2);
+	REQUIRE(calls.bindVertexArray == 2);
+	state.BindArrayBuffer(4);
+	REQUIRE(calls.bindBuffer == 2);
+	state.OnProgramDeleted(1);
+	state.UseProgram(1);
+	REQUIRE(calls.useProgram == 2);
+}
+
+TEST_CASE("GL state skips setting enabled states that are already set")
+{
+	calls = GLCalls();
+	GLState state;
+
+	state.SetBlendEnabled(true);
+	state.SetBlendEnabled(true);
+	REQUIRE(calls.enable == 1);
+	REQUIRE(calls.lastCapability == GL_BLEND);
+	state.SetBlendEnabled(false);
+	REQUIRE(calls.disable == 1);
+
+	state.SetDepthTestEnabled(true);
+	REQUIRE(calls.lastCapability == GL_DEPTH_TEST);
+	state.SetCullFaceEnabled(false);
+	state.SetCullFaceEnabled(false);
+	REQUIRE(calls.lastCapability == GL_CULL_FACE);
+	REQUIRE(calls.enable == 2);
+	REQUIRE(calls.disable == 2);
+
+	// Each state is remembered separately.
+	state.SetDepthTestEnabled(true);
+	state.SetBlendEnabled(false);
+	REQUIRE(calls.enable == 2);
+	REQUIRE(calls.disable == 2);
+
+	state.SetDepthWriteEnabled(false);
+	state.SetDepthWriteEnabled(false);
+	REQUIRE(calls.depthMask == 1);
+	REQUIRE(calls.lastDepthMask == GL_FALSE);
+	state.SetDepthWriteEnabled(true);
+	REQUIRE(calls.depthMask == 2);
+	REQUIRE(calls.lastDepthMask == GL_TRUE);
+
+	state.EndFrame();
+	REQUIRE(state.GetBindsIssued() == 6);
+	REQUIRE(state.GetBindsSkipped() == 5);
+}
@@ -0,0 +1,124 @@
+//
+// GameProgressTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for GameProgress class.
+//
+#include "catch.hh"
+#include "GameProgress.h"
+
+#include "Localizer.h"
+
+// GameProgress only uses the localizer for timeblock display names. The real one loads text from assets, so stand in for it.
+TYPE_DEF_BASE(Localizer);
+std::string Localizer::GetText(const std::string& key) const { return key; }
+
+TEST_CASE("Game progress values start cleared and ignore case")
+{
+	GameProgress progress;
+	REQUIRE(!progress.GetFlag("GameProgressTest_NeverSet"));
+	REQUIRE(progress.GetGameVariable("GameProgressTest_NeverSet") == 0);
+	REQUIRE(progress.GetChatCount("GameProgressTest_NeverSet") == 0);
+	REQUIRE(progress.GetTopicCount("GameProgressTest_NeverSet", "GameProgressTest_NeverSet") == 0);
+	REQUIRE(progress.GetNounVerbCount("GameProgressTest_NeverSet", "GameProgressTest_NeverSet") == 0);
+
+	progress.SetFlag("GameProgressTest_Flag");
+	REQUIRE(progress.GetFlag("gameprogresstest_flag"));
+	REQUIRE(progress.GetFlag(Atom("GAMEPROGRESSTEST_FLAG")));
+	progress.ClearFlag("GameProgressTest_Flag");
+	REQUIRE(!progress.GetFlag("GameProgressTest_Flag"));
+
+	// Clearing a flag that was never set is fine.
+	progress.ClearFlag("GameProgressTest_NeverSetAgain");
+	REQUIRE(!progress.GetFlag("GameProgressTest_NeverSetAgain"));
+
+	progress.SetGameVariable("GameProgressTest_Var", 5);
+	progress.IncGameVariable("gameprogresstest_var");
+	REQUIRE(progress.GetGameVariable("GameProgressTest_Var") == 6);
+
+	progress.IncChatCount("GameProgressTest_Noun");
+	progress.IncChatCount("GameProgressTest_Noun");
+	REQUIRE(progress.GetChatCount("GameProgressTest_Noun") == 2);
+
+	// Topic and noun/verb counts are per pair, and order matters.
+	progress.SetTopicCount("GameProgressTest_Noun", "GameProgressTest_Topic", 3);
+	progress.IncTopicCount("GameProgressTest_Noun", "GameProgressTest_Topic");
+	REQUIRE(progress.GetTopicCount("gameprogresstest_noun", "gameprogresstest_topic") == 4);
+	REQUIRE(progress.GetTopicCount("GameProgressTest_Topic", "GameProgressTest_Noun") == 0);
+
+	progress.IncNounVerbCount("GameProgressTest_Noun", "GameProgressTest_Verb");
+	REQUIRE(progress.GetNounVerbCount("GameProgressTest_Noun", "GameProgressTest_Verb") == 1);
+	REQUIRE(progress.GetNounVerbCount("GameProgressTest_Verb", "GameProgressTest_Noun") == 0);
+	REQUIRE(progress.GetTopicCount("GameProgressTest_Noun", "GameProgressTest_Verb") == 0);
+
+	// Flags are stored as bits, so make sure neighboring flags don't affect each other.
+	for(int i = 0; i < 70; ++i)
+	{
+		if(i % 3 == 0) { progress.SetFlag("GameProgressTest_Bit" + std::to_string(i)); }
+	}
+	for(int i = 0; i < 70; ++i)
+	{
+		REQUIRE(progress.GetFlag("GameProgressTest_Bit" + std::to_string(i)) == (i % 3 == 0));
+	}
+}
+
+TEST_CASE("Game progress snapshots restore all progress")
+{
+	GameProgress progress;
+	progress.SetScore(10);
+	progress.SetTimeblock(Timeblock("110A"));
+	progress.SetFlag("SnapshotTest_FlagA");
+	progress.SetGameVariable("SnapshotTest_Var", 7);
+	progress.SetChatCount("SnapshotTest_Noun", 2);
+	progress.SetTopicCount("SnapshotTest_Noun", "SnapshotTest_Topic", 3);
+	progress.SetNounVerbCount("SnapshotTest_Noun", "SnapshotTest_Verb", 4);
+
+	GameProgress::Snapshot snapshot;
+	progress.SaveSnapshot(snapshot);
+
+	// Change everything, including values first used after the snapshot.
+	progress.SetScore(20);
+	progress.SetTimeblock(Timeblock("102P"));
+	progress.ClearFlag("SnapshotTest_FlagA");
+	progress.SetFlag("SnapshotTest_FlagB");
+	progress.SetGameVariable("SnapshotTest_Var", 8);
+	progress.SetGameVariable("SnapshotTest_NewVar", 1);
+	progress.SetChatCount("SnapshotTest_NewNoun", 5);
+	progress.IncTopicCount("SnapshotTest_Noun", "SnapshotTest_Topic");
+	progress.SetTopicCount("SnapshotTest_Noun", "SnapshotTest_NewTopic", 6);
+	progress.IncNounVerbCount("SnapshotTest_Noun", "SnapshotTest_Verb");
+	progress.SetNounVerbCount("SnapshotTest_Noun", "SnapshotTest_NewVerb", 9);
+
+	// Changing the timeblock resets chat counts.
+	REQUIRE(progress.GetChatCount("SnapshotTest_Noun") == 0);
+
+	progress.RestoreSnapshot(snapshot);
+	REQUIRE(progress.GetScore() == 10);
+	REQUIRE(progress.GetTimeblock().ToString() == "110A");
+	REQUIRE(progress.GetFlag("SnapshotTest_FlagA"));
+	REQUIRE(!progress.GetFlag("SnapshotTest_FlagB"));
+	REQUIRE(progress.GetGameVariable("SnapshotTest_Var") == 7);
+	REQUIRE(progress.GetGameVariable("SnapshotTest_NewVar") == 0);
+	REQUIRE(progress.GetChatCount("SnapshotTest_Noun") == 2);
+	REQUIRE(progress.GetChatCount("SnapshotTest_NewNoun") == 0);
+	REQUIRE(progress.GetTopicCount("SnapshotTest_Noun", "SnapshotTest_Topic") == 3);
+	REQUIRE(progress.GetTopicCount("SnapshotTest_Noun", "SnapshotTest_NewTopic") == 0);
+	REQUIRE(progress.GetNounVerbCount("SnapshotTest_Noun", "SnapshotTest_Verb") == 4);
+	REQUIRE(progress.GetNounVerbCount("SnapshotTest_Noun", "SnapshotTest_NewVerb") == 0);
+
+	// Values first used after the snapshot still work normally after restoring.
+	progress.IncTopicCount("SnapshotTest_Noun", "SnapshotTest_NewTopic");
+	REQUIRE(progress.GetTopicCount("SnapshotTest_Noun", "SnapshotTest_NewTopic") == 1);
+	progress.SetFlag("SnapshotTest_FlagB");
+	REQUIRE(progress.GetFlag("SnapshotTest_FlagB"));
+
+	// A snapshot can be reused, and restored more than once.
+	progress.SaveSnapshot(snapshot);
+	progress.SetGameVariable("SnapshotTest_Var", 100);
+	progress.RestoreSnapshot(snapshot);
+	progress.RestoreSnapshot(snapshot);
+	REQUIRE(progress.GetGameVariable("SnapshotTest_Var") == 7);
+	REQUIRE(progress.GetTopicCount("SnapshotTest_Noun", "SnapshotTest_NewTopic") == 1);
+	REQUIRE(progress.GetFlag("SnapshotTest_FlagB"));
+}
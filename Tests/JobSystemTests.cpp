@@ -0,0 +1,59 @@
+//
+// JobSystemTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for JobSystem class.
+//
+#include "catch.hh"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <vector>
+
+TEST_CASE("JobSystem runs every index exactly once")
+{
+	JobSystem jobSystem(3);
+	REQUIRE(jobSystem.GetThreadCount() == 4);
+	
+	// Count how many times each index is visited. Uneven amounts of work per index gives stealing something to do.
+	const int kCount = 1000;
+	std::vector<std::atomic<int>> visits(kCount);
+	for(auto& visit : visits)
+	{
+		visit = 0;
+	}
+	std::atomic<int> total(0);
+	jobSystem.ParallelFor(kCount, [&](int index) {
+		volatile int busy = 0;
+		for(int i = 0; i < (index % 10) * 100; ++i) { busy = busy + i; }
+		++visits[index];
+		++total;
+	});
+	REQUIRE(total == kCount);
+	
+	bool allVisitedOnce = true;
+	for(auto& visit : visits)
+	{
+		allVisitedOnce &= (visit == 1);
+	}
+	REQUIRE(allVisitedOnce);
+	
+	// The system can be used over and over.
+	for(int i = 0; i < 50; ++i)
+	{
+		total = 0;
+		jobSystem.ParallelFor(i, [&](int index) { ++total; });
+		REQUIRE(total == i);
+	}
+}
+
+TEST_CASE("JobSystem with no workers runs on the calling thread")
+{
+	JobSystem jobSystem(0);
+	REQUIRE(jobSystem.GetThreadCount() == 1);
+	
+	std::vector<int> order;
+	jobSystem.ParallelFor(5, [&](int index) { order.push_back(index); });
+	REQUIRE(order == std::vector<int>({ 0, 1, 2, 3, 4 }));
+}
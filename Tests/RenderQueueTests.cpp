@@ -0,0 +1,211 @@
+//
+// RenderQueueTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for RenderQueue class.
+//
+#include "catch.hh"
+#include "RenderQueue.h"
+
+#include <algorithm>
+
+namespace
+{
+	// The queue only uses these as sort keys, so any distinct addresses will do.
+	char shaders[2];
+	char textures[3];
+	char meshes[3];
+	
+	RenderQueueItem MakeItem(int shader, int texture, int mesh, float depth = 0.0f, U64 materialKey = 0)
+	{
+		RenderQueueItem item;
+		item.materialKey = materialKey;
+		item.shader = reinterpret_cast<Shader*>(&shaders[shader]);
+		item.texture = reinterpret_cast<Texture*>(&textures[texture]);
+		item.submesh = reinterpret_cast<Submesh*>(&meshes[mesh]);
+		item.depth = depth;
+		return item;
+	}
+}
+
+TEST_CASE("Render queue groups opaque items by shader, then texture, then mesh")
+{
+	RenderQueue queue;
+	queue.AddOpaque(MakeItem(0, 0, 0));
+	queue.AddOpaque(MakeItem(1, 0, 0));
+	queue.AddOpaque(MakeItem(0, 1, 1));
+	queue.AddOpaque(MakeItem(1, 2, 2));
+	queue.AddOpaque(MakeItem(0, 0, 2));
+	queue.AddOpaque(MakeItem(0, 1, 0));
+	queue.AddOpaque(MakeItem(0, 0, 0));
+	queue.Sort();
+	REQUIRE(queue.GetOpaqueCount() == 7);
+	
+	// Each shader, and each texture within a shader, and each mesh within a texture, should be contiguous.
+	int shaderChanges = 0;
+	int textureChanges = 0;
+	int meshChanges = 0;
+	for(int i = 1; i < queue.GetOpaqueCount(); ++i)
+	{
+		const RenderQueueItem& prev = queue.GetOpaque(i - 1);
+		const RenderQueueItem& item = queue.GetOpaque(i);
+		if(item.shader != prev.shader) { ++shaderChanges; }
+		else if(item.texture != prev.texture) { ++textureChanges; }
+		else if(item.submesh != prev.submesh) { ++meshChanges; }
+	}
+	REQUIRE(shaderChanges == 1);
+	REQUIRE(textureChanges == 2);
+	REQUIRE(meshChanges == 2);
+	
+	// Items with identical keys stay in the order added.
+	REQUIRE(queue.GetOpaque(0).shader == queue.GetOpaque(1).shader);
+	REQUIRE(queue.GetOpaque(0).submesh == queue.GetOpaque(1).submesh);
+}
+
+TEST_CASE("Render queue sorts translucent items back to front")
+{
+	RenderQueue queue;
+	queue.AddTranslucent(MakeItem(0, 0, 0, 5.0f));
+	queue.AddTranslucent(MakeItem(0, 0, 1, -2.0f));
+	queue.AddTranslucent(MakeItem(0, 0, 2, 100.0f));
+	queue.AddTranslucent(MakeItem(0, 0, 0, 0.0f));
+	queue.AddTranslucent(MakeItem(0, 0, 0, -30.5f));
+	queue.AddTranslucent(MakeItem(0, 0, 0, 5.5f));
+	queue.Sort();
+	REQUIRE(queue.GetTranslucentCount() == 6);
+	
+	float expected[] = { 100.0f, 5.5f, 5.0f, 0.0f, -2.0f, -30.5f };
+	for(int i = 0; i < 6; ++i)
+	{
+		REQUIRE(queue.GetTranslucent(i).depth == expected[i]);
+	}
+	
+	// Opaque and translucent items are kept separately.
+	REQUIRE(queue.GetOpaqueCount() == 0);
+}
+
+TEST_CASE("Render queue starts over after clear")
+{
+	RenderQueue queue;
+	queue.AddOpaque(MakeItem(0, 0, 0));
+	queue.AddTranslucent(MakeItem(0, 0, 0, 1.0f));
+	queue.Sort();
+	queue.Clear();
+	REQUIRE(queue.GetOpaqueCount() == 0);
+	REQUIRE(queue.GetTranslucentCount() == 0);
+	
+	// Sorting many items exercises every radix pass.
+	for(int i = 0; i < 1000; ++i)
+	{
+		queue.AddTranslucent(MakeItem(0, 0, 0, static_cast<float>((i * 7919) % 1000) - 500.0f));
+	}
+	queue.Sort();
+	for(int i = 1; i < queue.GetTranslucentCount(); ++i)
+	{
+		REQUIRE(queue.GetTranslucent(i - 1).depth >= queue.GetTranslucent(i).depth);
+	}
+}
+
+TEST_CASE("Render queue groups identical opaque items for instancing")
+{
+	RenderQueue queue;
+	queue.AddOpaque(MakeItem(0, 0, 0, 0.0f, 1));
+	queue.AddOpaque(MakeItem(0, 1, 1, 0.0f, 1));
+	queue.AddOpaque(MakeItem(0, 0, 0, 0.0f, 2));
+	queue.AddOpaque(MakeItem(0, 0, 0, 0.0f, 1));
+	queue.AddOpaque(MakeItem(0, 1, 1, 0.0f, 0));
+	queue.AddOpaque(MakeItem(0, 1, 1, 0.0f, 0));
+	queue.AddOpaque(MakeItem(0, 0, 0, 0.0f, 1));
+	queue.Sort();
+	
+	// Groups cover every opaque item exactly once, in order.
+	int total = 0;
+	int largestGroup = 0;
+	for(int i = 0; i < queue.GetInstanceGroupCount(); ++i)
+	{
+		const RenderQueue::InstanceGroup& group = queue.GetInstanceGroup(i);
+		REQUIRE(group.first == total);
+		total += group.count;
+		largestGroup = std::max(largestGroup, group.count);
+		
+		// Everything in a group looks the same.
+		const RenderQueueItem& first = queue.GetOpaque(group.first);
+		for(int j = 1; j < group.count; ++j)
+		{
+			const RenderQueueItem& item = queue.GetOpaque(group.first + j);
+			REQUIRE(item.materialKey == first.materialKey);
+			REQUIRE(item.submesh == first.submesh);
+			REQUIRE(item.texture == first.texture);
+		}
+	}
+	REQUIRE(total == queue.GetOpaqueCount());
+	
+	// Three items share shader/texture/mesh/key 1. Key 2 is on its own.
+	// The key 0 items can't be instanced, and neither can the key 1 item with a different texture and mesh.
+	REQUIRE(largestGroup == 3);
+	REQUIRE(queue.GetInstanceGroupCount() == 5);
+}
+
+TEST_CASE("Render queue packs instance transforms group by group")
+{
+	RenderQueue queue;
+	
+	// Each item's transform records the order it was added in, so it can be found again after sorting.
+	// Two groups of three and two, an item that can't be instanced, and an item alone in its group.
+	const int kMaterialKeys[] = { 1, 2, 1, 0, 2, 1, 3 };
+	const int kMeshes[] = { 0, 1, 0, 0, 1, 0, 2 };
+	for(int i = 0; i < 7; ++i)
+	{
+		RenderQueueItem item = MakeItem(0, 0, kMeshes[i], 0.0f, kMaterialKeys[i]);
+		item.worldTransform = Matrix4::MakeTranslate(Vector3(static_cast<float>(i), 0.0f, 0.0f));
+		queue.AddOpaque(item);
+	}
+	queue.Sort();
+	
+	std::vector<Matrix4> transforms;
+	transforms.push_back(Matrix4::Identity); // Left over from an earlier frame.
+	queue.BuildInstanceTransforms(transforms);
+	REQUIRE(transforms.size() == 5);
+	
+	// Each instanced group's transforms start where the previous group's end, and match the group's items in sorted order.
+	int nextInstance = 0;
+	int instancedGroupCount = 0;
+	for(int i = 0; i < queue.GetInstanceGroupCount(); ++i)
+	{
+		const RenderQueue::InstanceGroup& group = queue.GetInstanceGroup(i);
+		if(group.count == 1)
+		{
+			REQUIRE(group.firstInstance == -1);
+			continue;
+		}
+		
+		REQUIRE(group.firstInstance == nextInstance);
+		for(int j = 0; j < group.count; ++j)
+		{
+			REQUIRE(transforms[group.firstInstance + j] == queue.GetOpaque(group.first + j).worldTransform);
+		}
+		nextInstance += group.count;
+		++instancedGroupCount;
+	}
+	REQUIRE(nextInstance == 5);
+	REQUIRE(instancedGroupCount == 2);
+	
+	// Items within a group keep the order they were added in.
+	for(int i = 1; i < 5; ++i)
+	{
+		const Matrix4& prev = transforms[i - 1];
+		const Matrix4& transform = transforms[i];
+		if(kMaterialKeys[static_cast<int>(prev.GetTranslation().x)] == kMaterialKeys[static_cast<int>(transform.GetTranslation().x)])
+		{
+			REQUIRE(prev.GetTranslation().x < transform.GetTranslation().x);
+		}
+	}
+	
+	// Groups are rebuilt each sort, so nothing is instanced until transforms are built again.
+	queue.Sort();
+	for(int i = 0; i < queue.GetInstanceGroupCount(); ++i)
+	{
+		REQUIRE(queue.GetInstanceGroup(i).firstInstance == -1);
+	}
+}
@@ -0,0 +1,108 @@
+//
+// SheepOptimizerTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for SheepOptimizer.
+//
+#include "catch.hh"
+#include "SheepOptimizer.h"
+#include "SheepScript.h"
+
+namespace
+{
+	SheepDecodedInstruction Instruction(SheepInstruction instruction, int intArg = 0)
+	{
+		SheepDecodedInstruction decoded;
+		decoded.instruction = instruction;
+		decoded.intArg = intArg;
+		return decoded;
+	}
+}
+
+TEST_CASE("Sheep optimizer folds constants and removes dead branches")
+{
+	// if(2 * 3 == 6) { x = 1; } else { x = 2; }
+	std::vector<SheepDecodedInstruction> instructions = {
+		Instruction(SheepInstruction::PushI, 2),		// 0
+		Instruction(SheepInstruction::PushI, 3),
+		Instruction(SheepInstruction::MultiplyI),
+		Instruction(SheepInstruction::PushI, 6),
+		Instruction(SheepInstruction::IsEqualI),
+		Instruction(SheepInstruction::BranchIfZero, 9),	// 5
+		Instruction(SheepInstruction::PushI, 1),
+		Instruction(SheepInstruction::StoreI, 0),
+		Instruction(SheepInstruction::Branch, 11),
+		Instruction(SheepInstruction::PushI, 2),		// 9
+		Instruction(SheepInstruction::StoreI, 0),
+		Instruction(SheepInstruction::ReturnV)			// 11
+	};
+	std::vector<int> indexMap = SheepOptimizer::Optimize(instructions, { 0 });
+
+	// Only the "true" case is left.
+	REQUIRE(instructions.size() == 3);
+	REQUIRE(instructions[0].instruction == SheepInstruction::PushI);
+	REQUIRE(instructions[0].intArg == 1);
+	REQUIRE(instructions[1].instruction == SheepInstruction::StoreI);
+	REQUIRE(instructions[2].instruction == SheepInstruction::ReturnV);
+
+	// Removed instructions map to where execution would continue.
+	REQUIRE(indexMap[0] == 0);
+	REQUIRE(indexMap[11] == 2);
+}
+
+TEST_CASE("Sheep optimizer fuses common sequences")
+{
+	// if(x != 4) { Foo("text"); }
+	std::vector<SheepDecodedInstruction> instructions = {
+		Instruction(SheepInstruction::LoadI, 0),		// 0
+		Instruction(SheepInstruction::PushI, 4),
+		Instruction(SheepInstruction::IsEqualI),
+		Instruction(SheepInstruction::Not),
+		Instruction(SheepInstruction::BranchIfZero, 10),
+		Instruction(SheepInstruction::PushS, 8),		// 5
+		Instruction(SheepInstruction::GetString),
+		Instruction(SheepInstruction::PushI, 1),
+		Instruction(SheepInstruction::CallSysFunctionV, 3),
+		Instruction(SheepInstruction::Pop),
+		Instruction(SheepInstruction::ReturnV)			// 10
+	};
+	SheepOptimizer::Optimize(instructions, { 0 });
+
+	REQUIRE(instructions.size() == 4);
+	REQUIRE(instructions[0].instruction == SheepInstruction::LoadCompareConstBranchI);
+	REQUIRE(instructions[0].compare == SheepInstruction::IsNotEqualI);
+	REQUIRE(instructions[0].intArg == 3);
+	REQUIRE(instructions[0].intArg2 == 0);
+	REQUIRE(instructions[0].intArg3 == 4);
+	REQUIRE(instructions[1].instruction == SheepInstruction::PushStringConst);
+	REQUIRE(instructions[1].intArg == 8);
+	REQUIRE(instructions[2].instruction == SheepInstruction::CallSysFunctionArgsV);
+	REQUIRE(instructions[2].intArg == 3);
+	REQUIRE(instructions[2].intArg2 == 1);
+	REQUIRE(instructions[3].instruction == SheepInstruction::ReturnV);
+}
+
+TEST_CASE("Sheep optimizer doesn't fuse across branch targets")
+{
+	// A branch lands on the "PushI", so it can't be combined with the "LoadI" before it.
+	std::vector<SheepDecodedInstruction> instructions = {
+		Instruction(SheepInstruction::LoadI, 0),		// 0
+		Instruction(SheepInstruction::Branch, 3),
+		Instruction(SheepInstruction::LoadI, 1),
+		Instruction(SheepInstruction::PushI, 5),		// 3
+		Instruction(SheepInstruction::IsLessI),
+		Instruction(SheepInstruction::StoreI, 2),
+		Instruction(SheepInstruction::ReturnV)
+	};
+	SheepOptimizer::Optimize(instructions, { 0, 2 });
+
+	REQUIRE(instructions.size() == 6);
+	REQUIRE(instructions[0].instruction == SheepInstruction::LoadI);
+	REQUIRE(instructions[1].instruction == SheepInstruction::Branch);
+	REQUIRE(instructions[1].intArg == 3);
+	REQUIRE(instructions[2].instruction == SheepInstruction::LoadI);
+	REQUIRE(instructions[3].instruction == SheepInstruction::CompareConstI);
+	REQUIRE(instructions[3].compare == SheepInstruction::IsLessI);
+	REQUIRE(instructions[3].intArg == 5);
+}
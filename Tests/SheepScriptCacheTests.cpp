@@ -0,0 +1,151 @@
+//
+// SheepScriptCacheTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for SheepScriptCache class, and reading/writing compiled scripts.
+//
+#include "catch.hh"
+#include "SheepScriptCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "BinaryReader.h"
+#include "BinaryWriter.h"
+#include "HeadlessSheepAPI.h"
+#include "SheepCompiler.h"
+#include "SheepScript.h"
+#include "SheepVM.h"
+
+namespace
+{
+	// Condition in the same form as NVC case logic (see SheepManager::CompileEval).
+	// Uses each section of a compiled script: imports, string constants, variables of each type, functions, and bytecode.
+	const std::string kSheep = "symbols { int n$ = 0; int v$ = 0; float f$ = 0.5; string s$ = \"unused\"; } "
+							   "code { X$() { (n$ == 1 && !GetFlag(\"CacheTestFlag\")) || v$ == 2 } }";
+
+	const char* kCacheFilePath = "SheepScriptCacheTest.bin";
+
+	std::string WriteScript(const SheepScript* script)
+	{
+		BinaryWriter writer;
+		script->Write(writer);
+		return writer.GetMemory();
+	}
+
+	SheepScript* ReadScript(const std::string& data)
+	{
+		BinaryReader reader(data.data(), static_cast<unsigned int>(data.size()));
+		return new SheepScript("CacheTest", reader);
+	}
+}
+
+TEST_CASE("Compiled sheep round trips through the cache file")
+{
+	HeadlessSheepAPI::SetQuiet(true);
+	HeadlessSheepAPI::Reset();
+
+	SheepCompiler compiler;
+	SheepScript* compiled = compiler.Compile("CacheTest", kSheep);
+	REQUIRE(compiled != nullptr);
+
+	SheepScriptCache cache;
+	cache.Add(kSheep, compiled);
+	REQUIRE(cache.IsDirty());
+	REQUIRE(cache.Save(kCacheFilePath));
+	REQUIRE(!cache.IsDirty());
+
+	SheepScriptCache loadedCache;
+	REQUIRE(loadedCache.Load(kCacheFilePath));
+	REQUIRE(loadedCache.GetCount() == 1);
+	std::remove(kCacheFilePath);
+
+	// Only the exact sheep text finds a cached script.
+	REQUIRE(loadedCache.Create("CacheTest", kSheep + " ") == nullptr);
+	SheepScript* cached = loadedCache.Create("CacheTest", kSheep);
+	REQUIRE(cached != nullptr);
+	REQUIRE(cached->IsValid());
+
+	// The cached script is identical to the compiled one...
+	REQUIRE(cached->GetBytecodeLength() == compiled->GetBytecodeLength());
+	REQUIRE(std::memcmp(cached->GetBytecode(), compiled->GetBytecode(), compiled->GetBytecodeLength()) == 0);
+	REQUIRE(cached->GetFunctionOffset("X$") == compiled->GetFunctionOffset("X$"));
+	REQUIRE(cached->GetInstructions().size() == compiled->GetInstructions().size());
+	REQUIRE(cached->GetVariables().size() == 4);
+	REQUIRE(cached->GetVariables()[2].type == SheepValueType::Float);
+	REQUIRE(cached->GetVariables()[2].floatValue == 0.5f);
+	REQUIRE(cached->GetVariables()[3].type == SheepValueType::String);
+	REQUIRE(cached->GetSysImport(0) != nullptr);
+	REQUIRE(cached->GetSysImport(0)->name == "GetFlag");
+	REQUIRE(cached->GetSysFunc(0) != nullptr);
+
+	// ...and executes with the same results.
+	SheepVM vm;
+	for(int n = 0; n < 3; n++)
+	{
+		for(int v = 0; v < 4; v++)
+		{
+			bool expected = n == 1 || v == 2;
+			REQUIRE(vm.Evaluate(compiled, n, v) == expected);
+			REQUIRE(vm.Evaluate(cached, n, v) == expected);
+		}
+	}
+
+	delete cached;
+	delete compiled;
+}
+
+TEST_CASE("Compiled sheep with bad counts or lengths is rejected")
+{
+	HeadlessSheepAPI::SetQuiet(true);
+
+	SheepCompiler compiler;
+	SheepScript* compiled = compiler.Compile("CacheTest", kSheep);
+	REQUIRE(compiled != nullptr);
+	std::string data = WriteScript(compiled);
+
+	// Sanity check: unmodified data reads fine.
+	SheepScript* script = ReadScript(data);
+	REQUIRE(script->IsValid());
+	delete script;
+
+	// Truncated data, cut off anywhere, is invalid.
+	for(size_t length = 0; length < data.size(); length++)
+	{
+		script = ReadScript(data.substr(0, length));
+		REQUIRE(!script->IsValid());
+		REQUIRE(script->GetBytecodeLength() == 0);
+		REQUIRE(script->GetFunctionOffset("X$") < 0);
+		delete script;
+	}
+
+	// A huge import count (the first value) is invalid, rather than a huge allocation.
+	std::string corrupt = data;
+	corrupt[0] = '\xFF';
+	corrupt[1] = '\xFF';
+	corrupt[2] = '\xFF';
+	corrupt[3] = '\x7F';
+	script = ReadScript(corrupt);
+	REQUIRE(!script->IsValid());
+	delete script;
+
+	// Corrupt data in a cache file isn't used, so the script will be compiled again.
+	SheepScriptCache cache;
+	cache.Add(kSheep, compiled);
+	REQUIRE(cache.Save(kCacheFilePath));
+	{
+		// Skip identifier, version, entry count, and sheep text block, plus data block length, to get to the import count.
+		std::FILE* file = std::fopen(kCacheFilePath, "r+b");
+		REQUIRE(file != nullptr);
+		std::fseek(file, 11 + 4 + 4 + 4 + static_cast<long>(kSheep.size()) + 4, SEEK_SET);
+		std::fwrite(corrupt.data(), 1, 4, file);
+		std::fclose(file);
+	}
+	SheepScriptCache loadedCache;
+	REQUIRE(loadedCache.Load(kCacheFilePath));
+	std::remove(kCacheFilePath);
+	REQUIRE(loadedCache.Create("CacheTest", kSheep) == nullptr);
+
+	delete compiled;
+}
@@ -0,0 +1,137 @@
+//
+// UIBatchListTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for UIBatchList class.
+//
+#include "catch.hh"
+#include "UIBatchList.h"
+
+namespace
+{
+	// The list only compares these, so any distinct addresses will do.
+	char shaders[2];
+	char textures[3];
+
+	void SetLook(UIBatchList& batches, int shader, int texture, const Color32& replaceColor = Color32::White)
+	{
+		batches.SetLook(reinterpret_cast<Shader*>(&shaders[shader]), reinterpret_cast<Texture*>(&textures[texture]), replaceColor);
+	}
+
+	// Adds an axis-aligned quad with its lower-left corner at (x, y).
+	void AddQuad(UIBatchList& batches, float x, float y, float width, float height, const Color32& color = Color32::White)
+	{
+		batches.AddQuad(Vector3(x, y + height, 0.0f), Vector3(x + width, y + height, 0.0f), Vector3(x + width, y, 0.0f), Vector3(x, y, 0.0f),
+						Vector2(0.0f, 0.0f), Vector2(1.0f, 1.0f), color);
+	}
+
+	Texture* GetTexture(int texture)
+	{
+		return reinterpret_cast<Texture*>(&textures[texture]);
+	}
+}
+
+TEST_CASE("UI batch list merges quads with the same look that don't overlap")
+{
+	UIBatchList batches;
+
+	// Three side-by-side quads, alternating textures: the third can join the first batch.
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 0.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 1);
+	AddQuad(batches, 20.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 40.0f, 0.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetQuadCount() == 3);
+	REQUIRE(batches.GetBatchCount() == 2);
+	REQUIRE(batches.GetBatch(0).texture == GetTexture(0));
+	REQUIRE(batches.GetBatch(0).vertices.size() == 8);
+	REQUIRE(batches.GetBatch(1).texture == GetTexture(1));
+	REQUIRE(batches.GetBatch(1).vertices.size() == 4);
+
+	// The batch's bounds grow to include all its quads.
+	REQUIRE(batches.GetBatch(0).bounds.x == 0.0f);
+	REQUIRE(batches.GetBatch(0).bounds.width == 50.0f);
+	REQUIRE(batches.GetBatch(0).bounds.height == 10.0f);
+
+	// Quads that only touch at an edge don't count as overlapping.
+	SetLook(batches, 0, 1);
+	AddQuad(batches, 50.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 60.0f, 0.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 2);
+	REQUIRE(batches.GetBatch(0).vertices.size() == 12);
+}
+
+TEST_CASE("UI batch list splits batches when quads overlap")
+{
+	UIBatchList batches;
+
+	// Quad C must draw on top of quad B, so it can't move back into quad A's batch.
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 0.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 1);
+	AddQuad(batches, 5.0f, 5.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 8.0f, 8.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 3);
+	REQUIRE(batches.GetBatch(0).texture == GetTexture(0));
+	REQUIRE(batches.GetBatch(1).texture == GetTexture(1));
+	REQUIRE(batches.GetBatch(2).texture == GetTexture(0));
+
+	// Consecutive quads with the same look always share a batch, even if they overlap each other.
+	AddQuad(batches, 8.0f, 8.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 3);
+	REQUIRE(batches.GetBatch(2).vertices.size() == 8);
+
+	// A quad can skip back past batches it doesn't overlap, but not past one it does.
+	// Here, a texture 1 quad far away overlaps nothing, so it joins texture 1's batch.
+	SetLook(batches, 0, 1);
+	AddQuad(batches, 100.0f, 100.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 3);
+	REQUIRE(batches.GetBatch(1).vertices.size() == 8);
+}
+
+TEST_CASE("UI batch list splits batches by shader and replace color")
+{
+	UIBatchList batches;
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 0.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 1, 0);
+	AddQuad(batches, 20.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 0, 0, Color32::Red);
+	AddQuad(batches, 40.0f, 0.0f, 10.0f, 10.0f);
+	SetLook(batches, 1, 0);
+	AddQuad(batches, 60.0f, 0.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 3);
+	REQUIRE(batches.GetBatch(1).vertices.size() == 8);
+	REQUIRE(batches.GetBatch(2).replaceColor == Color32::Red);
+
+	// Vertex color is per quad, so it never splits a batch.
+	SetLook(batches, 0, 0);
+	AddQuad(batches, 80.0f, 0.0f, 10.0f, 10.0f, Color32::Blue);
+	REQUIRE(batches.GetBatchCount() == 3);
+	const UIBatchList::Vertex& vertex = batches.GetBatch(0).vertices.back();
+	REQUIRE(vertex.r == 0.0f);
+	REQUIRE(vertex.b == 1.0f);
+
+	// Vertices are upper-left, upper-right, lower-right, lower-left, with UVs to match.
+	const std::vector<UIBatchList::Vertex>& vertices = batches.GetBatch(0).vertices;
+	REQUIRE(vertices[4].x == 80.0f);
+	REQUIRE(vertices[4].y == 10.0f);
+	REQUIRE(vertices[4].u == 0.0f);
+	REQUIRE(vertices[4].v == 0.0f);
+	REQUIRE(vertices[6].x == 90.0f);
+	REQUIRE(vertices[6].y == 0.0f);
+	REQUIRE(vertices[6].u == 1.0f);
+	REQUIRE(vertices[6].v == 1.0f);
+
+	// Clearing removes all quads.
+	batches.Clear();
+	REQUIRE(batches.GetBatchCount() == 0);
+	REQUIRE(batches.GetQuadCount() == 0);
+	AddQuad(batches, 0.0f, 0.0f, 10.0f, 10.0f);
+	REQUIRE(batches.GetBatchCount() == 1);
+	REQUIRE(batches.GetBatch(0).vertices.size() == 4);
+}
@@ -0,0 +1,172 @@
+//
+// UniformBufferTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests that the CPU-side uniform blocks match the std140 blocks declared in the shaders.
+//
+#include "catch.hh"
+#include "UniformBuffer.h"
+
+#include <cstddef>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct BlockMember
+	{
+		std::string type;
+		std::string name;
+		int offset = 0;
+	};
+
+	// Assigns std140 offsets to block members (only for the types the shared blocks use), and returns the block size.
+	int LayoutStd140(std::vector<BlockMember>& members)
+	{
+		int offset = 0;
+		for(BlockMember& member : members)
+		{
+			int alignment = 0;
+			int size = 0;
+			if(member.type == "float") { alignment = 4; size = 4; }
+			else if(member.type == "vec2") { alignment = 8; size = 8; }
+			else if(member.type == "vec3") { alignment = 16; size = 12; }
+			else if(member.type == "vec4") { alignment = 16; size = 16; }
+			else if(member.type == "mat4") { alignment = 16; size = 64; } // Four vec4 columns.
+			REQUIRE(alignment != 0);
+
+			offset = (offset + alignment - 1) / alignment * alignment;
+			member.offset = offset;
+			offset += size;
+		}
+
+		// A block is padded to a multiple of a vec4's size.
+		return (offset + 15) / 16 * 16;
+	}
+
+	// Reads the members of a uniform block declared in a shader. Returns false if the shader doesn't declare it.
+	bool ReadBlock(const std::string& shaderFileName, const std::string& blockName, std::vector<BlockMember>& outMembers)
+	{
+		std::ifstream file(std::string(ASSETS_DIR) + "/" + shaderFileName);
+		REQUIRE(file.good());
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		std::string text = buffer.str();
+
+		std::size_t blockStart = text.find("uniform " + blockName);
+		if(blockStart == std::string::npos) { return false; }
+		std::size_t membersStart = text.find('{', blockStart);
+		std::size_t membersEnd = text.find('}', blockStart);
+		REQUIRE(membersStart < membersEnd);
+
+		// Members are declared as "type name;".
+		std::stringstream members(text.substr(membersStart + 1, membersEnd - membersStart - 1));
+		BlockMember member;
+		while(members >> member.type >> member.name)
+		{
+			REQUIRE(member.name.back() == ';');
+			member.name.pop_back();
+			outMembers.push_back(member);
+		}
+		return true;
+	}
+
+	// Every shader that declares a shared block.
+	const char* kShaderFileNames[] = {
+		"3D-Billboard.vert",
+		"3D-Color.vert",
+		"3D-Diffuse-Tex.frag",
+		"3D-Diffuse-Tex.vert",
+		"3D-Diffuse-Tex-Instanced.vert",
+		"3D-Diffuse-Tex-VertexAnim.vert",
+		"3D-Lightmap.frag",
+		"3D-Lightmap.vert",
+		"3D-Skybox.vert",
+		"UI-Batch.vert",
+		"UI-Text-ColorReplace.frag"
+	};
+}
+
+TEST_CASE("Frame uniform block matches std140 layout of FrameBlock")
+{
+	std::vector<BlockMember> expected {
+		{ "mat4", "gViewMatrix", static_cast<int>(offsetof(FrameUniformBlock, viewMatrix)) },
+		{ "mat4", "gProjMatrix", static_cast<int>(offsetof(FrameUniformBlock, projMatrix)) },
+		{ "mat4", "gWorldToProjMatrix", static_cast<int>(offsetof(FrameUniformBlock, worldToProjMatrix)) },
+		{ "float", "gAlphaTest", static_cast<int>(offsetof(FrameUniformBlock, alphaTest)) }
+	};
+	REQUIRE(expected[0].offset == 0);
+	REQUIRE(expected[1].offset == 64);
+	REQUIRE(expected[2].offset == 128);
+	REQUIRE(expected[3].offset == 192);
+
+	int blockCount = 0;
+	for(const char* shaderFileName : kShaderFileNames)
+	{
+		std::vector<BlockMember> members;
+		if(!ReadBlock(shaderFileName, "FrameBlock", members)) { continue; }
+		++blockCount;
+
+		INFO(shaderFileName);
+		REQUIRE(LayoutStd140(members) == sizeof(FrameUniformBlock));
+		REQUIRE(members.size() == expected.size());
+		for(int i = 0; i < members.size(); ++i)
+		{
+			REQUIRE(members[i].type == expected[i].type);
+			REQUIRE(members[i].name == expected[i].name);
+			REQUIRE(members[i].offset == expected[i].offset);
+		}
+	}
+	REQUIRE(blockCount > 0);
+}
+
+TEST_CASE("Material uniform block matches std140 layout of MaterialBlock")
+{
+	std::vector<BlockMember> expected {
+		{ "vec4", "uColor", static_cast<int>(offsetof(MaterialUniformBlock, color)) },
+		{ "vec4", "uReplaceColor", static_cast<int>(offsetof(MaterialUniformBlock, replaceColor)) }
+	};
+	REQUIRE(expected[0].offset == 0);
+	REQUIRE(expected[1].offset == 16);
+
+	int blockCount = 0;
+	for(const char* shaderFileName : kShaderFileNames)
+	{
+		std::vector<BlockMember> members;
+		if(!ReadBlock(shaderFileName, "MaterialBlock", members)) { continue; }
+		++blockCount;
+
+		INFO(shaderFileName);
+		REQUIRE(LayoutStd140(members) == sizeof(MaterialUniformBlock));
+		REQUIRE(members.size() == expected.size());
+		for(int i = 0; i < members.size(); ++i)
+		{
+			REQUIRE(members[i].type == expected[i].type);
+			REQUIRE(members[i].name == expected[i].name);
+			REQUIRE(members[i].offset == expected[i].offset);
+		}
+	}
+	REQUIRE(blockCount > 0);
+}
+
+TEST_CASE("std140 layout aligns vectors and pads blocks")
+{
+	// Sanity check the layout rules the tests above rely on.
+	std::vector<BlockMember> members {
+		{ "float", "a" },
+		{ "vec3", "b" },
+		{ "float", "c" },
+		{ "vec2", "d" },
+		{ "mat4", "e" },
+		{ "float", "f" }
+	};
+	REQUIRE(LayoutStd140(members) == 128);
+	REQUIRE(members[1].offset == 16);
+	REQUIRE(members[2].offset == 28);
+	REQUIRE(members[3].offset == 32);
+	REQUIRE(members[4].offset == 48);
+	REQUIRE(members[5].offset == 112);
+}
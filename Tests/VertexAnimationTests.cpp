@@ -0,0 +1,171 @@
+//
+// VertexAnimationTests.cpp
+//
+// Clark Kromenaker
+//
+// Tests for VertexAnimation class.
+//
+#include "catch.hh"
+#include "VertexAnimation.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// Helpers for building a small ACT file in memory.
+	void Write(std::vector<char>& data, const void* value, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(value);
+		data.insert(data.end(), bytes, bytes + size);
+	}
+	void WriteUByte(std::vector<char>& data, uint8_t value) { Write(data, &value, sizeof(value)); }
+	void WriteUShort(std::vector<char>& data, uint16_t value) { Write(data, &value, sizeof(value)); }
+	void WriteUInt(std::vector<char>& data, uint32_t value) { Write(data, &value, sizeof(value)); }
+	void WriteFloat(std::vector<char>& data, float value) { Write(data, &value, sizeof(value)); }
+	void PatchUInt(std::vector<char>& data, size_t offset, uint32_t value) { memcpy(&data[offset], &value, sizeof(value)); }
+
+	// Builds an ACT with one mesh, one submesh, two vertices, and three frames:
+	// Frame 0: Uncompressed vertex data (v0 = (1, 2, 3) by default, v1 = (0, 0, 0)) and an identity transform.
+	// Frame 1: No data.
+	// Frame 2: Compressed vertex data - v0 unchanged, v1 moved by (1, 1, 1) using byte compression.
+	std::vector<char> BuildTestAct(const Vector3& v0 = Vector3(1.0f, 2.0f, 3.0f))
+	{
+		const int kFrameCount = 3;
+		std::vector<char> data;
+		data.insert(data.end(), { 'H', 'T', 'C', 'A' });
+		WriteUInt(data, 0);				// version
+		WriteUInt(data, kFrameCount);	// frame count
+		WriteUInt(data, 1);				// mesh count
+		WriteUInt(data, 0);				// contents size
+		char modelName[32] = "TEST.MOD";
+		Write(data, modelName, sizeof(modelName));
+
+		// Reserve space for keyframe offsets.
+		size_t offsetsStart = data.size();
+		for(int i = 0; i < kFrameCount; ++i)
+		{
+			WriteUInt(data, 0);
+		}
+
+		// Frame 0
+		PatchUInt(data, offsetsStart, static_cast<uint32_t>(data.size()));
+		WriteUShort(data, 0); // mesh index
+		WriteUInt(data, (1 + 4 + 2 + 2 + 24) + (1 + 4 + 48));
+		{
+			WriteUByte(data, 0);
+			WriteUInt(data, 2 + 2 + 24);
+			WriteUShort(data, 0); // submesh index
+			WriteUShort(data, 2); // vertex count
+			WriteFloat(data, v0.x); WriteFloat(data, v0.z); WriteFloat(data, v0.y); // x, z, y
+			WriteFloat(data, 0.0f); WriteFloat(data, 0.0f); WriteFloat(data, 0.0f);
+
+			WriteUByte(data, 2);
+			WriteUInt(data, 48);
+			WriteFloat(data, 1.0f); WriteFloat(data, 0.0f); WriteFloat(data, 0.0f); // i
+			WriteFloat(data, 0.0f); WriteFloat(data, 0.0f); WriteFloat(data, 1.0f); // k
+			WriteFloat(data, 0.0f); WriteFloat(data, 1.0f); WriteFloat(data, 0.0f); // j
+			WriteFloat(data, 0.0f); WriteFloat(data, 0.0f); WriteFloat(data, 0.0f); // position
+		}
+
+		// Frame 1
+		PatchUInt(data, offsetsStart + 4, static_cast<uint32_t>(data.size()));
+		WriteUShort(data, 0);
+		WriteUInt(data, 0);
+
+		// Frame 2
+		PatchUInt(data, offsetsStart + 8, static_cast<uint32_t>(data.size()));
+		WriteUShort(data, 0);
+		WriteUInt(data, 1 + 4 + 2 + 2 + 1 + 3);
+		{
+			WriteUByte(data, 1);
+			WriteUInt(data, 2 + 2 + 1 + 3);
+			WriteUShort(data, 0); // submesh index
+			WriteUShort(data, 2); // vertex count
+			WriteUByte(data, 0x04); // v0 unchanged, v1 byte-compressed
+			WriteUByte(data, 0x20); WriteUByte(data, 0x20); WriteUByte(data, 0x20); // 1.0 for each axis
+		}
+		return data;
+	}
+}
+
+TEST_CASE("VertexAnimation parses and samples keyframes")
+{
+	std::vector<char> data = BuildTestAct();
+	VertexAnimation anim("TEST.ACT", data.data(), static_cast<int>(data.size()));
+	REQUIRE(anim.GetFrameCount() == 3);
+	REQUIRE(anim.GetModelName() == "TEST.MOD");
+
+	// At frame 0, positions match the uncompressed data exactly.
+	VertexAnimationVertexPose pose = anim.SampleVertexPose(0.0f, 15, 0, 0);
+	REQUIRE(pose.mFrameNumber == 0);
+	REQUIRE(pose.mVertexPositions.size() == 2);
+	REQUIRE(pose.mVertexPositions[0] == Vector3(1.0f, 2.0f, 3.0f));
+	REQUIRE(pose.mVertexPositions[1] == Vector3::Zero);
+
+	// Frame 1 has no data, so it is halfway between the keyframes at frame 0 and frame 2.
+	pose = anim.SampleVertexPose(1.0f / 15.0f, 15, 0, 0);
+	REQUIRE(pose.mVertexPositions[0] == Vector3(1.0f, 2.0f, 3.0f));
+	REQUIRE(pose.mVertexPositions[1] == Vector3(0.5f, 0.5f, 0.5f));
+
+	// At (and after) frame 2, compressed deltas have been applied.
+	REQUIRE(anim.SampleVertexPosition(2.0f / 15.0f, 15, 0, 0, 1) == Vector3(1.0f, 1.0f, 1.0f));
+	REQUIRE(anim.SampleVertexPosition(2.5f / 15.0f, 15, 0, 0, 1) == Vector3(1.0f, 1.0f, 1.0f));
+	REQUIRE(anim.SampleVertexPosition(2.5f / 15.0f, 15, 0, 0, 0) == Vector3(1.0f, 2.0f, 3.0f));
+
+	// Sampling into a buffer gives the same results, but fails if the vertex count doesn't match.
+	float positions[6] = { 0.0f };
+	REQUIRE(anim.SampleVertexPose(1.0f / 15.0f, 15, 0, 0, positions, 2));
+	REQUIRE(Vector3(positions[0], positions[1], positions[2]) == Vector3(1.0f, 2.0f, 3.0f));
+	REQUIRE(Vector3(positions[3], positions[4], positions[5]) == Vector3(0.5f, 0.5f, 0.5f));
+	REQUIRE(!anim.SampleVertexPose(1.0f / 15.0f, 15, 0, 0, positions, 3));
+	REQUIRE(!anim.SampleVertexPose(1.0f / 15.0f, 15, 0, 1, positions, 2));
+
+	// Keyframe pair lookup (used for interpolating on the GPU) agrees with the CPU sampling.
+	int currentIndex = -1;
+	int nextIndex = -1;
+	float t = 0.0f;
+	REQUIRE(anim.FindVertexKeyframes(1.0f / 15.0f, 15, 0, 0, currentIndex, nextIndex, t));
+	REQUIRE(currentIndex == 0);
+	REQUIRE(nextIndex == 1);
+	REQUIRE(t == Approx(0.5f));
+	REQUIRE(!anim.FindVertexKeyframes(1.0f / 15.0f, 15, 0, 1, currentIndex, nextIndex, t));
+	REQUIRE(anim.GetMeshCount() == 1);
+	REQUIRE(anim.GetSubmeshCount(0) == 1);
+	REQUIRE(anim.GetSubmeshCount(1) == 0);
+	
+	// Submeshes or meshes that don't exist give an error state.
+	REQUIRE(anim.SampleVertexPose(0.0f, 15, 0, 1).mFrameNumber == -1);
+	REQUIRE(anim.SampleVertexPose(0.0f, 15, 1, 0).mFrameNumber == -1);
+	REQUIRE(anim.SampleTransformPose(0.0f, 15, 1).mFrameNumber == -1);
+
+	// Keyframes are stored quantized, which should take half as much memory as full floats for position data.
+	REQUIRE(anim.GetVertexDataSize() < anim.GetUnquantizedVertexDataSize());
+
+	// The single transform keyframe is used for all times.
+	VertexAnimationTransformPose transformPose = anim.SampleTransformPose(2.0f / 15.0f, 15, 0);
+	REQUIRE(transformPose.mFrameNumber == 0);
+	REQUIRE(transformPose.mLocalPosition == Vector3::Zero);
+	REQUIRE(transformPose.mLocalScale == Vector3::One);
+}
+
+TEST_CASE("VertexAnimation quantized positions stay accurate")
+{
+	// Use a position that doesn't land exactly on a quantization step.
+	Vector3 v0(12.345f, -67.89f, 33.333f);
+	std::vector<char> data = BuildTestAct(v0);
+	VertexAnimation anim("TEST.ACT", data.data(), static_cast<int>(data.size()));
+
+	// Error should be no more than half a step over the ~100 unit range.
+	const float kTolerance = 0.001f;
+	Vector3 sampled = anim.SampleVertexPosition(0.0f, 15, 0, 0, 0);
+	REQUIRE(fabsf(sampled.x - v0.x) < kTolerance);
+	REQUIRE(fabsf(sampled.y - v0.y) < kTolerance);
+	REQUIRE(fabsf(sampled.z - v0.z) < kTolerance);
+
+	sampled = anim.SampleVertexPosition(2.0f / 15.0f, 15, 0, 0, 1);
+	REQUIRE(fabsf(sampled.x - 1.0f) < kTolerance);
+	REQUIRE(fabsf(sampled.y - 1.0f) < kTolerance);
+	REQUIRE(fabsf(sampled.z - 1.0f) < kTolerance);
+}
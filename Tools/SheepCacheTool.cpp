@@ -0,0 +1,94 @@
+//
+// SheepCacheTool.cpp
+//
+// Clark Kromenaker
+//
+// Offline tool that fills the compiled sheep cache, by compiling all sheep embedded in the game's assets.
+// With a full cache, the game never needs to run the sheep compiler when loading assets.
+//
+// Run from the game's working directory (so "Assets" can be found).
+// Optionally, pass the path to write the cache to. By default, it's written where the game looks for it (in the user's preferences directory).
+//
+#include <iostream>
+
+#include "AssetManager.h"
+#include "IniParser.h"
+#include "ReportManager.h"
+#include "Services.h"
+#include "SheepManager.h"
+
+int main(int argc, const char* argv[])
+{
+	std::string cachePath = argc > 1 ? argv[1] : SheepManager::GetDefaultScriptCachePath();
+
+	ReportManager reportManager;
+	Services::SetReports(&reportManager);
+
+	// Find assets the same way the game does (see GEngine::Initialize).
+	AssetManager assetManager;
+	Services::SetAssets(&assetManager);
+	assetManager.AddSearchPath("Assets/");
+	assetManager.AddSearchPath("Assets/GK3/");
+	std::vector<std::string> barns = {
+		"ambient.brn",
+		"common.brn",
+		"core.brn",
+		"day1.brn",
+		"day2.brn",
+		"day3.brn",
+		"day23.brn",
+		"day123.brn"
+	};
+	for(auto& barn : barns)
+	{
+		if(!assetManager.LoadBarn(barn))
+		{
+			std::cout << "Could not load barn: " << barn << std::endl;
+			return 1;
+		}
+	}
+
+	SheepManager sheepManager;
+	Services::SetSheep(&sheepManager);
+
+	// NVC case logic and action scripts are compiled (and cached) when an NVC loads.
+	std::vector<std::string> nvcNames = assetManager.GetBarnAssetNames(".NVC");
+	for(auto& nvcName : nvcNames)
+	{
+		assetManager.LoadNVC(nvcName);
+	}
+
+	// SIF and SCN conditions are only compiled when a scene is created, which needs most of the engine running.
+	// So, find the conditions and compile them directly instead, the same way SceneInitFile does.
+	int sceneFileCount = 0;
+	for(const std::string& extension : { ".SIF", ".SCN" })
+	{
+		for(auto& assetName : assetManager.GetBarnAssetNames(extension))
+		{
+			unsigned int bufferSize = 0;
+			char* buffer = assetManager.LoadRaw(assetName, bufferSize);
+			if(buffer == nullptr) { continue; }
+
+			IniParser parser(buffer, bufferSize);
+			IniSection section;
+			while(parser.ReadNextSection(section))
+			{
+				if(!section.condition.empty())
+				{
+					sheepManager.CompileCached("Int Evaluation", section.condition);
+				}
+			}
+			delete[] buffer;
+			++sceneFileCount;
+		}
+	}
+
+	if(!sheepManager.SaveScriptCache(cachePath))
+	{
+		std::cout << "Could not write sheep cache to " << cachePath << std::endl;
+		return 1;
+	}
+	std::cout << "Cached " << sheepManager.GetScriptCache().GetCount() << " compiled sheep scripts from "
+			  << nvcNames.size() << " NVC files and " << sceneFileCount << " scene files to " << cachePath << std::endl;
+	return 0;
+}
@@ -0,0 +1,316 @@
+//
+// HeadlessSheepAPI.cpp
+//
+// Clark Kromenaker
+//
+#include "HeadlessSheepAPI.h"
+
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+
+#include "ConditionCache.h"
+#include "ReportManager.h"
+#include "SheepAPI.h"
+#include "Services.h"
+#include "StringUtil.h"
+
+using namespace std;
+
+// Same as SheepAPI.cpp, to keep the registrations below identical to the real ones.
+#define WAITABLE true
+#define IMMEDIATE false
+
+#define DEV_FUNC true
+#define REL_FUNC false
+
+namespace
+{
+	bool quiet = false;
+	int errorCount = 0;
+	int stubCallCount = 0;
+
+	// Game state normally owned by GameProgress, LocationManager, and Scene.
+	std::unordered_map<Atom, int> flags;
+	std::unordered_map<Atom, int> gameVariables;
+	std::unordered_map<Atom, int> chatCounts;
+	std::unordered_map<U64, int> nounVerbCounts;
+	std::string egoName = "Gabriel";
+	std::string location = "R25";
+	std::string timeblock = "110A";
+
+	// A fixed seed, so runs are repeatable.
+	unsigned int randomSeed = 1;
+}
+
+// A deque (rather than SheepAPI.cpp's vector) because declarations are also added on demand, after scripts hold pointers to them.
+std::deque<SysFuncDecl> sysFuncs;
+
+// Maps from lowercase name, and from lowercase name plus argument types, to a declaration.
+std::unordered_map<std::string, SysFuncDecl*> nameToSysFunc;
+std::unordered_map<std::string, SysFuncDecl*> signatureToSysFunc;
+
+std::string GetSignature(const SysImport& sysImport)
+{
+	std::string signature = StringUtil::ToLowerCopy(sysImport.name);
+	signature += ':';
+	for(auto& argType : sysImport.argumentTypes)
+	{
+		signature += static_cast<char>('0' + argType);
+	}
+	return signature;
+}
+
+void AddSysFuncDecl(const std::string& name, char retType, std::initializer_list<char> argTypes, bool waitable, bool dev, SysFuncPtr function)
+{
+	SysFuncDecl sysFunc;
+	sysFunc.name = name;
+	sysFunc.returnType = retType;
+	for(auto argType : argTypes)
+	{
+		sysFunc.argumentTypes.push_back(argType);
+	}
+	sysFunc.waitable = waitable;
+	sysFunc.devOnly = dev;
+	sysFunc.function = function;
+
+	sysFuncs.push_back(sysFunc);
+	nameToSysFunc[StringUtil::ToLowerCopy(name)] = &sysFuncs.back();
+	signatureToSysFunc[GetSignature(sysFunc)] = &sysFuncs.back();
+}
+
+SysFuncDecl* GetSysFuncDecl(const std::string& name)
+{
+	auto it = nameToSysFunc.find(name);
+	if(it != nameToSysFunc.end())
+	{
+		return it->second;
+	}
+	return nullptr;
+}
+
+// Stand-ins for system functions the headless API doesn't implement. They do nothing and return a default value.
+SheepValue StubFunction(const SheepValue* args) { ++stubCallCount; return SheepValue(0); }
+SheepValue StubFunctionF(const SheepValue* args) { ++stubCallCount; return SheepValue(0.0f); }
+SheepValue StubFunctionS(const SheepValue* args) { ++stubCallCount; return SheepValue(StoreSysFuncString("")); }
+
+SysFuncDecl* GetSysFuncDecl(const SysImport* sysImport)
+{
+	std::string signature = GetSignature(*sysImport);
+	auto it = signatureToSysFunc.find(signature);
+	if(it != signatureToSysFunc.end())
+	{
+		return it->second;
+	}
+
+	// Compiled scripts can import any function the game has. Declare unknown ones on demand, so scripts still run.
+	SysFuncDecl sysFunc;
+	sysFunc.name = sysImport->name;
+	sysFunc.returnType = sysImport->returnType;
+	sysFunc.argumentTypes = sysImport->argumentTypes;
+	sysFunc.function = sysImport->returnType == 2 ? &StubFunctionF : (sysImport->returnType == 3 ? &StubFunctionS : &StubFunction);
+	sysFuncs.push_back(sysFunc);
+	signatureToSysFunc[signature] = &sysFuncs.back();
+	return &sysFuncs.back();
+}
+
+std::string sysFuncReturnString;
+
+const char* StoreSysFuncString(const std::string& str)
+{
+	sysFuncReturnString = str;
+	return sysFuncReturnString.c_str();
+}
+
+// The sheep compiler and VM report errors through ReportManager. The real one brings in the console and file output,
+// so this replaces it with one that just writes to stdout.
+ReportManager::ReportManager() { }
+
+void ReportManager::Log(const std::string& streamName, const std::string& content)
+{
+	bool isError = streamName.find("Error") != std::string::npos;
+	if(isError)
+	{
+		++errorCount;
+	}
+	if(!quiet || isError)
+	{
+		std::cout << streamName << ": " << content << std::endl;
+	}
+}
+
+void HeadlessSheepAPI::SetQuiet(bool isQuiet)
+{
+	quiet = isQuiet;
+}
+
+void HeadlessSheepAPI::Reset()
+{
+	flags.clear();
+	gameVariables.clear();
+	chatCounts.clear();
+	nounVerbCounts.clear();
+	randomSeed = 1;
+	ConditionCache::Clear();
+}
+
+int HeadlessSheepAPI::GetErrorCount()
+{
+	return errorCount;
+}
+
+int HeadlessSheepAPI::GetStubCallCount()
+{
+	return stubCallCount;
+}
+
+// ACTORS
+std::string GetEgoName()
+{
+	ConditionCache::Read(ConditionInput::Ego);
+	return egoName;
+}
+RegFunc0(GetEgoName, string, IMMEDIATE, REL_FUNC);
+
+int IsCurrentEgo(string actorName)
+{
+	ConditionCache::Read(ConditionInput::Ego);
+	return StringUtil::EqualsIgnoreCase(egoName, actorName) ? 1 : 0;
+}
+RegFunc1(IsCurrentEgo, int, string, IMMEDIATE, REL_FUNC);
+
+// GAME LOGIC
+int GetFlag(Atom flagName)
+{
+	ConditionCache::Read(ConditionInput::Flag, flagName);
+	auto it = flags.find(flagName);
+	return it != flags.end() ? it->second : 0;
+}
+RegFunc1(GetFlag, int, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid SetFlag(Atom flagName)
+{
+	flags[flagName] = 1;
+	ConditionCache::Changed(ConditionInput::Flag, flagName);
+	return 0;
+}
+RegFunc1(SetFlag, void, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid ClearFlag(Atom flagName)
+{
+	flags[flagName] = 0;
+	ConditionCache::Changed(ConditionInput::Flag, flagName);
+	return 0;
+}
+RegFunc1(ClearFlag, void, Atom, IMMEDIATE, REL_FUNC);
+
+int GetChatCount(Atom noun)
+{
+	ConditionCache::Read(ConditionInput::ChatCount, noun);
+	auto it = chatCounts.find(noun);
+	return it != chatCounts.end() ? it->second : 0;
+}
+RegFunc1(GetChatCount, int, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid SetChatCount(Atom noun, int count)
+{
+	chatCounts[noun] = count;
+	ConditionCache::Changed(ConditionInput::ChatCount, noun);
+	return 0;
+}
+RegFunc2(SetChatCount, void, Atom, int, IMMEDIATE, DEV_FUNC);
+
+int GetGameVariableInt(Atom varName)
+{
+	ConditionCache::Read(ConditionInput::GameVariable, varName);
+	auto it = gameVariables.find(varName);
+	return it != gameVariables.end() ? it->second : 0;
+}
+RegFunc1(GetGameVariableInt, int, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid IncGameVariableInt(Atom varName)
+{
+	++gameVariables[varName];
+	ConditionCache::Changed(ConditionInput::GameVariable, varName);
+	return 0;
+}
+RegFunc1(IncGameVariableInt, void, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid SetGameVariableInt(Atom varName, int value)
+{
+	gameVariables[varName] = value;
+	ConditionCache::Changed(ConditionInput::GameVariable, varName);
+	return 0;
+}
+RegFunc2(SetGameVariableInt, void, Atom, int, IMMEDIATE, REL_FUNC);
+
+int GetNounVerbCount(Atom noun, Atom verb)
+{
+	U64 key = Atom::MakeKey(noun, verb);
+	ConditionCache::Read(ConditionInput::NounVerbCount, key);
+	auto it = nounVerbCounts.find(key);
+	return it != nounVerbCounts.end() ? it->second : 0;
+}
+RegFunc2(GetNounVerbCount, int, Atom, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid IncNounVerbCount(Atom noun, Atom verb)
+{
+	U64 key = Atom::MakeKey(noun, verb);
+	++nounVerbCounts[key];
+	ConditionCache::Changed(ConditionInput::NounVerbCount, key);
+	return 0;
+}
+RegFunc2(IncNounVerbCount, void, Atom, Atom, IMMEDIATE, REL_FUNC);
+
+shpvoid SetNounVerbCount(Atom noun, Atom verb, int count)
+{
+	U64 key = Atom::MakeKey(noun, verb);
+	nounVerbCounts[key] = count;
+	ConditionCache::Changed(ConditionInput::NounVerbCount, key);
+	return 0;
+}
+RegFunc3(SetNounVerbCount, void, Atom, Atom, int, IMMEDIATE, REL_FUNC);
+
+int IsCurrentLocation(std::string locationName)
+{
+	ConditionCache::Read(ConditionInput::Location);
+	return StringUtil::EqualsIgnoreCase(location, locationName) ? 1 : 0;
+}
+RegFunc1(IsCurrentLocation, int, string, IMMEDIATE, REL_FUNC);
+
+int IsCurrentTime(std::string timeblockName)
+{
+	ConditionCache::Read(ConditionInput::Timeblock);
+	return StringUtil::EqualsIgnoreCase(timeblock, timeblockName) ? 1 : 0;
+}
+RegFunc1(IsCurrentTime, int, string, IMMEDIATE, REL_FUNC);
+
+int GetRandomInt(int lower, int upper)
+{
+	// Both upper and lower are inclusive. A simple LCG is plenty here, and gives the same sequence every run.
+	randomSeed = randomSeed * 1103515245 + 12345;
+	return upper > lower ? lower + static_cast<int>((randomSeed >> 16) % (upper - lower + 1)) : lower;
+}
+RegFunc2(GetRandomInt, int, int, int, IMMEDIATE, REL_FUNC);
+
+// REPORTS
+shpvoid PrintFloat(float value)
+{
+	Services::GetReports()->Log("SheepScript", std::to_string(value));
+	return 0;
+}
+RegFunc1(PrintFloat, void, float, IMMEDIATE, DEV_FUNC);
+
+shpvoid PrintInt(int value)
+{
+	Services::GetReports()->Log("SheepScript", std::to_string(value));
+	return 0;
+}
+RegFunc1(PrintInt, void, int, IMMEDIATE, DEV_FUNC);
+
+shpvoid PrintString(std::string message)
+{
+	Services::GetReports()->Log("SheepScript", message);
+	return 0;
+}
+RegFunc1(PrintString, void, string, IMMEDIATE, DEV_FUNC);
@@ -0,0 +1,26 @@
+//
+// HeadlessSheepAPI.h
+//
+// Clark Kromenaker
+//
+// A stand-in for the game's sheep system functions (SheepAPI.cpp), for running sheep without the rest of the engine.
+//
+// A handful of commonly used system functions (flags, game variables, noun/verb counts, printing) are backed by
+// simple in-memory game state. Any other system function a script imports is declared on demand and does nothing.
+//
+#pragma once
+
+namespace HeadlessSheepAPI
+{
+	// If true, output from sheep (PrintString, etc) is discarded. Errors are always output.
+	void SetQuiet(bool quiet);
+
+	// Clears all game state (flags, variables, counts), so each run of a script starts from the same state.
+	void Reset();
+
+	// Number of errors logged (e.g. by the sheep compiler).
+	int GetErrorCount();
+
+	// Number of system function calls that went to on-demand declarations (functions the headless API doesn't implement).
+	int GetStubCallCount();
+}
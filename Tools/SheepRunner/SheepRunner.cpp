@@ -0,0 +1,215 @@
+//
+// SheepRunner.cpp
+//
+// Clark Kromenaker
+//
+// Runs sheep scripts without the rest of the engine (no window, rendering, or audio), and reports how fast they run.
+// Useful for benchmarking the sheep compiler and VM, and for catching performance regressions in CI.
+//
+// Usage: sheeprunner [-f function] [-n iterations] [-v] <script.shp | archive.brn>...
+// Each .SHP file can be sheep text or compiled sheep. For a barn, every sheep script in it is run.
+// System functions are provided by HeadlessSheepAPI; only a few have real behavior.
+//
+// Returns non-zero if any script couldn't be loaded, or if nothing was run.
+//
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BarnFile.h"
+#include "FileSystem.h"
+#include "HeadlessSheepAPI.h"
+#include "ReportManager.h"
+#include "Services.h"
+#include "SheepCompiler.h"
+#include "SheepScript.h"
+#include "SheepVM.h"
+#include "StringUtil.h"
+
+namespace
+{
+	SheepScript* LoadSheep(SheepCompiler& compiler, const std::string& name, char* data, int dataLength)
+	{
+		// Compiled sheep always starts with this identifier. Anything else is treated as sheep text.
+		if(dataLength >= 8 && std::string(data, 8) == "GK3Sheep")
+		{
+			return new SheepScript(name, data, dataLength);
+		}
+
+		// The compiler still creates a script for most errors (e.g. an unknown system function), so check for any logged errors too.
+		int errorCount = HeadlessSheepAPI::GetErrorCount();
+		SheepScript* script = compiler.Compile(name, std::string(data, dataLength));
+		if(script != nullptr && HeadlessSheepAPI::GetErrorCount() > errorCount)
+		{
+			delete script;
+			script = nullptr;
+		}
+		return script;
+	}
+
+	bool LoadFile(SheepCompiler& compiler, const std::string& filePath, std::vector<SheepScript*>& scripts)
+	{
+		std::ifstream file(filePath, std::ios::in | std::ios::binary);
+		if(!file.good())
+		{
+			std::cout << "Could not open " << filePath << std::endl;
+			return false;
+		}
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		SheepScript* script = LoadSheep(compiler, Path::GetFileNameNoExtension(filePath), &data[0], static_cast<int>(data.size()));
+		if(script == nullptr)
+		{
+			std::cout << "Could not load sheep from " << filePath << std::endl;
+			return false;
+		}
+		scripts.push_back(script);
+		return true;
+	}
+
+	bool LoadBarn(SheepCompiler& compiler, const std::string& filePath, std::vector<SheepScript*>& scripts)
+	{
+		BarnFile barn(filePath);
+		if(!barn.CanRead())
+		{
+			std::cout << "Could not open " << filePath << std::endl;
+			return false;
+		}
+
+		bool success = true;
+		for(auto& assetName : barn.GetAssetNames(".SHP"))
+		{
+			BarnAsset* asset = barn.GetAsset(assetName);
+			unsigned int bufferSize = asset->uncompressedSize;
+			char* buffer = new char[bufferSize];
+			SheepScript* script = nullptr;
+			if(barn.Extract(assetName, buffer, bufferSize))
+			{
+				script = LoadSheep(compiler, Path::GetFileNameNoExtension(assetName), buffer, bufferSize);
+			}
+			delete[] buffer;
+
+			if(script == nullptr)
+			{
+				std::cout << "Could not load sheep " << assetName << " from " << filePath << std::endl;
+				success = false;
+				continue;
+			}
+			scripts.push_back(script);
+		}
+		return success;
+	}
+
+	void Run(SheepVM& vm, SheepScript* script, int bytecodeOffset)
+	{
+		// Every run starts from the same game state, so iterations do the same work.
+		HeadlessSheepAPI::Reset();
+		vm.Execute(script, bytecodeOffset, nullptr);
+	}
+}
+
+int main(int argc, const char* argv[])
+{
+	ReportManager reportManager;
+	Services::SetReports(&reportManager);
+
+	std::string functionName;
+	int iterations = 1000;
+	bool verbose = false;
+	std::vector<std::string> filePaths;
+	for(int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if(arg == "-f" && i + 1 < argc)
+		{
+			functionName = argv[++i];
+		}
+		else if(arg == "-n" && i + 1 < argc)
+		{
+			iterations = std::max(1, StringUtil::ToInt(argv[++i]));
+		}
+		else if(arg == "-v")
+		{
+			verbose = true;
+		}
+		else
+		{
+			filePaths.push_back(arg);
+		}
+	}
+	if(filePaths.empty())
+	{
+		std::cout << "Usage: sheeprunner [-f function] [-n iterations] [-v] <script.shp | archive.brn>..." << std::endl;
+		return 1;
+	}
+	HeadlessSheepAPI::SetQuiet(!verbose);
+
+	// Load everything up front, so compile time isn't counted as run time.
+	SheepCompiler compiler;
+	std::vector<SheepScript*> scripts;
+	bool success = true;
+	for(auto& filePath : filePaths)
+	{
+		bool isBarn = filePath.size() > 4 && StringUtil::EqualsIgnoreCase(filePath.substr(filePath.size() - 4), ".brn");
+		success &= isBarn ? LoadBarn(compiler, filePath, scripts) : LoadFile(compiler, filePath, scripts);
+	}
+
+	SheepVM vm;
+	SheepProfiler& profiler = vm.GetProfiler();
+	std::cout << std::fixed << std::setprecision(2);
+	for(SheepScript* script : scripts)
+	{
+		// Run the first function, unless another one was asked for.
+		int bytecodeOffset = functionName.empty() ? 0 : script->GetFunctionOffset(functionName);
+		if(bytecodeOffset < 0)
+		{
+			std::cout << script->GetName() << ": no function named " << functionName << std::endl;
+			success = false;
+			continue;
+		}
+
+		// One profiled run, to count the instructions executed per run.
+		profiler.SetEnabled(true);
+		Run(vm, script, bytecodeOffset);
+		profiler.SetEnabled(false);
+		U64 instructionCount = profiler.GetInstructionCount();
+
+		// Then the timed runs.
+		int stubCallCount = HeadlessSheepAPI::GetStubCallCount();
+		SheepProfiler::Clock::time_point start = SheepProfiler::Now();
+		for(int i = 0; i < iterations; i++)
+		{
+			Run(vm, script, bytecodeOffset);
+		}
+		SheepProfiler::Clock::time_point end = SheepProfiler::Now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		double microsecondsPerRun = seconds * 1000000.0 / iterations;
+		double instructionsPerSecond = seconds > 0.0 ? instructionCount * iterations / seconds : 0.0;
+		std::cout << script->GetName() << ": " << iterations << " runs in " << seconds * 1000.0 << " ms, "
+				  << microsecondsPerRun << " us/run, " << instructionCount << " instructions/run, "
+				  << instructionsPerSecond / 1000000.0 << "M instructions/s";
+		if(HeadlessSheepAPI::GetStubCallCount() > stubCallCount)
+		{
+			std::cout << " (called unimplemented system functions)";
+		}
+		std::cout << std::endl;
+
+		if(vm.IsAnyRunning())
+		{
+			std::cout << script->GetName() << ": still running after last run (waiting on something that never finishes?)" << std::endl;
+			success = false;
+		}
+	}
+
+	if(scripts.empty())
+	{
+		std::cout << "No sheep scripts were run." << std::endl;
+		success = false;
+	}
+	return success ? 0 : 1;
+}
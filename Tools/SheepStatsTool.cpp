@@ -0,0 +1,86 @@
+//
+// SheepStatsTool.cpp
+//
+// Clark Kromenaker
+//
+// Offline tool that reports how much the sheep optimizer shrinks the game's sheep scripts.
+// Loads every sheep script (.SHP) in the game's assets and compares instruction counts before and after optimization.
+//
+// Run from the game's working directory (so "Assets" can be found).
+//
+#include <iomanip>
+#include <iostream>
+
+#include "AssetManager.h"
+#include "ReportManager.h"
+#include "Services.h"
+
+int main(int argc, const char* argv[])
+{
+	ReportManager reportManager;
+	Services::SetReports(&reportManager);
+
+	// Find assets the same way the game does (see GEngine::Initialize).
+	AssetManager assetManager;
+	Services::SetAssets(&assetManager);
+	assetManager.AddSearchPath("Assets/");
+	assetManager.AddSearchPath("Assets/GK3/");
+	std::vector<std::string> barns = {
+		"ambient.brn",
+		"common.brn",
+		"core.brn",
+		"day1.brn",
+		"day2.brn",
+		"day3.brn",
+		"day23.brn",
+		"day123.brn"
+	};
+	for(auto& barn : barns)
+	{
+		if(!assetManager.LoadBarn(barn))
+		{
+			std::cout << "Could not load barn: " << barn << std::endl;
+			return 1;
+		}
+	}
+
+	// Scripts are decoded and optimized as they load.
+	int scriptCount = 0;
+	long long unoptimizedCount = 0;
+	long long optimizedCount = 0;
+	long long instructionCounts[kSheepDecodedInstructionCount] = { };
+	for(auto& sheepName : assetManager.GetBarnAssetNames(".SHP"))
+	{
+		SheepScript* script = assetManager.LoadSheep(sheepName);
+		if(script == nullptr) { continue; }
+
+		++scriptCount;
+		unoptimizedCount += script->GetUnoptimizedInstructionCount();
+		optimizedCount += script->GetInstructions().size();
+		for(auto& instruction : script->GetInstructions())
+		{
+			++instructionCounts[static_cast<int>(instruction.instruction)];
+		}
+	}
+
+	std::cout << "Optimized " << scriptCount << " sheep scripts: " << unoptimizedCount << " instructions before, "
+			  << optimizedCount << " instructions after";
+	if(unoptimizedCount > 0)
+	{
+		double removed = 100.0 * (unoptimizedCount - optimizedCount) / unoptimizedCount;
+		std::cout << " (" << std::fixed << std::setprecision(1) << removed << "% fewer)";
+	}
+	std::cout << std::endl;
+
+	// Show how often each superinstruction was used.
+	const char* superinstructionNames[] = {
+		"PushStringConst",
+		"CallSysFunctionArgsV", "CallSysFunctionArgsI", "CallSysFunctionArgsF", "CallSysFunctionArgsS",
+		"CompareConstI", "LoadCompareConstI", "CompareConstBranchI", "LoadCompareConstBranchI"
+	};
+	for(int i = kSheepInstructionCount; i < kSheepDecodedInstructionCount; i++)
+	{
+		std::cout << "  " << superinstructionNames[i - kSheepInstructionCount] << ": " << instructionCounts[i] << std::endl;
+	}
+	return 0;
+}